@@ -2,118 +2,351 @@
 // Licensed under the MIT License.
 #include "acc_task.h"
 
-#include <cstdlib>
+#include <chrono>
 #include <cstring>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <variant>
 #include <vector>
 
-static std::vector<Ort::Value> RunInference(Ort::Session& session, const ModelIOInfo& model_io_info,
-                                            Span<const char> input_buffer) {
+// Gets the data of a tensor for all datasets in a batch as a single span. Returns false if the datasets' tensors are
+// not adjacent in memory (consecutive datasets in a shape group buffer are always adjacent).
+static bool GetContiguousBatchData(const DatasetsIOData& io_data, Span<const size_t> dataset_indices,
+                                   size_t tensor_index, Span<char>& batch_data) {
+  const Span<char> first_data = io_data.datasets[dataset_indices[0]].tensors[tensor_index].data;
+  const size_t tensor_size = first_data.size();
+  const size_t batch_size = dataset_indices.size();
+
+  for (size_t b = 1; b < batch_size; b++) {
+    const Span<char> data = io_data.datasets[dataset_indices[b]].tensors[tensor_index].data;
+    if (data.data() != first_data.data() + b * tensor_size || data.size() != tensor_size) {
+      return false;
+    }
+  }
+
+  batch_data = Span<char>(first_data.data(), tensor_size * batch_size);
+  return true;
+}
+
+// Returns the data for an input stacked across all datasets in a batch. The data is used in place if the datasets'
+// tensors are already contiguous. Otherwise, the data is copied into a new staging buffer.
+static Span<char> StackInputData(const DatasetsIOData& all_inputs, Span<const size_t> dataset_indices,
+                                 size_t input_index, std::vector<std::unique_ptr<char[]>>& staging_buffers) {
+  Span<char> batch_data;
+  if (GetContiguousBatchData(all_inputs, dataset_indices, input_index, batch_data)) {
+    return batch_data;
+  }
+
+  const size_t tensor_size = all_inputs.datasets[dataset_indices[0]].tensors[input_index].data.size();
+  const size_t batch_size = dataset_indices.size();
+
+  staging_buffers.emplace_back(std::make_unique<char[]>(tensor_size * batch_size));
+  char* staging_buffer = staging_buffers.back().get();
+
+  for (size_t b = 0; b < batch_size; b++) {
+    const Span<char> data = all_inputs.datasets[dataset_indices[b]].tensors[input_index].data;
+    std::memcpy(staging_buffer + b * tensor_size, data.data(), tensor_size);
+  }
+
+  return Span<char>(staging_buffer, tensor_size * batch_size);
+}
+
+// Creates output values over the pre-allocated output buffers of a batch's datasets, which allows ORT to write the
+// outputs directly into their final location. Returns false if the outputs were not pre-allocated (e.g., the output
+// shapes depend on the model's computation) or are not contiguous across the batch.
+static bool BindPreallocatedOutputs(const ModelIOInfo& model_io_info, const DatasetsIOData& all_outputs,
+                                    Span<const size_t> dataset_indices, std::vector<Ort::Value>& ort_outputs) {
+  const std::vector<IOInfo>& output_infos = model_io_info.outputs;
+  const size_t num_outputs = output_infos.size();
+  const size_t batch_size = dataset_indices.size();
+
+  for (size_t b = 0; b < batch_size; b++) {
+    if (all_outputs.datasets[dataset_indices[b]].tensors.size() != num_outputs) {
+      return false;
+    }
+  }
+
+  std::vector<Span<char>> batch_data(num_outputs);
+  for (size_t i = 0; i < num_outputs; i++) {
+    if (!GetContiguousBatchData(all_outputs, dataset_indices, i, batch_data[i])) {
+      return false;
+    }
+  }
+
+  const DatasetIOData& first_dataset = all_outputs.datasets[dataset_indices[0]];
+  ort_outputs.clear();
+  ort_outputs.reserve(num_outputs);
+
+  for (size_t i = 0; i < num_outputs; i++) {
+    std::vector<int64_t> shape = first_dataset.tensors[i].shape;
+
+    if (batch_size > 1) {
+      shape[0] *= static_cast<int64_t>(batch_size);
+    }
+
+    ort_outputs.emplace_back(Ort::Value::CreateTensor(model_io_info.cpu_memory_info, batch_data[i].data(),
+                                                      batch_data[i].size(), shape.data(), shape.size(),
+                                                      output_infos[i].data_type));
+  }
+
+  return true;
+}
+
+// Runs a batch of datasets. If `ort_outputs` is not empty, the outputs are written into the given (pre-allocated)
+// output values. Otherwise, ORT allocates the outputs and `ort_outputs` is set to the results.
+static void RunInference(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+                         Span<const size_t> dataset_indices, std::vector<Ort::Value>& ort_outputs) {
   // Setup input
   const std::vector<IOInfo>& input_infos = model_io_info.inputs;
   const size_t num_inputs = input_infos.size();
+  const size_t batch_size = dataset_indices.size();
+  const DatasetIOData& first_dataset = all_inputs.datasets[dataset_indices[0]];
   std::vector<Ort::Value> ort_inputs;
-  std::vector<const char*> ort_input_names;
+  std::vector<std::unique_ptr<char[]>> staging_buffers;  // Must outlive the call to Run().
 
   ort_inputs.reserve(num_inputs);
-  ort_input_names.reserve(num_inputs);
 
-  for (size_t input_offset = 0, i = 0; i < num_inputs; input_offset += input_infos[i].total_data_size, i++) {
-    assert(input_offset < input_buffer.size());
-    const IOInfo& input_info = input_infos[i];
-    Span<const char> input_data(&input_buffer[input_offset], input_info.total_data_size);
-    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+  for (size_t i = 0; i < num_inputs; i++) {
+    const TensorData& input_tensor = first_dataset.tensors[i];
+    std::vector<int64_t> shape = input_tensor.shape;
+    Span<char> data = input_tensor.data;
+
+    if (batch_size > 1) {
+      shape[0] *= static_cast<int64_t>(batch_size);
+      data = StackInputData(all_inputs, dataset_indices, i, staging_buffers);
+    }
+
+    ort_inputs.emplace_back(Ort::Value::CreateTensor(model_io_info.cpu_memory_info, data.data(), data.size(),
+                                                     shape.data(), shape.size(), input_infos[i].data_type));
+  }
 
-    ort_inputs.emplace_back(Ort::Value::CreateTensor(memory_info, (void*)input_data.data(), input_data.size(),
-                                                     input_info.shape.data(), input_info.shape.size(),
-                                                     input_info.data_type));
-    ort_input_names.push_back(input_info.name.c_str());
+  if (!ort_outputs.empty()) {
+    session.Run(Ort::RunOptions{nullptr}, model_io_info.input_names.data(), ort_inputs.data(), ort_inputs.size(),
+                model_io_info.output_names.data(), ort_outputs.data(), ort_outputs.size());
+    return;
   }
 
-  const size_t num_outputs = model_io_info.outputs.size();
-  std::vector<const char*> ort_output_names;
-  ort_output_names.reserve(num_outputs);
+  ort_outputs = session.Run(Ort::RunOptions{nullptr}, model_io_info.input_names.data(), ort_inputs.data(),
+                            ort_inputs.size(), model_io_info.output_names.data(), model_io_info.output_names.size());
+}
+
+// Gets the shape and data of the part of a (possibly batched) output that belongs to the dataset at `batch_index`.
+// Returns false if the output can't be split into the batch's datasets.
+static bool GetBatchSlice(const Ort::Value& ort_output, const IOInfo& output_info, size_t batch_size,
+                          size_t batch_index, std::vector<int64_t>& slice_shape, Span<const char>& slice_data) {
+  slice_shape = ort_output.GetTensorTypeAndShapeInfo().GetShape();
+  const char* output_data = static_cast<const char*>(ort_output.GetTensorRawData());
+  const size_t output_size = output_info.GetDataSize(Span<const int64_t>(slice_shape));
 
-  for (size_t i = 0; i < num_outputs; i++) {
-    ort_output_names.push_back(model_io_info.outputs[i].name.c_str());
+  if (batch_size == 1) {
+    slice_data = Span<const char>(output_data, output_size);
+    return true;
   }
 
-  return session.Run(Ort::RunOptions{nullptr}, ort_input_names.data(), ort_inputs.data(), ort_inputs.size(),
-                     ort_output_names.data(), ort_output_names.size());
+  if (slice_shape.empty() || slice_shape[0] % static_cast<int64_t>(batch_size) != 0) {
+    std::cerr << "[ERROR]: The leading dimension of batched output " << output_info.name
+              << " is not a multiple of the batch size (" << batch_size << ")." << std::endl;
+    return false;
+  }
+
+  slice_shape[0] /= static_cast<int64_t>(batch_size);
+  const size_t slice_size = output_info.GetDataSize(Span<const int64_t>(slice_shape));
+
+  if (slice_size * batch_size != output_size) {
+    std::cerr << "[ERROR]: Batched output " << output_info.name << " can't be split at byte boundaries." << std::endl;
+    return false;
+  }
+
+  slice_data = Span<const char>(output_data + batch_index * slice_size, slice_size);
+  return true;
 }
 
-Task::Task(Ort::Session& session, const ModelIOInfo& model_io_info, Span<const char> input_buffer,
-           Span<char> output_buffer)
+Task::Task(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+           Span<const size_t> dataset_indices, DatasetsIOData& all_outputs)
     : session_(session),
       model_io_info_(model_io_info),
-      input_buffer_(input_buffer),
-      variant_(Inference{output_buffer}) {}
+      all_inputs_(all_inputs),
+      dataset_indices_(dataset_indices),
+      variant_(Inference{&all_outputs}) {}
 
-Task::Task(Ort::Session& session, const ModelIOInfo& model_io_info, Span<const char> input_buffer,
-           Span<const char> expected_output_buffer, Span<AccMetrics> output_acc_metric)
+Task::Task(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+           Span<const size_t> dataset_indices, const DatasetsIOData& all_expected_outputs,
+           Span<std::vector<AccMetrics>> all_acc_metrics, size_t top_k)
     : session_(session),
       model_io_info_(model_io_info),
-      input_buffer_(input_buffer),
-      variant_(AccuracyCheck{expected_output_buffer, output_acc_metric}) {}
+      all_inputs_(all_inputs),
+      dataset_indices_(dataset_indices),
+      variant_(AccuracyCheck{&all_expected_outputs, all_acc_metrics, top_k}) {}
 
-Task Task::CreateInferenceTask(Ort::Session& session, const ModelIOInfo& model_io_info, Span<const char> input_buffer,
-                               Span<char> output_buffer) {
-  return Task(session, model_io_info, input_buffer, output_buffer);
+Task::Task(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+           Span<const size_t> dataset_indices, Span<double> latencies_ms)
+    : session_(session),
+      model_io_info_(model_io_info),
+      all_inputs_(all_inputs),
+      dataset_indices_(dataset_indices),
+      variant_(Benchmark{latencies_ms}) {}
+
+Task Task::CreateInferenceTask(Ort::Session& session, const ModelIOInfo& model_io_info,
+                               const DatasetsIOData& all_inputs, Span<const size_t> dataset_indices,
+                               DatasetsIOData& all_outputs) {
+  return Task(session, model_io_info, all_inputs, dataset_indices, all_outputs);
 }
 
 Task Task::CreateAccuracyCheckTask(Ort::Session& session, const ModelIOInfo& model_io_info,
-                                   Span<const char> input_buffer, Span<const char> expected_output_buffer,
-                                   Span<AccMetrics> output_acc_metric) {
-  return Task(session, model_io_info, input_buffer, expected_output_buffer, output_acc_metric);
+                                   const DatasetsIOData& all_inputs, Span<const size_t> dataset_indices,
+                                   const DatasetsIOData& all_expected_outputs,
+                                   Span<std::vector<AccMetrics>> all_acc_metrics, size_t top_k) {
+  return Task(session, model_io_info, all_inputs, dataset_indices, all_expected_outputs, all_acc_metrics, top_k);
+}
+
+Task Task::CreateBenchmarkTask(Ort::Session& session, const ModelIOInfo& model_io_info,
+                               const DatasetsIOData& all_inputs, Span<const size_t> dataset_indices,
+                               Span<double> latencies_ms) {
+  return Task(session, model_io_info, all_inputs, dataset_indices, latencies_ms);
 }
 
-void Task::Run() {
+bool Task::Run() {
   AccuracyCheck* accuracy_check_data = std::get_if<AccuracyCheck>(&variant_);
   if (accuracy_check_data) {
-    RunAsAccuracyCheckTask(*accuracy_check_data);
-    return;
+    return RunAsAccuracyCheckTask(*accuracy_check_data);
   }
 
   Inference* inference_data = std::get_if<Inference>(&variant_);
   if (inference_data) {
-    RunAsInferenceTask(*inference_data);
-    return;
+    return RunAsInferenceTask(*inference_data);
+  }
+
+  Benchmark* benchmark_data = std::get_if<Benchmark>(&variant_);
+  if (benchmark_data) {
+    return RunAsBenchmarkTask(*benchmark_data);
   }
 
   // Should not reach this line unless we add a new (unhandled) std::variant type.
   std::cerr << "[ERROR]: Unhandled std::variant type for Task::variant_ member." << std::endl;
-  std::abort();
+  return false;
 }
 
-void Task::RunAsInferenceTask(Inference& inference_args) {
-  std::vector<Ort::Value> ort_output_vals = RunInference(session_, model_io_info_, input_buffer_);
-  Span<char>& output_buffer = inference_args.output_buffer;
+bool Task::RunAsInferenceTask(Inference& inference_args) {
+  std::vector<Ort::Value> ort_output_vals;
+
+  // Let ORT write the outputs directly into the pre-allocated output buffers, if possible.
+  const bool outputs_bound =
+      BindPreallocatedOutputs(model_io_info_, *inference_args.all_outputs, dataset_indices_, ort_output_vals);
+
+  RunInference(session_, model_io_info_, all_inputs_, dataset_indices_, ort_output_vals);
+
+  if (outputs_bound) {
+    return true;
+  }
 
-  // Unfortunately, we have to copy output values (Ort::Value is not copyable, so it is limited when stored in a
-  // std::vector)
+  // The output shapes are only known after the run (the output shapes depend on the model's computation), so size
+  // the output buffers here. Unfortunately, we have to copy output values (Ort::Value is not copyable, so it is
+  // limited when stored in a std::vector)
   const std::vector<IOInfo>& output_infos = model_io_info_.get().outputs;
   const size_t num_outputs = output_infos.size();
+  const size_t batch_size = dataset_indices_.size();
+  std::vector<Span<const char>> output_slices(num_outputs);
 
-  for (size_t output_offset = 0, i = 0; i < num_outputs; output_offset += output_infos[i].total_data_size, i++) {
-    assert(output_offset < output_buffer.size());
-    std::memcpy(&output_buffer[output_offset], ort_output_vals[i].GetTensorRawData(), output_infos[i].total_data_size);
+  for (size_t b = 0; b < batch_size; b++) {
+    DatasetIOData& output_data = inference_args.all_outputs->datasets[dataset_indices_[b]];
+    size_t total_output_size = 0;
+
+    output_data.tensors.resize(num_outputs);
+    for (size_t i = 0; i < num_outputs; i++) {
+      if (!GetBatchSlice(ort_output_vals[i], output_infos[i], batch_size, b, output_data.tensors[i].shape,
+                         output_slices[i])) {
+        return false;
+      }
+      total_output_size += output_slices[i].size();
+    }
+
+    output_data.owned_buffer = std::make_unique<char[]>(total_output_size);
+
+    for (size_t output_offset = 0, i = 0; i < num_outputs; i++) {
+      TensorData& output_tensor = output_data.tensors[i];
+      const size_t output_size = output_slices[i].size();
+
+      assert(output_offset + output_size <= total_output_size);
+      output_tensor.data = Span<char>(output_data.owned_buffer.get() + output_offset, output_size);
+      std::memcpy(output_tensor.data.data(), output_slices[i].data(), output_size);
+      output_offset += output_size;
+    }
   }
+
+  return true;
 }
 
-void Task::RunAsAccuracyCheckTask(AccuracyCheck& accuracy_check_args) {
-  std::vector<Ort::Value> ort_output_vals = RunInference(session_, model_io_info_, input_buffer_);
+// Returns the metrics recorded for an output whose shape differs from the expected output. The floating-point
+// metrics are NaN so that they are not mistaken for real measurements in the results.
+static AccMetrics GetShapeMismatchMetrics() {
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  AccMetrics metrics;
+  metrics.rmse = nan;
+  metrics.snr = nan;
+  metrics.min_val = nan;
+  metrics.max_val = nan;
+  metrics.min_expected_val = nan;
+  metrics.max_expected_val = nan;
+  metrics.cosine_similarity = nan;
+  metrics.max_abs_error = nan;
+  metrics.max_rel_error = nan;
+  metrics.top_k_agreement = nan;
+  metrics.shape_mismatch = true;
+  return metrics;
+}
+
+bool Task::RunAsAccuracyCheckTask(AccuracyCheck& accuracy_check_args) {
+  std::vector<Ort::Value> ort_output_vals;
+  RunInference(session_, model_io_info_, all_inputs_, dataset_indices_, ort_output_vals);
 
   const std::vector<IOInfo>& output_infos = model_io_info_.get().outputs;
   const size_t num_outputs = output_infos.size();
-  Span<const char> expected_output_buffer = accuracy_check_args.expected_output_buffer;
+  const size_t batch_size = dataset_indices_.size();
+  std::vector<int64_t> actual_shape;
+  Span<const char> actual_data;
+
+  for (size_t b = 0; b < batch_size; b++) {
+    const size_t dataset_index = dataset_indices_[b];
+    const DatasetIOData& expected_output_data = accuracy_check_args.all_expected_outputs->datasets[dataset_index];
+    std::vector<AccMetrics>& acc_metrics = accuracy_check_args.all_acc_metrics[dataset_index];
+
+    for (size_t i = 0; i < num_outputs; i++) {
+      const IOInfo& output_info = output_infos[i];
+      const TensorData& expected_output = expected_output_data.tensors[i];
 
-  for (size_t output_offset = 0, i = 0; i < num_outputs; output_offset += output_infos[i].total_data_size, i++) {
-    assert(output_offset < expected_output_buffer.size());
-    const IOInfo& output_info = output_infos[i];
-    Span<const char> raw_expected_output(&expected_output_buffer[output_offset], output_info.total_data_size);
+      if (!GetBatchSlice(ort_output_vals[i], output_info, batch_size, b, actual_shape, actual_data)) {
+        return false;
+      }
 
-    accuracy_check_args.output_acc_metric[i] =
-        ComputeAccuracyMetric(ort_output_vals[i].GetConst(), raw_expected_output, output_info);
+      // A shape mismatch fails this dataset's test, but the remaining outputs and datasets are still checked.
+      if (actual_shape != expected_output.shape) {
+        std::cerr << "[ERROR]: The shape of output " << output_info.name << " does not match the shape of the "
+                  << "expected output for dataset " << dataset_index << "." << std::endl;
+        acc_metrics[i] = GetShapeMismatchMetrics();
+        continue;
+      }
+
+      if (!ComputeAccuracyMetric(actual_data, expected_output.data, Span<const int64_t>(actual_shape), output_info,
+                                 accuracy_check_args.top_k, acc_metrics[i])) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool Task::RunAsBenchmarkTask(Benchmark& benchmark_args) {
+  for (size_t r = 0; r < benchmark_args.latencies_ms.size(); r++) {
+    std::vector<Ort::Value> ort_output_vals;
+
+    const auto start_time = std::chrono::steady_clock::now();
+    RunInference(session_, model_io_info_, all_inputs_, dataset_indices_, ort_output_vals);
+    const auto end_time = std::chrono::steady_clock::now();
+
+    benchmark_args.latencies_ms[r] = std::chrono::duration<double, std::milli>(end_time - start_time).count();
   }
+
+  return true;
 }
@@ -5,24 +5,35 @@
 
 #include <functional>
 #include <variant>
+#include <vector>
 
 #include "basic_utils.h"
+#include "data_loader.h"
 #include "model_io_utils.h"
 
 /// <summary>
 /// A class representing an "inference" or "accuracy-check" task that can be executed
 /// on a separate thread. The task is created with a *dedicated* region of memory into which it can
 /// write its results.
+///
+/// A task runs a batch of one or more datasets with identical input shapes. A batch with multiple datasets is run
+/// with a single call to Session::Run() by stacking the datasets along the leading dimension of every input.
+/// The outputs are then split back into per-dataset results.
 /// </summary>
 class Task {
  private:
   struct Inference {
-    Span<char> output_buffer;
+    DatasetsIOData* all_outputs;
   };
 
   struct AccuracyCheck {
-    Span<const char> expected_output_buffer;
-    Span<AccMetrics> output_acc_metric;
+    const DatasetsIOData* all_expected_outputs;
+    Span<std::vector<AccMetrics>> all_acc_metrics;  // Indexed by dataset.
+    size_t top_k;
+  };
+
+  struct Benchmark {
+    Span<double> latencies_ms;  // One entry per run.
   };
 
  public:
@@ -30,45 +41,73 @@ class Task {
   Task(const Task& other) = default;
 
   /// <summary>
-  /// Creates a Task that runs a session and stores the inference results in an output buffer.
+  /// Creates a Task that runs a session and stores the inference results (and their shapes) in the output data.
+  /// The output buffers are allocated by the task once the actual output shapes are known.
   /// </summary>
   /// <param name="session">The initialized ONNX Runtime session</param>
   /// <param name="model_io_info">Information about the model's input and output tensors</param>
-  /// <param name="input_buffer">Constant byte buffer containing the model's input data</param>
-  /// <param name="output_buffer">Output byte buffer into which to store the model's output</param>
+  /// <param name="all_inputs">The model's input data for all datasets</param>
+  /// <param name="dataset_indices">The datasets to run as a single batch</param>
+  /// <param name="all_outputs">Output into which to store the model's outputs for the batch's datasets</param>
   /// <returns>The new inference task</returns>
   static Task CreateInferenceTask(Ort::Session& session, const ModelIOInfo& model_io_info,
-                                  Span<const char> input_buffer, Span<char> output_buffer);
+                                  const DatasetsIOData& all_inputs, Span<const size_t> dataset_indices,
+                                  DatasetsIOData& all_outputs);
 
   /// <summary>
   /// Creates a Task that runs a session and computes the accuracy when compared against expected results.
   /// </summary>
   /// <param name="session">The initialized ONNX Runtime session</param>
   /// <param name="model_io_info">Information about the model's input and output tensors</param>
-  /// <param name="input_buffer">Constant byte buffer containing the model's input data</param>
-  /// <param name="expected_output_buffer">Constant byte buffer containing the expected inference results</param>
-  /// <param name="output_acc_metric">Output buffer into which to store the accuracy results</param>
+  /// <param name="all_inputs">The model's input data for all datasets</param>
+  /// <param name="dataset_indices">The datasets to run as a single batch</param>
+  /// <param name="all_expected_outputs">The expected inference results for all datasets</param>
+  /// <param name="all_acc_metrics">Output into which to store the accuracy results of the batch's datasets</param>
+  /// <param name="top_k">The number of largest output elements to compare for the top-k metrics</param>
   /// <returns>The new accuracy-check task</returns>
   static Task CreateAccuracyCheckTask(Ort::Session& session, const ModelIOInfo& model_io_info,
-                                      Span<const char> input_buffer, Span<const char> expected_output_buffer,
-                                      Span<AccMetrics> output_acc_metric);
+                                      const DatasetsIOData& all_inputs, Span<const size_t> dataset_indices,
+                                      const DatasetsIOData& all_expected_outputs,
+                                      Span<std::vector<AccMetrics>> all_acc_metrics, size_t top_k);
+
+  /// <summary>
+  /// Creates a Task that runs a session repeatedly with the same inputs and records the latency of every run.
+  /// The outputs are discarded.
+  /// </summary>
+  /// <param name="session">The initialized ONNX Runtime session</param>
+  /// <param name="model_io_info">Information about the model's input and output tensors</param>
+  /// <param name="all_inputs">The model's input data for all datasets</param>
+  /// <param name="dataset_indices">The datasets to run as a single batch</param>
+  /// <param name="latencies_ms">Output into which to store the latency (in milliseconds) of each run. The number of
+  /// runs is the size of this span.</param>
+  /// <returns>The new benchmark task</returns>
+  static Task CreateBenchmarkTask(Ort::Session& session, const ModelIOInfo& model_io_info,
+                                  const DatasetsIOData& all_inputs, Span<const size_t> dataset_indices,
+                                  Span<double> latencies_ms);
 
   /// <summary>
   /// Runs the task.
   /// </summary>
-  void Run();
+  /// <returns>True on success. False if the outputs can't be split into the batch's datasets or compared with the
+  /// expected outputs (an error is printed).</returns>
+  bool Run();
 
  private:
-  Task(Ort::Session& session, const ModelIOInfo& model_io_info, Span<const char> input_buffer,
-       Span<char> output_buffer);
-  Task(Ort::Session& session, const ModelIOInfo& model_io_info, Span<const char> input_buffer,
-       Span<const char> expected_output_buffer, Span<AccMetrics> output_acc_metric);
+  Task(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+       Span<const size_t> dataset_indices, DatasetsIOData& all_outputs);
+  Task(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+       Span<const size_t> dataset_indices, const DatasetsIOData& all_expected_outputs,
+       Span<std::vector<AccMetrics>> all_acc_metrics, size_t top_k);
+  Task(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+       Span<const size_t> dataset_indices, Span<double> latencies_ms);
 
-  void RunAsInferenceTask(Inference& inference_args);
-  void RunAsAccuracyCheckTask(AccuracyCheck& accuracy_check_args);
+  bool RunAsInferenceTask(Inference& inference_args);
+  bool RunAsAccuracyCheckTask(AccuracyCheck& accuracy_check_args);
+  bool RunAsBenchmarkTask(Benchmark& benchmark_args);
 
   std::reference_wrapper<Ort::Session> session_;
   std::reference_wrapper<const ModelIOInfo> model_io_info_;
-  Span<const char> input_buffer_;
-  std::variant<Inference, AccuracyCheck> variant_;
+  std::reference_wrapper<const DatasetsIOData> all_inputs_;
+  Span<const size_t> dataset_indices_;
+  std::variant<Inference, AccuracyCheck, Benchmark> variant_;
 };
@@ -0,0 +1,501 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include "accuracy_results.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+
+#include "mapped_file.h"
+
+static void AppendDouble(std::string& buffer, double value) {
+  std::array<char, 32> chars;
+  const std::to_chars_result result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+  assert(result.ec == std::errc());
+  buffer.append(chars.data(), result.ptr);
+}
+
+static void AppendUInt(std::string& buffer, uint64_t value) {
+  std::array<char, 24> chars;
+  const std::to_chars_result result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+  assert(result.ec == std::errc());
+  buffer.append(chars.data(), result.ptr);
+}
+
+// JSON cannot represent NaN or infinity, so those are written as null.
+static void AppendJsonDouble(std::string& buffer, double value) {
+  if (std::isfinite(value)) {
+    AppendDouble(buffer, value);
+  } else {
+    buffer += "null";
+  }
+}
+
+// Returns the CSV column names (without the "Output_<index>_" prefix) written for an accuracy metric.
+static std::vector<const char*> GetCSVMetricColumnNames(AccMetricType metric_type) {
+  switch (metric_type) {
+    case AccMetricType::Snr:
+      return {"SNR"};
+    case AccMetricType::Rmse:
+      return {"RMSE"};
+    case AccMetricType::CosineSim:
+      return {"COSINE"};
+    case AccMetricType::MaxAbsError:
+      return {"MAX_ABS_ERR", "MAX_ABS_ERR_INDEX"};
+    case AccMetricType::MaxRelError:
+      return {"MAX_REL_ERR", "MAX_REL_ERR_INDEX"};
+    case AccMetricType::TopK:
+      return {"TOP1_MATCH", "TOPK_AGREEMENT"};
+    case AccMetricType::MinMax:
+      return {"MIN", "MAX", "EXPECTED_MIN", "EXPECTED_MAX"};
+    case AccMetricType::ErrorHistogram:
+      return {"ERR_HIST"};
+  }
+
+  assert(false && "Unhandled AccMetricType");
+  return {};
+}
+
+static void AppendMetricsAsCSV(std::string& buffer, const AccMetrics& metrics,
+                               const std::vector<AccMetricType>& types) {
+  for (size_t t = 0; t < types.size(); t++) {
+    if (t > 0) {
+      buffer += ',';
+    }
+
+    switch (types[t]) {
+      case AccMetricType::Snr:
+        AppendDouble(buffer, metrics.snr);
+        break;
+      case AccMetricType::Rmse:
+        AppendDouble(buffer, metrics.rmse);
+        break;
+      case AccMetricType::CosineSim:
+        AppendDouble(buffer, metrics.cosine_similarity);
+        break;
+      case AccMetricType::MaxAbsError:
+        AppendDouble(buffer, metrics.max_abs_error);
+        buffer += ',';
+        AppendUInt(buffer, metrics.max_abs_error_index);
+        break;
+      case AccMetricType::MaxRelError:
+        AppendDouble(buffer, metrics.max_rel_error);
+        buffer += ',';
+        AppendUInt(buffer, metrics.max_rel_error_index);
+        break;
+      case AccMetricType::TopK:
+        buffer += metrics.top1_match ? "1," : "0,";
+        AppendDouble(buffer, metrics.top_k_agreement);
+        break;
+      case AccMetricType::MinMax:
+        AppendDouble(buffer, metrics.min_val);
+        buffer += ',';
+        AppendDouble(buffer, metrics.max_val);
+        buffer += ',';
+        AppendDouble(buffer, metrics.min_expected_val);
+        buffer += ',';
+        AppendDouble(buffer, metrics.max_expected_val);
+        break;
+      case AccMetricType::ErrorHistogram:
+        // Use a separator other than ',' so that the whole histogram stays in a single CSV column.
+        for (size_t b = 0; b < metrics.error_histogram.size(); b++) {
+          if (b > 0) {
+            buffer += ';';
+          }
+          AppendUInt(buffer, metrics.error_histogram[b]);
+        }
+        break;
+    }
+  }
+}
+
+static void AppendMetricsAsJson(std::string& buffer, const AccMetrics& metrics,
+                                const std::vector<AccMetricType>& types) {
+  buffer += '{';
+  for (size_t t = 0; t < types.size(); t++) {
+    if (t > 0) {
+      buffer += ',';
+    }
+
+    switch (types[t]) {
+      case AccMetricType::Snr:
+        buffer += "\"snr\":";
+        AppendJsonDouble(buffer, metrics.snr);
+        break;
+      case AccMetricType::Rmse:
+        buffer += "\"rmse\":";
+        AppendJsonDouble(buffer, metrics.rmse);
+        break;
+      case AccMetricType::CosineSim:
+        buffer += "\"cosine\":";
+        AppendJsonDouble(buffer, metrics.cosine_similarity);
+        break;
+      case AccMetricType::MaxAbsError:
+        buffer += "\"max_abs_err\":";
+        AppendJsonDouble(buffer, metrics.max_abs_error);
+        buffer += ",\"max_abs_err_index\":";
+        AppendUInt(buffer, metrics.max_abs_error_index);
+        break;
+      case AccMetricType::MaxRelError:
+        buffer += "\"max_rel_err\":";
+        AppendJsonDouble(buffer, metrics.max_rel_error);
+        buffer += ",\"max_rel_err_index\":";
+        AppendUInt(buffer, metrics.max_rel_error_index);
+        break;
+      case AccMetricType::TopK:
+        buffer += metrics.top1_match ? "\"top1_match\":true" : "\"top1_match\":false";
+        buffer += ",\"topk_agreement\":";
+        AppendJsonDouble(buffer, metrics.top_k_agreement);
+        break;
+      case AccMetricType::MinMax:
+        buffer += "\"min\":";
+        AppendJsonDouble(buffer, metrics.min_val);
+        buffer += ",\"max\":";
+        AppendJsonDouble(buffer, metrics.max_val);
+        buffer += ",\"expected_min\":";
+        AppendJsonDouble(buffer, metrics.min_expected_val);
+        buffer += ",\"expected_max\":";
+        AppendJsonDouble(buffer, metrics.max_expected_val);
+        break;
+      case AccMetricType::ErrorHistogram:
+        buffer += "\"err_hist\":[";
+        for (size_t b = 0; b < metrics.error_histogram.size(); b++) {
+          if (b > 0) {
+            buffer += ',';
+          }
+          AppendUInt(buffer, metrics.error_histogram[b]);
+        }
+        buffer += ']';
+        break;
+    }
+  }
+  buffer += '}';
+}
+
+// Copies the remaining contents of `src` (from the beginning) to `dst`.
+static bool CopyFileContents(std::FILE* src, std::ostream& dst) {
+  std::array<char, 64 * 1024> chunk;
+
+  if (std::fseek(src, 0, SEEK_SET) != 0) {
+    return false;
+  }
+
+  size_t num_read = 0;
+  while ((num_read = std::fread(chunk.data(), 1, chunk.size(), src)) > 0) {
+    dst.write(chunk.data(), static_cast<std::streamsize>(num_read));
+  }
+
+  return !std::ferror(src) && static_cast<bool>(dst);
+}
+
+ResultWriter::ResultWriter(ResultsFormat format, std::vector<AccMetricType> metrics)
+    : format_(format), metrics_(std::move(metrics)) {}
+
+ResultWriter::~ResultWriter() {
+  if (thread_.joinable()) {
+    Finish();
+  }
+}
+
+bool ResultWriter::Open(const std::filesystem::path& output_file) {
+  output_file_ = output_file;
+
+  if (output_file_.empty()) {
+    rows_file_ = std::tmpfile();
+    rows_file_is_temp_ = true;
+  } else {
+    rows_file_path_ = output_file_;
+    if (format_ == ResultsFormat::Csv) {
+      rows_file_path_ += ".rows";
+    }
+
+    rows_file_ = std::fopen(rows_file_path_.string().c_str(), "w+b");
+  }
+
+  if (rows_file_ == nullptr) {
+    std::cerr << "[ERROR]: Unable to open output file "
+              << (rows_file_is_temp_ ? std::string("(temporary)") : rows_file_path_.string()) << std::endl;
+    return false;
+  }
+
+  thread_ = std::thread(&ResultWriter::ThreadEntry, this);
+  return true;
+}
+
+void ResultWriter::WriteModelResults(std::vector<std::string> keys, std::vector<std::vector<AccMetrics>> results) {
+  assert(keys.size() == results.size());
+  for (const std::vector<AccMetrics>& dataset_results : results) {
+    max_num_outputs_ = std::max(max_num_outputs_, dataset_results.size());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    queue_.push_back(ModelResults{std::move(keys), std::move(results)});
+  }
+  signal_.notify_one();
+}
+
+void ResultWriter::ThreadEntry() {
+  std::string buffer;
+
+  while (true) {
+    ModelResults model_results;
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      signal_.wait(lock, [this]() { return shutdown_ || !queue_.empty(); });
+
+      if (queue_.empty()) {
+        return;  // Shutting down and all results have been written.
+      }
+
+      model_results = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    buffer.clear();
+    FormatModelResults(model_results, buffer);
+
+    // Flush after every model so that the results written so far survive an interrupted run.
+    if (std::fwrite(buffer.data(), 1, buffer.size(), rows_file_) != buffer.size() || std::fflush(rows_file_) != 0) {
+      write_failed_ = true;
+    }
+  }
+}
+
+void ResultWriter::FormatModelResults(const ModelResults& model_results, std::string& buffer) const {
+  for (size_t i = 0; i < model_results.results.size(); i++) {
+    const std::vector<AccMetrics>& metrics = model_results.results[i];
+
+    if (format_ == ResultsFormat::Json) {
+      buffer += "{\"key\":";
+      AppendJsonString(buffer, model_results.keys[i]);
+      buffer += ",\"outputs\":[";
+      for (size_t j = 0; j < metrics.size(); j++) {
+        if (j > 0) {
+          buffer += ',';
+        }
+        AppendMetricsAsJson(buffer, metrics[j], metrics_);
+      }
+      buffer += "]}\n";
+      continue;
+    }
+
+    AppendCSVField(buffer, model_results.keys[i]);
+    for (size_t j = 0; j < metrics.size(); j++) {
+      buffer += ',';
+      AppendMetricsAsCSV(buffer, metrics[j], metrics_);
+    }
+    buffer += '\n';
+  }
+}
+
+std::string ResultWriter::GetCSVHeaderRow() const {
+  std::string header = "Model_And_Input";
+
+  for (size_t i = 0; i < max_num_outputs_; i++) {
+    for (AccMetricType metric_type : metrics_) {
+      for (const char* column_name : GetCSVMetricColumnNames(metric_type)) {
+        header += ",Output_";
+        AppendUInt(header, i);
+        header += '_';
+        header += column_name;
+      }
+    }
+  }
+  header += '\n';
+
+  return header;
+}
+
+bool ResultWriter::Finish() {
+  if (!thread_.joinable()) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    shutdown_ = true;
+  }
+  signal_.notify_one();
+  thread_.join();
+
+  bool success = !write_failed_;
+
+  // JSON Lines results are self-describing, so only CSV results have a header row.
+  const std::string csv_header_row = format_ == ResultsFormat::Csv ? GetCSVHeaderRow() : std::string();
+
+  if (output_file_.empty()) {
+    const char* format_name = format_ == ResultsFormat::Csv ? "CSV" : "JSON Lines";
+    std::cout << std::endl << "[INFO]: Accuracy results (" << format_name << " format):" << std::endl << std::endl;
+    std::cout << csv_header_row;
+    success = CopyFileContents(rows_file_, std::cout) && success;
+    std::cout << std::endl;
+  } else if (format_ == ResultsFormat::Csv) {
+    std::ofstream output_file(output_file_, std::ios::binary);
+
+    if (!output_file.is_open()) {
+      std::cerr << "[ERROR]: Unable to open output file " << output_file_ << std::endl;
+      success = false;
+    } else {
+      output_file << csv_header_row;
+      success = CopyFileContents(rows_file_, output_file) && success;
+    }
+  }
+
+  std::fclose(rows_file_);
+  rows_file_ = nullptr;
+
+  if (!output_file_.empty() && format_ == ResultsFormat::Csv && success) {
+    std::error_code error_code;
+    std::filesystem::remove(rows_file_path_, error_code);
+  }
+
+  if (!success) {
+    std::cerr << "[ERROR]: Failed to write accuracy results" << std::endl;
+  } else if (!output_file_.empty()) {
+    std::cout << std::endl << "[INFO]: Saved accuracy results to " << output_file_.string() << std::endl << std::endl;
+  }
+
+  return success;
+}
+
+// Gets the next field of a CSV record from the remaining text. Quoted fields are parsed as described in RFC 4180 (they
+// may contain commas, line breaks and doubled quotes). Sets `end_of_record` if the field is the last one in its record
+// and consumes the record's line terminator. Returns false if a quoted field is malformed.
+static bool GetNextCSVField(std::string_view& text, std::string& field, bool& end_of_record) {
+  field.clear();
+
+  if (!text.empty() && text.front() == '"') {
+    size_t pos = 1;
+    while (true) {
+      const size_t quote_pos = text.find('"', pos);
+      if (quote_pos == std::string_view::npos) {
+        return false;  // Unterminated quoted field.
+      }
+
+      field.append(text.data() + pos, quote_pos - pos);
+      pos = quote_pos + 1;
+
+      if (pos < text.size() && text[pos] == '"') {
+        field += '"';  // Escaped quote.
+        pos++;
+        continue;
+      }
+      break;
+    }
+
+    text.remove_prefix(pos);
+    if (!text.empty() && text.front() != ',' && text.front() != '\r' && text.front() != '\n') {
+      return false;  // Unexpected characters after the closing quote.
+    }
+  } else {
+    const size_t end_pos = std::min(text.find_first_of(",\r\n"), text.size());
+    field.assign(text.data(), end_pos);
+    text.remove_prefix(end_pos);
+  }
+
+  end_of_record = text.empty() || text.front() != ',';
+
+  if (!end_of_record) {
+    text.remove_prefix(1);
+  } else if (!text.empty()) {
+    text.remove_prefix(text.front() == '\r' && text.size() > 1 && text[1] == '\n' ? 2 : 1);
+  }
+
+  return true;
+}
+
+// Gets all fields of the next CSV record from the remaining text. Returns false if the record is malformed.
+static bool GetNextCSVRecord(std::string_view& text, std::vector<std::string>& fields) {
+  fields.clear();
+
+  bool end_of_record = false;
+  while (!end_of_record) {
+    fields.emplace_back();
+    if (!GetNextCSVField(text, fields.back(), end_of_record)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ReadExpectedAccuraciesFromFile(const std::filesystem::path& filepath,
+                                    std::unordered_map<std::string, std::vector<double>>& expected_acc_map) {
+  MappedFile mapped_file;
+
+  if (!MappedFile::Open(filepath, mapped_file)) {
+    std::cerr << "[ERROR]: Unable to read expected accuracy file " << filepath << std::endl;
+    return false;
+  }
+
+  const Span<char> file_bytes = mapped_file.Data();
+  std::string_view text(file_bytes.data(), file_bytes.size());
+  std::vector<std::string> fields;
+
+  // The first row contains the column names. Only the SNR columns (e.g., Output_0_SNR) are used for comparison.
+  if (text.empty() || !GetNextCSVRecord(text, fields)) {
+    std::cerr << "[ERROR]: Failed to read first row from expected accuracy file " << filepath << std::endl;
+    return false;
+  }
+
+  std::vector<bool> is_snr_column;
+  {
+    constexpr std::string_view snr_suffix = "_SNR";
+
+    for (std::string_view column_name : fields) {
+      const bool is_snr = column_name.size() >= snr_suffix.size() &&
+                          column_name.substr(column_name.size() - snr_suffix.size()) == snr_suffix;
+      is_snr_column.push_back(is_snr);
+    }
+  }
+
+  if (std::find(is_snr_column.begin(), is_snr_column.end(), true) == is_snr_column.end()) {
+    std::cerr << "[ERROR]: Expected accuracy file " << filepath << " does not contain any SNR columns" << std::endl;
+    return false;
+  }
+
+  // Parse every row of the CSV file to fill out the expected accuracies map. Rows are counted as records because a
+  // quoted key may span several lines.
+  for (size_t row_number = 2; !text.empty(); row_number++) {
+    if (!GetNextCSVRecord(text, fields)) {
+      std::cerr << "[ERROR]: Failed to parse row " << row_number << " of expected accuracy file " << filepath
+                << std::endl;
+      return false;
+    }
+
+    if (fields.size() == 1 && fields[0].empty()) {
+      continue;  // Skip empty line
+    }
+
+    std::vector<double> output_snr_values;
+
+    for (size_t column = 1; column < fields.size(); column++) {
+      if (column >= is_snr_column.size() || !is_snr_column[column]) {
+        continue;
+      }
+
+      const std::string& value = fields[column];
+      double snr = 0.0;
+      const std::from_chars_result result = std::from_chars(value.data(), value.data() + value.size(), snr);
+
+      if (result.ec != std::errc() || result.ptr != value.data() + value.size()) {
+        std::cerr << "[ERROR]: Failed to parse output SNR '" << value << "' on row " << row_number
+                  << " of expected accuracy file " << filepath << std::endl;
+        return false;
+      }
+
+      output_snr_values.push_back(snr);
+    }
+
+    expected_acc_map[std::move(fields[0])] = std::move(output_snr_values);
+  }
+
+  return true;
+}
@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "basic_utils.h"
+#include "cmd_args.h"
+
+/// <summary>
+/// Writes accuracy results in CSV or JSON Lines format as each model finishes. Results are formatted and written
+/// by a background thread, so the caller can move on to the next model immediately.
+///
+/// JSON Lines results written to a file are streamed directly into the file. The CSV header row depends on the
+/// maximum number of outputs across all models, so CSV rows are first streamed into a "<output_file>.rows" file
+/// (which keeps the results written so far if the run is interrupted) and combined with the header row by Finish().
+/// Results printed to stdout are written once all models are done, so that they are not interleaved with progress
+/// messages.
+/// </summary>
+class ResultWriter {
+ public:
+  ResultWriter(ResultsFormat format, std::vector<AccMetricType> metrics);
+  ~ResultWriter();
+
+  ResultWriter(const ResultWriter& other) = delete;
+  ResultWriter& operator=(const ResultWriter& other) = delete;
+
+  /// <summary>
+  /// Opens the destination for the results and starts the writer thread.
+  /// </summary>
+  /// <param name="output_file">The file into which to write the results. Empty to print to stdout.</param>
+  /// <returns>True on success</returns>
+  bool Open(const std::filesystem::path& output_file);
+
+  /// <summary>
+  /// Queues the results of all datasets of a model for writing.
+  /// </summary>
+  /// <param name="keys">The key (e.g., "model_name/test_data_set_0") for each dataset</param>
+  /// <param name="results">The accuracy metrics of every output for each dataset</param>
+  void WriteModelResults(std::vector<std::string> keys, std::vector<std::vector<AccMetrics>> results);
+
+  /// <summary>
+  /// Waits for all queued results to be written and completes the output (e.g., adds the CSV header row).
+  /// </summary>
+  /// <returns>True if all results were written successfully</returns>
+  bool Finish();
+
+ private:
+  struct ModelResults {
+    std::vector<std::string> keys;
+    std::vector<std::vector<AccMetrics>> results;
+  };
+
+  void ThreadEntry();
+  void FormatModelResults(const ModelResults& model_results, std::string& buffer) const;
+  std::string GetCSVHeaderRow() const;
+
+  ResultsFormat format_;
+  std::vector<AccMetricType> metrics_;
+  std::filesystem::path output_file_;
+  std::filesystem::path rows_file_path_;  // Only used for CSV results written to a file.
+  std::FILE* rows_file_ = nullptr;
+  bool rows_file_is_temp_ = false;
+  size_t max_num_outputs_ = 0;
+  bool write_failed_ = false;
+
+  std::mutex lock_;
+  std::condition_variable signal_;
+  std::deque<ModelResults> queue_;
+  bool shutdown_ = false;
+  std::thread thread_;
+};
+
+/// <summary>
+/// Reads the expected SNR of every output for each model/dataset pair from a CSV file previously written by this
+/// tool. Only the SNR columns (e.g., Output_0_SNR) are used. Lines may be of any length.
+/// </summary>
+/// <param name="filepath">The CSV file</param>
+/// <param name="expected_acc_map">Output into which to store the expected SNRs, keyed by model/dataset</param>
+/// <returns>True on success</returns>
+bool ReadExpectedAccuraciesFromFile(const std::filesystem::path& filepath,
+                                    std::unordered_map<std::string, std::vector<double>>& expected_acc_map);
@@ -2,8 +2,9 @@
 // Licensed under the MIT License.
 #include "accuracy_tester.h"
 
-#include <array>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -15,26 +16,29 @@
 #include <vector>
 
 #include "acc_task.h"
+#include "accuracy_results.h"
+#include "benchmark.h"
 #include "cmd_args.h"
 #include "data_loader.h"
+#include "hash_utils.h"
 #include "model_io_utils.h"
+#include "reference_cache.h"
+#include "session_cache.h"
 #include "task_thread_pool.h"
 
 static bool GetExpectedOutputsFromModel(Ort::Env& env, TaskThreadPool& pool, const AppArgs& args,
                                         const std::filesystem::path& model_path,
                                         const std::vector<std::filesystem::path>& dataset_paths,
-                                        std::vector<std::unique_ptr<char[]>>& all_inputs,
-                                        std::vector<std::unique_ptr<char[]>>& all_outputs);
+                                        const std::filesystem::path& reference_cache_path, DatasetsIOData& all_inputs,
+                                        DatasetsIOData& all_outputs, SessionBenchmark* benchmark);
 
-static bool GetEpAccuracy(Ort::Env& env, TaskThreadPool& pool, const std::filesystem::path& model_path,
-                          const std::vector<std::filesystem::path>& dataset_paths,
-                          const Ort::SessionOptions& session_options, std::vector<std::unique_ptr<char[]>>& all_inputs,
-                          std::vector<std::unique_ptr<char[]>>& all_outputs,
-                          std::vector<std::vector<AccMetrics>>& test_accuracy_results);
+static bool GetEpAccuracy(Ort::Env& env, TaskThreadPool& pool, const AppArgs& args,
+                          const std::filesystem::path& model_path,
+                          const std::vector<std::filesystem::path>& dataset_paths, DatasetsIOData& all_inputs,
+                          DatasetsIOData& all_outputs, std::vector<std::vector<AccMetrics>>& test_accuracy_results,
+                          SessionBenchmark* benchmark);
 
-static std::string PrintAccuracyResults(const std::vector<std::vector<AccMetrics>>& test_accuracy_results,
-                                        const std::vector<std::filesystem::path>& dataset_paths,
-                                        const std::filesystem::directory_entry& model_dir);
+static bool WriteBenchmarkResults(const AppArgs& args, const std::string& benchmark_rows);
 
 static bool CompareToExpectedAccuracy(const std::vector<std::vector<AccMetrics>>& test_accuracy_results,
                                       const std::unordered_map<std::string, std::vector<double>>& expected_accuracies,
@@ -43,29 +47,31 @@ static bool CompareToExpectedAccuracy(const std::vector<std::vector<AccMetrics>>
                                       std::ostringstream& output_str_stream, size_t& total_tests,
                                       size_t& total_failed_tests);
 
-static bool GetExpectedAccuraciesFromFile(const std::filesystem::path& filepath,
-                                          std::unordered_map<std::string, std::vector<double>>& expected_acc_map);
-
-static std::string GetCSVHeaderRow(size_t num_outputs);
-
 bool RunAccuracyTest(Ort::Env& env, const AppArgs& app_args) {
   assert(app_args.num_threads >= 1);
   TaskThreadPool pool(app_args.num_threads - 1);
   TaskThreadPool dummy_pool(0);  // For EPs that only support single-threaded inference (e.g., QNN).
   size_t total_tests = 0;
   size_t total_failed_tests = 0;
-  size_t max_num_outputs = 0;
+  size_t num_shape_mismatches = 0;
 
-  std::ostringstream output_str_stream;
   std::unordered_map<std::string, std::vector<double>> expected_accuracies;
   std::ostringstream accuracy_cmp_result_stream;
 
   if (!app_args.expected_accuracy_file.empty()) {
-    if (!GetExpectedAccuraciesFromFile(app_args.expected_accuracy_file, expected_accuracies)) {
+    if (!ReadExpectedAccuraciesFromFile(app_args.expected_accuracy_file, expected_accuracies)) {
       return false;
     }
   }
 
+  ResultWriter result_writer(app_args.results_format, app_args.metrics);
+  if (!result_writer.Open(app_args.output_file)) {
+    return false;
+  }
+
+  const bool run_benchmark = app_args.benchmark_runs > 0;
+  std::string benchmark_rows;
+
   for (const std::filesystem::directory_entry& model_dir : std::filesystem::directory_iterator{app_args.test_dir}) {
     const std::filesystem::path& model_dir_path = model_dir.path();
     const std::string model_name = model_dir_path.filename().string();
@@ -101,8 +107,10 @@ bool RunAccuracyTest(Ort::Env& env, const AppArgs& app_args) {
       ep_model_path = base_model_path;
     }
 
-    std::vector<std::unique_ptr<char[]>> all_inputs;
-    std::vector<std::unique_ptr<char[]>> all_outputs;
+    DatasetsIOData all_inputs;
+    DatasetsIOData all_outputs;
+    SessionBenchmark reference_benchmark;
+    SessionBenchmark ep_benchmark;
 
     // Load expected outputs from base model running on CPU EP (unless user wants to use outputs from disk).
     if (!app_args.load_expected_outputs_from_disk) {
@@ -112,7 +120,20 @@ bool RunAccuracyTest(Ort::Env& env, const AppArgs& app_args) {
         return false;
       }
 
-      if (!GetExpectedOutputsFromModel(env, pool, app_args, base_model_path, dataset_paths, all_inputs, all_outputs)) {
+      // Reuse cached outputs if the model, inputs, and ORT version are unchanged.
+      std::filesystem::path cache_file_path;
+
+      if (!app_args.reference_cache_dir.empty()) {
+        std::string cache_key;
+        if (!GetReferenceCacheKey(base_model_path, dataset_paths, cache_key)) {
+          return false;
+        }
+
+        cache_file_path = app_args.reference_cache_dir / (cache_key + ".refcache");
+      }
+
+      if (!GetExpectedOutputsFromModel(env, pool, app_args, base_model_path, dataset_paths, cache_file_path,
+                                       all_inputs, all_outputs, run_benchmark ? &reference_benchmark : nullptr)) {
         return false;
       }
     }
@@ -120,15 +141,31 @@ bool RunAccuracyTest(Ort::Env& env, const AppArgs& app_args) {
     // Run accuracy measurements with the EP under test.
     std::vector<std::vector<AccMetrics>> test_accuracy_results;
     TaskThreadPool& ep_pool = app_args.supports_multithread_inference ? pool : dummy_pool;
-    if (!GetEpAccuracy(env, ep_pool, ep_model_path, dataset_paths, app_args.session_options, all_inputs, all_outputs,
-                       test_accuracy_results)) {
+    if (!GetEpAccuracy(env, ep_pool, app_args, ep_model_path, dataset_paths, all_inputs, all_outputs,
+                       test_accuracy_results, run_benchmark ? &ep_benchmark : nullptr)) {
       return false;
     }
 
-    // Print the accuracy results to string stream.
-    std::string acc_results = PrintAccuracyResults(test_accuracy_results, dataset_paths, model_dir);
-    output_str_stream << acc_results;
-    max_num_outputs = std::max(max_num_outputs, test_accuracy_results[0].size());
+    // The reference session is not benchmarked if its outputs were loaded from disk or from the reference cache, so
+    // its rows are omitted.
+    if (run_benchmark) {
+      if (!reference_benchmark.dataset_latencies.empty()) {
+        benchmark_rows += FormatBenchmarkResults(model_name, dataset_paths, "reference", reference_benchmark,
+                                                 app_args.results_format);
+      } else {
+        std::cout << "[INFO]: Skipped the reference benchmark for " << model_name
+                  << " because its expected outputs were not computed" << std::endl;
+      }
+
+      benchmark_rows += FormatBenchmarkResults(model_name, dataset_paths, "ep", ep_benchmark,
+                                               app_args.results_format);
+    }
+
+    for (const std::vector<AccMetrics>& output_metrics : test_accuracy_results) {
+      for (const AccMetrics& metrics : output_metrics) {
+        num_shape_mismatches += metrics.shape_mismatch ? 1 : 0;
+      }
+    }
 
     // Compare with expected accuracy results if the user provided an input file with previous accuracy results.
     if (!app_args.expected_accuracy_file.empty()) {
@@ -137,23 +174,23 @@ bool RunAccuracyTest(Ort::Env& env, const AppArgs& app_args) {
         return false;
       }
     }
-  }
 
-  const std::string csv_header_row = GetCSVHeaderRow(max_num_outputs);
+    // Hand the results off to the writer thread, which writes them while the next model is tested.
+    std::vector<std::string> result_keys;
+    result_keys.reserve(dataset_paths.size());
+    for (const std::filesystem::path& dataset_path : dataset_paths) {
+      result_keys.push_back(model_name + "/" + dataset_path.filename().string());
+    }
 
-  if (!app_args.output_file.empty()) {
-    std::ofstream output_file(app_args.output_file);
+    result_writer.WriteModelResults(std::move(result_keys), std::move(test_accuracy_results));
+  }
 
-    if (!output_file.is_open()) {
-      std::cerr << "[ERROR]: Unable to open output file " << app_args.output_file << std::endl;
-      return false;
-    }
+  if (!result_writer.Finish()) {
+    return false;
+  }
 
-    output_file << csv_header_row << output_str_stream.str();
-    std::cout << std::endl << "[INFO]: Saved accuracy results to " << app_args.output_file << std::endl << std::endl;
-  } else {
-    std::cout << std::endl << "[INFO]: Accuracy results (CSV format):" << std::endl << std::endl;
-    std::cout << csv_header_row << output_str_stream.str() << std::endl;
+  if (run_benchmark && !WriteBenchmarkResults(app_args, benchmark_rows)) {
+    return false;
   }
 
   if (!app_args.expected_accuracy_file.empty()) {
@@ -168,18 +205,96 @@ bool RunAccuracyTest(Ort::Env& env, const AppArgs& app_args) {
     return total_failed_tests == 0;
   }
 
+  // Without expected accuracies, an output with an unexpected shape is the only way a test can fail.
+  if (num_shape_mismatches > 0) {
+    std::cerr << "[ERROR]: " << num_shape_mismatches << " output(s) did not match the shape of the expected output"
+              << std::endl;
+    return false;
+  }
+
   return true;
 }
 
+// Splits the datasets into batches of at most `batch_size` datasets with identical input shapes. Each batch is a
+// contiguous range of a shape group, which lets a batch use the group's input buffer without copying.
+static std::vector<Span<const size_t>> GetDatasetBatches(const DatasetsIOData& all_inputs,
+                                                         const ModelIOInfo& model_io_info, size_t batch_size) {
+  if (batch_size > 1 && !model_io_info.SupportsBatching()) {
+    std::cout << "[INFO]: Model does not have a symbolic batch dimension on all inputs and outputs. "
+              << "Running datasets one at a time." << std::endl;
+    batch_size = 1;
+  }
+
+  std::vector<Span<const size_t>> batches;
+
+  for (const std::vector<size_t>& shape_group : all_inputs.shape_groups) {
+    for (size_t start = 0; start < shape_group.size(); start += batch_size) {
+      const size_t count = std::min(batch_size, shape_group.size() - start);
+      batches.emplace_back(shape_group.data() + start, count);
+    }
+  }
+
+  return batches;
+}
+
+// Reports session creation (i.e., model load and compilation) time separately from the time spent running inference.
+static void PrintSessionTimes(const char* session_name, const SessionCreationInfo& creation_info,
+                              std::chrono::steady_clock::duration run_time) {
+  std::cout << "[INFO]: " << session_name << " session: created in " << creation_info.creation_ms << " ms";
+
+  if (creation_info.loaded_from_cache) {
+    std::cout << " (loaded from session cache)";
+  } else if (!creation_info.cache_file_path.empty()) {
+    std::cout << " (saved to session cache)";
+  }
+
+  std::cout << ", ran inference in " << std::chrono::duration<double, std::milli>(run_time).count() << " ms"
+            << std::endl;
+}
+
+// Describes the EP and session configs of the EP under test for the session cache key.
+static std::string GetEpSessionConfig(const AppArgs& args) {
+  std::string session_config = "ep=" + args.execution_provider + "\n";
+
+  for (const auto& it : args.ep_options) {
+    session_config += "ep_option:" + it.first + "=" + it.second + "\n";
+
+    // An EP option may name a library that the EP loads (e.g., QNN EP's backend_path). Its contents identify the
+    // EP's version, which the compiled model depends on.
+    std::error_code error_code;
+    Hasher hasher;
+    if (std::filesystem::is_regular_file(it.second, error_code) && HashFileContents(it.second, hasher)) {
+      session_config += "ep_file:" + it.first + "=" + HashToHexString(hasher.Digest()) + "\n";
+    }
+  }
+
+  for (const auto& it : args.session_configs) {
+    session_config += "session_config:" + it.first + "=" + it.second + "\n";
+  }
+
+  return session_config;
+}
+
 static bool GetExpectedOutputsFromModel(Ort::Env& env, TaskThreadPool& pool, const AppArgs& args,
                                         const std::filesystem::path& model_path,
                                         const std::vector<std::filesystem::path>& dataset_paths,
-                                        std::vector<std::unique_ptr<char[]>>& all_inputs,
-                                        std::vector<std::unique_ptr<char[]>>& all_outputs) {
+                                        const std::filesystem::path& reference_cache_path, DatasetsIOData& all_inputs,
+                                        DatasetsIOData& all_outputs, SessionBenchmark* benchmark) {
   Ort::SessionOptions session_options;
   session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
 
-  Ort::Session f32_cpu_sess(env, model_path.c_str(), session_options);
+  // The session's memory is the growth of the resident set while it is created and run. Loading the datasets in
+  // between is not counted.
+  const size_t creation_start_rss_bytes = GetCurrentRssBytes();
+  Ort::Session f32_cpu_sess(nullptr);
+  SessionCreationInfo creation_info;
+  if (!CreateSessionWithCache(env, model_path, session_options, args.session_cache_dir,
+                              SessionCacheType::OptimizedModel, "reference\nep=cpu\ngraph_optimization_level=all\n",
+                              f32_cpu_sess, creation_info)) {
+    return false;
+  }
+
+  size_t session_rss_bytes = GetRssGrowthBytes(creation_start_rss_bytes);
   ModelIOInfo model_io_info;
 
   if (!ModelIOInfo::Init(model_io_info, f32_cpu_sess.GetConst())) {
@@ -187,60 +302,97 @@ static bool GetExpectedOutputsFromModel(Ort::Env& env, TaskThreadPool& pool, con
     return false;
   }
 
+  // The cached outputs are checked against the model's outputs, so the session is created even on a cache hit. It is
+  // not run. Saving outputs to disk (-s) requires running the model, so it bypasses the cache lookup.
+  const size_t num_datasets = dataset_paths.size();
+  if (!reference_cache_path.empty() && !args.save_expected_outputs_to_disk &&
+      LoadReferenceOutputsFromCache(reference_cache_path, model_io_info, num_datasets, all_outputs)) {
+    std::cout << "[INFO]: Loaded expected outputs from reference cache " << reference_cache_path << std::endl;
+    return true;
+  }
+
   if (!LoadIODataFromDisk(dataset_paths, model_io_info.inputs, "input_", all_inputs)) {
     std::cerr << "[ERROR]: Failed to load test inputs for model directory " << model_path.parent_path() << std::endl;
     return false;
   }
 
-  const size_t num_datasets = dataset_paths.size();
+  const std::vector<Span<const size_t>> batches = GetDatasetBatches(all_inputs, model_io_info, args.batch_size);
   std::vector<Task> tasks;
-  tasks.reserve(num_datasets);
-
-  const size_t total_input_data_size = model_io_info.GetTotalInputSize();
-  const size_t total_output_data_size = model_io_info.GetTotalOutputSize();
+  tasks.reserve(batches.size());
 
-  all_outputs.reserve(num_datasets);
+  AllocateOutputData(all_inputs, model_io_info, all_outputs);
+  assert(all_outputs.datasets.size() == num_datasets);
 
-  for (size_t i = 0; i < num_datasets; i++) {
-    all_outputs.emplace_back(std::make_unique<char[]>(total_output_data_size));
+  // Batches are ordered by shape group so that consecutive runs with the same input shapes can reuse ORT's
+  // allocations.
+  for (Span<const size_t> batch : batches) {
+    tasks.push_back(Task::CreateInferenceTask(f32_cpu_sess, model_io_info, all_inputs, batch, all_outputs));
+  }
 
-    Task task = Task::CreateInferenceTask(f32_cpu_sess, model_io_info,
-                                          Span<const char>(all_inputs[i].get(), total_input_data_size),
-                                          Span<char>(all_outputs.back().get(), total_output_data_size));
-    tasks.push_back(std::move(task));
+  const size_t run_start_rss_bytes = GetCurrentRssBytes();
+  const auto run_start_time = std::chrono::steady_clock::now();
+  if (!pool.CompleteTasks(tasks)) {
+    std::cerr << "[ERROR]: Failed to run model " << model_path << " on CPU EP" << std::endl;
+    return false;
   }
 
-  pool.CompleteTasks(tasks);
+  PrintSessionTimes("reference", creation_info, std::chrono::steady_clock::now() - run_start_time);
+  session_rss_bytes += GetRssGrowthBytes(run_start_rss_bytes);
 
   if (args.save_expected_outputs_to_disk) {
-    // Write outputs to disk: output_0.raw, output_1.raw, ...
+    // Write outputs to disk: output_0.raw, output_1.raw, ... (or .pb files in .pb datasets)
     for (size_t dataset_index = 0; dataset_index < num_datasets; dataset_index++) {
-      const std::filesystem::path& dataset_dir = dataset_paths[dataset_index];
-      Span<const char> dataset_output(all_outputs[dataset_index].get(), total_output_data_size);
-      const std::vector<IOInfo>& output_infos = model_io_info.outputs;
-      const size_t num_outputs = output_infos.size();
-
-      for (size_t buf_offset = 0, i = 0; i < num_outputs; buf_offset += output_infos[i].total_data_size, i++) {
-        std::ostringstream oss;
-        oss << "output_" << i << ".raw";
+      if (!SaveIODataToDisk(dataset_paths[dataset_index], model_io_info.outputs, "output_",
+                            all_outputs.datasets[dataset_index])) {
+        return false;
+      }
+    }
+  }
 
-        std::filesystem::path output_filepath = dataset_dir / oss.str();
-        std::ofstream ofs(output_filepath, std::ios::binary);
+  if (!reference_cache_path.empty() && !SaveReferenceOutputsToCache(reference_cache_path, all_outputs)) {
+    return false;
+  }
 
-        assert(buf_offset < dataset_output.size());
-        ofs.write(&dataset_output[buf_offset], output_infos[i].total_data_size);
-      }
+  if (benchmark != nullptr) {
+    benchmark->session_creation_ms = creation_info.creation_ms;
+    benchmark->session_rss_bytes = session_rss_bytes;
+    if (!BenchmarkSession(f32_cpu_sess, model_io_info, all_inputs, pool, args.warmup_runs, args.benchmark_runs,
+                          *benchmark)) {
+      std::cerr << "[ERROR]: Failed to benchmark model " << model_path << " on CPU EP" << std::endl;
+      return false;
     }
   }
   return true;
 }
 
-static bool GetEpAccuracy(Ort::Env& env, TaskThreadPool& pool, const std::filesystem::path& model_path,
-                          const std::vector<std::filesystem::path>& dataset_paths,
-                          const Ort::SessionOptions& session_options, std::vector<std::unique_ptr<char[]>>& all_inputs,
-                          std::vector<std::unique_ptr<char[]>>& all_outputs,
-                          std::vector<std::vector<AccMetrics>>& test_accuracy_results) {
-  Ort::Session session(env, model_path.c_str(), session_options);
+static bool GetEpAccuracy(Ort::Env& env, TaskThreadPool& pool, const AppArgs& args,
+                          const std::filesystem::path& model_path,
+                          const std::vector<std::filesystem::path>& dataset_paths, DatasetsIOData& all_inputs,
+                          DatasetsIOData& all_outputs, std::vector<std::vector<AccMetrics>>& test_accuracy_results,
+                          SessionBenchmark* benchmark) {
+  // Compiling EPs save their compiled graph as an EPContext model. Other EPs save the optimized model. The optimized
+  // model of a compiling EP without EPContext support cannot be saved, because its compiled nodes cannot be
+  // serialized, so such sessions are not cached.
+  const SessionCacheType cache_type =
+      args.supports_ep_context ? SessionCacheType::EpContext : SessionCacheType::OptimizedModel;
+  std::filesystem::path session_cache_dir = args.session_cache_dir;
+
+  if (!session_cache_dir.empty() && args.compiles_model && !args.supports_ep_context) {
+    std::cerr << "[WARNING]: Not caching the " << args.execution_provider << " session for " << model_path
+              << ": the EP compiles the model but does not support EPContext models" << std::endl;
+    session_cache_dir.clear();
+  }
+
+  const size_t creation_start_rss_bytes = GetCurrentRssBytes();
+  Ort::Session session(nullptr);
+  SessionCreationInfo creation_info;
+  if (!CreateSessionWithCache(env, model_path, args.session_options, session_cache_dir, cache_type,
+                              GetEpSessionConfig(args), session, creation_info)) {
+    return false;
+  }
+
+  size_t session_rss_bytes = GetRssGrowthBytes(creation_start_rss_bytes);
+
   ModelIOInfo model_io_info;
 
   if (!ModelIOInfo::Init(model_io_info, session.GetConst())) {
@@ -265,113 +417,70 @@ static bool GetEpAccuracy(Ort::Env& env, TaskThreadPool& pool, const std::filesy
     }
   }
 
-  assert(all_inputs.size() == num_datasets);
-  assert(all_outputs.size() == num_datasets);
+  assert(all_inputs.datasets.size() == num_datasets);
+  assert(all_outputs.datasets.size() == num_datasets);
 
+  const std::vector<Span<const size_t>> batches = GetDatasetBatches(all_inputs, model_io_info, args.batch_size);
   std::vector<Task> tasks;
-  tasks.reserve(num_datasets);
+  tasks.reserve(batches.size());
 
   test_accuracy_results.resize(num_datasets, std::vector<AccMetrics>(model_io_info.outputs.size()));
 
-  const size_t total_input_data_size = model_io_info.GetTotalInputSize();
-  const size_t total_output_data_size = model_io_info.GetTotalOutputSize();
-
-  for (size_t i = 0; i < num_datasets; i++) {
-    Task task = Task::CreateAccuracyCheckTask(
-        session, model_io_info, Span<const char>(all_inputs[i].get(), total_input_data_size),
-        Span<const char>(all_outputs[i].get(), total_output_data_size), Span<AccMetrics>(test_accuracy_results[i]));
-    tasks.push_back(std::move(task));
+  // Batches are ordered by shape group so that consecutive runs with the same input shapes can reuse ORT's
+  // allocations.
+  for (Span<const size_t> batch : batches) {
+    tasks.push_back(Task::CreateAccuracyCheckTask(session, model_io_info, all_inputs, batch, all_outputs,
+                                                  Span<std::vector<AccMetrics>>(test_accuracy_results), args.top_k));
   }
 
-  pool.CompleteTasks(tasks);
-  return true;
-}
-
-static std::string PrintAccuracyResults(const std::vector<std::vector<AccMetrics>>& test_accuracy_results,
-                                        const std::vector<std::filesystem::path>& dataset_paths,
-                                        const std::filesystem::directory_entry& model_dir) {
-  assert(test_accuracy_results.size() == dataset_paths.size());
-  std::ostringstream oss;
-  for (size_t i = 0; i < test_accuracy_results.size(); i++) {
-    const std::filesystem::path& test_path = dataset_paths[i];
-    const std::vector<AccMetrics>& metrics = test_accuracy_results[i];
-    std::string key = model_dir.path().filename().string() + "/" + test_path.filename().string();
-
-    oss << key << ",";
-    for (size_t j = 0; j < metrics.size(); j++) {
-      oss << std::setprecision(std::numeric_limits<double>::max_digits10) << metrics[j].snr;
-      if (j < metrics.size() - 1) {
-        oss << ",";
-      }
-    }
-    oss << std::endl;
+  const size_t run_start_rss_bytes = GetCurrentRssBytes();
+  const auto run_start_time = std::chrono::steady_clock::now();
+  if (!pool.CompleteTasks(tasks)) {
+    std::cerr << "[ERROR]: Failed to run model " << model_path << " on " << args.execution_provider << " EP"
+              << std::endl;
+    return false;
   }
 
-  return oss.str();
-}
-
-static std::string GetCSVHeaderRow(size_t num_outputs) {
-  assert(num_outputs > 0);
-  std::ostringstream oss;
+  PrintSessionTimes(args.execution_provider.c_str(), creation_info, std::chrono::steady_clock::now() - run_start_time);
+  session_rss_bytes += GetRssGrowthBytes(run_start_rss_bytes);
 
-  oss << "Model_And_Input,";
-  for (size_t i = 0; i < num_outputs; i++) {
-    oss << "Output_" << i << "_SNR";
-    if (i != num_outputs - 1) {
-      oss << ",";
+  if (benchmark != nullptr) {
+    benchmark->session_creation_ms = creation_info.creation_ms;
+    benchmark->session_rss_bytes = session_rss_bytes;
+    if (!BenchmarkSession(session, model_io_info, all_inputs, pool, args.warmup_runs, args.benchmark_runs,
+                          *benchmark)) {
+      std::cerr << "[ERROR]: Failed to benchmark model " << model_path << " on " << args.execution_provider << " EP"
+                << std::endl;
+      return false;
     }
   }
-  oss << std::endl;
-
-  return oss.str();
+  return true;
 }
 
-static bool GetExpectedAccuraciesFromFile(const std::filesystem::path& filepath,
-                                          std::unordered_map<std::string, std::vector<double>>& expected_acc_map) {
-  std::ifstream in_fs(filepath);
+static std::filesystem::path GetBenchmarkOutputPath(const std::filesystem::path& output_file) {
+  std::filesystem::path benchmark_file = output_file;
+  benchmark_file.replace_filename(output_file.stem().string() + ".benchmark" + output_file.extension().string());
+  return benchmark_file;
+}
 
-  constexpr size_t N = 1024;
-  std::array<char, N> tmp_buf = {};
+static bool WriteBenchmarkResults(const AppArgs& args, const std::string& benchmark_rows) {
+  const std::string header = args.results_format == ResultsFormat::Csv ? GetBenchmarkCSVHeaderRow() : std::string();
 
-  // Skip first row (contains column names for CSV file).
-  if (!in_fs.getline(&tmp_buf[0], tmp_buf.size())) {
-    std::cerr << "[ERROR]: Failed to read first row from expected accuracy file " << filepath << std::endl;
-    return false;
+  if (args.output_file.empty()) {
+    std::cout << std::endl << "[INFO]: Benchmark results:" << std::endl << header << benchmark_rows << std::flush;
+    return true;
   }
 
-  // Parse every row of the CSV file to fill out the expected accuracies map.
-  while (in_fs.getline(&tmp_buf[0], tmp_buf.size())) {
-    if (tmp_buf[0] == '\0') {
-      continue;  // Skip empty line
-    }
-
-    std::istringstream iss(tmp_buf.data());
+  const std::filesystem::path benchmark_file = GetBenchmarkOutputPath(args.output_file);
+  std::ofstream ofs(benchmark_file, std::ios::binary);
+  ofs << header << benchmark_rows;
 
-    if (!iss.getline(&tmp_buf[0], tmp_buf.size(), ',')) {
-      std::cerr << "[ERROR]: Failed to parse key from expected accuracy file " << filepath << std::endl;
-      return false;
-    }
-
-    std::string key(tmp_buf.data());
-
-    std::vector<double> output_snr_values;
-    while (iss.getline(&tmp_buf[0], tmp_buf.size(), ',')) {
-      output_snr_values.push_back(std::stod(tmp_buf.data()));
-    }
-
-    if (iss.bad()) {
-      std::cerr << "[ERROR]: Failed to parse output SNRs from expected accuracy file " << filepath << std::endl;
-      return false;
-    }
-
-    expected_acc_map[key] = std::move(output_snr_values);
-  }
-
-  if (in_fs.bad()) {
-    std::cerr << "[ERROR]: Failed to read from expected accuracy file " << filepath << std::endl;
+  if (!ofs) {
+    std::cerr << "[ERROR]: Failed to write benchmark results to " << benchmark_file << std::endl;
     return false;
   }
 
+  std::cout << "[INFO]: Wrote benchmark results to " << benchmark_file << std::endl;
   return true;
 }
 
@@ -404,6 +513,12 @@ static bool CompareToExpectedAccuracy(const std::vector<std::vector<AccMetrics>>
     for (size_t j = 0; j < expected_values.size(); j++) {
       const auto& metrics = actual_output_metrics[j];
 
+      if (metrics.shape_mismatch) {
+        passed = false;
+        oss << "\tOutput " << j << " shape does not match the expected output shape" << std::endl;
+        continue;
+      }
+
       if (!(expected_values[j] - metrics.snr <= EPSILON_DBL)) {
         passed = false;
         oss << "\tOutput " << j << " SNR decreased: expected "
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <fstream>
 #include <string>
+#include <utility>
 
 bool FillBytesFromBinaryFile(Span<char> array, const std::string& binary_filepath) {
   std::ifstream input_ifs(binary_filepath, std::ifstream::binary);
@@ -78,3 +79,160 @@ std::vector<std::filesystem::path> GetSortedDatasetPaths(const std::filesystem::
 
   return dataset_paths;
 }
+
+void AppendJsonString(std::string& buffer, std::string_view str) {
+  constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+  buffer += '"';
+  for (char c : str) {
+    const auto byte = static_cast<unsigned char>(c);
+
+    if (c == '"' || c == '\\') {
+      buffer += '\\';
+      buffer += c;
+    } else if (c == '\n') {
+      buffer += "\\n";
+    } else if (c == '\r') {
+      buffer += "\\r";
+    } else if (c == '\t') {
+      buffer += "\\t";
+    } else if (byte < 0x20) {
+      buffer += "\\u00";
+      buffer += HEX_DIGITS[byte >> 4];
+      buffer += HEX_DIGITS[byte & 0xF];
+    } else {
+      buffer += c;
+    }
+  }
+  buffer += '"';
+}
+
+void AppendCSVField(std::string& buffer, std::string_view str) {
+  if (str.find_first_of(",\"\r\n") == std::string_view::npos) {
+    buffer += str;
+    return;
+  }
+
+  buffer += '"';
+  for (char c : str) {
+    if (c == '"') {
+      buffer += '"';
+    }
+    buffer += c;
+  }
+  buffer += '"';
+}
+
+static constexpr std::array<std::pair<AccMetricType, const char*>, 8> ACC_METRIC_NAMES = {{
+    {AccMetricType::Snr, "snr"},
+    {AccMetricType::Rmse, "rmse"},
+    {AccMetricType::CosineSim, "cosine"},
+    {AccMetricType::MaxAbsError, "max_abs_err"},
+    {AccMetricType::MaxRelError, "max_rel_err"},
+    {AccMetricType::TopK, "topk"},
+    {AccMetricType::MinMax, "minmax"},
+    {AccMetricType::ErrorHistogram, "err_hist"},
+}};
+
+const char* GetAccMetricName(AccMetricType metric_type) {
+  for (const auto& entry : ACC_METRIC_NAMES) {
+    if (entry.first == metric_type) {
+      return entry.second;
+    }
+  }
+
+  assert(false && "Unhandled AccMetricType");
+  return "unknown";
+}
+
+bool ParseAccMetricTypes(std::string_view metrics_str, std::vector<AccMetricType>& metric_types) {
+  metric_types.clear();
+
+  while (!metrics_str.empty()) {
+    const size_t comma_pos = metrics_str.find(',');
+    std::string_view name = metrics_str.substr(0, comma_pos);
+    metrics_str = comma_pos == std::string_view::npos ? std::string_view{} : metrics_str.substr(comma_pos + 1);
+
+    if (name.empty()) {
+      continue;
+    }
+
+    if (name == "all") {
+      for (const auto& entry : ACC_METRIC_NAMES) {
+        metric_types.push_back(entry.first);
+      }
+      continue;
+    }
+
+    auto it = std::find_if(ACC_METRIC_NAMES.begin(), ACC_METRIC_NAMES.end(),
+                           [name](const auto& entry) { return name == entry.second; });
+    if (it == ACC_METRIC_NAMES.end()) {
+      return false;
+    }
+
+    metric_types.push_back(it->first);
+  }
+
+  // Remove duplicates while preserving the order in which the metrics were specified.
+  std::vector<AccMetricType> unique_metric_types;
+  for (AccMetricType metric_type : metric_types) {
+    if (std::find(unique_metric_types.begin(), unique_metric_types.end(), metric_type) == unique_metric_types.end()) {
+      unique_metric_types.push_back(metric_type);
+    }
+  }
+  metric_types = std::move(unique_metric_types);
+
+  return !metric_types.empty();
+}
+
+void AccMetricsAccumulator::Finalize(AccMetrics& metrics) const {
+  metrics = {};
+
+  if (num_seen_ == 0) {
+    return;
+  }
+
+  metrics.rmse = std::sqrt(diff_norm_sq_ / static_cast<double>(num_seen_));
+
+  const double expected_norm = std::sqrt(expected_norm_sq_);
+  const double actual_norm = std::sqrt(actual_norm_sq_);
+  const double diff_norm = std::sqrt(diff_norm_sq_);
+  metrics.snr = 20.0 * std::log10(std::max(expected_norm, EPSILON_DBL) / std::max(diff_norm, EPSILON_DBL));
+
+  if (expected_norm == 0.0 && actual_norm == 0.0) {
+    metrics.cosine_similarity = 1.0;  // Both outputs are all zeros, which we consider to be identical.
+  } else if (expected_norm == 0.0 || actual_norm == 0.0) {
+    metrics.cosine_similarity = 0.0;
+  } else {
+    metrics.cosine_similarity = dot_product_ / (expected_norm * actual_norm);
+  }
+
+  metrics.min_val = min_val_;
+  metrics.max_val = max_val_;
+  metrics.min_expected_val = min_expected_val_;
+  metrics.max_expected_val = max_expected_val_;
+  metrics.max_abs_error = max_abs_error_;
+  metrics.max_abs_error_index = max_abs_error_index_;
+  metrics.max_rel_error = max_rel_error_;
+  metrics.max_rel_error_index = max_rel_error_index_;
+  metrics.error_histogram = error_histogram_;
+
+  Span<const size_t> expected_indices = expected_top_k_.Indices();
+  Span<const size_t> actual_indices = actual_top_k_.Indices();
+
+  if (!expected_indices.empty() && !actual_indices.empty()) {
+    metrics.top1_match = expected_indices[0] == actual_indices[0];
+
+    size_t num_common = 0;
+    for (size_t i = 0; i < expected_indices.size(); i++) {
+      for (size_t j = 0; j < actual_indices.size(); j++) {
+        if (expected_indices[i] == actual_indices[j]) {
+          num_common++;
+          break;
+        }
+      }
+    }
+
+    metrics.top_k_agreement = static_cast<double>(num_common) / static_cast<double>(expected_indices.size());
+  }
+}
@@ -8,6 +8,7 @@
 #include <condition_variable>
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -23,6 +24,10 @@ class Span {
   template <size_t N>
   Span(std::array<T, N> arr) : data_(arr.data()), size_(N) {}
 
+  // Allows implicit conversion from Span<U> to Span<const U>.
+  template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+  Span(const Span<U>& other) : data_(other.data()), size_(other.size()) {}
+
   Span(const Span& other) = default;
   Span(Span&& other) = default;
 
@@ -60,8 +65,61 @@ int32_t GetFileIndexSuffix(const std::string& filename_wo_ext, const char* prefi
 bool FillBytesFromBinaryFile(Span<char> array, const std::string& binary_filepath);
 std::vector<std::filesystem::path> GetSortedDatasetPaths(const std::filesystem::path& model_dir);
 
+/// <summary>
+/// Appends a string to a JSON document as a quoted JSON string, escaping quotes, backslashes and control characters.
+/// </summary>
+/// <param name="buffer">The JSON document</param>
+/// <param name="str">The string to append (UTF-8)</param>
+void AppendJsonString(std::string& buffer, std::string_view str);
+
+/// <summary>
+/// Appends a string to a CSV document as a single field. Fields that contain commas, quotes or line breaks are quoted
+/// as described in RFC 4180 (with embedded quotes doubled).
+/// </summary>
+/// <param name="buffer">The CSV document</param>
+/// <param name="str">The string to append</param>
+void AppendCSVField(std::string& buffer, std::string_view str);
+
 constexpr double EPSILON_DBL = 2e-16;
 
+// Relative errors are computed as |actual - expected| / max(|expected|, REL_ERROR_DENOM_FLOOR) so that expected values
+// at (or very near) zero do not produce infinite relative errors.
+constexpr double REL_ERROR_DENOM_FLOOR = 1e-6;
+
+// The largest supported value for the number of top-k indices compared for each output.
+constexpr size_t MAX_TOP_K = 64;
+
+// Upper bounds (exclusive) of the absolute-error histogram bins. The last bin holds all errors >= 1.0.
+constexpr std::array<double, 8> ERROR_HISTOGRAM_BIN_BOUNDS = {1e-7, 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1.0};
+constexpr size_t ERROR_HISTOGRAM_NUM_BINS = ERROR_HISTOGRAM_BIN_BOUNDS.size() + 1;
+
+/// <summary>
+/// The accuracy metrics that can be selected for output (see the --metrics command-line option).
+/// </summary>
+enum class AccMetricType {
+  Snr,             // Signal-to-noise ratio (dB)
+  Rmse,            // Root-mean-square error
+  CosineSim,       // Cosine similarity between expected and actual output
+  MaxAbsError,     // Maximum absolute error and the flat index at which it occurs
+  MaxRelError,     // Maximum relative error and the flat index at which it occurs
+  TopK,            // Top-1 match and top-k index agreement (e.g., for classifier logits)
+  MinMax,          // Min/max of the actual and expected outputs
+  ErrorHistogram,  // Histogram of absolute errors (see ERROR_HISTOGRAM_BIN_BOUNDS)
+};
+
+/// <summary>
+/// Gets the name of an accuracy metric as used on the command-line (e.g., "snr").
+/// </summary>
+const char* GetAccMetricName(AccMetricType metric_type);
+
+/// <summary>
+/// Parses a comma-separated list of accuracy metric names (e.g., "snr,cosine,topk").
+/// </summary>
+/// <param name="metrics_str">The comma-separated metric names</param>
+/// <param name="metric_types">Output vector into which to store the parsed metric types (in order)</param>
+/// <returns>True on success</returns>
+bool ParseAccMetricTypes(std::string_view metrics_str, std::vector<AccMetricType>& metric_types);
+
 struct AccMetrics {
   double rmse = 0.0;
   double snr = 0.0;
@@ -69,6 +127,16 @@ struct AccMetrics {
   double max_val = 0.0;
   double min_expected_val = 0.0;
   double max_expected_val = 0.0;
+  double cosine_similarity = 0.0;
+  double max_abs_error = 0.0;
+  size_t max_abs_error_index = 0;
+  double max_rel_error = 0.0;
+  size_t max_rel_error_index = 0;
+  bool top1_match = false;
+  double top_k_agreement = 0.0;  // Fraction of the expected top-k indices that are also in the actual top-k.
+  std::array<uint64_t, ERROR_HISTOGRAM_NUM_BINS> error_histogram = {};
+  bool shape_mismatch = false;  // The actual output's shape differs from the expected output's shape.
+
   friend bool operator==(const AccMetrics& l, const AccMetrics& r) {
     if (l.rmse != r.rmse) return false;
     if (l.min_val != r.min_val) return false;
@@ -76,40 +144,144 @@ struct AccMetrics {
     if (l.min_expected_val != r.min_expected_val) return false;
     if (l.max_expected_val != r.max_expected_val) return false;
     if (l.snr != r.snr) return false;
+    if (l.cosine_similarity != r.cosine_similarity) return false;
+    if (l.max_abs_error != r.max_abs_error) return false;
+    if (l.max_abs_error_index != r.max_abs_error_index) return false;
+    if (l.max_rel_error != r.max_rel_error) return false;
+    if (l.max_rel_error_index != r.max_rel_error_index) return false;
+    if (l.top1_match != r.top1_match) return false;
+    if (l.top_k_agreement != r.top_k_agreement) return false;
+    if (l.error_histogram != r.error_histogram) return false;
+    if (l.shape_mismatch != r.shape_mismatch) return false;
 
     return true;
   }
   friend bool operator!=(const AccMetrics& l, const AccMetrics& r) { return !(l == r); }
 };
 
-template <typename T>
-void GetAccuracy(Span<const T> expected_output, Span<const T> actual_output, AccMetrics& metrics) {
-  // Compute RMSE. This is not a great way to measure accuracy, but ....
-  assert(expected_output.size() == actual_output.size());
-  const size_t num_outputs = expected_output.size();
-
-  metrics.rmse = 0.0;
-  metrics.min_val = static_cast<double>(actual_output[0]);
-  metrics.max_val = static_cast<double>(actual_output[0]);
-  metrics.min_expected_val = static_cast<double>(expected_output[0]);
-  metrics.max_expected_val = static_cast<double>(expected_output[0]);
-  double tensor_norm = 0.0;
-  double diff_norm = 0.0;
-  for (size_t i = 0; i < num_outputs; i++) {
-    double diff = static_cast<double>(actual_output[i]) - static_cast<double>(expected_output[i]);
-    diff_norm += diff * diff;
-    tensor_norm += static_cast<double>(expected_output[i]) * static_cast<double>(expected_output[i]);
-
-    metrics.rmse += diff * diff;
-    metrics.min_val = std::min(metrics.min_val, static_cast<double>(actual_output[i]));
-    metrics.max_val = std::max(metrics.max_val, static_cast<double>(actual_output[i]));
-    metrics.min_expected_val = std::min(metrics.min_expected_val, static_cast<double>(expected_output[i]));
-    metrics.max_expected_val = std::max(metrics.max_expected_val, static_cast<double>(expected_output[i]));
+/// <summary>
+/// Keeps track of the k largest values (and their flat indices) seen in a stream of values.
+/// Ties are resolved in favor of the value seen first.
+/// </summary>
+class TopKTracker {
+ public:
+  explicit TopKTracker(size_t k) : k_(std::min(k, MAX_TOP_K)) {}
+
+  void Push(double value, size_t index) {
+    if (k_ == 0 || (size_ == k_ && !(value > values_[size_ - 1]))) {
+      return;  // Not larger than the current k-th largest value (also filters NaN).
+    }
+
+    size_t pos = size_ < k_ ? size_++ : size_ - 1;
+    while (pos > 0 && value > values_[pos - 1]) {
+      values_[pos] = values_[pos - 1];
+      indices_[pos] = indices_[pos - 1];
+      pos--;
+    }
+
+    values_[pos] = value;
+    indices_[pos] = index;
   }
 
-  metrics.rmse = std::sqrt(metrics.rmse / static_cast<double>(num_outputs));
+  Span<const size_t> Indices() const { return Span<const size_t>(indices_.data(), size_); }
+
+ private:
+  size_t k_;
+  size_t size_ = 0;
+  std::array<double, MAX_TOP_K> values_ = {};
+  std::array<size_t, MAX_TOP_K> indices_ = {};
+};
+
+/// <summary>
+/// Accumulates all accuracy metrics for an output in a single pass over the (expected, actual) elements.
+/// The elements may be provided in one or more consecutive blocks via Update().
+/// </summary>
+class AccMetricsAccumulator {
+ public:
+  explicit AccMetricsAccumulator(size_t top_k) : top_k_(top_k), expected_top_k_(top_k), actual_top_k_(top_k) {}
+
+  template <typename T>
+  void Update(const T* expected_output, const T* actual_output, size_t num_elems) {
+    if (num_elems == 0) {
+      return;
+    }
+
+    if (num_seen_ == 0) {
+      min_val_ = max_val_ = static_cast<double>(actual_output[0]);
+      min_expected_val_ = max_expected_val_ = static_cast<double>(expected_output[0]);
+    }
+
+    const bool track_top_k = top_k_ > 0;
+
+    for (size_t i = 0; i < num_elems; i++) {
+      const double expected = static_cast<double>(expected_output[i]);
+      const double actual = static_cast<double>(actual_output[i]);
+      const double diff = actual - expected;
+      const double abs_diff = std::abs(diff);
+      const double rel_diff = abs_diff / std::max(std::abs(expected), REL_ERROR_DENOM_FLOOR);
+
+      diff_norm_sq_ += diff * diff;
+      expected_norm_sq_ += expected * expected;
+      actual_norm_sq_ += actual * actual;
+      dot_product_ += expected * actual;
+
+      min_val_ = std::min(min_val_, actual);
+      max_val_ = std::max(max_val_, actual);
+      min_expected_val_ = std::min(min_expected_val_, expected);
+      max_expected_val_ = std::max(max_expected_val_, expected);
+
+      if (abs_diff > max_abs_error_) {
+        max_abs_error_ = abs_diff;
+        max_abs_error_index_ = num_seen_ + i;
+      }
+
+      if (rel_diff > max_rel_error_) {
+        max_rel_error_ = rel_diff;
+        max_rel_error_index_ = num_seen_ + i;
+      }
+
+      size_t bin = 0;
+      while (bin < ERROR_HISTOGRAM_BIN_BOUNDS.size() && !(abs_diff < ERROR_HISTOGRAM_BIN_BOUNDS[bin])) {
+        bin++;
+      }
+      error_histogram_[bin]++;
+
+      if (track_top_k) {
+        expected_top_k_.Push(expected, num_seen_ + i);
+        actual_top_k_.Push(actual, num_seen_ + i);
+      }
+    }
+
+    num_seen_ += num_elems;
+  }
+
+  void Finalize(AccMetrics& metrics) const;
+
+ private:
+  size_t top_k_;
+  size_t num_seen_ = 0;
+  double diff_norm_sq_ = 0.0;
+  double expected_norm_sq_ = 0.0;
+  double actual_norm_sq_ = 0.0;
+  double dot_product_ = 0.0;
+  double min_val_ = 0.0;
+  double max_val_ = 0.0;
+  double min_expected_val_ = 0.0;
+  double max_expected_val_ = 0.0;
+  double max_abs_error_ = 0.0;
+  size_t max_abs_error_index_ = 0;
+  double max_rel_error_ = 0.0;
+  size_t max_rel_error_index_ = 0;
+  std::array<uint64_t, ERROR_HISTOGRAM_NUM_BINS> error_histogram_ = {};
+  TopKTracker expected_top_k_;
+  TopKTracker actual_top_k_;
+};
+
+template <typename T>
+void GetAccuracy(Span<const T> expected_output, Span<const T> actual_output, AccMetrics& metrics, size_t top_k) {
+  assert(expected_output.size() == actual_output.size());
+  AccMetricsAccumulator accumulator(top_k);
 
-  tensor_norm = std::max(std::sqrt(tensor_norm), EPSILON_DBL);
-  diff_norm = std::max(std::sqrt(diff_norm), EPSILON_DBL);
-  metrics.snr = 20.0 * std::log10(tensor_norm / diff_norm);
+  accumulator.Update(expected_output.data(), actual_output.data(), expected_output.size());
+  accumulator.Finalize(metrics);
 }
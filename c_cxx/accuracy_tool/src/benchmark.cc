@@ -0,0 +1,210 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <fstream>
+#endif
+
+#include "acc_task.h"
+
+// Returns the nearest-rank percentile of sorted values.
+static double GetPercentile(const std::vector<double>& sorted_values, double percentile) {
+  const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(sorted_values.size())));
+  return sorted_values[std::clamp<size_t>(rank, 1, sorted_values.size()) - 1];
+}
+
+LatencyStats ComputeLatencyStats(std::vector<double> latencies_ms) {
+  LatencyStats stats;
+
+  if (latencies_ms.empty()) {
+    return stats;
+  }
+
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  stats.p50_ms = GetPercentile(latencies_ms, 50.0);
+  stats.p90_ms = GetPercentile(latencies_ms, 90.0);
+  stats.p99_ms = GetPercentile(latencies_ms, 99.0);
+  stats.max_ms = latencies_ms.back();
+
+  return stats;
+}
+
+size_t GetPeakRssBytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters = {};
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return 0;
+  }
+  return static_cast<size_t>(counters.PeakWorkingSetSize);
+#else
+  struct rusage usage = {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return static_cast<size_t>(usage.ru_maxrss);  // Bytes on macOS.
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;  // Kilobytes on Linux.
+#endif
+#endif
+}
+
+size_t GetCurrentRssBytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters = {};
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return 0;
+  }
+  return static_cast<size_t>(counters.WorkingSetSize);
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info = {};
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) !=
+      KERN_SUCCESS) {
+    return 0;
+  }
+  return static_cast<size_t>(info.resident_size);
+#else
+  // The second field of /proc/self/statm is the resident set size in pages.
+  std::ifstream ifs("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  if (!(ifs >> total_pages >> resident_pages)) {
+    return 0;
+  }
+  return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+size_t GetRssGrowthBytes(size_t start_rss_bytes) {
+  const size_t rss_bytes = GetCurrentRssBytes();
+  return rss_bytes > start_rss_bytes ? rss_bytes - start_rss_bytes : 0;
+}
+
+bool BenchmarkSession(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+                      TaskThreadPool& pool, size_t warmup_runs, size_t timed_runs, SessionBenchmark& benchmark) {
+  const size_t num_datasets = all_inputs.datasets.size();
+  std::vector<size_t> dataset_indices(num_datasets);
+  std::iota(dataset_indices.begin(), dataset_indices.end(), 0);
+
+  // Submit datasets with the same input shapes back-to-back so that consecutive runs can reuse ORT's allocations.
+  std::vector<size_t> dataset_order;
+  dataset_order.reserve(num_datasets);
+  for (const std::vector<size_t>& shape_group : all_inputs.shape_groups) {
+    dataset_order.insert(dataset_order.end(), shape_group.begin(), shape_group.end());
+  }
+
+  auto run_all_datasets = [&](std::vector<std::vector<double>>& latencies_ms) {
+    std::vector<Task> tasks;
+    tasks.reserve(num_datasets);
+
+    for (size_t d : dataset_order) {
+      tasks.push_back(Task::CreateBenchmarkTask(session, model_io_info, all_inputs,
+                                                Span<const size_t>(&dataset_indices[d], 1),
+                                                Span<double>(latencies_ms[d])));
+    }
+
+    return pool.CompleteTasks(tasks);
+  };
+
+  const size_t start_rss_bytes = GetCurrentRssBytes();
+
+  if (warmup_runs > 0) {
+    std::vector<std::vector<double>> warmup_latencies_ms(num_datasets, std::vector<double>(warmup_runs));
+    if (!run_all_datasets(warmup_latencies_ms)) {
+      return false;
+    }
+  }
+
+  std::vector<std::vector<double>> latencies_ms(num_datasets, std::vector<double>(timed_runs));
+
+  const auto start_time = std::chrono::steady_clock::now();
+  const bool succeeded = run_all_datasets(latencies_ms);
+  const auto end_time = std::chrono::steady_clock::now();
+
+  if (!succeeded) {
+    return false;
+  }
+
+  const double elapsed_s = std::chrono::duration<double>(end_time - start_time).count();
+  benchmark.throughput = elapsed_s > 0.0 ? static_cast<double>(num_datasets * timed_runs) / elapsed_s : 0.0;
+  benchmark.session_rss_bytes += GetRssGrowthBytes(start_rss_bytes);
+  benchmark.process_peak_rss_bytes = GetPeakRssBytes();
+
+  benchmark.dataset_latencies.clear();
+  benchmark.dataset_latencies.reserve(num_datasets);
+  for (std::vector<double>& dataset_latencies_ms : latencies_ms) {
+    benchmark.dataset_latencies.push_back(ComputeLatencyStats(std::move(dataset_latencies_ms)));
+  }
+
+  return true;
+}
+
+std::string FormatBenchmarkResults(const std::string& model_name,
+                                   const std::vector<std::filesystem::path>& dataset_paths, const char* session_name,
+                                   const SessionBenchmark& benchmark, ResultsFormat format) {
+  std::ostringstream oss;
+  oss << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+  const double session_rss_mb = static_cast<double>(benchmark.session_rss_bytes) / (1024.0 * 1024.0);
+  const double process_peak_rss_mb = static_cast<double>(benchmark.process_peak_rss_bytes) / (1024.0 * 1024.0);
+
+  for (size_t i = 0; i < benchmark.dataset_latencies.size(); i++) {
+    const LatencyStats& stats = benchmark.dataset_latencies[i];
+    const std::string key = model_name + "/" + dataset_paths[i].filename().string();
+
+    if (format == ResultsFormat::Json) {
+      std::string json_strings = "{\"key\":";
+      AppendJsonString(json_strings, key);
+      json_strings += ",\"session\":";
+      AppendJsonString(json_strings, session_name);
+
+      oss << json_strings << ",\"session_creation_ms\":" << benchmark.session_creation_ms
+          << ",\"session_rss_mb\":" << session_rss_mb << ",\"process_peak_rss_mb\":" << process_peak_rss_mb
+          << ",\"throughput\":" << benchmark.throughput << ",\"p50_ms\":" << stats.p50_ms
+          << ",\"p90_ms\":" << stats.p90_ms << ",\"p99_ms\":" << stats.p99_ms << ",\"max_ms\":" << stats.max_ms << "}"
+          << std::endl;
+      continue;
+    }
+
+    std::string csv_strings;
+    AppendCSVField(csv_strings, key);
+    csv_strings += ',';
+    AppendCSVField(csv_strings, session_name);
+
+    oss << csv_strings << "," << benchmark.session_creation_ms << "," << session_rss_mb << ","
+        << process_peak_rss_mb << "," << benchmark.throughput << "," << stats.p50_ms << "," << stats.p90_ms << ","
+        << stats.p99_ms << "," << stats.max_ms << std::endl;
+  }
+
+  return oss.str();
+}
+
+std::string GetBenchmarkCSVHeaderRow() {
+  return "Model_And_Input,Session,Session_Creation_ms,Session_RSS_MB,Process_Peak_RSS_MB,Throughput_Runs_Per_s,"
+         "P50_ms,P90_ms,P99_ms,Max_ms\n";
+}
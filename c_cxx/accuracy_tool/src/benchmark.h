@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <onnxruntime_cxx_api.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "cmd_args.h"
+#include "data_loader.h"
+#include "model_io_utils.h"
+#include "task_thread_pool.h"
+
+/// <summary>
+/// Latency percentiles (nearest-rank) of the timed runs of a single dataset.
+/// </summary>
+struct LatencyStats {
+  double p50_ms = 0.0;
+  double p90_ms = 0.0;
+  double p99_ms = 0.0;
+  double max_ms = 0.0;
+};
+
+/// <summary>
+/// Performance measurements for one session (e.g., the reference CPU EP session or the session for the EP under
+/// test) of a model.
+/// </summary>
+struct SessionBenchmark {
+  double session_creation_ms = 0.0;
+  double throughput = 0.0;     // Timed runs per second across all inference threads.
+  size_t session_rss_bytes = 0;       // Growth of the process's resident set while the session was created and run.
+  size_t process_peak_rss_bytes = 0;  // Process-wide peak resident set size after the benchmark (all sessions so far).
+  std::vector<LatencyStats> dataset_latencies;  // Indexed by dataset. Empty if the session was not benchmarked.
+};
+
+/// <summary>
+/// Computes the latency percentiles of a set of runs.
+/// </summary>
+/// <param name="latencies_ms">The latency of every run (in milliseconds)</param>
+/// <returns>The latency percentiles</returns>
+LatencyStats ComputeLatencyStats(std::vector<double> latencies_ms);
+
+/// <summary>
+/// Gets the peak resident set size (i.e., peak working set on Windows) of the process so far. The peak never
+/// decreases, so it includes the memory of every session that the process created before.
+/// </summary>
+/// <returns>The peak RSS in bytes, or 0 if it can't be queried</returns>
+size_t GetPeakRssBytes();
+
+/// <summary>
+/// Gets the current resident set size (i.e., working set on Windows) of the process.
+/// </summary>
+/// <returns>The current RSS in bytes, or 0 if it can't be queried</returns>
+size_t GetCurrentRssBytes();
+
+/// <summary>
+/// Gets how much the resident set of the process grew since GetCurrentRssBytes() returned `start_rss_bytes`.
+/// </summary>
+/// <returns>The growth in bytes, or 0 if the resident set shrank</returns>
+size_t GetRssGrowthBytes(size_t start_rss_bytes);
+
+/// <summary>
+/// Replays every dataset `warmup_runs + timed_runs` times with the given session and records the latency of the
+/// timed runs. Datasets are run concurrently by the thread pool, so the throughput reflects the configured number of
+/// inference threads (use a single thread to measure uncontended latencies).
+/// </summary>
+/// <param name="session">The initialized ONNX Runtime session</param>
+/// <param name="model_io_info">Information about the model's input and output tensors</param>
+/// <param name="all_inputs">The model's input data for all datasets</param>
+/// <param name="pool">The thread pool used to run the datasets</param>
+/// <param name="warmup_runs">Number of untimed runs per dataset</param>
+/// <param name="timed_runs">Number of timed runs per dataset</param>
+/// <param name="benchmark">Output into which to store the measurements. The session creation time is not set, and the
+/// growth of the resident set during the runs is added to `session_rss_bytes`.</param>
+/// <returns>True on success</returns>
+bool BenchmarkSession(Ort::Session& session, const ModelIOInfo& model_io_info, const DatasetsIOData& all_inputs,
+                      TaskThreadPool& pool, size_t warmup_runs, size_t timed_runs, SessionBenchmark& benchmark);
+
+/// <summary>
+/// Formats the benchmark results of a session as CSV rows or JSON Lines (one per dataset). Each row uses the same
+/// key as the accuracy results (e.g., "model_name/test_data_set_0").
+/// </summary>
+/// <param name="model_name">The name of the model</param>
+/// <param name="dataset_paths">The dataset directories of the model</param>
+/// <param name="session_name">The name of the benchmarked session (e.g., "reference" or "ep")</param>
+/// <param name="benchmark">The benchmark results</param>
+/// <param name="format">The output format</param>
+/// <returns>The formatted rows</returns>
+std::string FormatBenchmarkResults(const std::string& model_name,
+                                   const std::vector<std::filesystem::path>& dataset_paths, const char* session_name,
+                                   const SessionBenchmark& benchmark, ResultsFormat format);
+
+/// <summary>
+/// Gets the header row for CSV benchmark results.
+/// </summary>
+std::string GetBenchmarkCSVHeaderRow();
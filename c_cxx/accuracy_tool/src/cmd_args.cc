@@ -37,6 +37,43 @@ void PrintUsage(std::ostream& stream, std::string_view prog_name) {
   stream << " --model model_name                    Model to test. Option can be specified multiple times."
          << std::endl;
   stream << "                                       By default, all found models are tested." << std::endl;
+  stream << " -m/--metrics metric1,metric2,...      Accuracy metrics to output. Defaults to 'snr'." << std::endl;
+  stream << "                                       Options: 'snr', 'rmse', 'cosine', 'max_abs_err', 'max_rel_err',"
+         << std::endl;
+  stream << "                                       'topk', 'minmax', 'err_hist', or 'all'." << std::endl;
+  stream << " -k/--top_k k                          Number of largest output elements compared by the 'topk' metric."
+         << std::endl;
+  stream << "                                       Defaults to 5. Maximum is " << MAX_TOP_K << "." << std::endl;
+  stream << " -f/--output_format format             Format of the accuracy results: 'csv' or 'json' (JSON Lines)."
+         << std::endl;
+  stream << "                                       Defaults to 'csv'." << std::endl;
+  stream << " --reference_cache_dir path            Directory in which to cache the expected outputs from the baseline"
+         << std::endl;
+  stream << "                                       model on CPU EP. Cached outputs are reused when the model, inputs,"
+         << std::endl;
+  stream << "                                       and ONNX Runtime version are unchanged. Created if necessary."
+         << std::endl;
+  stream << " --session_cache_dir path              Directory in which to cache the optimized baseline model and the"
+         << std::endl;
+  stream << "                                       EPContext model compiled by the EP under test (if supported)."
+         << std::endl;
+  stream << "                                       Cached models are reused when the model, EP options, session"
+         << std::endl;
+  stream << "                                       configs, and ONNX Runtime version are unchanged." << std::endl;
+  stream << " -b/--batch_size n                     Number of datasets with identical input shapes to stack into a"
+         << std::endl;
+  stream << "                                       single inference run. Only used for models whose inputs and"
+         << std::endl;
+  stream << "                                       outputs all have a symbolic batch dimension. Defaults to 1."
+         << std::endl;
+  stream << " --benchmark n                         Replay every dataset n more times with the reference and EP"
+         << std::endl;
+  stream << "                                       sessions and report latency percentiles, throughput, session"
+         << std::endl;
+  stream << "                                       creation time, and peak memory. Disabled by default." << std::endl;
+  stream << " --warmup n                            Number of untimed runs per dataset before benchmarking."
+         << std::endl;
+  stream << "                                       Defaults to 1." << std::endl;
   stream << std::endl;
   stream << "[EP_ARGS]: Specify EP-specific runtime options as key value pairs." << std::endl;
   stream << "  Example: -e <provider_name> \"<key1>|<val1> <key2>|<val2>\"" << std::endl;
@@ -174,6 +211,96 @@ bool ParseCmdLineArgs(AppArgs& app_args, int argc, char** argv) {
 
       arg = cmd_args.GetNext();
       app_args.only_models.insert(std::string(arg));
+    } else if (arg == "-m" || arg == "--metrics") {
+      if (!cmd_args.HasNext()) {
+        std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      arg = cmd_args.GetNext();
+      if (!ParseAccMetricTypes(arg, app_args.metrics)) {
+        std::cerr << "[ERROR]: Invalid list of accuracy metrics: " << arg << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+    } else if (arg == "-k" || arg == "--top_k") {
+      if (!cmd_args.HasNext()) {
+        std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      int k = std::stoi(std::string(cmd_args.GetNext()));
+      if (k <= 0 || static_cast<size_t>(k) > MAX_TOP_K) {
+        std::cerr << "[ERROR]: The value of top_k must be in the range [1, " << MAX_TOP_K << "]." << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      app_args.top_k = static_cast<size_t>(k);
+    } else if (arg == "-b" || arg == "--batch_size") {
+      if (!cmd_args.HasNext()) {
+        std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      int n = std::stoi(std::string(cmd_args.GetNext()));
+      if (n <= 0) {
+        std::cerr << "[ERROR]: The batch size must be greater than 0." << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      app_args.batch_size = static_cast<size_t>(n);
+    } else if (arg == "--benchmark") {
+      if (!cmd_args.HasNext()) {
+        std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      int n = std::stoi(std::string(cmd_args.GetNext()));
+      if (n <= 0) {
+        std::cerr << "[ERROR]: The number of benchmark runs must be greater than 0." << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      app_args.benchmark_runs = static_cast<size_t>(n);
+    } else if (arg == "--warmup") {
+      if (!cmd_args.HasNext()) {
+        std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      int n = std::stoi(std::string(cmd_args.GetNext()));
+      if (n < 0) {
+        std::cerr << "[ERROR]: The number of warmup runs must not be negative." << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      app_args.warmup_runs = static_cast<size_t>(n);
+    } else if (arg == "-f" || arg == "--output_format") {
+      if (!cmd_args.HasNext()) {
+        std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      arg = cmd_args.GetNext();
+      if (arg == "csv") {
+        app_args.results_format = ResultsFormat::Csv;
+      } else if (arg == "json") {
+        app_args.results_format = ResultsFormat::Json;
+      } else {
+        std::cerr << "[ERROR]: Unsupported output format: " << arg << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
     } else if (arg == "-a" || arg == "--expected_accuracy_file") {
       if (!cmd_args.HasNext()) {
         std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
@@ -220,6 +347,45 @@ bool ParseCmdLineArgs(AppArgs& app_args, int argc, char** argv) {
 
       for (auto& it : session_configs) {
         app_args.session_options.AddConfigEntry(it.first.c_str(), it.second.c_str());
+        app_args.session_configs[it.first] = it.second;
+      }
+    } else if (arg == "--reference_cache_dir") {
+      if (!cmd_args.HasNext()) {
+        std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      arg = cmd_args.GetNext();
+      std::error_code error_code;
+      std::filesystem::create_directories(std::filesystem::path(arg), error_code);
+      if (error_code) {
+        std::cerr << "[ERROR]: Unable to create reference cache directory " << arg << ": " << error_code.message()
+                  << std::endl;
+        return false;
+      }
+
+      if (!GetValidPath(prog_name, arg, true, app_args.reference_cache_dir)) {
+        return false;
+      }
+    } else if (arg == "--session_cache_dir") {
+      if (!cmd_args.HasNext()) {
+        std::cerr << "[ERROR]: Must provide an argument after the " << arg << " option" << std::endl;
+        PrintUsage(std::cerr, prog_name);
+        return false;
+      }
+
+      arg = cmd_args.GetNext();
+      std::error_code error_code;
+      std::filesystem::create_directories(std::filesystem::path(arg), error_code);
+      if (error_code) {
+        std::cerr << "[ERROR]: Unable to create session cache directory " << arg << ": " << error_code.message()
+                  << std::endl;
+        return false;
+      }
+
+      if (!GetValidPath(prog_name, arg, true, app_args.session_cache_dir)) {
+        return false;
       }
     } else if (arg == "-s" || arg == "--save_expected_outputs") {
       app_args.save_expected_outputs_to_disk = true;
@@ -257,5 +423,12 @@ bool ParseCmdLineArgs(AppArgs& app_args, int argc, char** argv) {
     return false;
   }
 
+  if (app_args.load_expected_outputs_from_disk && !app_args.reference_cache_dir.empty()) {
+    std::cerr << "[ERROR]: Cannot enable both --reference_cache_dir and -l/--load_expected_outputs" << std::endl
+              << std::endl;
+    PrintUsage(std::cerr, prog_name);
+    return false;
+  }
+
   return true;
-}
\ No newline at end of file
+}
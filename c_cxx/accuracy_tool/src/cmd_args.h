@@ -5,10 +5,14 @@
 
 #include <cassert>
 #include <filesystem>
+#include <map>
 #include <ostream>
 #include <string>
 #include <string_view>
 #include <unordered_set>
+#include <vector>
+
+#include "basic_utils.h"
 
 /// <summary>
 /// Convenience structure for getting individual command-line arguments.
@@ -48,6 +52,14 @@ struct CmdArgParser {
   int index_;
 };
 
+/// <summary>
+/// The file format used to output accuracy results.
+/// </summary>
+enum class ResultsFormat {
+  Csv,
+  Json,  // JSON Lines: one JSON object per line for every model/dataset pair.
+};
+
 /// <summary>
 /// The application's input arguments after parsing the command-line.
 /// </summary>
@@ -59,10 +71,23 @@ struct AppArgs {
   std::string execution_provider;
   bool uses_qdq_model = false;
   bool supports_multithread_inference = true;
+  bool compiles_model = false;        // EP under test compiles (part of) the model instead of running ORT kernels.
+  bool supports_ep_context = false;  // EP under test can compile the model into an EPContext model.
   bool save_expected_outputs_to_disk = false;
   bool load_expected_outputs_from_disk = false;
+  std::filesystem::path reference_cache_dir;  // Directory for cached expected outputs. Empty if caching is disabled.
+  std::filesystem::path session_cache_dir;    // Directory for cached compiled models. Empty if caching is disabled.
   size_t num_threads = 1;
+  std::vector<AccMetricType> metrics = {AccMetricType::Snr};  // Accuracy metrics to output.
+  size_t top_k = 5;
+  size_t batch_size = 1;  // Max number of datasets to stack into a single inference run.
+  size_t benchmark_runs = 0;  // Timed runs per dataset. 0 disables benchmarking.
+  size_t warmup_runs = 1;     // Untimed runs per dataset before benchmarking.
+  ResultsFormat results_format = ResultsFormat::Csv;
   Ort::SessionOptions session_options;
+  // The EP options and session configs already applied to session_options. Used for the session cache key.
+  std::map<std::string, std::string> ep_options;
+  std::map<std::string, std::string> session_configs;
 };
 
 /// <summary>
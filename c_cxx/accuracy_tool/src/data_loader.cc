@@ -4,74 +4,526 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-bool LoadIODataFromDisk(const std::vector<std::filesystem::path>& dataset_paths, const std::vector<IOInfo>& io_infos,
-                        const char* data_file_prefix, std::vector<std::unique_ptr<char[]>>& dataset_data) {
-  size_t total_data_size = 0;
-  for (const auto& io_info : io_infos) {
-    total_data_size += io_info.total_data_size;
+#include "tensor_proto_reader.h"
+
+// The files that provide the data (and optionally the shape) of one input or output tensor.
+struct TensorFiles {
+  std::filesystem::path data_file_path;
+  std::filesystem::path shape_file_path;
+  bool is_tensor_proto = false;  // True if the data file is a serialized onnx.TensorProto (.pb)
+};
+
+// A loaded tensor whose data has not yet been placed into its final buffer.
+struct PendingTensor {
+  MappedFile mapped_file;  // Only used for .pb files.
+  TensorProtoView tensor_proto;
+  bool use_in_place = false;  // True if the data in the mapped .pb file can be used directly.
+};
+
+static bool ReadShapeFile(const std::filesystem::path& shape_file_path, std::vector<int64_t>& shape) {
+  std::ifstream ifs(shape_file_path);
+  if (!ifs.is_open()) {
+    std::cerr << "[ERROR]: Unable to open shape file " << shape_file_path << std::endl;
+    return false;
   }
 
-  dataset_data.clear();
-  dataset_data.reserve(dataset_paths.size());
+  std::string contents((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  std::replace(contents.begin(), contents.end(), ',', ' ');
 
-  for (const auto& dataset_path : dataset_paths) {
-    dataset_data.emplace_back(std::make_unique<char[]>(total_data_size));
+  std::istringstream iss(contents);
+  int64_t dim = 0;
+  shape.clear();
 
-    size_t num_files_loaded = 0;
+  while (iss >> dim) {
+    if (dim < 0) {
+      std::cerr << "[ERROR]: Shape file " << shape_file_path << " contains a negative dimension" << std::endl;
+      return false;
+    }
+    shape.push_back(dim);
+  }
 
-    for (const auto& data_file_entry : std::filesystem::directory_iterator{dataset_path}) {
-      const std::filesystem::path& data_file_path = data_file_entry.path();
+  if (!iss.eof()) {
+    std::cerr << "[ERROR]: Unable to parse dimensions from shape file " << shape_file_path << std::endl;
+    return false;
+  }
 
-      if (!std::filesystem::is_regular_file(data_file_path)) {
-        continue;
-      }
+  return true;
+}
+
+static bool ResolveTensorShape(const IOInfo& io_info, const TensorFiles& files, size_t data_file_size,
+                               std::vector<int64_t>& shape) {
+  if (!files.shape_file_path.empty()) {
+    if (!ReadShapeFile(files.shape_file_path, shape)) {
+      return false;
+    }
+
+    if (!io_info.IsCompatibleShape(Span<const int64_t>(shape))) {
+      std::cerr << "[ERROR]: The shape in " << files.shape_file_path << " is not compatible with the model's shape "
+                << "for " << io_info.name << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  shape = io_info.shape;
+  const size_t num_symbolic_dims = std::count_if(shape.begin(), shape.end(), [](int64_t dim) { return dim < 0; });
+
+  if (num_symbolic_dims == 0) {
+    return true;
+  }
+
+  if (num_symbolic_dims > 1) {
+    std::cerr << "[ERROR]: " << io_info.name << " has " << num_symbolic_dims << " symbolic dimensions, so its shape "
+              << "cannot be inferred from " << files.data_file_path << ". Provide a "
+              << files.data_file_path.stem().string() << ".shape file." << std::endl;
+    return false;
+  }
+
+  // Infer the single symbolic dimension from the number of elements in the file.
+  int64_t known_elems = 1;
+  for (int64_t dim : shape) {
+    known_elems *= dim >= 0 ? dim : 1;
+  }
+
+  int64_t num_elems = static_cast<int64_t>(data_file_size * 8 / io_info.elem_bit_width);
+  if (known_elems != 0 && num_elems % known_elems != 0 && io_info.elem_bit_width < 8) {
+    num_elems -= 1;  // The last byte of a packed sub-byte tensor may contain padding.
+  }
+
+  if (known_elems == 0 || num_elems % known_elems != 0) {
+    std::cerr << "[ERROR]: Unable to infer the symbolic dimension of " << io_info.name << " from the size of "
+              << files.data_file_path << ". Provide a " << files.data_file_path.stem().string() << ".shape file."
+              << std::endl;
+    return false;
+  }
+
+  std::replace_if(shape.begin(), shape.end(), [](int64_t dim) { return dim < 0; }, num_elems / known_elems);
+  return true;
+}
+
+// Finds the data and shape files for every input (or output) in a dataset directory.
+static bool FindTensorFiles(const std::filesystem::path& dataset_path, const std::vector<IOInfo>& io_infos,
+                            const char* data_file_prefix, std::vector<TensorFiles>& tensor_files) {
+  tensor_files.assign(io_infos.size(), TensorFiles{});
+  size_t num_files_found = 0;
+
+  for (const auto& data_file_entry : std::filesystem::directory_iterator{dataset_path}) {
+    const std::filesystem::path& data_file_path = data_file_entry.path();
+
+    if (!std::filesystem::is_regular_file(data_file_path)) {
+      continue;
+    }
+
+    const std::string extension = data_file_path.extension().string();
+    const bool is_tensor_proto = extension == ".pb";
+    const bool is_data_file = extension == ".raw" || is_tensor_proto;
+    const bool is_shape_file = extension == ".shape";
+    if (!is_data_file && !is_shape_file) {
+      continue;
+    }
+
+    std::string data_filename_wo_ext = data_file_path.stem().string();
+    if (data_filename_wo_ext.rfind(data_file_prefix, 0) != 0) {
+      continue;
+    }
+
+    const int32_t io_index_s32 = GetFileIndexSuffix(data_filename_wo_ext, data_file_prefix);
+    if (io_index_s32 < 0) {
+      std::cerr << "[ERROR]: The file " << data_file_path << " does not have a properly formatted name"
+                << " (e.g., " << data_file_prefix << "0.raw)" << std::endl;
+      return false;
+    }
+
+    const size_t io_index = static_cast<size_t>(io_index_s32);
+    if (io_index >= io_infos.size()) {
+      std::cerr << "[ERROR]: The input (or output) file index for file " << data_file_path
+                << " exceeds the number of inputs (or outputs) in the model (" << io_infos.size() << ")" << std::endl;
+      return false;
+    }
+
+    if (is_shape_file) {
+      tensor_files[io_index].shape_file_path = data_file_path;
+      continue;
+    }
+
+    if (!tensor_files[io_index].data_file_path.empty()) {
+      std::cerr << "[ERROR]: " << dataset_path << " has both " << tensor_files[io_index].data_file_path.filename()
+                << " and " << data_file_path.filename() << ". Only one data file is allowed per tensor." << std::endl;
+      return false;
+    }
+
+    tensor_files[io_index].data_file_path = data_file_path;
+    tensor_files[io_index].is_tensor_proto = is_tensor_proto;
+    num_files_found += 1;
+  }
+
+  if (num_files_found != io_infos.size()) {
+    std::cerr << "[ERROR]: " << dataset_path << " does not have the expected number of " << data_file_prefix
+              << "<i>.raw (or .pb) files. Found " << num_files_found << " files, but expected " << io_infos.size()
+              << " files." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// Maps a .pb file, parses its TensorProto header, and validates the element type and shape against the model.
+static bool OpenTensorProtoFile(const IOInfo& io_info, const std::filesystem::path& pb_file_path,
+                                PendingTensor& pending_tensor, std::vector<int64_t>& shape) {
+  if (!MappedFile::Open(pb_file_path, pending_tensor.mapped_file)) {
+    return false;
+  }
+
+  Span<char> file_bytes = pending_tensor.mapped_file.Data();
+  TensorProtoView& tensor_proto = pending_tensor.tensor_proto;
+
+  if (!ParseTensorProto(file_bytes, tensor_proto)) {
+    std::cerr << "[ERROR]: Unable to parse TensorProto from file " << pb_file_path << std::endl;
+    return false;
+  }
 
-      std::string data_filename_wo_ext = data_file_path.stem().string();
-      if (data_filename_wo_ext.rfind(data_file_prefix, 0) != 0) {
+  if (static_cast<ONNXTensorElementDataType>(tensor_proto.data_type) != io_info.data_type) {
+    std::cerr << "[ERROR]: The element type in " << pb_file_path << " (" << tensor_proto.data_type
+              << ") does not match the model's element type for " << io_info.name << " (" << io_info.data_type << ")"
+              << std::endl;
+    return false;
+  }
+
+  if (!io_info.IsCompatibleShape(Span<const int64_t>(tensor_proto.dims))) {
+    std::cerr << "[ERROR]: The shape in " << pb_file_path << " is not compatible with the model's shape for "
+              << io_info.name << std::endl;
+    return false;
+  }
+
+  shape = tensor_proto.dims;
+
+  // Use the data in place only if it has the tensor's memory layout, the expected size, and element alignment.
+  const size_t elem_align = std::max<size_t>(1, io_info.elem_bit_width / 8);
+  pending_tensor.use_in_place = IsTensorProtoDataInMemoryLayout(tensor_proto) &&
+                                tensor_proto.data.size() == io_info.GetDataSize(Span<const int64_t>(shape)) &&
+                                reinterpret_cast<uintptr_t>(tensor_proto.data.data()) % elem_align == 0;
+  return true;
+}
+
+bool LoadIODataFromDisk(const std::vector<std::filesystem::path>& dataset_paths, const std::vector<IOInfo>& io_infos,
+                        const char* data_file_prefix, DatasetsIOData& io_data) {
+  const size_t num_datasets = dataset_paths.size();
+  const size_t num_tensors = io_infos.size();
+  std::vector<std::vector<TensorFiles>> all_tensor_files(num_datasets);
+  std::vector<std::vector<PendingTensor>> all_pending_tensors(num_datasets);
+
+  io_data.datasets.clear();
+  io_data.datasets.resize(num_datasets);
+  io_data.shape_groups.clear();
+  io_data.group_buffers.clear();
+  io_data.mapped_files.clear();
+
+  // Determine the actual shape of every tensor and group the datasets whose shapes are all identical.
+  std::map<std::vector<std::vector<int64_t>>, size_t> shapes_to_group;
+
+  for (size_t d = 0; d < num_datasets; d++) {
+    std::vector<TensorFiles>& tensor_files = all_tensor_files[d];
+    if (!FindTensorFiles(dataset_paths[d], io_infos, data_file_prefix, tensor_files)) {
+      return false;
+    }
+
+    std::vector<std::vector<int64_t>> shapes(num_tensors);
+    all_pending_tensors[d].resize(num_tensors);
+
+    for (size_t i = 0; i < num_tensors; i++) {
+      if (tensor_files[i].is_tensor_proto) {
+        if (!OpenTensorProtoFile(io_infos[i], tensor_files[i].data_file_path, all_pending_tensors[d][i], shapes[i])) {
+          return false;
+        }
         continue;
       }
 
-      const int32_t io_index_s32 = GetFileIndexSuffix(data_filename_wo_ext, data_file_prefix);
-      if (io_index_s32 < 0) {
-        std::cerr << "[ERROR]: The file " << data_file_path << " does not have a properly formatted name"
-                  << " (e.g., " << data_file_prefix << "0.raw)" << std::endl;
+      const size_t data_file_size = static_cast<size_t>(std::filesystem::file_size(tensor_files[i].data_file_path));
+
+      if (!ResolveTensorShape(io_infos[i], tensor_files[i], data_file_size, shapes[i])) {
         return false;
       }
 
-      const size_t io_index = static_cast<size_t>(io_index_s32);
-      if (io_index >= io_infos.size()) {
-        std::cerr << "[ERROR]: The input (or output) file index for file " << data_file_path
-                  << " exceeds the number of inputs (or outputs) in the model (" << io_infos.size() << ")" << std::endl;
+      const size_t expected_size = io_infos[i].GetDataSize(Span<const int64_t>(shapes[i]));
+      if (expected_size != data_file_size) {
+        std::cerr << "[ERROR]: The file " << tensor_files[i].data_file_path << " has " << data_file_size
+                  << " bytes, but " << expected_size << " bytes were expected for its shape" << std::endl;
         return false;
       }
+    }
 
-      size_t offset = 0;
-      for (size_t i = 0; i < io_index; i++) {
-        offset += io_infos[i].total_data_size;
+    auto [it, inserted] = shapes_to_group.try_emplace(shapes, io_data.shape_groups.size());
+    if (inserted) {
+      io_data.shape_groups.emplace_back();
+    }
+    io_data.shape_groups[it->second].push_back(d);
+
+    io_data.datasets[d].tensors.resize(num_tensors);
+    for (size_t i = 0; i < num_tensors; i++) {
+      io_data.datasets[d].tensors[i].shape = std::move(shapes[i]);
+    }
+  }
+
+  // Allocate one buffer per shape group and read every file directly into its place in the group buffer.
+  // Tensors whose .pb data is used in place don't need space in the group buffer.
+  io_data.group_buffers.reserve(io_data.shape_groups.size());
+
+  for (const std::vector<size_t>& group : io_data.shape_groups) {
+    size_t group_size = 0;
+    for (size_t d : group) {
+      for (size_t i = 0; i < num_tensors; i++) {
+        if (!all_pending_tensors[d][i].use_in_place) {
+          group_size += io_infos[i].GetDataSize(Span<const int64_t>(io_data.datasets[d].tensors[i].shape));
+        }
+      }
+    }
+
+    io_data.group_buffers.emplace_back(std::make_unique<char[]>(group_size));
+    char* group_buffer = io_data.group_buffers.back().get();
+
+    for (size_t offset = 0, i = 0; i < num_tensors; i++) {
+      for (size_t d : group) {
+        TensorData& tensor = io_data.datasets[d].tensors[i];
+        PendingTensor& pending_tensor = all_pending_tensors[d][i];
+        const std::filesystem::path& data_file_path = all_tensor_files[d][i].data_file_path;
+
+        if (pending_tensor.use_in_place) {
+          // Point into the (copy-on-write) mapping instead of the read-only view used for parsing.
+          Span<char> file_bytes = pending_tensor.mapped_file.Data();
+          const size_t data_offset = static_cast<size_t>(pending_tensor.tensor_proto.data.data() - file_bytes.data());
+          tensor.data = Span<char>(file_bytes.data() + data_offset, pending_tensor.tensor_proto.data.size());
+          io_data.mapped_files.push_back(std::move(pending_tensor.mapped_file));
+          continue;
+        }
+
+        const size_t tensor_size = io_infos[i].GetDataSize(Span<const int64_t>(tensor.shape));
+        assert(offset + tensor_size <= group_size);
+        tensor.data = Span<char>(group_buffer + offset, tensor_size);
+        offset += tensor_size;
+
+        if (all_tensor_files[d][i].is_tensor_proto) {
+          if (!CopyTensorProtoData(pending_tensor.tensor_proto, io_infos[i].elem_bit_width, tensor.data)) {
+            std::cerr << "[ERROR]: Unable to read tensor data from file " << data_file_path << std::endl;
+            return false;
+          }
+
+          pending_tensor.mapped_file = MappedFile();  // The data has been copied, so release the mapping.
+        } else if (!FillBytesFromBinaryFile(tensor.data, data_file_path.string())) {
+          std::cerr << "[ERROR]: Unable to read raw data from file " << data_file_path << std::endl;
+          return false;
+        }
       }
-      assert(offset < total_data_size);
+    }
+  }
+
+  return true;
+}
+
+// Determines the shape of every output from the model's output shapes and the actual input shapes of a dataset.
+// Returns false if an output has a symbolic dimension that can't be resolved before running the model.
+static bool ResolveOutputShapes(const ModelIOInfo& model_io_info, const DatasetIOData& input_data,
+                                std::vector<std::vector<int64_t>>& output_shapes) {
+  std::unordered_map<std::string, int64_t> dim_values;
 
-      Span<char> span_to_fill(dataset_data.back().get() + offset, io_infos[io_index].total_data_size);
-      if (!FillBytesFromBinaryFile(span_to_fill, data_file_path.string())) {
-        std::cerr << "[ERROR]: Unable to read raw data from file " << data_file_path << std::endl;
+  for (size_t i = 0; i < model_io_info.inputs.size(); i++) {
+    const IOInfo& input_info = model_io_info.inputs[i];
+    const std::vector<int64_t>& input_shape = input_data.tensors[i].shape;
+
+    for (size_t j = 0; j < input_info.dim_names.size() && j < input_shape.size(); j++) {
+      const std::string& dim_name = input_info.dim_names[j];
+      if (dim_name.empty()) {
+        continue;
+      }
+
+      auto [it, inserted] = dim_values.try_emplace(dim_name, input_shape[j]);
+      if (!inserted && it->second != input_shape[j]) {
+        return false;  // Inputs disagree on the value of a named dimension.
+      }
+    }
+  }
+
+  output_shapes.resize(model_io_info.outputs.size());
+  for (size_t i = 0; i < model_io_info.outputs.size(); i++) {
+    const IOInfo& output_info = model_io_info.outputs[i];
+    std::vector<int64_t>& output_shape = output_shapes[i];
+
+    output_shape = output_info.shape;
+    for (size_t j = 0; j < output_shape.size(); j++) {
+      if (output_shape[j] >= 0) {
+        continue;
+      }
+
+      auto it = j < output_info.dim_names.size() ? dim_values.find(output_info.dim_names[j]) : dim_values.end();
+      if (it == dim_values.end()) {
         return false;
       }
+      output_shape[j] = it->second;
+    }
+  }
 
-      num_files_loaded += 1;
+  return true;
+}
+
+void AllocateOutputData(const DatasetsIOData& all_inputs, const ModelIOInfo& model_io_info,
+                        DatasetsIOData& all_outputs) {
+  const std::vector<IOInfo>& output_infos = model_io_info.outputs;
+  const size_t num_outputs = output_infos.size();
+
+  all_outputs.datasets.clear();
+  all_outputs.datasets.resize(all_inputs.datasets.size());
+  all_outputs.shape_groups = all_inputs.shape_groups;
+  all_outputs.group_buffers.clear();
+  all_outputs.mapped_files.clear();
+
+  std::vector<std::vector<int64_t>> output_shapes;
+
+  for (const std::vector<size_t>& group : all_outputs.shape_groups) {
+    // All datasets in a group have the same input shapes, so they also have the same output shapes.
+    if (group.empty() || !ResolveOutputShapes(model_io_info, all_inputs.datasets[group[0]], output_shapes)) {
+      continue;
+    }
+
+    size_t group_size = 0;
+    for (size_t i = 0; i < num_outputs; i++) {
+      group_size += output_infos[i].GetDataSize(Span<const int64_t>(output_shapes[i])) * group.size();
     }
 
-    if (num_files_loaded != io_infos.size()) {
-      std::cerr << "[ERROR]: " << dataset_path << " does not have the expected number of " << data_file_prefix
-                << "<i>.raw files. Loaded " << num_files_loaded << " files, but expected " << io_infos.size()
-                << "files." << std::endl;
+    all_outputs.group_buffers.emplace_back(std::make_unique<char[]>(group_size));
+    char* group_buffer = all_outputs.group_buffers.back().get();
+
+    for (size_t d : group) {
+      all_outputs.datasets[d].tensors.resize(num_outputs);
+    }
+
+    for (size_t offset = 0, i = 0; i < num_outputs; i++) {
+      const size_t tensor_size = output_infos[i].GetDataSize(Span<const int64_t>(output_shapes[i]));
+
+      for (size_t d : group) {
+        TensorData& tensor = all_outputs.datasets[d].tensors[i];
+
+        assert(offset + tensor_size <= group_size);
+        tensor.shape = output_shapes[i];
+        tensor.data = Span<char>(group_buffer + offset, tensor_size);
+        offset += tensor_size;
+      }
+    }
+  }
+}
+
+// Returns true if the dataset directory stores its tensors as .pb files, in which case saved tensors are also written
+// as .pb files.
+static bool HasTensorProtoFiles(const std::filesystem::path& dataset_path) {
+  for (const auto& entry : std::filesystem::directory_iterator{dataset_path}) {
+    if (std::filesystem::is_regular_file(entry.path()) && entry.path().extension() == ".pb") {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Removes a file that would otherwise conflict with a newly saved tensor.
+static bool RemoveStaleFile(const std::filesystem::path& file_path) {
+  std::error_code error_code;
+  std::filesystem::remove(file_path, error_code);
+  if (error_code) {
+    std::cerr << "[ERROR]: Unable to remove file " << file_path << ": " << error_code.message() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// Loads the files that were just saved and checks that they contain the saved shapes and data.
+static bool CheckSavedIOData(const std::filesystem::path& dataset_path, const std::vector<IOInfo>& io_infos,
+                             const char* data_file_prefix, const DatasetIOData& dataset_data) {
+  DatasetsIOData loaded_data;
+  if (!LoadIODataFromDisk({dataset_path}, io_infos, data_file_prefix, loaded_data)) {
+    std::cerr << "[ERROR]: Unable to load the data saved to " << dataset_path << std::endl;
+    return false;
+  }
+
+  for (size_t i = 0; i < io_infos.size(); i++) {
+    const TensorData& saved = dataset_data.tensors[i];
+    const TensorData& loaded = loaded_data.datasets[0].tensors[i];
+
+    if (loaded.shape != saved.shape || loaded.data.size() != saved.data.size() ||
+        (!saved.data.empty() && std::memcmp(loaded.data.data(), saved.data.data(), saved.data.size()) != 0)) {
+      std::cerr << "[ERROR]: The data loaded from " << dataset_path << " for " << io_infos[i].name
+                << " does not match the saved data" << std::endl;
       return false;
     }
   }
 
   return true;
 }
+
+bool SaveIODataToDisk(const std::filesystem::path& dataset_path, const std::vector<IOInfo>& io_infos,
+                      const char* data_file_prefix, const DatasetIOData& dataset_data) {
+  assert(dataset_data.tensors.size() == io_infos.size());
+
+  // Only one data file is allowed per tensor, so the files are written in the format of the dataset's existing files,
+  // and any file of the other format is removed.
+  const bool use_tensor_proto = HasTensorProtoFiles(dataset_path);
+  std::string tensor_proto_bytes;
+
+  for (size_t i = 0; i < io_infos.size(); i++) {
+    const TensorData& tensor = dataset_data.tensors[i];
+    const std::string filename_wo_ext = data_file_prefix + std::to_string(i);
+    const char* data_file_ext = use_tensor_proto ? ".pb" : ".raw";
+    const char* stale_file_ext = use_tensor_proto ? ".raw" : ".pb";
+    const std::filesystem::path data_file_path = dataset_path / (filename_wo_ext + data_file_ext);
+    const std::filesystem::path stale_file_path = dataset_path / (filename_wo_ext + stale_file_ext);
+    const std::filesystem::path shape_file_path = dataset_path / (filename_wo_ext + ".shape");
+
+    if (!RemoveStaleFile(stale_file_path)) {
+      return false;
+    }
+
+    std::ofstream data_ofs(data_file_path, std::ios::binary);
+    if (use_tensor_proto) {
+      SerializeTensorProto(static_cast<int32_t>(io_infos[i].data_type), Span<const int64_t>(tensor.shape),
+                           Span<const char>(tensor.data), tensor_proto_bytes);
+      data_ofs.write(tensor_proto_bytes.data(), tensor_proto_bytes.size());
+    } else {
+      data_ofs.write(tensor.data.data(), tensor.data.size());
+    }
+
+    if (!data_ofs) {
+      std::cerr << "[ERROR]: Unable to write data to file " << data_file_path << std::endl;
+      return false;
+    }
+
+    // A .pb file stores the shape, so a .shape file is only written for raw files of tensors with dynamic shapes.
+    if (use_tensor_proto || !io_infos[i].IsDynamic()) {
+      if (!RemoveStaleFile(shape_file_path)) {
+        return false;
+      }
+      continue;
+    }
+
+    std::ofstream shape_ofs(shape_file_path);
+    for (size_t j = 0; j < tensor.shape.size(); j++) {
+      shape_ofs << (j > 0 ? " " : "") << tensor.shape[j];
+    }
+    shape_ofs << std::endl;
+
+    if (!shape_ofs) {
+      std::cerr << "[ERROR]: Unable to write shape to file " << shape_file_path << std::endl;
+      return false;
+    }
+  }
+
+  return CheckSavedIOData(dataset_path, io_infos, data_file_prefix, dataset_data);
+}
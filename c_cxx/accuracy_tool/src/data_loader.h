@@ -6,16 +6,93 @@
 #include <vector>
 
 #include "basic_utils.h"
+#include "mapped_file.h"
 #include "model_io_utils.h"
 
 /// <summary>
-/// Load raw input or output data for a given set of dataset paths. For example, this can be used to load all
-/// input_XXX.raw files for a particular model.
+/// The actual shape and raw data of a single input or output tensor for one dataset.
 /// </summary>
-/// <param name="dataset_paths">The directories containing raw data files</param>
+struct TensorData {
+  std::vector<int64_t> shape;
+  Span<char> data;
+};
+
+/// <summary>
+/// The input (or output) tensors of a single dataset.
+/// </summary>
+struct DatasetIOData {
+  std::vector<TensorData> tensors;
+
+  // Only set if the tensor data is not stored in a buffer shared with other datasets (e.g., outputs produced
+  // by a model with dynamic output shapes).
+  std::unique_ptr<char[]> owned_buffer;
+};
+
+/// <summary>
+/// The input (or output) tensors for all datasets of a model.
+///
+/// Datasets whose tensors have identical shapes are placed in the same shape group, which shares a single
+/// allocation. Within a group buffer, the data for each input (or output) index is stored contiguously for all
+/// datasets in the group (i.e., input 0 of every dataset, then input 1 of every dataset, ...).
+/// </summary>
+struct DatasetsIOData {
+  bool empty() const { return datasets.empty(); }
+
+  std::vector<DatasetIOData> datasets;
+  std::vector<std::vector<size_t>> shape_groups;  // Indices into `datasets`, one vector per group.
+  std::vector<std::unique_ptr<char[]>> group_buffers;
+  std::vector<MappedFile> mapped_files;  // Memory-mapped .pb files whose data is used in place.
+};
+
+/// <summary>
+/// Load input or output data for a given set of dataset paths. For example, this can be used to load all
+/// input_XXX.raw (or input_XXX.pb) files for a particular model.
+///
+/// Each tensor is read from either a headerless .raw file or a serialized onnx.TensorProto .pb file (as used by the
+/// ONNX test data layout). A .pb file is memory-mapped, and its data is used in place when it is stored in the
+/// tensor's memory layout and suitably aligned. The element type and shape of a .pb tensor are validated against
+/// the model.
+///
+/// The shape of each tensor in a .raw file is determined as follows:
+///   1. From a `<prefix><index>.shape` sidecar file, if one exists. The file contains the dimensions
+///      separated by spaces or commas (e.g., "1 128 768").
+///   2. From the model, if the model's shape is static.
+///   3. By inferring the single symbolic dimension from the size of the raw file.
+/// </summary>
+/// <param name="dataset_paths">The directories containing the data files</param>
 /// <param name="io_infos">Type and shape information for the inputs or outputs of a model</param>
 /// <param name="data_file_prefix">The prefix for the data file names (e.g., "input_" or "output_")</param>
-/// <param name="dataset_data">Output buffer into which to store loaded data</param>
+/// <param name="io_data">Output into which to store the loaded data</param>
 /// <returns>True on success</returns>
 bool LoadIODataFromDisk(const std::vector<std::filesystem::path>& dataset_paths, const std::vector<IOInfo>& io_infos,
-                        const char* data_file_prefix, std::vector<std::unique_ptr<char[]>>& dataset_data);
+                        const char* data_file_prefix, DatasetsIOData& io_data);
+
+/// <summary>
+/// Allocates the output buffers for all datasets before the model is run, so that the model can write its outputs
+/// directly into them. Outputs are allocated for every shape group whose output shapes are known from the model and
+/// the group's input shapes (i.e., every symbolic output dimension has the same name as an input dimension).
+/// Datasets in the remaining groups are left without output tensors; their outputs are allocated after the model
+/// is run.
+///
+/// Within a group buffer, the data for each output index is stored contiguously for all datasets in the group,
+/// which matches the layout of the input group buffers.
+/// </summary>
+/// <param name="all_inputs">The loaded input data for all datasets</param>
+/// <param name="model_io_info">Information about the model's input and output tensors</param>
+/// <param name="all_outputs">Output into which to allocate the output data</param>
+void AllocateOutputData(const DatasetsIOData& all_inputs, const ModelIOInfo& model_io_info,
+                        DatasetsIOData& all_outputs);
+
+/// <summary>
+/// Saves the input or output data of a single dataset as raw files (e.g., output_0.raw, output_1.raw, ...), or as
+/// onnx.TensorProto files (e.g., output_0.pb) if the dataset directory already contains .pb files. A .shape sidecar
+/// file is also written for every raw file whose tensor shape is not static in the model. Files of the other format
+/// that would conflict with the saved files are removed, and the saved files are loaded again to check them.
+/// </summary>
+/// <param name="dataset_path">The directory into which to write the files</param>
+/// <param name="io_infos">Type and shape information for the inputs or outputs of a model</param>
+/// <param name="data_file_prefix">The prefix for the data file names (e.g., "input_" or "output_")</param>
+/// <param name="dataset_data">The data to save</param>
+/// <returns>True on success</returns>
+bool SaveIODataToDisk(const std::filesystem::path& dataset_path, const std::vector<IOInfo>& io_infos,
+                      const char* data_file_prefix, const DatasetIOData& dataset_data);
@@ -0,0 +1,237 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include "data_type_utils.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#define ACC_TOOL_USE_X86_SIMD
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ACC_TOOL_USE_NEON
+#endif
+
+#if defined(ACC_TOOL_USE_X86_SIMD)
+// Defined in data_type_utils_avx2.cc, which is compiled with AVX2 and F16C enabled.
+size_t DecodeFloat16Avx2(const uint16_t* src, float* dst, size_t count);
+size_t DecodeBFloat16Avx2(const uint16_t* src, float* dst, size_t count);
+
+// Returns true if the CPU supports AVX2 and F16C and the OS saves the YMM registers on context switches.
+static bool DetectAvx2F16c() {
+  std::array<uint32_t, 4> leaf1{};  // eax, ebx, ecx, edx
+  std::array<uint32_t, 4> leaf7{};
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuid(regs, 0);
+  const bool has_leaf7 = regs[0] >= 7;
+  __cpuid(regs, 1);
+  std::memcpy(leaf1.data(), regs, sizeof(regs));
+  if (has_leaf7) {
+    __cpuidex(regs, 7, 0);
+    std::memcpy(leaf7.data(), regs, sizeof(regs));
+  }
+#else
+  const bool has_leaf7 = __get_cpuid_max(0, nullptr) >= 7;
+  __cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+  if (has_leaf7) {
+    __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+  }
+#endif
+
+  const bool has_f16c = (leaf1[2] & (1u << 29)) != 0;
+  const bool has_osxsave = (leaf1[2] & (1u << 27)) != 0;
+  const bool has_avx2 = (leaf7[1] & (1u << 5)) != 0;
+  if (!has_f16c || !has_osxsave || !has_avx2) {
+    return false;
+  }
+
+  // XCR0 tells which register states the OS saves. AVX2 needs the XMM and YMM state.
+#if defined(_MSC_VER)
+  const uint64_t xcr0 = _xgetbv(0);
+#else
+  uint32_t eax = 0;
+  uint32_t edx = 0;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  const uint64_t xcr0 = (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+  return (xcr0 & 0x6) == 0x6;
+}
+
+static bool HasAvx2F16c() {
+  static const bool has_avx2_f16c = DetectAvx2F16c();
+  return has_avx2_f16c;
+}
+#endif
+
+static float BitsToFloat(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static float Float16ToFloat(uint16_t h) {
+  const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+  const uint32_t exponent = (h >> 10) & 0x1F;
+  uint32_t mantissa = h & 0x3FF;
+
+  if (exponent == 0x1F) {
+    return BitsToFloat(sign | 0x7F800000 | (mantissa << 13));  // Infinity or NaN
+  }
+
+  if (exponent != 0) {
+    return BitsToFloat(sign | ((exponent + (127 - 15)) << 23) | (mantissa << 13));  // Normal value
+  }
+
+  if (mantissa == 0) {
+    return BitsToFloat(sign);  // Signed zero
+  }
+
+  // Subnormal float16 values are normal float values. Normalize the mantissa.
+  uint32_t float_exponent = 127 - 15 + 1;
+  while ((mantissa & 0x400) == 0) {
+    mantissa <<= 1;
+    float_exponent--;
+  }
+
+  return BitsToFloat(sign | (float_exponent << 23) | ((mantissa & 0x3FF) << 13));
+}
+
+void DecodeFloat16(const uint16_t* src, float* dst, size_t count) {
+  size_t i = 0;
+
+#if defined(ACC_TOOL_USE_X86_SIMD)
+  if (HasAvx2F16c()) {
+    i = DecodeFloat16Avx2(src, dst, count);
+  }
+#elif defined(ACC_TOOL_USE_NEON)
+  for (; i + 4 <= count; i += 4) {
+    float16x4_t h = vreinterpret_f16_u16(vld1_u16(src + i));
+    vst1q_f32(dst + i, vcvt_f32_f16(h));
+  }
+#endif
+
+  for (; i < count; i++) {
+    dst[i] = Float16ToFloat(src[i]);
+  }
+}
+
+void DecodeBFloat16(const uint16_t* src, float* dst, size_t count) {
+  size_t i = 0;
+
+#if defined(ACC_TOOL_USE_X86_SIMD)
+  if (HasAvx2F16c()) {
+    i = DecodeBFloat16Avx2(src, dst, count);
+  } else {
+    // Interleaving zeros below each 16-bit value produces the float bit patterns directly (SSE2 is baseline on x64).
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+      __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      _mm_storeu_ps(dst + i, _mm_castsi128_ps(_mm_unpacklo_epi16(zero, h)));
+      _mm_storeu_ps(dst + i + 4, _mm_castsi128_ps(_mm_unpackhi_epi16(zero, h)));
+    }
+  }
+#elif defined(ACC_TOOL_USE_NEON)
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t w = vshll_n_u16(vld1_u16(src + i), 16);
+    vst1q_f32(dst + i, vreinterpretq_f32_u32(w));
+  }
+#endif
+
+  for (; i < count; i++) {
+    dst[i] = BitsToFloat(static_cast<uint32_t>(src[i]) << 16);
+  }
+}
+
+using Float8Table = std::array<float, 256>;
+
+static Float8Table MakeFloat8Table(Float8Format format) {
+  const bool is_e4m3 = format == Float8Format::E4M3FN || format == Float8Format::E4M3FNUZ;
+  const bool is_fnuz = format == Float8Format::E4M3FNUZ || format == Float8Format::E5M2FNUZ;
+  const int mantissa_bits = is_e4m3 ? 3 : 2;
+  const uint32_t exponent_mask = is_e4m3 ? 0xF : 0x1F;
+  const int bias = (is_e4m3 ? 7 : 15) + (is_fnuz ? 1 : 0);
+  const uint32_t mantissa_mask = (1u << mantissa_bits) - 1;
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+
+  Float8Table table = {};
+  for (uint32_t bits = 0; bits < 256; bits++) {
+    const bool negative = (bits & 0x80) != 0;
+    const uint32_t exponent = (bits >> mantissa_bits) & exponent_mask;
+    const uint32_t mantissa = bits & mantissa_mask;
+    float value = 0.0f;
+
+    if (is_fnuz && bits == 0x80) {
+      table[bits] = nan;  // FNUZ formats use "negative zero" as the only NaN.
+      continue;
+    }
+
+    if (format == Float8Format::E4M3FN && exponent == exponent_mask && mantissa == mantissa_mask) {
+      table[bits] = nan;
+      continue;
+    }
+
+    if (format == Float8Format::E5M2 && exponent == exponent_mask) {
+      table[bits] = mantissa == 0 ? (negative ? -std::numeric_limits<float>::infinity()
+                                              : std::numeric_limits<float>::infinity())
+                                  : nan;
+      continue;
+    }
+
+    if (exponent == 0) {
+      value = std::ldexp(static_cast<float>(mantissa), 1 - bias - mantissa_bits);  // Subnormal
+    } else {
+      value = std::ldexp(static_cast<float>(mantissa | (1u << mantissa_bits)),
+                         static_cast<int>(exponent) - bias - mantissa_bits);
+    }
+
+    table[bits] = negative ? -value : value;
+  }
+
+  return table;
+}
+
+void DecodeFloat8(Float8Format format, const uint8_t* src, float* dst, size_t count) {
+  static const std::array<Float8Table, 4> tables = {
+      MakeFloat8Table(Float8Format::E4M3FN),
+      MakeFloat8Table(Float8Format::E4M3FNUZ),
+      MakeFloat8Table(Float8Format::E5M2),
+      MakeFloat8Table(Float8Format::E5M2FNUZ),
+  };
+  const Float8Table& table = tables[static_cast<size_t>(format)];
+
+  for (size_t i = 0; i < count; i++) {
+    dst[i] = table[src[i]];
+  }
+}
+
+void DecodeInt4(const uint8_t* packed, bool is_signed, size_t first_elem, float* dst, size_t count) {
+  // Signed nibbles are sign-extended with (v ^ 8) - 8.
+  const int32_t sign_flip = is_signed ? 8 : 0;
+  size_t elem = first_elem;
+  size_t i = 0;
+
+  // Align to a byte boundary so that the main loop can unpack both nibbles of each byte.
+  if ((elem & 1) != 0 && i < count) {
+    dst[i++] = static_cast<float>(((packed[elem >> 1] >> 4) ^ sign_flip) - sign_flip);
+    elem++;
+  }
+
+  for (; i + 2 <= count; i += 2, elem += 2) {
+    const int32_t byte = packed[elem >> 1];
+    dst[i] = static_cast<float>(((byte & 0xF) ^ sign_flip) - sign_flip);
+    dst[i + 1] = static_cast<float>(((byte >> 4) ^ sign_flip) - sign_flip);
+  }
+
+  if (i < count) {
+    dst[i] = static_cast<float>(((packed[elem >> 1] & 0xF) ^ sign_flip) - sign_flip);
+  }
+}
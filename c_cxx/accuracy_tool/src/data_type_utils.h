@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// The 8-bit floating-point formats defined by ONNX.
+/// </summary>
+enum class Float8Format {
+  E4M3FN,    // 4 exponent bits, 3 mantissa bits, no infinities, NaN is S.1111.111
+  E4M3FNUZ,  // Like E4M3FN, but with a bias of 8 and a single NaN (0x80) and no negative zero
+  E5M2,      // 5 exponent bits, 2 mantissa bits, IEEE-754 semantics (infinities and NaNs)
+  E5M2FNUZ,  // Like E5M2, but with a bias of 16 and a single NaN (0x80) and no infinities or negative zero
+};
+
+/// <summary>
+/// Decodes IEEE-754 half-precision values to float. Uses the F16C conversion instructions on x64 CPUs that support
+/// AVX2 and F16C (detected at runtime), or the NEON conversion instructions on ARM64.
+/// </summary>
+/// <param name="src">The raw float16 bit patterns</param>
+/// <param name="dst">Output buffer with room for `count` floats</param>
+/// <param name="count">The number of elements to decode</param>
+void DecodeFloat16(const uint16_t* src, float* dst, size_t count);
+
+/// <summary>
+/// Decodes bfloat16 values to float. A bfloat16 value is the upper 16 bits of a float, so decoding is a
+/// zero-extending shift, which is done with SSE2 or AVX2 (detected at runtime) on x64, or NEON on ARM64.
+/// </summary>
+/// <param name="src">The raw bfloat16 bit patterns</param>
+/// <param name="dst">Output buffer with room for `count` floats</param>
+/// <param name="count">The number of elements to decode</param>
+void DecodeBFloat16(const uint16_t* src, float* dst, size_t count);
+
+/// <summary>
+/// Decodes 8-bit floating-point values to float using a 256-entry lookup table.
+/// </summary>
+/// <param name="format">The 8-bit floating-point format of the source data</param>
+/// <param name="src">The raw float8 bit patterns</param>
+/// <param name="dst">Output buffer with room for `count` floats</param>
+/// <param name="count">The number of elements to decode</param>
+void DecodeFloat8(Float8Format format, const uint8_t* src, float* dst, size_t count);
+
+/// <summary>
+/// Unpacks 4-bit integers to float. ONNX packs two 4-bit elements per byte, with the element at the even index
+/// stored in the low nibble.
+/// </summary>
+/// <param name="packed">The packed 4-bit data for the entire tensor</param>
+/// <param name="is_signed">True for INT4 (two's complement), false for UINT4</param>
+/// <param name="first_elem">The index of the first element to unpack (may be odd)</param>
+/// <param name="dst">Output buffer with room for `count` floats</param>
+/// <param name="count">The number of elements to unpack</param>
+void DecodeInt4(const uint8_t* packed, bool is_signed, size_t first_elem, float* dst, size_t count);
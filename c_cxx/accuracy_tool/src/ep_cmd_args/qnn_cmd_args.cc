@@ -6,6 +6,7 @@
 #include <onnxruntime_session_options_config_keys.h>
 
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <unordered_set>
 
@@ -116,8 +117,11 @@ bool ParseQnnEpArgs(AppArgs& app_args, CmdArgParser& cmd_args) {
   }
 
   app_args.session_options.AppendExecutionProvider("QNN", qnn_options);
+  app_args.ep_options = std::map<std::string, std::string>(qnn_options.begin(), qnn_options.end());
   app_args.uses_qdq_model = backend_iter->second.rfind("QnnHtp") != std::string::npos;
   app_args.supports_multithread_inference = false;  // TODO: Work on enabling multi-threaded inference.
+  app_args.compiles_model = true;
+  app_args.supports_ep_context = true;
   app_args.execution_provider = "qnn";
   return true;
 }
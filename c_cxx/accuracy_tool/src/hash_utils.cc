@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include "hash_utils.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "mapped_file.h"
+#include "tensor_proto_reader.h"
+
+// Constants from the XXH64 specification.
+constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+constexpr size_t XXH_STRIPE_SIZE = 32;
+
+static inline uint64_t RotateLeft(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+// Assumes a little-endian host (as does the rest of the tool).
+static inline uint64_t Read64(const char* ptr) {
+  uint64_t value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+static inline uint32_t Read32(const char* ptr) {
+  uint32_t value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+static inline uint64_t Round(uint64_t acc, uint64_t input) {
+  acc += input * XXH_PRIME64_2;
+  acc = RotateLeft(acc, 31);
+  return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t MergeRound(uint64_t acc, uint64_t value) {
+  acc ^= Round(0, value);
+  return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static inline void ConsumeStripe(std::array<uint64_t, 4>& acc, const char* stripe) {
+  acc[0] = Round(acc[0], Read64(stripe));
+  acc[1] = Round(acc[1], Read64(stripe + 8));
+  acc[2] = Round(acc[2], Read64(stripe + 16));
+  acc[3] = Round(acc[3], Read64(stripe + 24));
+}
+
+Hasher::Hasher(uint64_t seed)
+    : acc_{seed + XXH_PRIME64_1 + XXH_PRIME64_2, seed + XXH_PRIME64_2, seed, seed - XXH_PRIME64_1}, seed_(seed) {}
+
+void Hasher::Update(Span<const char> bytes) {
+  const char* ptr = bytes.data();
+  size_t size = bytes.size();
+
+  total_size_ += size;
+
+  // Complete a partially filled stripe from a previous call.
+  if (buffer_size_ > 0) {
+    const size_t num_copied = std::min(size, XXH_STRIPE_SIZE - buffer_size_);
+    std::memcpy(buffer_.data() + buffer_size_, ptr, num_copied);
+    buffer_size_ += num_copied;
+    ptr += num_copied;
+    size -= num_copied;
+
+    if (buffer_size_ < XXH_STRIPE_SIZE) {
+      return;
+    }
+
+    ConsumeStripe(acc_, buffer_.data());
+    buffer_size_ = 0;
+  }
+
+  for (; size >= XXH_STRIPE_SIZE; ptr += XXH_STRIPE_SIZE, size -= XXH_STRIPE_SIZE) {
+    ConsumeStripe(acc_, ptr);
+  }
+
+  if (size > 0) {
+    std::memcpy(buffer_.data(), ptr, size);
+    buffer_size_ = size;
+  }
+}
+
+void Hasher::Update(std::string_view str) { Update(Span<const char>(str.data(), str.size())); }
+
+uint64_t Hasher::Digest() const {
+  uint64_t hash = 0;
+
+  if (total_size_ >= XXH_STRIPE_SIZE) {
+    hash = RotateLeft(acc_[0], 1) + RotateLeft(acc_[1], 7) + RotateLeft(acc_[2], 12) + RotateLeft(acc_[3], 18);
+    hash = MergeRound(hash, acc_[0]);
+    hash = MergeRound(hash, acc_[1]);
+    hash = MergeRound(hash, acc_[2]);
+    hash = MergeRound(hash, acc_[3]);
+  } else {
+    hash = seed_ + XXH_PRIME64_5;
+  }
+
+  hash += total_size_;
+
+  const char* ptr = buffer_.data();
+  size_t size = buffer_size_;
+
+  for (; size >= 8; ptr += 8, size -= 8) {
+    hash ^= Round(0, Read64(ptr));
+    hash = RotateLeft(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+  }
+
+  if (size >= 4) {
+    hash ^= static_cast<uint64_t>(Read32(ptr)) * XXH_PRIME64_1;
+    hash = RotateLeft(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+    ptr += 4;
+    size -= 4;
+  }
+
+  for (; size > 0; ptr++, size--) {
+    hash ^= static_cast<uint64_t>(static_cast<uint8_t>(*ptr)) * XXH_PRIME64_5;
+    hash = RotateLeft(hash, 11) * XXH_PRIME64_1;
+  }
+
+  // Final avalanche.
+  hash ^= hash >> 33;
+  hash *= XXH_PRIME64_2;
+  hash ^= hash >> 29;
+  hash *= XXH_PRIME64_3;
+  hash ^= hash >> 32;
+
+  return hash;
+}
+
+bool HashFileContents(const std::filesystem::path& filepath, Hasher& hasher) {
+  MappedFile mapped_file;
+
+  if (!MappedFile::Open(filepath, mapped_file)) {
+    std::cerr << "[ERROR]: Unable to read file " << filepath << " for hashing" << std::endl;
+    return false;
+  }
+
+  hasher.Update(Span<const char>(mapped_file.Data()));
+  return true;
+}
+
+std::string HashToHexString(uint64_t hash) {
+  constexpr char hex_digits[] = "0123456789abcdef";
+  std::string str(16, '0');
+
+  for (size_t i = 0; i < 16; i++) {
+    str[15 - i] = hex_digits[hash & 0xF];
+    hash >>= 4;
+  }
+
+  return str;
+}
+
+bool HashModelFiles(const std::filesystem::path& model_path, Hasher& hasher) {
+  MappedFile model_file;
+  if (!MappedFile::Open(model_path, model_file)) {
+    std::cerr << "[ERROR]: Unable to read model " << model_path << " for hashing" << std::endl;
+    return false;
+  }
+
+  const Span<const char> model_bytes(model_file.Data());
+  hasher.UpdateValue(static_cast<uint64_t>(model_bytes.size()));
+  hasher.Update(model_bytes);
+
+  std::vector<std::string> locations;
+  if (!GetExternalDataLocations(model_bytes, locations)) {
+    std::cerr << "[ERROR]: Unable to find the external data files of model " << model_path << std::endl;
+    return false;
+  }
+
+  hasher.UpdateValue(static_cast<uint64_t>(locations.size()));
+  for (const std::string& location : locations) {
+    const std::filesystem::path data_file_path = model_path.parent_path() / std::filesystem::u8path(location);
+    std::error_code error_code;
+    const uintmax_t data_file_size = std::filesystem::file_size(data_file_path, error_code);
+    if (error_code) {
+      std::cerr << "[ERROR]: Unable to find external data file " << data_file_path << " of model " << model_path
+                << std::endl;
+      return false;
+    }
+
+    hasher.UpdateValue(static_cast<uint64_t>(location.size()));
+    hasher.Update(location);
+    hasher.UpdateValue(static_cast<uint64_t>(data_file_size));
+
+    if (!HashFileContents(data_file_path, hasher)) {
+      return false;
+    }
+  }
+
+  return true;
+}
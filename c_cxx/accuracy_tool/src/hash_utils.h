@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "basic_utils.h"
+
+/// <summary>
+/// Computes a 64-bit XXH64 hash of a stream of bytes. The bytes may be provided in one or more calls to Update().
+/// Used to build content-based cache keys (not suitable for cryptographic purposes).
+/// </summary>
+class Hasher {
+ public:
+  explicit Hasher(uint64_t seed = 0);
+
+  void Update(Span<const char> bytes);
+  void Update(std::string_view str);
+
+  template <typename T>
+  void UpdateValue(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Hasher::UpdateValue() requires a trivially copyable type");
+    Update(Span<const char>(reinterpret_cast<const char*>(&value), sizeof(T)));
+  }
+
+  /// <summary>
+  /// Returns the hash of all bytes provided so far. Does not modify the hasher's state.
+  /// </summary>
+  uint64_t Digest() const;
+
+ private:
+  std::array<uint64_t, 4> acc_;
+  std::array<char, 32> buffer_ = {};
+  size_t buffer_size_ = 0;
+  uint64_t total_size_ = 0;
+  uint64_t seed_;
+};
+
+/// <summary>
+/// Hashes the contents of a file (memory-mapped) into the given hasher.
+/// </summary>
+/// <param name="filepath">The file to hash</param>
+/// <param name="hasher">The hasher to update</param>
+/// <returns>True on success</returns>
+bool HashFileContents(const std::filesystem::path& filepath, Hasher& hasher);
+
+/// <summary>
+/// Formats a 64-bit hash as a fixed-width, lowercase hexadecimal string.
+/// </summary>
+std::string HashToHexString(uint64_t hash);
+
+/// <summary>
+/// Hashes the name, size, and contents of every file in a directory whose name satisfies a filter, in sorted order.
+/// </summary>
+/// <param name="dir">The directory containing the files</param>
+/// <param name="filter">Function that returns true for the file names to hash</param>
+/// <param name="hasher">The hasher to update</param>
+/// <returns>True on success</returns>
+template <typename FilterFunc>
+bool HashMatchingFiles(const std::filesystem::path& dir, FilterFunc filter, Hasher& hasher) {
+  std::vector<std::filesystem::path> file_paths;
+
+  for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{dir}) {
+    if (entry.is_regular_file() && filter(entry.path().filename().string())) {
+      file_paths.push_back(entry.path());
+    }
+  }
+
+  std::sort(file_paths.begin(), file_paths.end());
+
+  hasher.UpdateValue(static_cast<uint64_t>(file_paths.size()));
+  for (const std::filesystem::path& file_path : file_paths) {
+    const std::string filename = file_path.filename().string();
+
+    hasher.UpdateValue(static_cast<uint64_t>(filename.size()));
+    hasher.Update(filename);
+    hasher.UpdateValue(static_cast<uint64_t>(std::filesystem::file_size(file_path)));
+
+    if (!HashFileContents(file_path, hasher)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/// <summary>
+/// Hashes a model file and its external data files, i.e., the files named by the "location" of the model's tensors
+/// with external data, relative to the model's directory.
+/// </summary>
+/// <param name="model_path">The model file</param>
+/// <param name="hasher">The hasher to update</param>
+/// <returns>True on success</returns>
+bool HashModelFiles(const std::filesystem::path& model_path, Hasher& hasher);
@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include "mapped_file.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Close();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+#else
+    munmap(data_, size_);
+#endif
+  }
+
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::filesystem::path& filepath, MappedFile& mapped_file) {
+  mapped_file.Close();
+
+  HANDLE file_handle = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    std::cerr << "[ERROR]: Unable to open file " << filepath << std::endl;
+    return false;
+  }
+
+  LARGE_INTEGER file_size = {};
+  if (!GetFileSizeEx(file_handle, &file_size)) {
+    std::cerr << "[ERROR]: Unable to get the size of file " << filepath << std::endl;
+    CloseHandle(file_handle);
+    return false;
+  }
+
+  if (file_size.QuadPart == 0) {
+    CloseHandle(file_handle);
+    return true;  // Empty files can't be mapped, but are valid.
+  }
+
+  // The view keeps the mapping (and file) alive, so the handles can be closed right away.
+  HANDLE mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file_handle);
+
+  if (mapping_handle == nullptr) {
+    std::cerr << "[ERROR]: Unable to create a file mapping for " << filepath << std::endl;
+    return false;
+  }
+
+  void* data = MapViewOfFile(mapping_handle, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(mapping_handle);
+
+  if (data == nullptr) {
+    std::cerr << "[ERROR]: Unable to map file " << filepath << std::endl;
+    return false;
+  }
+
+  mapped_file.data_ = static_cast<char*>(data);
+  mapped_file.size_ = static_cast<size_t>(file_size.QuadPart);
+  return true;
+}
+#else
+bool MappedFile::Open(const std::filesystem::path& filepath, MappedFile& mapped_file) {
+  mapped_file.Close();
+
+  int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "[ERROR]: Unable to open file " << filepath << std::endl;
+    return false;
+  }
+
+  struct stat file_stat = {};
+  if (fstat(fd, &file_stat) != 0) {
+    std::cerr << "[ERROR]: Unable to get the size of file " << filepath << std::endl;
+    close(fd);
+    return false;
+  }
+
+  if (file_stat.st_size == 0) {
+    close(fd);
+    return true;  // Empty files can't be mapped, but are valid.
+  }
+
+  // The mapping keeps the file alive, so the descriptor can be closed right away.
+  const size_t size = static_cast<size_t>(file_stat.st_size);
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    std::cerr << "[ERROR]: Unable to map file " << filepath << std::endl;
+    return false;
+  }
+
+  mapped_file.data_ = static_cast<char*>(data);
+  mapped_file.size_ = size;
+  return true;
+}
+#endif
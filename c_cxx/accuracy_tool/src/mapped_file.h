@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <filesystem>
+
+#include "basic_utils.h"
+
+/// <summary>
+/// A file mapped into memory with copy-on-write semantics. The mapped bytes are writable, but writes are private to
+/// the process and are never written back to the file.
+/// </summary>
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  ~MappedFile();
+
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  /// <summary>
+  /// Maps an entire file into memory.
+  /// </summary>
+  /// <param name="filepath">The file to map</param>
+  /// <param name="mapped_file">Set to the mapped file on success</param>
+  /// <returns>True on success</returns>
+  static bool Open(const std::filesystem::path& filepath, MappedFile& mapped_file);
+
+  Span<char> Data() const { return Span<char>(data_, size_); }
+
+ private:
+  void Close();
+
+  char* data_ = nullptr;
+  size_t size_ = 0;
+};
@@ -2,43 +2,64 @@
 // Licensed under the MIT License.
 #include "model_io_utils.h"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <iostream>
 
-bool GetTensorElemDataSize(ONNXTensorElementDataType data_type, size_t& size) {
+#include "data_type_utils.h"
+
+bool GetTensorElemBitWidth(ONNXTensorElementDataType data_type, size_t& bit_width) {
   switch (data_type) {
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
-      size = sizeof(float);
+      bit_width = sizeof(float) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
-      size = sizeof(uint8_t);
+      bit_width = sizeof(uint8_t) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
-      size = sizeof(int8_t);
+      bit_width = sizeof(int8_t) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
-      size = sizeof(uint16_t);
+      bit_width = sizeof(uint16_t) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
-      size = sizeof(int16_t);
+      bit_width = sizeof(int16_t) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
-      size = sizeof(int32_t);
+      bit_width = sizeof(int32_t) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
-      size = sizeof(int64_t);
+      bit_width = sizeof(int64_t) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
-      size = sizeof(bool);
+      bit_width = sizeof(bool) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
-      size = sizeof(double);
+      bit_width = sizeof(double) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32:
-      size = sizeof(uint32_t);
+      bit_width = sizeof(uint32_t) * 8;
       break;
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT64:
-      size = sizeof(uint64_t);
+      bit_width = sizeof(uint64_t) * 8;
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_BFLOAT16:
+      bit_width = 16;
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT8E4M3FN:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT8E4M3FNUZ:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT8E5M2:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT8E5M2FNUZ:
+      bit_width = 8;
       break;
+#if ORT_API_VERSION >= 20
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT4:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT4:
+      bit_width = 4;
+      break;
+#endif
     default:
       std::cerr << "[ERROR]: Unsupported tensor element data type: " << data_type << std::endl;
       return false;
@@ -47,101 +68,294 @@ bool GetTensorElemDataSize(ONNXTensorElementDataType data_type, size_t& size) {
   return true;
 }
 
-AccMetrics ComputeAccuracyMetric(Ort::ConstValue ort_output, Span<const char> raw_expected_output,
-                                 const IOInfo& output_info) {
-  AccMetrics metrics = {};
+size_t GetTensorDataSize(size_t bit_width, size_t num_elems) {
+  // Sub-byte elements are packed, with the last byte padded if necessary.
+  return (num_elems * bit_width + 7) / 8;
+}
+
+// Number of elements decoded to float at a time. Both decode buffers stay resident in the L1 cache.
+constexpr size_t DECODE_BLOCK_SIZE = 512;
+
+/// <summary>
+/// Computes accuracy metrics for an element type that the metric kernels do not handle directly. Elements are
+/// decoded to float one small block at a time, so no full-size converted copies of the outputs are made.
+/// </summary>
+/// <param name="num_elems">The number of elements in the output</param>
+/// <param name="decode">Function that decodes `count` expected and actual elements, starting at a given index</param>
+/// <param name="metrics">The accuracy metrics to set</param>
+/// <param name="top_k">The number of largest elements to compare for the top-k metrics (0 disables)</param>
+template <typename DecodeFunc>
+static void GetDecodedAccuracy(size_t num_elems, DecodeFunc decode, AccMetrics& metrics, size_t top_k) {
+  std::array<float, DECODE_BLOCK_SIZE> expected_block;
+  std::array<float, DECODE_BLOCK_SIZE> actual_block;
+  AccMetricsAccumulator accumulator(top_k);
+
+  for (size_t offset = 0; offset < num_elems; offset += DECODE_BLOCK_SIZE) {
+    const size_t count = std::min(DECODE_BLOCK_SIZE, num_elems - offset);
+    decode(offset, count, expected_block.data(), actual_block.data());
+    accumulator.Update(expected_block.data(), actual_block.data(), count);
+  }
+
+  accumulator.Finalize(metrics);
+}
+
+static void GetFloat8Accuracy(Float8Format format, Span<const char> raw_expected_output,
+                              Span<const char> raw_actual_output, AccMetrics& metrics, size_t top_k) {
+  const uint8_t* expected = reinterpret_cast<const uint8_t*>(raw_expected_output.data());
+  const uint8_t* actual = reinterpret_cast<const uint8_t*>(raw_actual_output.data());
+
+  GetDecodedAccuracy(
+      raw_expected_output.size(),
+      [format, expected, actual](size_t offset, size_t count, float* expected_block, float* actual_block) {
+        DecodeFloat8(format, expected + offset, expected_block, count);
+        DecodeFloat8(format, actual + offset, actual_block, count);
+      },
+      metrics, top_k);
+}
+
+bool ComputeAccuracyMetric(Span<const char> raw_actual_output, Span<const char> raw_expected_output,
+                           Span<const int64_t> shape, const IOInfo& output_info, size_t top_k, AccMetrics& metrics) {
+  assert(raw_actual_output.size() == raw_expected_output.size());
+  metrics = {};
   switch (output_info.data_type) {
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT: {
       Span<const float> expected_output = ReinterpretBytesAsSpan<const float>(raw_expected_output);
-      Span<const float> actual_output(ort_output.GetTensorData<float>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const float> actual_output = ReinterpretBytesAsSpan<const float>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8: {
       Span<const uint8_t> expected_output = ReinterpretBytesAsSpan<const uint8_t>(raw_expected_output);
-      Span<const uint8_t> actual_output(ort_output.GetTensorData<uint8_t>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const uint8_t> actual_output = ReinterpretBytesAsSpan<const uint8_t>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8: {
       Span<const int8_t> expected_output = ReinterpretBytesAsSpan<const int8_t>(raw_expected_output);
-      Span<const int8_t> actual_output(ort_output.GetTensorData<int8_t>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const int8_t> actual_output = ReinterpretBytesAsSpan<const int8_t>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16: {
       Span<const uint16_t> expected_output = ReinterpretBytesAsSpan<const uint16_t>(raw_expected_output);
-      Span<const uint16_t> actual_output(ort_output.GetTensorData<uint16_t>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const uint16_t> actual_output = ReinterpretBytesAsSpan<const uint16_t>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16: {
       Span<const int16_t> expected_output = ReinterpretBytesAsSpan<const int16_t>(raw_expected_output);
-      Span<const int16_t> actual_output(ort_output.GetTensorData<int16_t>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const int16_t> actual_output = ReinterpretBytesAsSpan<const int16_t>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32: {
       Span<const int32_t> expected_output = ReinterpretBytesAsSpan<const int32_t>(raw_expected_output);
-      Span<const int32_t> actual_output(ort_output.GetTensorData<int32_t>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const int32_t> actual_output = ReinterpretBytesAsSpan<const int32_t>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64: {
       Span<const int64_t> expected_output = ReinterpretBytesAsSpan<const int64_t>(raw_expected_output);
-      Span<const int64_t> actual_output(ort_output.GetTensorData<int64_t>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const int64_t> actual_output = ReinterpretBytesAsSpan<const int64_t>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL: {
       Span<const bool> expected_output = ReinterpretBytesAsSpan<const bool>(raw_expected_output);
-      Span<const bool> actual_output(ort_output.GetTensorData<bool>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const bool> actual_output = ReinterpretBytesAsSpan<const bool>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE: {
       Span<const double> expected_output = ReinterpretBytesAsSpan<const double>(raw_expected_output);
-      Span<const double> actual_output(ort_output.GetTensorData<double>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const double> actual_output = ReinterpretBytesAsSpan<const double>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32: {
       Span<const uint32_t> expected_output = ReinterpretBytesAsSpan<const uint32_t>(raw_expected_output);
-      Span<const uint32_t> actual_output(ort_output.GetTensorData<uint32_t>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const uint32_t> actual_output = ReinterpretBytesAsSpan<const uint32_t>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
       break;
     }
     case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT64: {
       Span<const uint64_t> expected_output = ReinterpretBytesAsSpan<const uint64_t>(raw_expected_output);
-      Span<const uint64_t> actual_output(ort_output.GetTensorData<uint64_t>(), expected_output.size());
-      GetAccuracy(expected_output, actual_output, metrics);
+      Span<const uint64_t> actual_output = ReinterpretBytesAsSpan<const uint64_t>(raw_actual_output);
+      GetAccuracy(expected_output, actual_output, metrics, top_k);
+      break;
+    }
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_BFLOAT16: {
+      const bool is_bf16 = output_info.data_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_BFLOAT16;
+      const uint16_t* expected = reinterpret_cast<const uint16_t*>(raw_expected_output.data());
+      const uint16_t* actual = reinterpret_cast<const uint16_t*>(raw_actual_output.data());
+
+      GetDecodedAccuracy(
+          raw_expected_output.size() / sizeof(uint16_t),
+          [is_bf16, expected, actual](size_t offset, size_t count, float* expected_block, float* actual_block) {
+            if (is_bf16) {
+              DecodeBFloat16(expected + offset, expected_block, count);
+              DecodeBFloat16(actual + offset, actual_block, count);
+            } else {
+              DecodeFloat16(expected + offset, expected_block, count);
+              DecodeFloat16(actual + offset, actual_block, count);
+            }
+          },
+          metrics, top_k);
+      break;
+    }
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT8E4M3FN:
+      GetFloat8Accuracy(Float8Format::E4M3FN, raw_expected_output, raw_actual_output, metrics, top_k);
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT8E4M3FNUZ:
+      GetFloat8Accuracy(Float8Format::E4M3FNUZ, raw_expected_output, raw_actual_output, metrics, top_k);
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT8E5M2:
+      GetFloat8Accuracy(Float8Format::E5M2, raw_expected_output, raw_actual_output, metrics, top_k);
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT8E5M2FNUZ:
+      GetFloat8Accuracy(Float8Format::E5M2FNUZ, raw_expected_output, raw_actual_output, metrics, top_k);
+      break;
+#if ORT_API_VERSION >= 20
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT4:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT4: {
+      const bool is_signed = output_info.data_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT4;
+      const uint8_t* expected = reinterpret_cast<const uint8_t*>(raw_expected_output.data());
+      const uint8_t* actual = reinterpret_cast<const uint8_t*>(raw_actual_output.data());
+
+      // Two elements are packed per byte, so the element count can't be derived from the byte size.
+      GetDecodedAccuracy(
+          static_cast<size_t>(GetShapeSize(shape)),
+          [is_signed, expected, actual](size_t offset, size_t count, float* expected_block, float* actual_block) {
+            DecodeInt4(expected, is_signed, offset, expected_block, count);
+            DecodeInt4(actual, is_signed, offset, actual_block, count);
+          },
+          metrics, top_k);
       break;
     }
+#endif
     default:
       // Note: shouldn't get here because we've already validated expected output data types when loading model.
       std::cerr << "[ERROR]: Unsupported tensor element data type: " << output_info.data_type << std::endl;
-      std::abort();
+      return false;
   }
 
-  return metrics;
+  return true;
 }
 
 bool IOInfo::Init(IOInfo& io_info, const char* name, ONNXTensorElementDataType data_type, std::vector<int64_t> shape) {
-  size_t elem_size = 0;
-  if (!GetTensorElemDataSize(data_type, elem_size)) {
+  size_t bit_width = 0;
+  if (!GetTensorElemBitWidth(data_type, bit_width)) {
     return false;
   }
 
-  const size_t total_data_size = elem_size * static_cast<size_t>(GetShapeSize(Span<const int64_t>(shape)));
-
   io_info.name = name;
   io_info.shape = std::move(shape);
   io_info.data_type = data_type;
-  io_info.total_data_size = total_data_size;
+  io_info.elem_bit_width = bit_width;
+  io_info.total_data_size = io_info.IsDynamic() ? 0 : io_info.GetDataSize(Span<const int64_t>(io_info.shape));
+
+  return true;
+}
+
+bool IOInfo::IsDynamic() const {
+  return std::any_of(shape.begin(), shape.end(), [](int64_t dim) { return dim < 0; });
+}
+
+bool IOInfo::IsCompatibleShape(Span<const int64_t> actual_shape) const {
+  if (actual_shape.size() != shape.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < shape.size(); i++) {
+    if (shape[i] >= 0 && shape[i] != actual_shape[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t IOInfo::GetDataSize(Span<const int64_t> actual_shape) const {
+  return GetTensorDataSize(elem_bit_width, static_cast<size_t>(GetShapeSize(actual_shape)));
+}
+
+ModelIOInfo::ModelIOInfo(ModelIOInfo&& other) : inputs(std::move(other.inputs)), outputs(std::move(other.outputs)) {
+  CacheRunArgs();
+}
+
+ModelIOInfo::ModelIOInfo(const ModelIOInfo& other) : inputs(other.inputs), outputs(other.outputs) {
+  CacheRunArgs();
+}
+
+ModelIOInfo& ModelIOInfo::operator=(const ModelIOInfo& other) {
+  if (this != &other) {
+    inputs = other.inputs;
+    outputs = other.outputs;
+    CacheRunArgs();
+  }
+
+  return *this;
+}
+
+ModelIOInfo& ModelIOInfo::operator=(ModelIOInfo&& other) {
+  if (this != &other) {
+    inputs = std::move(other.inputs);
+    outputs = std::move(other.outputs);
+    CacheRunArgs();
+  }
+
+  return *this;
+}
+
+// The name arrays point into the IOInfo names, so they must be rebuilt whenever the IOInfos are copied or moved.
+void ModelIOInfo::CacheRunArgs() {
+  input_names.clear();
+  for (const IOInfo& input_info : inputs) {
+    input_names.push_back(input_info.name.c_str());
+  }
+
+  output_names.clear();
+  for (const IOInfo& output_info : outputs) {
+    output_names.push_back(output_info.name.c_str());
+  }
+
+  cpu_memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+}
+
+bool ModelIOInfo::SupportsBatching() const {
+  std::string batch_dim_name;
+
+  for (const std::vector<IOInfo>* io_infos : {&inputs, &outputs}) {
+    for (const IOInfo& io_info : *io_infos) {
+      if (io_info.shape.empty() || io_info.shape[0] >= 0) {
+        return false;
+      }
+
+      if (io_info.dim_names.empty() || io_info.dim_names[0].empty()) {
+        continue;  // Unnamed symbolic dimension.
+      }
+
+      if (!batch_dim_name.empty() && batch_dim_name != io_info.dim_names[0]) {
+        return false;
+      }
+      batch_dim_name = io_info.dim_names[0];
+    }
+  }
 
   return true;
 }
 
+// Gets the names of an input's or output's symbolic dimensions (empty strings for static or unnamed dimensions).
+static std::vector<std::string> GetDimNames(const Ort::ConstTensorTypeAndShapeInfo& tensor_info) {
+  std::vector<std::string> dim_names;
+  for (const char* dim_name : tensor_info.GetSymbolicDimensions()) {
+    dim_names.emplace_back(dim_name != nullptr ? dim_name : "");
+  }
+
+  return dim_names;
+}
+
 bool ModelIOInfo::Init(ModelIOInfo& model_info, Ort::ConstSession session) {
   Ort::AllocatorWithDefaultOptions allocator;
 
@@ -166,6 +380,7 @@ bool ModelIOInfo::Init(ModelIOInfo& model_info, Ort::ConstSession session) {
         return false;
       }
 
+      input_info.dim_names = GetDimNames(tensor_info);
       model_info.inputs.push_back(std::move(input_info));
     }
   }
@@ -191,29 +406,11 @@ bool ModelIOInfo::Init(ModelIOInfo& model_info, Ort::ConstSession session) {
         return false;
       }
 
+      output_info.dim_names = GetDimNames(tensor_info);
       model_info.outputs.push_back(std::move(output_info));
     }
   }
 
+  model_info.CacheRunArgs();
   return true;
 }
-
-size_t ModelIOInfo::GetTotalInputSize() const {
-  size_t total_size = 0;
-
-  for (const auto& input_info : inputs) {
-    total_size += input_info.total_data_size;
-  }
-
-  return total_size;
-}
-
-size_t ModelIOInfo::GetTotalOutputSize() const {
-  size_t total_size = 0;
-
-  for (const auto& output_info : outputs) {
-    total_size += output_info.total_data_size;
-  }
-
-  return total_size;
-}
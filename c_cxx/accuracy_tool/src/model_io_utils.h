@@ -8,7 +8,21 @@
 
 #include "basic_utils.h"
 
-bool GetTensorElemDataSize(ONNXTensorElementDataType data_type, size_t& size);
+/// <summary>
+/// Gets the size of a tensor element in bits. Sub-byte types (e.g., INT4) are smaller than a byte.
+/// </summary>
+/// <param name="data_type">The tensor element type</param>
+/// <param name="bit_width">Set to the element size in bits</param>
+/// <returns>True if the element type is supported</returns>
+bool GetTensorElemBitWidth(ONNXTensorElementDataType data_type, size_t& bit_width);
+
+/// <summary>
+/// Gets the number of bytes needed to store a tensor's data, accounting for packed sub-byte element types.
+/// </summary>
+/// <param name="bit_width">The element size in bits</param>
+/// <param name="num_elems">The number of elements in the tensor</param>
+/// <returns>The tensor data size in bytes</returns>
+size_t GetTensorDataSize(size_t bit_width, size_t num_elems);
 
 struct IOInfo {
   IOInfo() = default;
@@ -36,19 +50,36 @@ struct IOInfo {
 
   friend bool operator!=(const IOInfo& l, const IOInfo& r) { return !(l == r); }
 
+  /// <summary>
+  /// Returns true if the model's shape has symbolic (or unknown) dimensions.
+  /// </summary>
+  bool IsDynamic() const;
+
+  /// <summary>
+  /// Returns true if a concrete shape matches the model's shape. Symbolic dimensions match any size.
+  /// </summary>
+  bool IsCompatibleShape(Span<const int64_t> actual_shape) const;
+
+  /// <summary>
+  /// Returns the size in bytes of this tensor's data for a concrete shape.
+  /// </summary>
+  size_t GetDataSize(Span<const int64_t> actual_shape) const;
+
   std::string name;
-  std::vector<int64_t> shape;
+  std::vector<int64_t> shape;           // Symbolic dimensions are negative.
+  std::vector<std::string> dim_names;  // Names of symbolic dimensions. Empty for static or unnamed dimensions.
   ONNXTensorElementDataType data_type = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
-  size_t total_data_size = 0;
+  size_t elem_bit_width = 0;
+  size_t total_data_size = 0;  // Zero if the shape is dynamic. Use GetDataSize() with the actual shape instead.
 };
 
 struct ModelIOInfo {
   ModelIOInfo() = default;
-  ModelIOInfo(ModelIOInfo&& other) = default;
-  ModelIOInfo(const ModelIOInfo& other) = default;
+  ModelIOInfo(ModelIOInfo&& other);
+  ModelIOInfo(const ModelIOInfo& other);
 
-  ModelIOInfo& operator=(const ModelIOInfo& other) = default;
-  ModelIOInfo& operator=(ModelIOInfo&& other) = default;
+  ModelIOInfo& operator=(const ModelIOInfo& other);
+  ModelIOInfo& operator=(ModelIOInfo&& other);
 
   friend bool operator==(const ModelIOInfo& l, const ModelIOInfo& r) {
     return l.inputs == r.inputs && l.outputs == r.outputs;
@@ -58,12 +89,33 @@ struct ModelIOInfo {
 
   static bool Init(ModelIOInfo& model_info, Ort::ConstSession session);
 
-  size_t GetTotalInputSize() const;
-  size_t GetTotalOutputSize() const;
+  /// <summary>
+  /// Returns true if datasets can be stacked along the leading dimension of every input and output. This requires
+  /// the leading dimension of every input and output to be symbolic (and to have the same name, if named).
+  /// </summary>
+  bool SupportsBatching() const;
 
   std::vector<IOInfo> inputs;
   std::vector<IOInfo> outputs;
+
+  // Arguments for Session::Run() that are cached to avoid rebuilding them for every run.
+  std::vector<const char*> input_names;   // Points to the names in `inputs`.
+  std::vector<const char*> output_names;  // Points to the names in `outputs`.
+  Ort::MemoryInfo cpu_memory_info{nullptr};
+
+ private:
+  void CacheRunArgs();
 };
 
-AccMetrics ComputeAccuracyMetric(Ort::ConstValue ort_output, Span<const char> raw_expected_output,
-                                 const IOInfo& output_info);
+/// <summary>
+/// Computes all accuracy metrics for a single model output in one pass over the data.
+/// </summary>
+/// <param name="raw_actual_output">The raw bytes of the actual output produced by ONNX Runtime</param>
+/// <param name="raw_expected_output">The raw bytes of the expected output</param>
+/// <param name="shape">The actual shape of the output</param>
+/// <param name="output_info">Type and shape information for the output</param>
+/// <param name="top_k">The number of largest elements to compare for the top-k metrics (0 disables)</param>
+/// <param name="metrics">Set to the accuracy metrics</param>
+/// <returns>True on success. False if the output's element type is not supported.</returns>
+bool ComputeAccuracyMetric(Span<const char> raw_actual_output, Span<const char> raw_expected_output,
+                           Span<const int64_t> shape, const IOInfo& output_info, size_t top_k, AccMetrics& metrics);
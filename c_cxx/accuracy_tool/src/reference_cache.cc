@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include "reference_cache.h"
+
+#include <onnxruntime_cxx_api.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "hash_utils.h"
+
+// Cache file layout (all integers are little-endian):
+//   ReferenceCacheHeader
+//   ReferenceCacheEntry[num_datasets * num_outputs]  (dataset-major)
+//   int64_t dims[]                                    (the dims of every entry, referenced by dims_offset)
+//   tensor data                                       (each tensor aligned to REFERENCE_CACHE_DATA_ALIGNMENT)
+constexpr char REFERENCE_CACHE_MAGIC[8] = {'O', 'R', 'T', 'A', 'C', 'C', 'R', 'C'};
+constexpr uint32_t REFERENCE_CACHE_VERSION = 1;
+constexpr size_t REFERENCE_CACHE_DATA_ALIGNMENT = 64;
+
+struct ReferenceCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_datasets;
+  uint32_t num_outputs;
+  uint32_t reserved;
+};
+
+struct ReferenceCacheEntry {
+  uint64_t dims_offset;
+  uint64_t rank;
+  uint64_t data_offset;
+  uint64_t data_size;
+};
+
+static_assert(sizeof(ReferenceCacheHeader) == 24, "Unexpected padding in ReferenceCacheHeader");
+static_assert(sizeof(ReferenceCacheEntry) == 32, "Unexpected padding in ReferenceCacheEntry");
+
+static size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+bool GetReferenceCacheKey(const std::filesystem::path& model_path,
+                          const std::vector<std::filesystem::path>& dataset_paths, std::string& cache_key) {
+  Hasher hasher;
+
+  hasher.UpdateValue(REFERENCE_CACHE_VERSION);
+  hasher.Update(Ort::GetVersionString());
+
+  if (!HashModelFiles(model_path, hasher)) {
+    return false;
+  }
+
+  hasher.UpdateValue(static_cast<uint64_t>(dataset_paths.size()));
+  for (const std::filesystem::path& dataset_path : dataset_paths) {
+    auto is_input_file = [](const std::string& filename) { return filename.rfind("input_", 0) == 0; };
+
+    if (!HashMatchingFiles(dataset_path, is_input_file, hasher)) {
+      return false;
+    }
+  }
+
+  cache_key = HashToHexString(hasher.Digest());
+  return true;
+}
+
+bool LoadReferenceOutputsFromCache(const std::filesystem::path& cache_file_path, const ModelIOInfo& model_io_info,
+                                   size_t num_datasets, DatasetsIOData& all_outputs) {
+  if (!std::filesystem::is_regular_file(cache_file_path)) {
+    return false;
+  }
+
+  MappedFile mapped_file;
+  if (!MappedFile::Open(cache_file_path, mapped_file)) {
+    return false;
+  }
+
+  const Span<char> file_bytes = mapped_file.Data();
+  const size_t file_size = file_bytes.size();
+  ReferenceCacheHeader header = {};
+
+  auto report_invalid = [&cache_file_path](const char* reason) {
+    std::cerr << "[WARNING]: Ignoring invalid reference cache file " << cache_file_path << ": " << reason
+              << std::endl;
+    return false;
+  };
+
+  if (file_size < sizeof(header)) {
+    return report_invalid("truncated header");
+  }
+
+  std::memcpy(&header, file_bytes.data(), sizeof(header));
+
+  if (std::memcmp(header.magic, REFERENCE_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != REFERENCE_CACHE_VERSION) {
+    return report_invalid("unknown format");
+  }
+
+  if (header.num_datasets != num_datasets) {
+    return report_invalid("unexpected number of datasets");
+  }
+
+  if (header.num_outputs != model_io_info.outputs.size()) {
+    return report_invalid("unexpected number of outputs");
+  }
+
+  const size_t num_entries = static_cast<size_t>(header.num_datasets) * header.num_outputs;
+  if (file_size < sizeof(header) + num_entries * sizeof(ReferenceCacheEntry)) {
+    return report_invalid("truncated index");
+  }
+
+  all_outputs.datasets.clear();
+  all_outputs.datasets.resize(num_datasets);
+  all_outputs.shape_groups.clear();
+  all_outputs.group_buffers.clear();
+  all_outputs.mapped_files.clear();
+
+  const char* entries_ptr = file_bytes.data() + sizeof(header);
+
+  for (size_t d = 0; d < num_datasets; d++) {
+    std::vector<TensorData>& tensors = all_outputs.datasets[d].tensors;
+    tensors.resize(header.num_outputs);
+
+    for (size_t i = 0; i < header.num_outputs; i++) {
+      ReferenceCacheEntry entry = {};
+      std::memcpy(&entry, entries_ptr + (d * header.num_outputs + i) * sizeof(entry), sizeof(entry));
+
+      if (entry.dims_offset > file_size || entry.rank > (file_size - entry.dims_offset) / sizeof(int64_t) ||
+          entry.data_offset > file_size || entry.data_size > file_size - entry.data_offset) {
+        all_outputs.datasets.clear();
+        return report_invalid("index entry out of bounds");
+      }
+
+      tensors[i].shape.resize(static_cast<size_t>(entry.rank));
+      if (entry.rank > 0) {
+        std::memcpy(tensors[i].shape.data(), file_bytes.data() + entry.dims_offset, entry.rank * sizeof(int64_t));
+      }
+
+      const IOInfo& output_info = model_io_info.outputs[i];
+      const std::vector<int64_t>& dims = tensors[i].shape;
+      const Span<const int64_t> shape(dims);
+      const bool has_negative_dim = std::any_of(dims.begin(), dims.end(), [](int64_t dim) { return dim < 0; });
+      if (has_negative_dim || !output_info.IsCompatibleShape(shape) ||
+          entry.data_size != output_info.GetDataSize(shape)) {
+        all_outputs.datasets.clear();
+        return report_invalid("output does not match the model");
+      }
+
+      tensors[i].data = Span<char>(file_bytes.data() + entry.data_offset, static_cast<size_t>(entry.data_size));
+    }
+  }
+
+  all_outputs.mapped_files.push_back(std::move(mapped_file));
+  return true;
+}
+
+bool SaveReferenceOutputsToCache(const std::filesystem::path& cache_file_path, const DatasetsIOData& all_outputs) {
+  const size_t num_datasets = all_outputs.datasets.size();
+  const size_t num_outputs = num_datasets > 0 ? all_outputs.datasets[0].tensors.size() : 0;
+
+  // Compute the layout of the file.
+  ReferenceCacheHeader header = {};
+  std::memcpy(header.magic, REFERENCE_CACHE_MAGIC, sizeof(header.magic));
+  header.version = REFERENCE_CACHE_VERSION;
+  header.num_datasets = static_cast<uint32_t>(num_datasets);
+  header.num_outputs = static_cast<uint32_t>(num_outputs);
+
+  std::vector<ReferenceCacheEntry> entries(num_datasets * num_outputs);
+  std::vector<int64_t> all_dims;
+  size_t dims_offset = sizeof(header) + entries.size() * sizeof(ReferenceCacheEntry);
+
+  for (size_t d = 0; d < num_datasets; d++) {
+    for (size_t i = 0; i < num_outputs; i++) {
+      const TensorData& tensor = all_outputs.datasets[d].tensors[i];
+      ReferenceCacheEntry& entry = entries[d * num_outputs + i];
+
+      entry.dims_offset = dims_offset + all_dims.size() * sizeof(int64_t);
+      entry.rank = tensor.shape.size();
+      all_dims.insert(all_dims.end(), tensor.shape.begin(), tensor.shape.end());
+    }
+  }
+
+  size_t data_offset = AlignUp(dims_offset + all_dims.size() * sizeof(int64_t), REFERENCE_CACHE_DATA_ALIGNMENT);
+  for (size_t d = 0; d < num_datasets; d++) {
+    for (size_t i = 0; i < num_outputs; i++) {
+      ReferenceCacheEntry& entry = entries[d * num_outputs + i];
+
+      entry.data_offset = data_offset;
+      entry.data_size = all_outputs.datasets[d].tensors[i].data.size();
+      data_offset = AlignUp(data_offset + entry.data_size, REFERENCE_CACHE_DATA_ALIGNMENT);
+    }
+  }
+
+  // Write to a temporary file and rename it into place once it is complete.
+  std::filesystem::path temp_file_path = cache_file_path;
+  temp_file_path += ".tmp";
+
+  {
+    std::ofstream out_fs(temp_file_path, std::ios::binary | std::ios::trunc);
+    if (!out_fs.is_open()) {
+      std::cerr << "[ERROR]: Unable to open reference cache file " << temp_file_path << std::endl;
+      return false;
+    }
+
+    out_fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_fs.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ReferenceCacheEntry));
+    out_fs.write(reinterpret_cast<const char*>(all_dims.data()), all_dims.size() * sizeof(int64_t));
+
+    const std::array<char, REFERENCE_CACHE_DATA_ALIGNMENT> padding = {};
+    size_t offset = dims_offset + all_dims.size() * sizeof(int64_t);
+
+    for (size_t d = 0; d < num_datasets; d++) {
+      for (size_t i = 0; i < num_outputs; i++) {
+        const ReferenceCacheEntry& entry = entries[d * num_outputs + i];
+        const Span<char> data = all_outputs.datasets[d].tensors[i].data;
+
+        out_fs.write(padding.data(), entry.data_offset - offset);
+        out_fs.write(data.data(), data.size());
+        offset = entry.data_offset + entry.data_size;
+      }
+    }
+
+    if (!out_fs) {
+      std::cerr << "[ERROR]: Failed to write reference cache file " << temp_file_path << std::endl;
+      return false;
+    }
+  }
+
+  std::error_code error_code;
+  std::filesystem::rename(temp_file_path, cache_file_path, error_code);
+  if (error_code) {
+    std::cerr << "[ERROR]: Unable to rename " << temp_file_path << " to " << cache_file_path << ": "
+              << error_code.message() << std::endl;
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "data_loader.h"
+#include "model_io_utils.h"
+
+/// <summary>
+/// Computes the key under which the expected (reference) outputs of a model are cached. The key is a hash of:
+///   - The ONNX Runtime version.
+///   - The bytes of the model file and of any file next to it whose name starts with the model's file name
+///     (e.g., external data such as model.onnx.data).
+///   - The names and bytes of every input_* file of every dataset, in order.
+/// </summary>
+/// <param name="model_path">The model that produces the reference outputs</param>
+/// <param name="dataset_paths">The directories containing the input files</param>
+/// <param name="cache_key">Set to the cache key (a hexadecimal string)</param>
+/// <returns>True on success</returns>
+bool GetReferenceCacheKey(const std::filesystem::path& model_path,
+                          const std::vector<std::filesystem::path>& dataset_paths, std::string& cache_key);
+
+/// <summary>
+/// Loads reference outputs from a cache file. The file is memory-mapped, and the output data is used in place.
+/// A missing or invalid cache file is reported as a cache miss. A cache file whose number of outputs, output shapes
+/// or output data sizes do not match the model's outputs is invalid.
+/// </summary>
+/// <param name="cache_file_path">The cache file</param>
+/// <param name="model_io_info">The inputs and outputs of the model that produces the reference outputs</param>
+/// <param name="num_datasets">The expected number of datasets</param>
+/// <param name="all_outputs">Output into which to store the cached outputs</param>
+/// <returns>True if the outputs were loaded from the cache</returns>
+bool LoadReferenceOutputsFromCache(const std::filesystem::path& cache_file_path, const ModelIOInfo& model_io_info,
+                                   size_t num_datasets, DatasetsIOData& all_outputs);
+
+/// <summary>
+/// Saves reference outputs to a cache file. The file is first written to a temporary file and then renamed, so
+/// concurrent readers never see a partially written cache file.
+/// </summary>
+/// <param name="cache_file_path">The cache file</param>
+/// <param name="all_outputs">The reference outputs for all datasets</param>
+/// <returns>True on success</returns>
+bool SaveReferenceOutputsToCache(const std::filesystem::path& cache_file_path, const DatasetsIOData& all_outputs);
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include "session_cache.h"
+
+#include <onnxruntime_session_options_config_keys.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+#include "hash_utils.h"
+
+constexpr uint32_t SESSION_CACHE_VERSION = 2;
+
+static const char* GetCacheFileSuffix(SessionCacheType cache_type) {
+  return cache_type == SessionCacheType::EpContext ? ".ctx.onnx" : ".optimized.onnx";
+}
+
+// Describes the host CPU. Cached models may be compiled for the exact CPU (e.g., its ISA extensions), so models
+// cached on another CPU must not be reused.
+static std::string GetCpuDescription() {
+  std::string description;
+#ifdef _WIN32
+  const char* processor_key = "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0";
+  for (const char* value_name : {"ProcessorNameString", "Identifier"}) {
+    char value[256] = {};
+    DWORD value_size = sizeof(value);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, processor_key, value_name, RRF_RT_REG_SZ, nullptr, value, &value_size) ==
+        ERROR_SUCCESS) {
+      description += std::string(value_name) + "=" + value + "\n";
+    }
+  }
+#else
+  // The fields of the first processor that identify the CPU model and its features (x86 and Arm).
+  const char* const fields[] = {"vendor_id", "cpu family", "model", "model name", "stepping", "flags",
+                                "CPU implementer", "CPU architecture", "CPU variant", "CPU part", "Features"};
+  std::ifstream ifs("/proc/cpuinfo");
+  std::string line;
+
+  while (std::getline(ifs, line) && !line.empty()) {
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+
+    const std::string field = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+    if (std::find(std::begin(fields), std::end(fields), field) != std::end(fields)) {
+      description += line + "\n";
+    }
+  }
+#endif
+  return description;
+}
+
+// Returns a random suffix for temporary files, so that concurrent runs that cache the same model do not write to
+// the same file.
+static std::string GetTempFileSuffix() {
+  std::random_device random_device;
+  const uint64_t random_value = (static_cast<uint64_t>(random_device()) << 32) | random_device();
+
+  std::ostringstream oss;
+  oss << ".tmp" << std::hex << random_value;
+  return oss.str();
+}
+
+// Creates a session and measures how long it takes.
+static Ort::Session CreateTimedSession(Ort::Env& env, const std::filesystem::path& model_path,
+                                       const Ort::SessionOptions& session_options, double& creation_ms) {
+  const auto start_time = std::chrono::steady_clock::now();
+  Ort::Session session(env, model_path.c_str(), session_options);
+  const auto end_time = std::chrono::steady_clock::now();
+
+  creation_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+  return session;
+}
+
+bool GetSessionCacheKey(const std::filesystem::path& model_path, SessionCacheType cache_type,
+                        std::string_view session_config, std::string& cache_key) {
+  Hasher hasher;
+
+  hasher.UpdateValue(SESSION_CACHE_VERSION);
+  hasher.Update(Ort::GetVersionString());
+  hasher.UpdateValue(static_cast<uint32_t>(cache_type));
+  hasher.UpdateValue(static_cast<uint64_t>(session_config.size()));
+  hasher.Update(session_config);
+
+  const std::string cpu_description = GetCpuDescription();
+  hasher.UpdateValue(static_cast<uint64_t>(cpu_description.size()));
+  hasher.Update(cpu_description);
+
+  if (!HashModelFiles(model_path, hasher)) {
+    return false;
+  }
+
+  cache_key = HashToHexString(hasher.Digest());
+  return true;
+}
+
+bool CreateSessionWithCache(Ort::Env& env, const std::filesystem::path& model_path,
+                            const Ort::SessionOptions& session_options, const std::filesystem::path& cache_dir,
+                            SessionCacheType cache_type, std::string_view session_config, Ort::Session& session,
+                            SessionCreationInfo& creation_info) {
+  creation_info = SessionCreationInfo{};
+
+  if (cache_dir.empty()) {
+    session = CreateTimedSession(env, model_path, session_options, creation_info.creation_ms);
+    return true;
+  }
+
+  std::string cache_key;
+  if (!GetSessionCacheKey(model_path, cache_type, session_config, cache_key)) {
+    return false;
+  }
+
+  const std::filesystem::path cache_file_path = cache_dir / (cache_key + GetCacheFileSuffix(cache_type));
+
+  if (std::filesystem::is_regular_file(cache_file_path)) {
+    // An optimized model must not be optimized again: the cached graph may already contain hardware-specific nodes.
+    // An EPContext model is loaded with the original options so that the EP can deserialize its compiled graph.
+    Ort::SessionOptions cached_session_options = session_options.Clone();
+    if (cache_type == SessionCacheType::OptimizedModel) {
+      cached_session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+    }
+
+    try {
+      session = CreateTimedSession(env, cache_file_path, cached_session_options, creation_info.creation_ms);
+      creation_info.loaded_from_cache = true;
+      creation_info.cache_file_path = cache_file_path;
+      return true;
+    } catch (const Ort::Exception& e) {
+      std::cerr << "[WARNING]: Ignoring invalid session cache file " << cache_file_path << ": " << e.what()
+                << std::endl;
+
+      std::error_code error_code;
+      std::filesystem::remove(cache_file_path, error_code);
+    }
+  }
+
+  // Have ONNX Runtime write the cached model to a temporary file while it creates the session from the original
+  // model, and rename the file into place once the session has been created.
+  const std::filesystem::path temp_file_path =
+      cache_dir / (cache_key + GetTempFileSuffix() + GetCacheFileSuffix(cache_type));
+  Ort::SessionOptions caching_session_options = session_options.Clone();
+
+  if (cache_type == SessionCacheType::OptimizedModel) {
+    caching_session_options.SetOptimizedModelFilePath(temp_file_path.c_str());
+  } else {
+    // Embed the EP's compiled graph in the EPContext model so that the cache entry is a single file.
+    caching_session_options.AddConfigEntry(kOrtSessionOptionEpContextEnable, "1");
+    caching_session_options.AddConfigEntry(kOrtSessionOptionEpContextFilePath, temp_file_path.string().c_str());
+    caching_session_options.AddConfigEntry(kOrtSessionOptionEpContextEmbedMode, "1");
+  }
+
+  session = CreateTimedSession(env, model_path, caching_session_options, creation_info.creation_ms);
+
+  // An EP only generates an EPContext model if it compiled (part of) the graph.
+  if (!std::filesystem::is_regular_file(temp_file_path)) {
+    std::cout << "[INFO]: No model was generated for the session cache from " << model_path << std::endl;
+    return true;
+  }
+
+  std::error_code error_code;
+  std::filesystem::rename(temp_file_path, cache_file_path, error_code);
+  if (error_code) {
+    std::cerr << "[ERROR]: Unable to rename " << temp_file_path << " to " << cache_file_path << ": "
+              << error_code.message() << std::endl;
+    return false;
+  }
+
+  creation_info.cache_file_path = cache_file_path;
+  return true;
+}
@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <onnxruntime_cxx_api.h>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/// <summary>
+/// The kind of model that is cached in place of the original model to speed up session creation.
+/// </summary>
+enum class SessionCacheType {
+  OptimizedModel,  // The graph after ONNX Runtime's optimizations (see SessionOptions::SetOptimizedModelFilePath).
+  EpContext,       // An EPContext model with the EP's compiled graph embedded (see "ep.context_enable").
+};
+
+/// <summary>
+/// Information about how a session was created.
+/// </summary>
+struct SessionCreationInfo {
+  double creation_ms = 0.0;               // Time to create the session (i.e., load, optimize, and compile the model).
+  bool loaded_from_cache = false;         // True if the session was created from a cached model.
+  std::filesystem::path cache_file_path;  // The cached model. Empty if caching is disabled or nothing was cached.
+};
+
+/// <summary>
+/// Computes the key under which a compiled model is cached. The key is a hash of:
+///   - The ONNX Runtime version.
+///   - The type of cached model.
+///   - The session configuration (e.g., EP options and session config entries).
+///   - The host CPU's model and features.
+///   - The bytes of the model file and of its external data files.
+/// </summary>
+/// <param name="model_path">The original model</param>
+/// <param name="cache_type">The type of cached model</param>
+/// <param name="session_config">Canonical description of the session options used to create the session</param>
+/// <param name="cache_key">Set to the cache key (a hexadecimal string)</param>
+/// <returns>True on success</returns>
+bool GetSessionCacheKey(const std::filesystem::path& model_path, SessionCacheType cache_type,
+                        std::string_view session_config, std::string& cache_key);
+
+/// <summary>
+/// Creates a session, reusing a model cached by a previous run if possible.
+///
+/// On a cache hit, the session is created from the cached model. Otherwise, the session is created from the original
+/// model and ONNX Runtime is asked to save the optimized (or EPContext) model into the cache directory. The cached
+/// model is first written to a uniquely named temporary file and then renamed, so concurrent runs never load a
+/// partially written model. A cached model that fails to load is deleted and regenerated.
+/// </summary>
+/// <param name="env">The ONNX Runtime environment</param>
+/// <param name="model_path">The original model</param>
+/// <param name="session_options">The session options (including the EP)</param>
+/// <param name="cache_dir">The cache directory. Empty to disable caching.</param>
+/// <param name="cache_type">The type of model to cache</param>
+/// <param name="session_config">Canonical description of session_options (part of the cache key)</param>
+/// <param name="session">Output parameter set to the new session</param>
+/// <param name="creation_info">Output parameter set to the session creation time and cache status</param>
+/// <returns>True on success</returns>
+bool CreateSessionWithCache(Ort::Env& env, const std::filesystem::path& model_path,
+                            const Ort::SessionOptions& session_options, const std::filesystem::path& cache_dir,
+                            SessionCacheType cache_type, std::string_view session_config, Ort::Session& session,
+                            SessionCreationInfo& creation_info);
@@ -27,7 +27,7 @@ TaskThreadPool::~TaskThreadPool() {
   }
 }
 
-void TaskThreadPool::CompleteTasks(Span<Task> tasks) {
+bool TaskThreadPool::CompleteTasks(Span<Task> tasks) {
   // Assert that it is only possible to call CompleteTasks() when either
   // this is the first set of tasks or we've completely processed the previous tasks.
   assert(tasks_completed_ == tasks_.size());
@@ -38,6 +38,7 @@ void TaskThreadPool::CompleteTasks(Span<Task> tasks) {
     tasks_ = tasks;
     tasks_completed_ = 0;
     next_task_index_ = 0;
+    all_tasks_succeeded_ = true;
     signal_.notify_all();
   }
 
@@ -47,6 +48,8 @@ void TaskThreadPool::CompleteTasks(Span<Task> tasks) {
       // Keep helping out the pool threads.
     }
   }
+
+  return all_tasks_succeeded_;
 }
 
 void TaskThreadPool::ThreadEntry() {
@@ -79,7 +82,9 @@ bool TaskThreadPool::RunNextTask() {
     return false;
   }
 
-  tasks_[task_index].Run();
+  if (!tasks_[task_index].Run()) {
+    all_tasks_succeeded_ = false;
+  }
 
   std::atomic_fetch_add(&tasks_completed_, static_cast<size_t>(1));
   return true;
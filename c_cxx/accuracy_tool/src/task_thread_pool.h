@@ -29,7 +29,8 @@ class TaskThreadPool {
   /// also helps complete the tasks.
   /// </summary>
   /// <param name="tasks">The fixed set of tasks to complete.</param>
-  void CompleteTasks(Span<Task> tasks);
+  /// <returns>True if every task succeeded. All tasks are run even if some fail.</returns>
+  bool CompleteTasks(Span<Task> tasks);
 
  private:
   void ThreadEntry();
@@ -41,5 +42,6 @@ class TaskThreadPool {
   Span<Task> tasks_;
   std::atomic<size_t> next_task_index_ = 0;
   std::atomic<size_t> tasks_completed_ = 0;
+  std::atomic<bool> all_tasks_succeeded_ = true;
   std::vector<std::thread> threads_;
 };
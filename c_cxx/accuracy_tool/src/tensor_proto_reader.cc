@@ -0,0 +1,399 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#include "tensor_proto_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+// Field numbers from onnx.proto (message TensorProto).
+constexpr uint32_t TENSOR_PROTO_DIMS = 1;
+constexpr uint32_t TENSOR_PROTO_DATA_TYPE = 2;
+constexpr uint32_t TENSOR_PROTO_FLOAT_DATA = 4;
+constexpr uint32_t TENSOR_PROTO_INT32_DATA = 5;
+constexpr uint32_t TENSOR_PROTO_INT64_DATA = 7;
+constexpr uint32_t TENSOR_PROTO_RAW_DATA = 9;
+constexpr uint32_t TENSOR_PROTO_DOUBLE_DATA = 10;
+constexpr uint32_t TENSOR_PROTO_UINT64_DATA = 11;
+constexpr uint32_t TENSOR_PROTO_EXTERNAL_DATA = 13;
+constexpr uint32_t TENSOR_PROTO_DATA_LOCATION = 14;
+
+// Field numbers from onnx.proto of the messages that may contain tensors (ModelProto, FunctionProto, GraphProto,
+// NodeProto, AttributeProto, SparseTensorProto) and of StringStringEntryProto.
+constexpr uint32_t MODEL_PROTO_GRAPH = 7;
+constexpr uint32_t MODEL_PROTO_FUNCTIONS = 25;
+constexpr uint32_t FUNCTION_PROTO_NODE = 7;
+constexpr uint32_t GRAPH_PROTO_NODE = 1;
+constexpr uint32_t GRAPH_PROTO_INITIALIZER = 5;
+constexpr uint32_t GRAPH_PROTO_SPARSE_INITIALIZER = 15;
+constexpr uint32_t NODE_PROTO_ATTRIBUTE = 5;
+constexpr uint32_t ATTRIBUTE_PROTO_T = 5;
+constexpr uint32_t ATTRIBUTE_PROTO_G = 6;
+constexpr uint32_t ATTRIBUTE_PROTO_TENSORS = 10;
+constexpr uint32_t ATTRIBUTE_PROTO_GRAPHS = 11;
+constexpr uint32_t ATTRIBUTE_PROTO_SPARSE_TENSOR = 22;
+constexpr uint32_t ATTRIBUTE_PROTO_SPARSE_TENSORS = 23;
+constexpr uint32_t SPARSE_TENSOR_PROTO_VALUES = 1;
+constexpr uint32_t SPARSE_TENSOR_PROTO_INDICES = 2;
+constexpr uint32_t STRING_STRING_ENTRY_KEY = 1;
+constexpr uint32_t STRING_STRING_ENTRY_VALUE = 2;
+
+// Subgraphs (e.g., of If and Loop nodes) are nested messages. Deeper nesting is rejected as malformed.
+constexpr int MAX_MESSAGE_DEPTH = 64;
+
+// Protobuf wire types.
+constexpr uint32_t WIRE_TYPE_VARINT = 0;
+constexpr uint32_t WIRE_TYPE_FIXED64 = 1;
+constexpr uint32_t WIRE_TYPE_LENGTH_DELIMITED = 2;
+constexpr uint32_t WIRE_TYPE_FIXED32 = 5;
+
+static bool ReadVarint(const uint8_t*& ptr, const uint8_t* end, uint64_t& value) {
+  value = 0;
+
+  for (uint32_t shift = 0; shift < 64 && ptr < end; shift += 7) {
+    const uint8_t byte = *ptr++;
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// A field of a serialized protobuf message.
+struct ProtoField {
+  uint32_t number = 0;
+  uint32_t wire_type = 0;
+  uint64_t varint_value = 0;  // Set for WIRE_TYPE_VARINT.
+  Span<const char> bytes;     // Set for WIRE_TYPE_LENGTH_DELIMITED.
+};
+
+// Reads the next field of a message and advances `ptr` past it.
+static bool ReadField(const uint8_t*& ptr, const uint8_t* end, const char* message_name, ProtoField& field) {
+  uint64_t key = 0;
+  if (!ReadVarint(ptr, end, key)) {
+    std::cerr << "[ERROR]: Malformed " << message_name << ": truncated field key" << std::endl;
+    return false;
+  }
+
+  field = ProtoField{};
+  field.number = static_cast<uint32_t>(key >> 3);
+  field.wire_type = static_cast<uint32_t>(key & 0x7);
+
+  switch (field.wire_type) {
+    case WIRE_TYPE_VARINT:
+      if (!ReadVarint(ptr, end, field.varint_value)) {
+        std::cerr << "[ERROR]: Malformed " << message_name << ": truncated varint in field " << field.number
+                  << std::endl;
+        return false;
+      }
+      break;
+    case WIRE_TYPE_FIXED64:
+    case WIRE_TYPE_FIXED32: {
+      const size_t size = field.wire_type == WIRE_TYPE_FIXED64 ? 8 : 4;
+      if (static_cast<size_t>(end - ptr) < size) {
+        std::cerr << "[ERROR]: Malformed " << message_name << ": truncated field " << field.number << std::endl;
+        return false;
+      }
+      ptr += size;
+      break;
+    }
+    case WIRE_TYPE_LENGTH_DELIMITED: {
+      uint64_t length = 0;
+      if (!ReadVarint(ptr, end, length) || length > static_cast<uint64_t>(end - ptr)) {
+        std::cerr << "[ERROR]: Malformed " << message_name << ": invalid length for field " << field.number
+                  << std::endl;
+        return false;
+      }
+      field.bytes = Span<const char>(reinterpret_cast<const char*>(ptr), static_cast<size_t>(length));
+      ptr += length;
+      break;
+    }
+    default:
+      std::cerr << "[ERROR]: Malformed " << message_name << ": unsupported wire type " << field.wire_type
+                << std::endl;
+      return false;
+  }
+
+  return true;
+}
+
+static void WriteVarint(uint64_t value, std::string& bytes) {
+  while (value >= 0x80) {
+    bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+
+  bytes.push_back(static_cast<char>(value));
+}
+
+static void WriteFieldKey(uint32_t field_number, uint32_t wire_type, std::string& bytes) {
+  WriteVarint((static_cast<uint64_t>(field_number) << 3) | wire_type, bytes);
+}
+
+bool ParseTensorProto(Span<const char> bytes, TensorProtoView& tensor_proto) {
+  const uint8_t* ptr = reinterpret_cast<const uint8_t*>(bytes.data());
+  const uint8_t* end = ptr + bytes.size();
+
+  tensor_proto = TensorProtoView{};
+
+  while (ptr < end) {
+    ProtoField field;
+    if (!ReadField(ptr, end, "TensorProto", field)) {
+      return false;
+    }
+
+    switch (field.number) {
+      case TENSOR_PROTO_DIMS:
+        if (field.wire_type == WIRE_TYPE_VARINT) {
+          tensor_proto.dims.push_back(static_cast<int64_t>(field.varint_value));
+        } else if (field.wire_type == WIRE_TYPE_LENGTH_DELIMITED) {
+          const uint8_t* dims_ptr = reinterpret_cast<const uint8_t*>(field.bytes.data());
+          const uint8_t* dims_end = dims_ptr + field.bytes.size();
+          while (dims_ptr < dims_end) {
+            uint64_t dim = 0;
+            if (!ReadVarint(dims_ptr, dims_end, dim)) {
+              std::cerr << "[ERROR]: Malformed TensorProto: truncated dims" << std::endl;
+              return false;
+            }
+            tensor_proto.dims.push_back(static_cast<int64_t>(dim));
+          }
+        }
+        break;
+      case TENSOR_PROTO_DATA_TYPE:
+        tensor_proto.data_type = static_cast<int32_t>(field.varint_value);
+        break;
+      case TENSOR_PROTO_RAW_DATA:
+      case TENSOR_PROTO_FLOAT_DATA:
+      case TENSOR_PROTO_DOUBLE_DATA:
+      case TENSOR_PROTO_INT32_DATA:
+      case TENSOR_PROTO_INT64_DATA:
+      case TENSOR_PROTO_UINT64_DATA:
+        if (field.wire_type != WIRE_TYPE_LENGTH_DELIMITED) {
+          std::cerr << "[ERROR]: TensorProto data stored as unpacked repeated values is not supported" << std::endl;
+          return false;
+        }
+
+        if (tensor_proto.data_field != TensorProtoDataField::None) {
+          std::cerr << "[ERROR]: TensorProto has more than one data field" << std::endl;
+          return false;
+        }
+
+        tensor_proto.data = field.bytes;
+        tensor_proto.data_field = field.number == TENSOR_PROTO_RAW_DATA      ? TensorProtoDataField::RawData
+                                  : field.number == TENSOR_PROTO_FLOAT_DATA  ? TensorProtoDataField::FloatData
+                                  : field.number == TENSOR_PROTO_DOUBLE_DATA ? TensorProtoDataField::DoubleData
+                                  : field.number == TENSOR_PROTO_INT32_DATA  ? TensorProtoDataField::Int32Data
+                                  : field.number == TENSOR_PROTO_INT64_DATA  ? TensorProtoDataField::Int64Data
+                                                                             : TensorProtoDataField::Uint64Data;
+        break;
+      case TENSOR_PROTO_EXTERNAL_DATA:
+        std::cerr << "[ERROR]: TensorProto with external data is not supported" << std::endl;
+        return false;
+      case TENSOR_PROTO_DATA_LOCATION:
+        if (field.varint_value != 0) {
+          std::cerr << "[ERROR]: TensorProto with external data is not supported" << std::endl;
+          return false;
+        }
+        break;
+      default:
+        break;  // Other fields (e.g., name, doc_string) are not needed.
+    }
+  }
+
+  return true;
+}
+
+bool IsTensorProtoDataInMemoryLayout(const TensorProtoView& tensor_proto) {
+  return tensor_proto.data_field == TensorProtoDataField::RawData ||
+         tensor_proto.data_field == TensorProtoDataField::FloatData ||
+         tensor_proto.data_field == TensorProtoDataField::DoubleData;
+}
+
+bool CopyTensorProtoData(const TensorProtoView& tensor_proto, size_t elem_bit_width, Span<char> dst) {
+  if (tensor_proto.data_field == TensorProtoDataField::None || IsTensorProtoDataInMemoryLayout(tensor_proto)) {
+    if (tensor_proto.data.size() != dst.size()) {
+      std::cerr << "[ERROR]: TensorProto has " << tensor_proto.data.size() << " bytes of data, but " << dst.size()
+                << " bytes were expected" << std::endl;
+      return false;
+    }
+
+    if (!dst.empty()) {
+      std::memcpy(dst.data(), tensor_proto.data.data(), dst.size());
+    }
+    return true;
+  }
+
+  if (elem_bit_width < 8) {
+    std::cerr << "[ERROR]: Sub-byte TensorProto elements must be stored in raw_data" << std::endl;
+    return false;
+  }
+
+  // Decode the packed varints, keeping the low bytes of each value (assumes a little-endian host).
+  const size_t elem_size = elem_bit_width / 8;
+  const uint8_t* ptr = reinterpret_cast<const uint8_t*>(tensor_proto.data.data());
+  const uint8_t* end = ptr + tensor_proto.data.size();
+  size_t offset = 0;
+
+  while (ptr < end) {
+    uint64_t value = 0;
+    if (!ReadVarint(ptr, end, value)) {
+      std::cerr << "[ERROR]: Malformed TensorProto: truncated data" << std::endl;
+      return false;
+    }
+
+    if (offset + elem_size > dst.size()) {
+      std::cerr << "[ERROR]: TensorProto has more elements than expected" << std::endl;
+      return false;
+    }
+
+    std::memcpy(dst.data() + offset, &value, elem_size);
+    offset += elem_size;
+  }
+
+  if (offset != dst.size()) {
+    std::cerr << "[ERROR]: TensorProto has fewer elements than expected" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+void SerializeTensorProto(int32_t data_type, Span<const int64_t> dims, Span<const char> data, std::string& bytes) {
+  bytes.clear();
+
+  for (size_t i = 0; i < dims.size(); i++) {
+    WriteFieldKey(TENSOR_PROTO_DIMS, WIRE_TYPE_VARINT, bytes);
+    WriteVarint(static_cast<uint64_t>(dims[i]), bytes);
+  }
+
+  WriteFieldKey(TENSOR_PROTO_DATA_TYPE, WIRE_TYPE_VARINT, bytes);
+  WriteVarint(static_cast<uint64_t>(data_type), bytes);
+
+  WriteFieldKey(TENSOR_PROTO_RAW_DATA, WIRE_TYPE_LENGTH_DELIMITED, bytes);
+  WriteVarint(data.size(), bytes);
+  bytes.append(data.data(), data.size());
+}
+
+namespace {
+
+// The messages of a model that may contain tensors, directly or in nested messages.
+enum class ModelMessage {
+  Model,
+  Function,
+  Graph,
+  Node,
+  Attribute,
+  SparseTensor,
+  Tensor,
+  ExternalDataEntry,
+};
+
+}  // namespace
+
+// Returns the kind of nested message stored in a length-delimited field, or false if the field cannot contain tensors.
+static bool GetNestedModelMessage(ModelMessage message, uint32_t field_number, ModelMessage& nested_message) {
+  switch (message) {
+    case ModelMessage::Model:
+      nested_message = field_number == MODEL_PROTO_GRAPH ? ModelMessage::Graph : ModelMessage::Function;
+      return field_number == MODEL_PROTO_GRAPH || field_number == MODEL_PROTO_FUNCTIONS;
+    case ModelMessage::Function:
+      nested_message = ModelMessage::Node;
+      return field_number == FUNCTION_PROTO_NODE;
+    case ModelMessage::Graph:
+      nested_message = field_number == GRAPH_PROTO_NODE          ? ModelMessage::Node
+                       : field_number == GRAPH_PROTO_INITIALIZER ? ModelMessage::Tensor
+                                                                 : ModelMessage::SparseTensor;
+      return field_number == GRAPH_PROTO_NODE || field_number == GRAPH_PROTO_INITIALIZER ||
+             field_number == GRAPH_PROTO_SPARSE_INITIALIZER;
+    case ModelMessage::Node:
+      nested_message = ModelMessage::Attribute;
+      return field_number == NODE_PROTO_ATTRIBUTE;
+    case ModelMessage::Attribute:
+      switch (field_number) {
+        case ATTRIBUTE_PROTO_T:
+        case ATTRIBUTE_PROTO_TENSORS:
+          nested_message = ModelMessage::Tensor;
+          return true;
+        case ATTRIBUTE_PROTO_G:
+        case ATTRIBUTE_PROTO_GRAPHS:
+          nested_message = ModelMessage::Graph;
+          return true;
+        case ATTRIBUTE_PROTO_SPARSE_TENSOR:
+        case ATTRIBUTE_PROTO_SPARSE_TENSORS:
+          nested_message = ModelMessage::SparseTensor;
+          return true;
+        default:
+          return false;
+      }
+    case ModelMessage::SparseTensor:
+      nested_message = ModelMessage::Tensor;
+      return field_number == SPARSE_TENSOR_PROTO_VALUES || field_number == SPARSE_TENSOR_PROTO_INDICES;
+    case ModelMessage::Tensor:
+      nested_message = ModelMessage::ExternalDataEntry;
+      return field_number == TENSOR_PROTO_EXTERNAL_DATA;
+    default:
+      return false;
+  }
+}
+
+static bool CollectExternalDataLocations(Span<const char> bytes, ModelMessage message, int depth,
+                                         std::vector<std::string>& locations) {
+  if (depth > MAX_MESSAGE_DEPTH) {
+    std::cerr << "[ERROR]: Malformed ModelProto: messages are nested too deeply" << std::endl;
+    return false;
+  }
+
+  const uint8_t* ptr = reinterpret_cast<const uint8_t*>(bytes.data());
+  const uint8_t* end = ptr + bytes.size();
+  std::string_view key;
+  std::string_view value;
+
+  while (ptr < end) {
+    ProtoField field;
+    if (!ReadField(ptr, end, "ModelProto", field)) {
+      return false;
+    }
+
+    if (field.wire_type != WIRE_TYPE_LENGTH_DELIMITED) {
+      continue;
+    }
+
+    if (message == ModelMessage::ExternalDataEntry) {
+      const std::string_view field_value(field.bytes.data(), field.bytes.size());
+      if (field.number == STRING_STRING_ENTRY_KEY) {
+        key = field_value;
+      } else if (field.number == STRING_STRING_ENTRY_VALUE) {
+        value = field_value;
+      }
+      continue;
+    }
+
+    ModelMessage nested_message = ModelMessage::Model;
+    if (GetNestedModelMessage(message, field.number, nested_message) &&
+        !CollectExternalDataLocations(field.bytes, nested_message, depth + 1, locations)) {
+      return false;
+    }
+  }
+
+  if (message == ModelMessage::ExternalDataEntry && key == "location") {
+    locations.emplace_back(value);
+  }
+
+  return true;
+}
+
+bool GetExternalDataLocations(Span<const char> model_bytes, std::vector<std::string>& locations) {
+  locations.clear();
+
+  if (!CollectExternalDataLocations(model_bytes, ModelMessage::Model, 0, locations)) {
+    return false;
+  }
+
+  std::sort(locations.begin(), locations.end());
+  locations.erase(std::unique(locations.begin(), locations.end()), locations.end());
+  return true;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "basic_utils.h"
+
+/// <summary>
+/// The onnx.TensorProto field that stores a tensor's data.
+/// </summary>
+enum class TensorProtoDataField {
+  None,        // No data field (only valid for tensors with zero elements)
+  RawData,     // raw_data: little-endian bytes
+  FloatData,   // float_data: packed fixed32 values
+  DoubleData,  // double_data: packed fixed64 values
+  Int32Data,   // int32_data: packed varints (also used for 8/16-bit types, bool, float16, bfloat16, and float8)
+  Int64Data,   // int64_data: packed varints
+  Uint64Data,  // uint64_data: packed varints (used for uint32 and uint64)
+};
+
+/// <summary>
+/// The fields of a serialized onnx.TensorProto that are needed to load its data. The data span points directly into
+/// the serialized bytes.
+/// </summary>
+struct TensorProtoView {
+  int32_t data_type = 0;  // onnx.TensorProto.DataType (same values as ONNXTensorElementDataType)
+  std::vector<int64_t> dims;
+  TensorProtoDataField data_field = TensorProtoDataField::None;
+  Span<const char> data;
+};
+
+/// <summary>
+/// Parses the header fields of a serialized onnx.TensorProto without copying its data. Tensors with external data
+/// are not supported.
+/// </summary>
+/// <param name="bytes">The serialized TensorProto</param>
+/// <param name="tensor_proto">Set to the parsed fields</param>
+/// <returns>True on success</returns>
+bool ParseTensorProto(Span<const char> bytes, TensorProtoView& tensor_proto);
+
+/// <summary>
+/// Returns true if the tensor's data field is stored in the same format as the in-memory tensor (on a little-endian
+/// host), which allows the data to be used in place.
+/// </summary>
+bool IsTensorProtoDataInMemoryLayout(const TensorProtoView& tensor_proto);
+
+/// <summary>
+/// Copies (and decodes, if necessary) a tensor's data into a buffer.
+/// </summary>
+/// <param name="tensor_proto">The parsed TensorProto</param>
+/// <param name="elem_bit_width">The size of a tensor element in bits</param>
+/// <param name="dst">The destination buffer, which must be exactly the size of the tensor's data</param>
+/// <returns>True on success</returns>
+bool CopyTensorProtoData(const TensorProtoView& tensor_proto, size_t elem_bit_width, Span<char> dst);
+
+/// <summary>
+/// Serializes a tensor as an onnx.TensorProto whose data is stored in raw_data. ParseTensorProto() reads it back.
+/// </summary>
+/// <param name="data_type">onnx.TensorProto.DataType (same values as ONNXTensorElementDataType)</param>
+/// <param name="dims">The tensor's shape</param>
+/// <param name="data">The tensor's data in its in-memory layout</param>
+/// <param name="bytes">Set to the serialized TensorProto</param>
+void SerializeTensorProto(int32_t data_type, Span<const int64_t> dims, Span<const char> data, std::string& bytes);
+
+/// <summary>
+/// Finds the external data files of a serialized onnx.ModelProto, i.e., the "location" of every tensor with external
+/// data in the model's graphs, subgraphs, and functions. The locations are relative to the model's directory.
+/// </summary>
+/// <param name="model_bytes">The serialized ModelProto</param>
+/// <param name="locations">Set to the sorted, unique locations</param>
+/// <returns>True on success</returns>
+bool GetExternalDataLocations(Span<const char> model_bytes, std::vector<std::string>& locations);
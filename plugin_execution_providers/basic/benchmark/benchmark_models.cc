@@ -0,0 +1,199 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "benchmark_models.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <utility>
+
+namespace {
+
+constexpr int kOpsetVersion = 17;
+constexpr size_t kMaxColumns = 1024;
+
+constexpr std::array<std::string_view, 4> kBinaryOps = {"Add", "Sub", "Mul", "Div"};
+constexpr std::array<std::string_view, 3> kUnaryOps = {"Relu", "Sigmoid", "Tanh"};
+
+constexpr std::array<std::pair<BroadcastPattern, const char*>, 4> kBroadcastPatternNames = {{
+    {BroadcastPattern::None, "none"},
+    {BroadcastPattern::Row, "row"},
+    {BroadcastPattern::Column, "column"},
+    {BroadcastPattern::Scalar, "scalar"},
+}};
+
+Ort::ValueInfo CreateFloatValueInfo(const std::string& name, const std::vector<int64_t>& shape) {
+  Ort::TensorTypeAndShapeInfo tensor_info(ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, shape);
+  Ort::TypeInfo type_info = Ort::TypeInfo::CreateTensorInfo(tensor_info.GetConst());
+  return Ort::ValueInfo(name, type_info.GetConst());
+}
+
+size_t GetNumElements(const std::vector<int64_t>& shape) {
+  size_t num_elements = 1;
+  for (int64_t dim : shape) {
+    num_elements *= static_cast<size_t>(dim);
+  }
+
+  return num_elements;
+}
+
+}  // namespace
+
+std::optional<BroadcastPattern> ParseBroadcastPattern(std::string_view name) {
+  for (const auto& [pattern, pattern_name] : kBroadcastPatternNames) {
+    if (name == pattern_name) {
+      return pattern;
+    }
+  }
+
+  return std::nullopt;
+}
+
+const char* GetBroadcastPatternName(BroadcastPattern pattern) {
+  for (const auto& [known_pattern, pattern_name] : kBroadcastPatternNames) {
+    if (pattern == known_pattern) {
+      return pattern_name;
+    }
+  }
+
+  return "unknown";
+}
+
+std::optional<BenchmarkModel> CreateElementwiseChainModel(size_t num_elements, const std::vector<std::string>& ops,
+                                                          BroadcastPattern pattern, /*out*/ std::string& error) {
+  if (num_elements == 0 || (num_elements > kMaxColumns && num_elements % kMaxColumns != 0)) {
+    error = "Elementwise model sizes must be at most " + std::to_string(kMaxColumns) + " or a multiple of it";
+    return std::nullopt;
+  }
+
+  if (ops.empty()) {
+    error = "Op chains must have at least one op";
+    return std::nullopt;
+  }
+
+  bool has_binary_op = false;
+  std::string chain_name;
+  for (const std::string& op : ops) {
+    const bool is_binary = std::find(kBinaryOps.begin(), kBinaryOps.end(), op) != kBinaryOps.end();
+    const bool is_unary = std::find(kUnaryOps.begin(), kUnaryOps.end(), op) != kUnaryOps.end();
+    if (!is_binary && !is_unary) {
+      error = "Unsupported op type " + op + " in op chain";
+      return std::nullopt;
+    }
+
+    has_binary_op |= is_binary;
+    chain_name += (chain_name.empty() ? "" : "+") + op;
+  }
+
+  const int64_t cols = static_cast<int64_t>(std::min(num_elements, kMaxColumns));
+  const int64_t rows = static_cast<int64_t>(num_elements) / cols;
+  const std::vector<int64_t> shape = {rows, cols};
+
+  BenchmarkModel model;
+  model.name = "chain_" + chain_name + "_" + std::to_string(num_elements);
+  model.inputs.push_back({"A", shape});
+  model.output_names.push_back("Y");
+
+  // The second input is only added if an op reads it. Its values are positive, so that Div does not divide by zero.
+  if (has_binary_op) {
+    std::vector<int64_t> b_shape;
+    switch (pattern) {
+      case BroadcastPattern::None:
+        b_shape = shape;
+        break;
+      case BroadcastPattern::Row:
+        b_shape = {cols};
+        break;
+      case BroadcastPattern::Column:
+        b_shape = {rows, 1};
+        break;
+      case BroadcastPattern::Scalar:
+        break;
+    }
+
+    model.name += std::string("_") + GetBroadcastPatternName(pattern);
+    model.inputs.push_back({"B", b_shape, 0.5f, 1.5f});
+  }
+
+  model.flops_per_run = ops.size() * num_elements;
+  for (const BenchmarkInput& input : model.inputs) {
+    model.bytes_per_run += GetNumElements(input.shape) * sizeof(float);
+  }
+
+  model.bytes_per_run += num_elements * sizeof(float);
+
+  model.create_model = [ops, inputs = model.inputs, shape]() {
+    Ort::Graph graph;
+
+    std::vector<Ort::ValueInfo> graph_inputs;
+    for (const BenchmarkInput& input : inputs) {
+      graph_inputs.push_back(CreateFloatValueInfo(input.name, input.shape));
+    }
+
+    std::vector<Ort::ValueInfo> graph_outputs;
+    graph_outputs.push_back(CreateFloatValueInfo("Y", shape));
+    graph.SetInputs(graph_inputs);
+    graph.SetOutputs(graph_outputs);
+
+    std::string previous_output = "A";
+    for (size_t i = 0; i < ops.size(); ++i) {
+      const std::string output = i + 1 == ops.size() ? "Y" : "T" + std::to_string(i);
+      std::vector<std::string> node_inputs = {previous_output};
+      if (std::find(kBinaryOps.begin(), kBinaryOps.end(), ops[i]) != kBinaryOps.end()) {
+        node_inputs.push_back("B");
+      }
+
+      Ort::Node node(ops[i], "", ops[i] + "_" + std::to_string(i), node_inputs, {output});
+      graph.AddNode(node);
+      previous_output = output;
+    }
+
+    Ort::Model ort_model({{"", kOpsetVersion}});
+    ort_model.AddGraph(graph);
+    return ort_model;
+  };
+
+  return model;
+}
+
+BenchmarkModel CreateMatMulModel(int64_t m, int64_t k, int64_t n) {
+  BenchmarkModel model;
+  model.name = "matmul_" + std::to_string(m) + "x" + std::to_string(k) + "x" + std::to_string(n);
+  model.inputs.push_back({"A", {m, k}});
+  model.output_names.push_back("Y");
+  model.flops_per_run = 2 * static_cast<uint64_t>(m) * static_cast<uint64_t>(k) * static_cast<uint64_t>(n);
+  model.bytes_per_run = (static_cast<uint64_t>(m) * static_cast<uint64_t>(k + n)) * sizeof(float);
+
+  model.create_model = [m, k, n]() {
+    Ort::Graph graph;
+
+    std::vector<Ort::ValueInfo> graph_inputs;
+    graph_inputs.push_back(CreateFloatValueInfo("A", {m, k}));
+    std::vector<Ort::ValueInfo> graph_outputs;
+    graph_outputs.push_back(CreateFloatValueInfo("Y", {m, n}));
+    graph.SetInputs(graph_inputs);
+    graph.SetOutputs(graph_outputs);
+
+    // The weight is the same for every session, so that the plugin EP's outputs can be compared with the CPU EP's.
+    const std::vector<int64_t> weight_shape = {k, n};
+    Ort::AllocatorWithDefaultOptions allocator;
+    Ort::Value weight = Ort::Value::CreateTensor<float>(allocator, weight_shape.data(), weight_shape.size());
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    float* weight_data = weight.GetTensorMutableData<float>();
+    std::generate_n(weight_data, GetNumElements(weight_shape), [&]() { return distribution(generator); });
+
+    graph.AddInitializer("W", weight, /*data_is_external*/ false);
+
+    Ort::Node node("MatMul", "", "MatMul_0", {"A", "W"}, {"Y"});
+    graph.AddNode(node);
+
+    Ort::Model ort_model({{"", kOpsetVersion}});
+    ort_model.AddGraph(graph);
+    return ort_model;
+  };
+
+  return model;
+}
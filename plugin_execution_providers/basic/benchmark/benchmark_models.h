@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"
+
+/// <summary>
+/// Shape of the second input of the binary ops in an elementwise chain model, relative to the [rows, cols] shape of
+/// the first input.
+/// </summary>
+enum class BroadcastPattern {
+  None,    // [rows, cols]
+  Row,     // [cols], broadcast to every row.
+  Column,  // [rows, 1], broadcast to every column.
+  Scalar,  // [], broadcast to every element.
+};
+
+std::optional<BroadcastPattern> ParseBroadcastPattern(std::string_view name);
+const char* GetBroadcastPatternName(BroadcastPattern pattern);
+
+/// <summary>
+/// A float32 graph input of a benchmark model. The benchmark fills it with values in [min_value, max_value].
+/// </summary>
+struct BenchmarkInput {
+  std::string name;
+  std::vector<int64_t> shape;
+  float min_value = -1.0f;
+  float max_value = 1.0f;
+};
+
+/// <summary>
+/// A model that the benchmark runs with and without the plugin EP. Models are built in memory with the Model Editor
+/// API instead of being loaded from files, so that any combination of the parameters can be benchmarked.
+/// </summary>
+struct BenchmarkModel {
+  std::string name;
+  std::vector<BenchmarkInput> inputs;
+  std::vector<std::string> output_names;
+  uint64_t flops_per_run = 0;  // Multiply-adds count as two.
+  uint64_t bytes_per_run = 0;  // Bytes of the inputs and outputs. Constant initializers are not counted.
+
+  // Builds a new model. A session takes the model's initializers, so every session is created from a new model.
+  std::function<Ort::Model()> create_model;
+};
+
+/// <summary>
+/// Creates a model that applies a chain of elementwise ops to an input of `num_elements` float32 values, which the
+/// plugin EP fuses into a single kernel.
+/// </summary>
+/// <param name="num_elements">Elements of the first input. Inputs with more than 1024 elements have 1024 columns and
+/// must have a multiple of 1024 elements.</param>
+/// <param name="ops">Op types of the chain: Add, Sub, Mul, Div, Relu, Sigmoid or Tanh. Each op reads the previous
+/// op's output, and the binary ops also read the second input.</param>
+/// <param name="pattern">Shape of the second input</param>
+/// <returns>The model, or std::nullopt with `error` set if the parameters are not supported</returns>
+std::optional<BenchmarkModel> CreateElementwiseChainModel(size_t num_elements, const std::vector<std::string>& ops,
+                                                          BroadcastPattern pattern, /*out*/ std::string& error);
+
+/// <summary>
+/// Creates a model with a MatMul of an [m, k] input and a constant [k, n] weight, which the plugin EP packs when the
+/// session is created.
+/// </summary>
+BenchmarkModel CreateMatMulModel(int64_t m, int64_t k, int64_t n);
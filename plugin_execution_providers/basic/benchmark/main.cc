@@ -0,0 +1,620 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Benchmarks the basic plugin EP against the stock CPU EP over a parameterized set of models, and reports latency
+// percentiles, throughput, session creation time and memory as a table and, optionally, as a JSON file.
+//
+// Usage: basic_plugin_ep_benchmark --ep_library <path to the plugin EP library> [options]. See PrintUsage().
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+#include "benchmark_models.h"
+#include "onnxruntime_cxx_api.h"
+
+namespace {
+
+constexpr const char* kDefaultEpName = "BasicPluginExecutionProvider";
+constexpr const char* kEpRegistrationName = "basic_ep_benchmark_registration";
+
+struct Options {
+  std::string ep_library;
+  std::string ep_name = kDefaultEpName;
+  std::unordered_map<std::string, std::string> ep_options;
+  std::vector<size_t> sizes = {1024, 262144, 4194304};
+  std::vector<std::vector<std::string>> chains = {{"Add"}, {"Mul", "Add", "Relu"}, {"Sub", "Div", "Sigmoid", "Tanh"}};
+  std::vector<BroadcastPattern> patterns = {BroadcastPattern::None, BroadcastPattern::Row, BroadcastPattern::Column,
+                                            BroadcastPattern::Scalar};
+  std::vector<size_t> matmul_sizes = {128, 512, 1024};
+  size_t warmup = 5;
+  size_t runs = 50;
+  std::string output_file;
+};
+
+struct LatencyStats {
+  double min_ms = 0.0;
+  double mean_ms = 0.0;
+  double p50_ms = 0.0;
+  double p90_ms = 0.0;
+  double p99_ms = 0.0;
+  double max_ms = 0.0;
+};
+
+struct ProcessMemory {
+  uint64_t resident_bytes = 0;       // Zero if the platform is not supported.
+  uint64_t peak_resident_bytes = 0;  // Since the process started, or since ResetPeakResidentMemory().
+};
+
+struct BenchmarkResult {
+  std::string model;
+  std::string ep;
+  double session_creation_ms = 0.0;
+  LatencyStats latency;
+  double gflops = 0.0;               // Per second, at the median latency.
+  double gbytes_per_second = 0.0;    // Bytes of the inputs and outputs per second, at the median latency.
+  int64_t session_memory_bytes = 0;  // Resident memory that the session creation added.
+  int64_t run_memory_bytes = 0;      // Resident memory that the warmup runs added to the session's.
+  std::optional<int64_t> session_peak_bytes;  // Peak resident memory that the session added. Not set if unknown.
+  uint64_t process_peak_resident_bytes = 0;   // High-water mark of the process, including earlier sessions.
+  std::optional<double> max_abs_diff;  // Largest difference from the CPU EP's outputs. Not set for the CPU EP.
+};
+
+void PrintUsage() {
+  std::cout
+      << "Usage: basic_plugin_ep_benchmark --ep_library <path> [options]\n"
+         "\n"
+         "Options:\n"
+         "  --ep_library <path>        Plugin EP library to register. Required.\n"
+         "  --ep_name <name>           EP name of the devices to select (default: "
+      << kDefaultEpName
+      << ").\n"
+         "  --ep_option <key>=<value>  EP option for the plugin EP's sessions. May be repeated.\n"
+         "  --sizes <n,...>            Elements of the elementwise models (default: 1024,262144,4194304).\n"
+         "  --chains <op+op,...>       Elementwise op chains of Add, Sub, Mul, Div, Relu, Sigmoid and Tanh\n"
+         "                             (default: Add,Mul+Add+Relu,Sub+Div+Sigmoid+Tanh).\n"
+         "  --broadcast <pattern,...>  Shapes of the binary ops' second input: none, row, column or scalar\n"
+         "                             (default: none,row,column,scalar).\n"
+         "  --matmul_sizes <n,...>     Sizes of the square MatMul models, or empty for none (default: 128,512,1024).\n"
+         "  --warmup <n>               Runs before the measured runs (default: 5).\n"
+         "  --runs <n>                 Measured runs (default: 50).\n"
+         "  --output <path>            JSON file for the results.\n";
+}
+
+std::vector<std::string> Split(std::string_view str, char separator) {
+  std::vector<std::string> parts;
+  size_t begin = 0;
+  while (begin <= str.size()) {
+    const size_t end = std::min(str.find(separator, begin), str.size());
+    if (end > begin) {
+      parts.emplace_back(str.substr(begin, end - begin));
+    }
+
+    begin = end + 1;
+  }
+
+  return parts;
+}
+
+bool ParseSize(const std::string& str, /*out*/ size_t& value) {
+  if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+
+  value = static_cast<size_t>(std::stoull(str));
+  return true;
+}
+
+bool ParseSizes(const std::string& str, /*out*/ std::vector<size_t>& values) {
+  values.clear();
+  for (const std::string& part : Split(str, ',')) {
+    size_t value = 0;
+    if (!ParseSize(part, value) || value == 0) {
+      return false;
+    }
+
+    values.push_back(value);
+  }
+
+  return true;
+}
+
+// Parses the command line. Returns false after printing an error or the usage.
+bool ParseOptions(int argc, char** argv, /*out*/ Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      PrintUsage();
+      return false;
+    }
+
+    if (i + 1 >= argc) {
+      std::cerr << "Missing value for " << arg << "\n";
+      return false;
+    }
+
+    const std::string value = argv[++i];
+    bool is_valid = true;
+
+    if (arg == "--ep_library") {
+      options.ep_library = value;
+    } else if (arg == "--ep_name") {
+      options.ep_name = value;
+    } else if (arg == "--ep_option") {
+      const size_t separator = value.find('=');
+      is_valid = separator != std::string::npos && separator > 0;
+      if (is_valid) {
+        options.ep_options[value.substr(0, separator)] = value.substr(separator + 1);
+      }
+    } else if (arg == "--sizes") {
+      is_valid = ParseSizes(value, options.sizes);
+    } else if (arg == "--chains") {
+      options.chains.clear();
+      for (const std::string& chain : Split(value, ',')) {
+        options.chains.push_back(Split(chain, '+'));
+      }
+    } else if (arg == "--broadcast") {
+      options.patterns.clear();
+      for (const std::string& name : Split(value, ',')) {
+        std::optional<BroadcastPattern> pattern = ParseBroadcastPattern(name);
+        is_valid = is_valid && pattern.has_value();
+        if (pattern.has_value()) {
+          options.patterns.push_back(*pattern);
+        }
+      }
+    } else if (arg == "--matmul_sizes") {
+      is_valid = ParseSizes(value, options.matmul_sizes);
+    } else if (arg == "--warmup") {
+      is_valid = ParseSize(value, options.warmup);
+    } else if (arg == "--runs") {
+      is_valid = ParseSize(value, options.runs) && options.runs > 0;
+    } else if (arg == "--output") {
+      options.output_file = value;
+    } else {
+      std::cerr << "Unknown option " << arg << "\n";
+      PrintUsage();
+      return false;
+    }
+
+    if (!is_valid) {
+      std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+      return false;
+    }
+  }
+
+  if (options.ep_library.empty()) {
+    std::cerr << "--ep_library is required\n";
+    PrintUsage();
+    return false;
+  }
+
+  return true;
+}
+
+ProcessMemory GetProcessMemory() {
+  ProcessMemory memory;
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters = {};
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    memory.resident_bytes = counters.WorkingSetSize;
+    memory.peak_resident_bytes = counters.PeakWorkingSetSize;
+  }
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info = {};
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+      KERN_SUCCESS) {
+    memory.resident_bytes = info.resident_size;
+    memory.peak_resident_bytes = info.resident_size_max;
+  }
+#elif defined(__linux__)
+  // VmRSS and VmHWM are reported in kB.
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    uint64_t kilobytes = 0;
+    fields >> key >> kilobytes;
+    if (key == "VmRSS:") {
+      memory.resident_bytes = kilobytes * 1024;
+    } else if (key == "VmHWM:") {
+      memory.peak_resident_bytes = kilobytes * 1024;
+    }
+  }
+#endif
+  return memory;
+}
+
+// Resets the process's peak resident memory to its current resident memory, so that the next peak only covers what
+// follows. Returns false if the platform does not support it (only Linux resets VmHWM, see proc(5)).
+bool ResetPeakResidentMemory() {
+#if defined(__linux__)
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+  clear_refs.flush();
+  return static_cast<bool>(clear_refs);
+#else
+  return false;
+#endif
+}
+
+// Nearest-rank percentiles of the latencies.
+LatencyStats GetLatencyStats(std::vector<double> latencies_ms) {
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+
+  auto percentile = [&latencies_ms](double p) {
+    const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(latencies_ms.size())));
+    return latencies_ms[std::clamp<size_t>(rank, 1, latencies_ms.size()) - 1];
+  };
+
+  LatencyStats stats;
+  stats.min_ms = latencies_ms.front();
+  stats.max_ms = latencies_ms.back();
+  stats.p50_ms = percentile(50.0);
+  stats.p90_ms = percentile(90.0);
+  stats.p99_ms = percentile(99.0);
+
+  for (double latency_ms : latencies_ms) {
+    stats.mean_ms += latency_ms;
+  }
+
+  stats.mean_ms /= static_cast<double>(latencies_ms.size());
+  return stats;
+}
+
+double GetElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// <summary>
+/// Runs the sessions of the benchmark. Inputs are generated once per model, so that every EP gets the same data.
+/// </summary>
+class Benchmark {
+ public:
+  Benchmark(Ort::Env& env, const Options& options, std::vector<Ort::ConstEpDevice> ep_devices)
+      : env_(env), options_(options), ep_devices_(std::move(ep_devices)) {}
+
+  // Benchmarks a model with the CPU EP and then with the plugin EP, and appends the results.
+  void Run(const BenchmarkModel& model, /*out*/ std::vector<BenchmarkResult>& results) {
+    CreateInputs(model);
+
+    std::vector<std::vector<float>> cpu_outputs;
+    results.push_back(RunSession(model, /*use_plugin_ep*/ false, cpu_outputs));
+
+    std::vector<std::vector<float>> ep_outputs;
+    BenchmarkResult ep_result = RunSession(model, /*use_plugin_ep*/ true, ep_outputs);
+
+    if (cpu_outputs.size() != ep_outputs.size()) {
+      throw std::runtime_error("Model " + model.name + ": the plugin EP produced " +
+                               std::to_string(ep_outputs.size()) + " outputs instead of " +
+                               std::to_string(cpu_outputs.size()));
+    }
+
+    double max_abs_diff = 0.0;
+    for (size_t i = 0; i < cpu_outputs.size(); ++i) {
+      if (cpu_outputs[i].size() != ep_outputs[i].size()) {
+        throw std::runtime_error("Model " + model.name + ": output " + std::to_string(i) + " of the plugin EP has " +
+                                 std::to_string(ep_outputs[i].size()) + " elements instead of " +
+                                 std::to_string(cpu_outputs[i].size()));
+      }
+
+      for (size_t j = 0; j < cpu_outputs[i].size(); ++j) {
+        max_abs_diff = std::max(max_abs_diff, static_cast<double>(std::fabs(cpu_outputs[i][j] - ep_outputs[i][j])));
+      }
+    }
+
+    ep_result.max_abs_diff = max_abs_diff;
+    results.push_back(std::move(ep_result));
+  }
+
+ private:
+  void CreateInputs(const BenchmarkModel& model) {
+    std::mt19937 generator(0);
+    input_data_.clear();
+
+    for (const BenchmarkInput& input : model.inputs) {
+      size_t num_elements = 1;
+      for (int64_t dim : input.shape) {
+        num_elements *= static_cast<size_t>(dim);
+      }
+
+      std::uniform_real_distribution<float> distribution(input.min_value, input.max_value);
+      std::vector<float>& data = input_data_.emplace_back(num_elements);
+      std::generate(data.begin(), data.end(), [&]() { return distribution(generator); });
+    }
+  }
+
+  // Creates a session for the model, runs it, and copies its outputs to `outputs`.
+  BenchmarkResult RunSession(const BenchmarkModel& model, bool use_plugin_ep,
+                             /*out*/ std::vector<std::vector<float>>& outputs) {
+    BenchmarkResult result;
+    result.model = model.name;
+    result.ep = use_plugin_ep ? options_.ep_name : "CPUExecutionProvider";
+
+    Ort::SessionOptions session_options;
+    if (use_plugin_ep) {
+      session_options.AppendExecutionProvider_V2(env_, ep_devices_, options_.ep_options);
+    }
+
+    // The model is built before the timer starts, so the creation time covers graph optimization, partitioning and
+    // kernel compilation. The plugin EP reuses the kernels of identical subgraphs that earlier sessions compiled.
+    Ort::Model ort_model = model.create_model();
+
+    // The process's peak only covers this session if it was reset, or if the session raised it.
+    const bool peak_was_reset = ResetPeakResidentMemory();
+    const ProcessMemory memory_before = GetProcessMemory();
+    auto start = std::chrono::steady_clock::now();
+    Ort::Session session(env_, ort_model, session_options);
+    result.session_creation_ms = GetElapsedMs(start);
+    const ProcessMemory memory_after_creation = GetProcessMemory();
+
+    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    std::vector<const char*> input_names;
+    std::vector<Ort::Value> input_values;
+    for (size_t i = 0; i < model.inputs.size(); ++i) {
+      const BenchmarkInput& input = model.inputs[i];
+      input_names.push_back(input.name.c_str());
+      input_values.push_back(Ort::Value::CreateTensor<float>(memory_info, input_data_[i].data(), input_data_[i].size(),
+                                                             input.shape.data(), input.shape.size()));
+    }
+
+    std::vector<const char*> output_names;
+    for (const std::string& output_name : model.output_names) {
+      output_names.push_back(output_name.c_str());
+    }
+
+    auto run = [&]() {
+      return session.Run(Ort::RunOptions{nullptr}, input_names.data(), input_values.data(), input_values.size(),
+                         output_names.data(), output_names.size());
+    };
+
+    std::vector<Ort::Value> output_values;
+    for (size_t i = 0; i < options_.warmup; ++i) {
+      output_values = run();
+    }
+
+    const ProcessMemory memory_after_warmup = GetProcessMemory();
+
+    std::vector<double> latencies_ms;
+    latencies_ms.reserve(options_.runs);
+    for (size_t i = 0; i < options_.runs; ++i) {
+      start = std::chrono::steady_clock::now();
+      output_values = run();
+      latencies_ms.push_back(GetElapsedMs(start));
+    }
+
+    result.latency = GetLatencyStats(std::move(latencies_ms));
+    result.gflops = static_cast<double>(model.flops_per_run) / (result.latency.p50_ms * 1e6);
+    result.gbytes_per_second = static_cast<double>(model.bytes_per_run) / (result.latency.p50_ms * 1e6);
+    result.session_memory_bytes = static_cast<int64_t>(memory_after_creation.resident_bytes) -
+                                  static_cast<int64_t>(memory_before.resident_bytes);
+    result.run_memory_bytes = static_cast<int64_t>(memory_after_warmup.resident_bytes) -
+                              static_cast<int64_t>(memory_after_creation.resident_bytes);
+
+    const ProcessMemory memory_after_runs = GetProcessMemory();
+    if (peak_was_reset || memory_after_runs.peak_resident_bytes > memory_before.peak_resident_bytes) {
+      result.session_peak_bytes = static_cast<int64_t>(memory_after_runs.peak_resident_bytes) -
+                                  static_cast<int64_t>(memory_before.resident_bytes);
+    }
+
+    result.process_peak_resident_bytes = memory_after_runs.peak_resident_bytes;
+
+    outputs.clear();
+    for (Ort::Value& output_value : output_values) {
+      const float* data = output_value.GetTensorData<float>();
+      outputs.emplace_back(data, data + output_value.GetTensorTypeAndShapeInfo().GetElementCount());
+    }
+
+    return result;
+  }
+
+  Ort::Env& env_;
+  const Options& options_;
+  std::vector<Ort::ConstEpDevice> ep_devices_;
+  std::vector<std::vector<float>> input_data_;
+};
+
+// Creates the models for every combination of the options. Chains without binary ops do not depend on the broadcast
+// pattern and are created once per size.
+bool CreateModels(const Options& options, /*out*/ std::vector<BenchmarkModel>& models) {
+  std::set<std::string> model_names;
+
+  for (size_t size : options.sizes) {
+    for (const std::vector<std::string>& chain : options.chains) {
+      for (BroadcastPattern pattern : options.patterns) {
+        std::string error;
+        std::optional<BenchmarkModel> model = CreateElementwiseChainModel(size, chain, pattern, error);
+        if (!model.has_value()) {
+          std::cerr << error << "\n";
+          return false;
+        }
+
+        if (model_names.insert(model->name).second) {
+          models.push_back(std::move(*model));
+        }
+      }
+    }
+  }
+
+  for (size_t size : options.matmul_sizes) {
+    const int64_t dim = static_cast<int64_t>(size);
+    models.push_back(CreateMatMulModel(dim, dim, dim));
+  }
+
+  return true;
+}
+
+std::string EscapeJson(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      std::ostringstream code;
+      code << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+      escaped += code.str();
+    } else {
+      escaped += c;
+    }
+  }
+
+  return escaped;
+}
+
+// Writes the results as a JSON document, with one object per model and EP.
+void WriteJson(std::ostream& out, const Options& options, const std::vector<BenchmarkResult>& results) {
+  out << std::setprecision(6);
+  out << "{\n";
+  out << "  \"ort_version\": \"" << EscapeJson(Ort::GetVersionString()) << "\",\n";
+  out << "  \"ep_name\": \"" << EscapeJson(options.ep_name) << "\",\n";
+
+  // Sorted, so that the documents of different runs can be compared line by line.
+  const std::map<std::string, std::string> ep_options(options.ep_options.begin(), options.ep_options.end());
+  out << "  \"ep_options\": {";
+  for (auto it = ep_options.begin(); it != ep_options.end(); ++it) {
+    out << (it == ep_options.begin() ? "" : ", ") << "\"" << EscapeJson(it->first) << "\": \""
+        << EscapeJson(it->second) << "\"";
+  }
+
+  out << "},\n";
+  out << "  \"warmup\": " << options.warmup << ",\n";
+  out << "  \"runs\": " << options.runs << ",\n";
+  out << "  \"results\": [\n";
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    out << "    {\"model\": \"" << EscapeJson(result.model) << "\", \"ep\": \"" << EscapeJson(result.ep) << "\", "
+        << "\"session_creation_ms\": " << result.session_creation_ms << ", "
+        << "\"latency_ms\": {\"min\": " << result.latency.min_ms << ", \"mean\": " << result.latency.mean_ms
+        << ", \"p50\": " << result.latency.p50_ms << ", \"p90\": " << result.latency.p90_ms
+        << ", \"p99\": " << result.latency.p99_ms << ", \"max\": " << result.latency.max_ms << "}, "
+        << "\"gflops\": " << result.gflops << ", \"gbytes_per_second\": " << result.gbytes_per_second << ", "
+        << "\"session_memory_bytes\": " << result.session_memory_bytes << ", "
+        << "\"run_memory_bytes\": " << result.run_memory_bytes << ", "
+        << "\"process_peak_resident_bytes\": " << result.process_peak_resident_bytes;
+
+    if (result.session_peak_bytes.has_value()) {
+      out << ", \"session_peak_bytes\": " << *result.session_peak_bytes;
+    }
+
+    if (result.max_abs_diff.has_value()) {
+      out << ", \"max_abs_diff\": " << *result.max_abs_diff;
+    }
+
+    out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+
+  out << "  ]\n";
+  out << "}\n";
+}
+
+void PrintResult(const BenchmarkResult& result) {
+  std::cout << std::left << std::setw(44) << result.model << std::setw(30) << result.ep << std::right << std::fixed
+            << std::setprecision(2) << std::setw(10) << result.session_creation_ms << std::setprecision(3)
+            << std::setw(10) << result.latency.p50_ms << std::setw(10) << result.latency.p90_ms << std::setw(10)
+            << result.latency.p99_ms << std::setprecision(1) << std::setw(9) << result.gflops << std::setw(9)
+            << result.gbytes_per_second << std::setw(10)
+            << static_cast<double>(result.session_memory_bytes + result.run_memory_bytes) / (1024.0 * 1024.0);
+
+  if (result.max_abs_diff.has_value()) {
+    std::cout << std::scientific << std::setprecision(2) << std::setw(11) << *result.max_abs_diff;
+  }
+
+  std::cout << std::defaultfloat << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+
+  std::vector<BenchmarkModel> models;
+  if (!CreateModels(options, models)) {
+    return EXIT_FAILURE;
+  }
+
+  try {
+    Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "basic_plugin_ep_benchmark");
+    const std::filesystem::path ep_library_path(options.ep_library);
+    env.RegisterExecutionProviderLibrary(kEpRegistrationName, ep_library_path.native());
+
+    std::vector<BenchmarkResult> results;
+    {
+      std::vector<Ort::ConstEpDevice> ep_devices;
+      for (Ort::ConstEpDevice ep_device : env.GetEpDevices()) {
+        if (options.ep_name == ep_device.EpName()) {
+          ep_devices.push_back(ep_device);
+        }
+      }
+
+      if (ep_devices.empty()) {
+        std::cerr << "No devices found for EP " << options.ep_name << "\n";
+        env.UnregisterExecutionProviderLibrary(kEpRegistrationName);
+        return EXIT_FAILURE;
+      }
+
+      std::cout << std::left << std::setw(44) << "model" << std::setw(30) << "EP" << std::right << std::setw(10)
+                << "create ms" << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms"
+                << std::setw(9) << "GFLOP/s" << std::setw(9) << "GB/s" << std::setw(10) << "mem MiB" << std::setw(11)
+                << "max diff"
+                << "\n";
+
+      Benchmark benchmark(env, options, std::move(ep_devices));
+      for (const BenchmarkModel& model : models) {
+        const size_t first_result = results.size();
+        benchmark.Run(model, results);
+        for (size_t i = first_result; i < results.size(); ++i) {
+          PrintResult(results[i]);
+        }
+      }
+    }
+
+    // Must only unregister a library after all sessions that use the library have been released.
+    env.UnregisterExecutionProviderLibrary(kEpRegistrationName);
+
+    if (!options.output_file.empty()) {
+      std::ofstream output_file(options.output_file);
+      WriteJson(output_file, options, results);
+      if (!output_file) {
+        std::cerr << "Unable to write " << options.output_file << "\n";
+        return EXIT_FAILURE;
+      }
+    }
+  } catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+from pathlib import Path
+import sys
+
+import onnx
+from onnxscript import script, FLOAT, opset15 as op
+
+# Shape of the tensors in the chain and multi-output models. Large enough that the intermediate tensors do not fit in the cache.
+N = 2048
+
+def gen_elementwise_chain_model(model_path: Path):
+    # Chain of unary and binary ops that the EP fuses into one node. Only the output is written to memory.
+    @script(default_opset=op)
+    def model(x: FLOAT[N, N], y: FLOAT[N, N]) -> FLOAT[N, N]:
+        a = op.Sigmoid(x * y)
+        b = op.Tanh(a + x)
+        c = op.Relu(b - y)
+        return op.Clip(c / (a + y), op.Constant(value_float=0.0), op.Constant(value_float=6.0))
+
+    model_proto = model.to_model_proto()
+    onnx.save(model_proto, model_path)
+
+def gen_elementwise_multi_output_model(model_path: Path):
+    # DAG with a shared intermediate and two outputs.
+    @script(default_opset=op)
+    def model(x: FLOAT[N, N], y: FLOAT[N, N], z: FLOAT[N, N]) -> (FLOAT[N, N], FLOAT[N, N]):
+        s = op.Cast(x + y, to=onnx.TensorProto.FLOAT)
+        out0 = op.Relu(s * z)
+        out1 = op.Sigmoid(s - z)
+        return out0, out1
+
+    model_proto = model.to_model_proto()
+    onnx.save(model_proto, model_path)
+
+def gen_elementwise_broadcast_model(model_path: Path):
+    # Per-channel scale and bias (broadcast along the inner dimensions) followed by a scalar clamp.
+    @script(default_opset=op)
+    def model(x: FLOAT[8, 64, 56, 56], scale: FLOAT[1, 64, 1, 1], bias: FLOAT[64, 1, 1]) -> FLOAT[8, 64, 56, 56]:
+        return op.Relu(x * scale + bias)
+
+    model_proto = model.to_model_proto()
+    onnx.save(model_proto, model_path)
+
+def gen_elementwise_tiny_model(model_path: Path):
+    # The chain model's ops on tensors so small that the run time is dominated by the per-run overhead of the kernel.
+    @script(default_opset=op)
+    def model(x: FLOAT[1, 16], y: FLOAT[1, 16]) -> FLOAT[1, 16]:
+        a = op.Sigmoid(x * y)
+        b = op.Tanh(a + x)
+        c = op.Relu(b - y)
+        return op.Clip(c / (a + y), op.Constant(value_float=0.0), op.Constant(value_float=6.0))
+
+    model_proto = model.to_model_proto()
+    onnx.save(model_proto, model_path)
+
+if __name__ == "__main__":
+    assert len(sys.argv) == 2, "Usage: gen_elementwise_model.py OUTPUT_DIR"
+    output_dir = Path(sys.argv[1])
+    gen_elementwise_chain_model(output_dir / "elementwise_chain.onnx")
+    gen_elementwise_multi_output_model(output_dir / "elementwise_multi_output.onnx")
+    gen_elementwise_broadcast_model(output_dir / "elementwise_broadcast.onnx")
+    gen_elementwise_tiny_model(output_dir / "elementwise_tiny.onnx")
@@ -0,0 +1,63 @@
+from pathlib import Path
+import argparse
+
+import numpy as np
+import onnx
+from onnx import TensorProto, helper, numpy_helper
+
+# Sizes of the square MatMul models in the benchmark sweep.
+SWEEP_SIZES = [64, 128, 256, 512, 1024, 2048, 4096]
+
+def save_model(graph: onnx.GraphProto, model_path: Path):
+    model_proto = helper.make_model(graph, opset_imports=[helper.make_opsetid("", 15)])
+    onnx.checker.check_model(model_proto)
+    onnx.save(model_proto, model_path)
+
+def gen_matmul_model(model_path: Path, m: int, k: int, n: int, rng: np.random.Generator):
+    # Y = X * W with a constant W, which the EP packs when the session is created.
+    w = numpy_helper.from_array(rng.standard_normal((k, n), dtype=np.float32), "W")
+    graph = helper.make_graph(
+        [helper.make_node("MatMul", ["X", "W"], ["Y"])],
+        "matmul",
+        [helper.make_tensor_value_info("X", TensorProto.FLOAT, [m, k])],
+        [helper.make_tensor_value_info("Y", TensorProto.FLOAT, [m, n])],
+        [w])
+    save_model(graph, model_path)
+
+def gen_batched_matmul_model(model_path: Path, rng: np.random.Generator):
+    # MatMul with a 3D input and a dynamic batch dimension. The EP flattens the leading dimensions into rows.
+    w = numpy_helper.from_array(rng.standard_normal((256, 512), dtype=np.float32), "W")
+    graph = helper.make_graph(
+        [helper.make_node("MatMul", ["X", "W"], ["Y"])],
+        "batched_matmul",
+        [helper.make_tensor_value_info("X", TensorProto.FLOAT, ["batch", 128, 256])],
+        [helper.make_tensor_value_info("Y", TensorProto.FLOAT, ["batch", 128, 512])],
+        [w])
+    save_model(graph, model_path)
+
+def gen_gemm_bias_model(model_path: Path, rng: np.random.Generator):
+    # Gemm with a transposed constant B, alpha, beta and a bias that is broadcast to every row. Followed by a Relu,
+    # which the EP fuses separately.
+    w = numpy_helper.from_array(rng.standard_normal((384, 512), dtype=np.float32), "W")
+    bias = numpy_helper.from_array(rng.standard_normal((384,), dtype=np.float32), "bias")
+    graph = helper.make_graph(
+        [helper.make_node("Gemm", ["X", "W", "bias"], ["G"], transB=1, alpha=0.5, beta=2.0),
+         helper.make_node("Relu", ["G"], ["Y"])],
+        "gemm_bias",
+        [helper.make_tensor_value_info("X", TensorProto.FLOAT, [256, 512])],
+        [helper.make_tensor_value_info("Y", TensorProto.FLOAT, [256, 384])],
+        [w, bias])
+    save_model(graph, model_path)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Generate MatMul/Gemm models with constant weights.")
+    parser.add_argument("output_dir", type=Path)
+    parser.add_argument("--sizes", type=int, nargs="+", default=SWEEP_SIZES, help="Sizes of the square MatMul models")
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(0)
+    for size in args.sizes:
+        gen_matmul_model(args.output_dir / f"matmul_{size}.onnx", size, size, size, rng)
+
+    gen_batched_matmul_model(args.output_dir / "matmul_batched.onnx", rng)
+    gen_gemm_bias_model(args.output_dir / "gemm_bias.onnx", rng)
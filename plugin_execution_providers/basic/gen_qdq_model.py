@@ -0,0 +1,83 @@
+from pathlib import Path
+import argparse
+
+import numpy as np
+import onnx
+from onnx import TensorProto, helper, numpy_helper
+
+# Sizes of the square QDQ MatMul models in the benchmark sweep.
+SWEEP_SIZES = [256, 1024]
+
+# Shape of the elementwise QDQ models.
+ELEMENTWISE_SHAPE = [4096, 1024]
+
+def save_model(graph: onnx.GraphProto, model_path: Path):
+    model_proto = helper.make_model(graph, opset_imports=[helper.make_opsetid("", 13)])
+    onnx.checker.check_model(model_proto)
+    onnx.save(model_proto, model_path)
+
+def quant_params(name: str, scale: float, zero_point: int, dtype: type) -> list[onnx.TensorProto]:
+    # Per-tensor scale and zero point, as scalar initializers.
+    return [numpy_helper.from_array(np.array(scale, dtype=np.float32), f"{name}_scale"),
+            numpy_helper.from_array(np.array(zero_point, dtype=dtype), f"{name}_zero_point")]
+
+def gen_qdq_node_unit_model(model_path: Path, op_type: str, a_shape: list, b: np.ndarray | list,
+                            a_params: tuple, b_params: tuple, y_params: tuple, y_shape: list):
+    # DequantizeLinear -> op -> QuantizeLinear with quantized graph inputs and outputs, so that only the quantized
+    # tensors move through memory. `b` is either a constant or the shape of a second graph input.
+    # Each params tuple is (scale, zero point, numpy type).
+    tensor_types = {np.uint8: TensorProto.UINT8, np.int8: TensorProto.INT8}
+    initializers = quant_params("A", *a_params) + quant_params("B", *b_params) + quant_params("Y", *y_params)
+    inputs = [helper.make_tensor_value_info("A", tensor_types[a_params[2]], a_shape)]
+
+    if isinstance(b, np.ndarray):
+        initializers.append(numpy_helper.from_array(b, "B"))
+    else:
+        inputs.append(helper.make_tensor_value_info("B", tensor_types[b_params[2]], b))
+
+    graph = helper.make_graph(
+        [helper.make_node("DequantizeLinear", ["A", "A_scale", "A_zero_point"], ["A_float"]),
+         helper.make_node("DequantizeLinear", ["B", "B_scale", "B_zero_point"], ["B_float"]),
+         helper.make_node(op_type, ["A_float", "B_float"], ["Y_float"]),
+         helper.make_node("QuantizeLinear", ["Y_float", "Y_scale", "Y_zero_point"], ["Y"])],
+        f"qdq_{op_type.lower()}",
+        inputs,
+        [helper.make_tensor_value_info("Y", tensor_types[y_params[2]], y_shape)],
+        initializers)
+    save_model(graph, model_path)
+
+def gen_matmul_model(model_path: Path, a_shape: list, k: int, n: int, rng: np.random.Generator):
+    # uint8 A times a constant int8 B, which the EP packs when the session is created. A in [-2, 2] and B in [-1, 1].
+    # The output scale covers about 4 standard deviations (sqrt(K) * 2 / 3) of the sums of products.
+    b = rng.integers(-127, 128, (k, n), dtype=np.int8)
+    y_scale = 4.0 * np.sqrt(k) * (2.0 / 3.0) / 127.0
+    gen_qdq_node_unit_model(model_path, "MatMul", a_shape, b,
+                            (1.0 / 64.0, 128, np.uint8), (1.0 / 127.0, 0, np.int8), (y_scale, 128, np.uint8),
+                            a_shape[:-1] + [n])
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Generate QDQ Add/Mul/MatMul models with quantized inputs/outputs.")
+    parser.add_argument("output_dir", type=Path)
+    parser.add_argument("--sizes", type=int, nargs="+", default=SWEEP_SIZES, help="Sizes of the square MatMul models")
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(0)
+
+    # uint8 inputs in [-6.4, 6.4], and their sum.
+    gen_qdq_node_unit_model(args.output_dir / "qdq_add.onnx", "Add", ELEMENTWISE_SHAPE, ELEMENTWISE_SHAPE,
+                            (0.05, 128, np.uint8), (0.05, 128, np.uint8), (0.1, 128, np.uint8), ELEMENTWISE_SHAPE)
+
+    # int8 inputs in [-6.4, 6.4], and their product.
+    gen_qdq_node_unit_model(args.output_dir / "qdq_mul.onnx", "Mul", ELEMENTWISE_SHAPE, ELEMENTWISE_SHAPE,
+                            (0.05, 0, np.int8), (0.05, 0, np.int8), (0.35, 0, np.int8), ELEMENTWISE_SHAPE)
+
+    # int8 input times a constant scalar, which is broadcast.
+    gen_qdq_node_unit_model(args.output_dir / "qdq_mul_scalar.onnx", "Mul", ELEMENTWISE_SHAPE,
+                            np.array(-100, dtype=np.int8), (0.05, 0, np.int8), (0.01, 0, np.int8),
+                            (0.05, 0, np.int8), ELEMENTWISE_SHAPE)
+
+    for size in args.sizes:
+        gen_matmul_model(args.output_dir / f"qdq_matmul_{size}.onnx", [size, size], size, size, rng)
+
+    # MatMul with a 3D input and a dynamic batch dimension. The EP flattens the leading dimensions into rows.
+    gen_matmul_model(args.output_dir / "qdq_matmul_batched.onnx", ["batch", 128, 256], 256, 512, rng)
@@ -0,0 +1,120 @@
+import argparse
+import os
+import statistics
+import tempfile
+import time
+
+import numpy as np
+import onnxruntime as ort
+import onnxruntime_ep_basic as basic_ep
+
+# Compares the basic plugin EP's fused elementwise kernel with the stock CPU EP, and the plugin EP's session creation
+# time from the original model (cold start) with the time from an EPContext model (warm start).
+# Generate the models with `gen_elementwise_model.py` first.
+
+def create_session(model_path: str, use_plugin_ep: bool, config_entries: dict | None = None) -> ort.InferenceSession:
+    sess_options = ort.SessionOptions()
+    for key, value in (config_entries or {}).items():
+        sess_options.add_session_config_entry(key, value)
+
+    if use_plugin_ep:
+        ep_name = basic_ep.get_ep_names()[0]
+        selected_ep_devices = [ep_device for ep_device in ort.get_ep_devices() if ep_device.ep_name == ep_name]
+        assert len(selected_ep_devices) > 0
+        sess_options.add_provider_for_devices(selected_ep_devices, {})
+
+        return ort.InferenceSession(model_path, sess_options=sess_options)
+
+    return ort.InferenceSession(model_path, sess_options=sess_options, providers=["CPUExecutionProvider"])
+
+def benchmark(sess: ort.InferenceSession, feeds: dict, warmup: int, runs: int) -> list[float]:
+    for _ in range(warmup):
+        sess.run([], feeds)
+
+    latencies_ms = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        sess.run([], feeds)
+        latencies_ms.append((time.perf_counter() - start) * 1000.0)
+
+    return latencies_ms
+
+def benchmark_session_creation(model_path: str, runs: int) -> list[float]:
+    creation_times_ms = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        sess = create_session(model_path, use_plugin_ep=True)
+        creation_times_ms.append((time.perf_counter() - start) * 1000.0)
+        del sess
+
+    return creation_times_ms
+
+def create_ep_context_model(model_path: str, ep_context_model_path: str, embed_mode: bool):
+    # The EP writes its compiled kernels into EPContext nodes, and ORT saves the model with these nodes.
+    config_entries = {
+        "ep.context_enable": "1",
+        "ep.context_file_path": ep_context_model_path,
+        "ep.context_embed_mode": "1" if embed_mode else "0",
+    }
+    sess = create_session(model_path, use_plugin_ep=True, config_entries=config_entries)
+    del sess
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark the basic plugin EP against the CPU EP.")
+    parser.add_argument("models", nargs="+", help="Paths to models generated by gen_elementwise_model.py")
+    parser.add_argument("--warmup", type=int, default=3, help="Number of warmup runs")
+    parser.add_argument("--runs", type=int, default=20, help="Number of measured runs")
+    parser.add_argument("--session_runs", type=int, default=5, help="Number of measured session creations")
+    parser.add_argument("--embed_ep_context", action="store_true",
+                        help="Embed the compiled kernels in the EPContext model instead of writing separate files")
+    args = parser.parse_args()
+
+    ep_registration_name = "basic_ep_registration"
+    ort.register_execution_provider_library(ep_registration_name, basic_ep.get_library_path())
+
+    for model_path in args.models:
+        rng = np.random.default_rng(0)
+        feeds = None
+        results = {}
+
+        for name, use_plugin_ep in (("CPU EP", False), ("Basic plugin EP", True)):
+            sess = create_session(model_path, use_plugin_ep)
+            if feeds is None:
+                feeds = {
+                    input.name: rng.standard_normal(input.shape, dtype=np.float32) for input in sess.get_inputs()
+                }
+
+            latencies_ms = benchmark(sess, feeds, args.warmup, args.runs)
+            results[name] = (statistics.median(latencies_ms), sess.run([], feeds))
+            del sess
+
+        print(f"{model_path}:")
+        for name, (median_ms, _) in results.items():
+            # Microseconds, so that the per-run overhead of tiny models is visible.
+            print(f"  {name:<16} median {median_ms * 1000.0:10.1f} us")
+
+        cpu_outputs = results["CPU EP"][1]
+        ep_outputs = results["Basic plugin EP"][1]
+        for cpu_output, ep_output in zip(cpu_outputs, ep_outputs):
+            np.testing.assert_allclose(ep_output, cpu_output, rtol=1e-5, atol=1e-5)
+
+        with tempfile.TemporaryDirectory() as temp_dir:
+            model_name = os.path.splitext(os.path.basename(model_path))[0]
+            ep_context_model_path = os.path.join(temp_dir, model_name + "_ctx.onnx")
+            create_ep_context_model(model_path, ep_context_model_path, args.embed_ep_context)
+
+            cold_ms = statistics.median(benchmark_session_creation(model_path, args.session_runs))
+            warm_ms = statistics.median(benchmark_session_creation(ep_context_model_path, args.session_runs))
+            print(f"  Session creation median {cold_ms:8.3f} ms (original model), {warm_ms:8.3f} ms (EPContext model)")
+
+            # The kernels loaded from the EPContext model must compute the same outputs.
+            sess = create_session(ep_context_model_path, use_plugin_ep=True)
+            for ep_output, ctx_output in zip(ep_outputs, sess.run([], feeds)):
+                np.testing.assert_array_equal(ctx_output, ep_output)
+            del sess
+
+    # Must only unregister a library after all sessions that use the library have been released
+    ort.unregister_execution_provider_library(ep_registration_name)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,64 @@
+import argparse
+import statistics
+
+import numpy as np
+import onnxruntime as ort
+import onnxruntime_ep_basic as basic_ep
+
+from benchmark_elementwise import benchmark, create_session
+
+# Compares the basic plugin EP's GEMM kernel (B packed when the session is created) with the stock CPU EP.
+# Generate the models with `gen_gemm_model.py` first.
+
+def get_input_shape(input: ort.NodeArg, batch_size: int) -> list[int]:
+    return [dim if isinstance(dim, int) else batch_size for dim in input.shape]
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark the basic plugin EP's MatMul/Gemm against the CPU EP.")
+    parser.add_argument("models", nargs="+", help="Paths to models generated by gen_gemm_model.py")
+    parser.add_argument("--warmup", type=int, default=3, help="Number of warmup runs")
+    parser.add_argument("--runs", type=int, default=20, help="Number of measured runs")
+    parser.add_argument("--batch_size", type=int, default=8, help="Size of dynamic input dimensions")
+    args = parser.parse_args()
+
+    ep_registration_name = "basic_ep_registration"
+    ort.register_execution_provider_library(ep_registration_name, basic_ep.get_library_path())
+
+    print(f"{'model':<40} {'CPU EP ms':>10} {'GFLOP/s':>8} {'plugin ms':>10} {'GFLOP/s':>8} {'speedup':>8}")
+
+    for model_path in args.models:
+        rng = np.random.default_rng(0)
+        feeds = None
+        results = {}
+
+        for name, use_plugin_ep in (("CPU EP", False), ("Basic plugin EP", True)):
+            sess = create_session(model_path, use_plugin_ep)
+            if feeds is None:
+                feeds = {
+                    input.name: rng.standard_normal(get_input_shape(input, args.batch_size), dtype=np.float32)
+                    for input in sess.get_inputs()
+                }
+
+            latencies_ms = benchmark(sess, feeds, args.warmup, args.runs)
+            results[name] = (statistics.median(latencies_ms), sess.run([], feeds))
+            del sess
+
+        # 2 * M * N * K, with K from the last dimension of the (first) input and M * N from the output.
+        input_shape = next(iter(feeds.values())).shape
+        output = results["CPU EP"][1][0]
+        gflops = 2.0 * output.size * input_shape[-1] / 1e9
+
+        cpu_ms = results["CPU EP"][0]
+        ep_ms = results["Basic plugin EP"][0]
+        print(f"{model_path:<40} {cpu_ms:10.3f} {gflops / cpu_ms * 1000:8.1f} {ep_ms:10.3f} "
+              f"{gflops / ep_ms * 1000:8.1f} {cpu_ms / ep_ms:7.2f}x")
+
+        # The kernels sum the products in a different order.
+        for cpu_output, ep_output in zip(results["CPU EP"][1], results["Basic plugin EP"][1]):
+            np.testing.assert_allclose(ep_output, cpu_output, rtol=1e-4, atol=1e-3)
+
+    # Must only unregister a library after all sessions that use the library have been released
+    ort.unregister_execution_provider_library(ep_registration_name)
+
+if __name__ == "__main__":
+    main()
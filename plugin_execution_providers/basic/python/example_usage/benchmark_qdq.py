@@ -0,0 +1,66 @@
+import argparse
+import statistics
+
+import numpy as np
+import onnxruntime as ort
+import onnxruntime_ep_basic as basic_ep
+
+from benchmark_elementwise import benchmark, create_session
+from benchmark_gemm import get_input_shape
+
+# Compares the basic plugin EP's QDQ kernels (computed on the int8/uint8 data) with the stock CPU EP, which fuses the
+# same node units into its own quantized kernels. Generate the models with `gen_qdq_model.py` first.
+
+NUMPY_TYPES = {"tensor(uint8)": np.uint8, "tensor(int8)": np.int8}
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark the basic plugin EP's QDQ kernels against the CPU EP.")
+    parser.add_argument("models", nargs="+", help="Paths to models generated by gen_qdq_model.py")
+    parser.add_argument("--warmup", type=int, default=3, help="Number of warmup runs")
+    parser.add_argument("--runs", type=int, default=20, help="Number of measured runs")
+    parser.add_argument("--batch_size", type=int, default=8, help="Size of dynamic input dimensions")
+    args = parser.parse_args()
+
+    ep_registration_name = "basic_ep_registration"
+    ort.register_execution_provider_library(ep_registration_name, basic_ep.get_library_path())
+
+    print(f"{'model':<40} {'CPU EP ms':>10} {'GB/s':>8} {'plugin ms':>10} {'GB/s':>8} {'speedup':>8}")
+
+    for model_path in args.models:
+        rng = np.random.default_rng(0)
+        feeds = None
+        results = {}
+
+        for name, use_plugin_ep in (("CPU EP", False), ("Basic plugin EP", True)):
+            sess = create_session(model_path, use_plugin_ep)
+            if feeds is None:
+                feeds = {}
+                for input in sess.get_inputs():
+                    dtype = NUMPY_TYPES[input.type]
+                    info = np.iinfo(dtype)
+                    shape = get_input_shape(input, args.batch_size)
+                    feeds[input.name] = rng.integers(info.min, info.max, shape, dtype=dtype, endpoint=True)
+
+            latencies_ms = benchmark(sess, feeds, args.warmup, args.runs)
+            results[name] = (statistics.median(latencies_ms), sess.run([], feeds))
+            del sess
+
+        # Bytes of the quantized inputs and outputs. A MatMul's constant B is not counted.
+        gigabytes = (sum(feed.nbytes for feed in feeds.values()) +
+                     sum(output.nbytes for output in results["CPU EP"][1])) / 1e9
+
+        cpu_ms = results["CPU EP"][0]
+        ep_ms = results["Basic plugin EP"][0]
+        print(f"{model_path:<40} {cpu_ms:10.3f} {gigabytes / cpu_ms * 1000:8.1f} {ep_ms:10.3f} "
+              f"{gigabytes / ep_ms * 1000:8.1f} {cpu_ms / ep_ms:7.2f}x")
+
+        # The EP folds the scales into one multiplier per op, so a value that is close to a rounding boundary may be
+        # quantized to a neighbouring value.
+        for cpu_output, ep_output in zip(results["CPU EP"][1], results["Basic plugin EP"][1]):
+            np.testing.assert_allclose(ep_output.astype(np.int32), cpu_output.astype(np.int32), rtol=0, atol=1)
+
+    # Must only unregister a library after all sessions that use the library have been released
+    ort.unregister_execution_provider_library(ep_registration_name)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,277 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "arena_allocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "plugin_ep_utils.h"
+#include "sync_stream.h"
+
+namespace {
+
+constexpr size_t kHugePageSize = size_t{2} << 20;
+
+// Blocks of size classes up to this size are bump-allocated from chunks. Larger blocks are allocated one at a time.
+size_t GetMaxChunkedClassSize(size_t chunk_size) { return chunk_size / 8; }
+
+void* SystemAlloc(size_t size, bool use_huge_pages) {
+#if defined(_WIN32)
+  (void)use_huge_pages;  // Large pages need the SeLockMemoryPrivilege on Windows, so they are not used.
+  return _aligned_malloc(size, ArenaAllocator::kAlignment);
+#else
+  const bool huge = use_huge_pages && size >= kHugePageSize;
+  void* p = nullptr;
+  if (posix_memalign(&p, huge ? kHugePageSize : ArenaAllocator::kAlignment, size) != 0) {
+    return nullptr;
+  }
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (huge) {
+    madvise(p, size, MADV_HUGEPAGE);  // A hint: failure leaves regular pages.
+  }
+#endif
+
+  return p;
+#endif
+}
+
+void SystemFree(void* p) {
+#if defined(_WIN32)
+  _aligned_free(p);
+#else
+  free(p);
+#endif
+}
+
+}  // namespace
+
+/*static*/
+OrtStatus* ArenaAllocator::ParseOptions(const OrtApi& ort_api, const OrtKeyValuePairs* allocator_options,
+                                        /*out*/ Options& options) {
+  options = Options{};
+  if (allocator_options == nullptr) {
+    return nullptr;
+  }
+
+  if (const char* value = ort_api.GetKeyValue(allocator_options, "arena.chunk_size_bytes"); value != nullptr) {
+    const std::string_view str{value};
+    auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), options.chunk_size);
+    if (ec != std::errc{} || end != str.data() + str.size() || options.chunk_size < kAlignment) {
+      RETURN_ERROR(ORT_INVALID_ARGUMENT, "Invalid value for allocator option arena.chunk_size_bytes: '" << str
+                                                                                                      << "'");
+    }
+  }
+
+  if (const char* value = ort_api.GetKeyValue(allocator_options, "arena.use_huge_pages"); value != nullptr) {
+    options.use_huge_pages = std::string_view{value} == "1";
+  }
+
+  return nullptr;
+}
+
+ArenaAllocator::ArenaAllocator(const OrtApi& ort_api, const OrtMemoryInfo& memory_info, const Options& options)
+    : OrtAllocator{}, ort_api_(ort_api), memory_info_(memory_info), options_(options) {
+  OrtAllocator::version = ORT_API_VERSION;
+  OrtAllocator::Alloc = [](OrtAllocator* this_, size_t size) {
+    return static_cast<ArenaAllocator*>(this_)->Alloc(size);
+  };
+  OrtAllocator::Free = [](OrtAllocator* this_, void* p) { static_cast<ArenaAllocator*>(this_)->Free(p); };
+  OrtAllocator::Info = [](const OrtAllocator* this_) {
+    return &static_cast<const ArenaAllocator*>(this_)->memory_info_;
+  };
+  OrtAllocator::Reserve = [](OrtAllocator* this_, size_t size) {
+    return static_cast<ArenaAllocator*>(this_)->Reserve(size);
+  };
+  OrtAllocator::GetStats = [](const OrtAllocator* this_, OrtKeyValuePairs** out) noexcept -> OrtStatus* {
+    const auto& allocator = *static_cast<const ArenaAllocator*>(this_);
+    const Stats stats = allocator.GetStats();
+
+    OrtKeyValuePairs* kvps = nullptr;
+    allocator.ort_api_.CreateKeyValuePairs(&kvps);
+
+    // Use the key names of ORT's own arena so that existing tooling can read them.
+    auto add = [&](const char* key, size_t value) {
+      allocator.ort_api_.AddKeyValuePair(kvps, key, std::to_string(value).c_str());
+    };
+    add("InUse", stats.bytes_in_use);
+    add("MaxInUse", stats.max_bytes_in_use);
+    add("NumAllocs", stats.num_allocs);
+    add("NumReserves", stats.num_reserves);
+    add("NumArenaExtensions", stats.num_system_allocs);
+    add("TotalAllocated", stats.bytes_from_system);
+
+    *out = kvps;
+    return nullptr;
+  };
+  OrtAllocator::AllocOnStream = nullptr;
+}
+
+ArenaAllocator::~ArenaAllocator() {
+  for (const auto& [allocation, size] : system_allocations_) {
+    SystemFree(allocation);
+  }
+}
+
+/*static*/
+size_t ArenaAllocator::GetSizeClass(size_t size, /*out*/ size_t& class_size) {
+  size = std::max<size_t>((size + kAlignment - 1) / kAlignment, 1) * kAlignment;
+
+  // 64, 128, 192, 256
+  if (size <= 4 * kAlignment) {
+    class_size = size;
+    return size / kAlignment - 1;
+  }
+
+  // Four classes in (2^k, 2^(k + 1)], each a multiple of 2^(k - 2). k >= 8, so the classes stay 64-byte aligned.
+  const size_t k = std::bit_width(size - 1) - 1;
+  const size_t step = size_t{1} << (k - 2);
+  class_size = (size + step - 1) / step * step;
+  return 4 + (k - 8) * 4 + (class_size / step - 5);
+}
+
+uint8_t* ArenaAllocator::AllocateFromSystem(size_t size) {
+  auto* allocation = static_cast<uint8_t*>(SystemAlloc(size, options_.use_huge_pages));
+  if (allocation != nullptr) {
+    ++stats_.num_system_allocs;
+    stats_.bytes_from_system += size;
+  }
+
+  return allocation;
+}
+
+void* ArenaAllocator::InitializeBlock(uint8_t* block, size_t size_class, size_t class_size) {
+  auto* header = reinterpret_cast<BlockHeader*>(block);
+  header->size_class = size_class;
+  header->size = class_size;
+
+  ++stats_.num_allocs;
+  stats_.bytes_in_use += class_size;
+  stats_.max_bytes_in_use = std::max(stats_.max_bytes_in_use, stats_.bytes_in_use);
+
+  return block + kAlignment;
+}
+
+/*static*/
+bool ArenaAllocator::IsArenaMemory(Ort::ConstMemoryInfo memory_info) {
+  const std::string name = memory_info.GetAllocatorName();
+  return name == kCpuMemoryName || name == kVirtualDeviceMemoryName;
+}
+
+void* ArenaAllocator::Alloc(size_t size) {
+  size_t class_size = 0;
+  const size_t size_class = GetSizeClass(size, class_size);
+  const size_t block_size = kAlignment + class_size;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!deferred_blocks_.empty()) {
+    ReleaseDeferredBlocks();
+  }
+
+  if (size_class >= size_classes_.size()) {
+    size_classes_.resize(size_class + 1);
+  }
+
+  SizeClass& sc = size_classes_[size_class];
+
+  if (!sc.free_blocks.empty()) {
+    void* p = sc.free_blocks.back();
+    sc.free_blocks.pop_back();
+    return InitializeBlock(static_cast<uint8_t*>(p) - kAlignment, size_class, class_size);
+  }
+
+  if (block_size > GetMaxChunkedClassSize(options_.chunk_size)) {
+    uint8_t* block = AllocateFromSystem(block_size);
+    if (block == nullptr) {
+      return nullptr;
+    }
+
+    system_allocations_.emplace_back(block, block_size);
+    return InitializeBlock(block, size_class, class_size);
+  }
+
+  if (sc.chunk_cursor == nullptr || static_cast<size_t>(sc.chunk_end - sc.chunk_cursor) < block_size) {
+    // The tail of the previous chunk (less than one block) is left unused.
+    const size_t chunk_size = options_.chunk_size / block_size * block_size;
+    uint8_t* chunk = AllocateFromSystem(chunk_size);
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+
+    system_allocations_.emplace_back(chunk, chunk_size);
+    sc.chunk_cursor = chunk;
+    sc.chunk_end = chunk + chunk_size;
+  }
+
+  uint8_t* block = sc.chunk_cursor;
+  sc.chunk_cursor += block_size;
+  return InitializeBlock(block, size_class, class_size);
+}
+
+void ArenaAllocator::Free(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+
+  uint8_t* block = static_cast<uint8_t*>(p) - kAlignment;
+  const auto& header = *reinterpret_cast<const BlockHeader*>(block);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.bytes_in_use -= header.size;
+
+  if (header.size_class == kReservedClass) {
+    stats_.bytes_from_system -= kAlignment + header.size;
+    SystemFree(block);
+    return;
+  }
+
+  // A task that was enqueued before the block was freed may still read it.
+  if (SyncStream::HasPendingTasks()) {
+    deferred_blocks_.emplace_back(p, SyncStream::GetLastTicket());
+    return;
+  }
+
+  size_classes_[header.size_class].free_blocks.push_back(p);
+}
+
+void ArenaAllocator::ReleaseDeferredBlocks() {
+  const uint64_t completed_ticket = SyncStream::GetCompletedTicket();
+
+  while (!deferred_blocks_.empty() && deferred_blocks_.front().second <= completed_ticket) {
+    void* p = deferred_blocks_.front().first;
+    const auto& header = *reinterpret_cast<const BlockHeader*>(static_cast<uint8_t*>(p) - kAlignment);
+    size_classes_[header.size_class].free_blocks.push_back(p);
+    deferred_blocks_.pop_front();
+  }
+}
+
+void* ArenaAllocator::Reserve(size_t size) {
+  size = std::max<size_t>((size + kAlignment - 1) / kAlignment, 1) * kAlignment;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  uint8_t* block = AllocateFromSystem(kAlignment + size);
+  if (block == nullptr) {
+    return nullptr;
+  }
+
+  ++stats_.num_reserves;
+  return InitializeBlock(block, kReservedClass, size);
+}
+
+ArenaAllocator::Stats ArenaAllocator::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
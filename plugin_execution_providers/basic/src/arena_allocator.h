@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#define ORT_API_MANUAL_INIT
+#include "onnxruntime_cxx_api.h"
+#undef ORT_API_MANUAL_INIT
+
+/// <summary>
+/// CPU arena allocator that BasicPluginEpFactory provides for the EP's OrtMemoryInfo.
+///
+/// Requests are rounded up to a size class: multiples of 64 bytes up to 256 bytes, then four classes per power of two
+/// (at most 25% overhead). Freed blocks go to a per-class free list and are reused by the next request of the same
+/// class. Blocks are never returned to the system before the allocator is released, so repeated runs of the same
+/// graph stop allocating system memory after the first run.
+///
+/// Blocks of small classes are bump-allocated from per-class chunks of `chunk_size` bytes. Blocks of larger classes
+/// are allocated from the system one at a time. All blocks are 64-byte aligned and start with a 64-byte header that
+/// records their size class.
+///
+/// Blocks that are freed while a SyncStream has pending tasks are only reused once the tasks that were enqueued before
+/// the block was freed have finished, because ORT frees the inputs of a kernel that runs on a stream before the stream
+/// has computed it.
+/// </summary>
+class ArenaAllocator : public OrtAllocator {
+ public:
+  static constexpr size_t kAlignment = 64;
+
+  // Allocator names of the OrtMemoryInfo that BasicPluginEpFactory registers an ArenaAllocator for.
+  static constexpr const char* kCpuMemoryName = "BasicPluginEp CPU";
+  static constexpr const char* kVirtualDeviceMemoryName = "BasicPluginEp VirtualDevice";
+
+  struct Options {
+    size_t chunk_size = size_t{4} << 20;  // Bytes that small size classes reserve from the system at a time.
+    bool use_huge_pages = false;          // Request transparent huge pages for large system allocations (Linux).
+  };
+
+  struct Stats {
+    size_t bytes_in_use = 0;       // Size class bytes of the blocks that are currently allocated.
+    size_t max_bytes_in_use = 0;   // Peak of bytes_in_use.
+    size_t num_allocs = 0;         // Number of Alloc() and Reserve() calls.
+    size_t num_reserves = 0;       // Number of Reserve() calls.
+    size_t num_system_allocs = 0;  // Number of allocations from the system (chunks, large blocks, reserves).
+    size_t bytes_from_system = 0;  // Bytes currently allocated from the system.
+  };
+
+  /// <summary>
+  /// Reads the arena options from an allocator's OrtKeyValuePairs:
+  ///   "arena.chunk_size_bytes": Bytes that small size classes reserve from the system at a time.
+  ///   "arena.use_huge_pages": "1" to request transparent huge pages on Linux.
+  /// </summary>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  static OrtStatus* ParseOptions(const OrtApi& ort_api, const OrtKeyValuePairs* allocator_options,
+                                 /*out*/ Options& options);
+
+  ArenaAllocator(const OrtApi& ort_api, const OrtMemoryInfo& memory_info, const Options& options);
+  ~ArenaAllocator();
+
+  /// <summary>
+  /// Checks if memory was allocated by an ArenaAllocator, from the allocator name of its OrtMemoryInfo. Other memory
+  /// (e.g., from ORT's CPU allocator) may be reused as soon as ORT frees it.
+  /// </summary>
+  static bool IsArenaMemory(Ort::ConstMemoryInfo memory_info);
+
+  ArenaAllocator(const ArenaAllocator&) = delete;
+  ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+  void* Alloc(size_t size);
+  void Free(void* p);
+
+  /// <summary>
+  /// Allocates memory outside of the arena for long-lived buffers (e.g., initializers). Free() returns it to the
+  /// system.
+  /// </summary>
+  void* Reserve(size_t size);
+
+  Stats GetStats() const;
+
+ private:
+  struct BlockHeader {
+    size_t size_class;
+    size_t size;  // Bytes after the header.
+  };
+
+  struct SizeClass {
+    std::vector<void*> free_blocks;
+    uint8_t* chunk_cursor = nullptr;  // Next unused block in the current chunk (small classes only).
+    uint8_t* chunk_end = nullptr;
+  };
+
+  static_assert(sizeof(BlockHeader) <= kAlignment);
+
+  static constexpr size_t kReservedClass = SIZE_MAX;
+
+  // Gets the index and size of the size class for a request.
+  static size_t GetSizeClass(size_t size, /*out*/ size_t& class_size);
+
+  // Moves the blocks in `deferred_blocks_` whose tasks have finished to their free lists.
+  void ReleaseDeferredBlocks();
+
+  uint8_t* AllocateFromSystem(size_t size);
+  void* InitializeBlock(uint8_t* block, size_t size_class, size_t class_size);
+
+  const OrtApi& ort_api_;
+  const OrtMemoryInfo& memory_info_;
+  const Options options_;
+
+  mutable std::mutex mutex_;
+  std::vector<SizeClass> size_classes_;
+  // Blocks that were freed while a SyncStream had pending tasks, and the last ticket that was enqueued when each block
+  // was freed (see SyncStream::GetLastTicket()). Tickets increase from front to back.
+  std::deque<std::pair<void*, uint64_t>> deferred_blocks_;
+  std::vector<std::pair<uint8_t*, size_t>> system_allocations_;  // Chunks and large blocks, freed in the dtor.
+  Stats stats_;
+};
@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Helpers for the kernels that are serialized into EPContext nodes. Values are stored in host byte order.
+
+constexpr size_t kBlobDataAlignment = 64;  // Alignment of tensor data within a blob.
+constexpr uint64_t kBlobMaxRank = 64;
+
+inline size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+inline size_t GetNumElements(const std::vector<int64_t>& shape) {
+  size_t num_elements = 1;
+  for (int64_t dim : shape) {
+    num_elements *= static_cast<size_t>(dim);
+  }
+
+  return num_elements;
+}
+
+/// <summary>
+/// Appends values to a serialized kernel.
+/// </summary>
+class BlobWriter {
+ public:
+  explicit BlobWriter(std::string& blob) : blob_(blob) { blob_.clear(); }
+
+  template <typename T>
+  void Write(T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    blob_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void WriteShape(const std::vector<int64_t>& shape) {
+    Write<uint64_t>(shape.size());
+    for (int64_t dim : shape) {
+      Write(dim);
+    }
+  }
+
+  void WriteBytes(const void* data, size_t size) { blob_.append(static_cast<const char*>(data), size); }
+  void PadTo(size_t alignment) { blob_.resize(AlignUp(blob_.size(), alignment), '\0'); }
+
+ private:
+  std::string& blob_;
+};
+
+/// <summary>
+/// Reads a blob that BlobWriter wrote. Every read fails instead of reading past the end of the blob.
+/// </summary>
+class BlobReader {
+ public:
+  explicit BlobReader(std::span<const uint8_t> blob) : blob_(blob) {}
+
+  template <typename T>
+  bool Read(/*out*/ T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (blob_.size() - position_ < sizeof(T)) {
+      return false;
+    }
+
+    std::memcpy(&value, blob_.data() + position_, sizeof(T));
+    position_ += sizeof(T);
+    return true;
+  }
+
+  bool ReadSize(/*out*/ size_t& value, uint64_t max_value) {
+    uint64_t value64 = 0;
+    if (!Read(value64) || value64 > max_value) {
+      return false;
+    }
+
+    value = static_cast<size_t>(value64);
+    return true;
+  }
+
+  bool ReadShape(/*out*/ std::vector<int64_t>& shape) {
+    size_t rank = 0;
+    if (!ReadSize(rank, kBlobMaxRank)) {
+      return false;
+    }
+
+    shape.resize(rank);
+    for (int64_t& dim : shape) {
+      if (!Read(dim) || dim < 0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  size_t GetPosition() const { return position_; }
+  size_t GetRemainingSize() const { return blob_.size() - position_; }
+
+ private:
+  std::span<const uint8_t> blob_;
+  size_t position_ = 0;
+};
+
+/// <summary>
+/// Gets a view of tensor data at `offset` bytes after `data_start` in a blob, after checking that the whole tensor is
+/// inside the blob. The size is checked one dimension at a time, so that a corrupt shape cannot overflow it.
+/// </summary>
+/// <returns>Null if the tensor is not inside the blob</returns>
+inline const void* GetBlobTensorBytes(std::span<const uint8_t> blob, size_t data_start, size_t offset,
+                                      const std::vector<int64_t>& shape, size_t element_size) {
+  if (data_start > blob.size() || offset > blob.size() - data_start) {
+    return nullptr;
+  }
+
+  const size_t available_bytes = blob.size() - data_start - offset;
+  size_t num_bytes = element_size;
+  for (int64_t dim : shape) {
+    if (dim != 0 && num_bytes > available_bytes / static_cast<size_t>(dim)) {
+      return nullptr;
+    }
+
+    num_bytes *= static_cast<size_t>(dim);
+  }
+
+  if (num_bytes > available_bytes) {
+    return nullptr;  // Scalar at the end of the blob.
+  }
+
+  return blob.data() + data_start + offset;
+}
+
+/// <summary>
+/// Gets a view of float32 tensor data in a blob (see GetBlobTensorBytes()).
+/// </summary>
+inline const float* GetBlobTensorData(std::span<const uint8_t> blob, size_t data_start, size_t offset,
+                                      const std::vector<int64_t>& shape) {
+  return static_cast<const float*>(GetBlobTensorBytes(blob, data_start, offset, shape, sizeof(float)));
+}
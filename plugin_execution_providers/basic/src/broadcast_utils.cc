@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "broadcast_utils.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <utility>
+
+bool GetBroadcastShape(std::span<const int64_t> shape0, std::span<const int64_t> shape1,
+                       /*out*/ std::vector<int64_t>& result) {
+  const size_t rank = std::max(shape0.size(), shape1.size());
+  std::vector<int64_t> broadcast_shape(rank, 1);  // `result` may alias an input.
+
+  // Align the shapes on their innermost dimension.
+  for (size_t i = 0; i < rank; ++i) {
+    const int64_t dim0 = i < shape0.size() ? shape0[shape0.size() - 1 - i] : 1;
+    const int64_t dim1 = i < shape1.size() ? shape1[shape1.size() - 1 - i] : 1;
+
+    if (dim0 != dim1 && dim0 != 1 && dim1 != 1) {
+      return false;
+    }
+
+    broadcast_shape[rank - 1 - i] = dim0 == 1 ? dim1 : dim0;
+  }
+
+  result = std::move(broadcast_shape);
+  return true;
+}
+
+size_t BroadcastLayout::GetNumElements() const {
+  return std::accumulate(shape.begin(), shape.end(), size_t{1}, std::multiplies<size_t>());
+}
+
+bool CreateBroadcastLayout(std::span<const int64_t> iteration_shape,
+                           const std::vector<std::vector<int64_t>>& operand_shapes,
+                           /*out*/ BroadcastLayout& layout) {
+  const size_t rank = iteration_shape.size();
+  const size_t num_operands = operand_shapes.size();
+
+  // Uncollapsed strides of each operand in the iteration space, aligned on the innermost dimension.
+  std::vector<std::vector<size_t>> strides(num_operands, std::vector<size_t>(rank, 0));
+
+  for (size_t operand = 0; operand < num_operands; ++operand) {
+    const std::vector<int64_t>& operand_shape = operand_shapes[operand];
+    if (operand_shape.size() > rank) {
+      return false;
+    }
+
+    size_t stride = 1;
+    for (size_t i = 0; i < operand_shape.size(); ++i) {
+      const size_t dim = rank - 1 - i;
+      const int64_t operand_dim = operand_shape[operand_shape.size() - 1 - i];
+
+      if (operand_dim == iteration_shape[dim]) {
+        strides[operand][dim] = operand_dim == 1 ? 0 : stride;
+      } else if (operand_dim != 1) {
+        return false;
+      }
+
+      stride *= static_cast<size_t>(operand_dim);
+    }
+  }
+
+  layout.shape.clear();
+  layout.strides.assign(num_operands, {});
+
+  // Walk from the outermost dimension and merge each dimension into the previous loop when every operand's stride
+  // in the previous loop continues its stride in this one.
+  for (size_t dim = 0; dim < rank; ++dim) {
+    const auto dim_size = static_cast<size_t>(iteration_shape[dim]);
+    if (dim_size == 1) {
+      continue;
+    }
+
+    bool can_merge = !layout.shape.empty();
+    for (size_t operand = 0; can_merge && operand < num_operands; ++operand) {
+      can_merge = layout.strides[operand].back() == strides[operand][dim] * dim_size;
+    }
+
+    if (can_merge) {
+      layout.shape.back() *= dim_size;
+      for (size_t operand = 0; operand < num_operands; ++operand) {
+        layout.strides[operand].back() = strides[operand][dim];
+      }
+    } else {
+      layout.shape.push_back(dim_size);
+      for (size_t operand = 0; operand < num_operands; ++operand) {
+        layout.strides[operand].push_back(strides[operand][dim]);
+      }
+    }
+  }
+
+  // A scalar iteration space (or one with only dimensions of size 1) is a single row of one element.
+  if (layout.shape.empty()) {
+    layout.shape.push_back(1);
+    for (size_t operand = 0; operand < num_operands; ++operand) {
+      layout.strides[operand].push_back(0);
+    }
+  }
+
+  return true;
+}
+
+void BroadcastRowIterator::Reset(const BroadcastLayout& layout, size_t first_row) {
+  layout_ = &layout;
+  row_index_.assign(layout.shape.size() - 1, 0);
+  offsets_.assign(layout.strides.size(), 0);
+
+  for (size_t dim = row_index_.size(); dim-- > 0;) {
+    row_index_[dim] = first_row % layout.shape[dim];
+    first_row /= layout.shape[dim];
+
+    for (size_t operand = 0; operand < offsets_.size(); ++operand) {
+      offsets_[operand] += row_index_[dim] * layout.strides[operand][dim];
+    }
+  }
+}
+
+bool BroadcastRowIterator::Next() {
+  // Increment the outer loop indices like an odometer, innermost outer loop first.
+  for (size_t dim = row_index_.size(); dim-- > 0;) {
+    const bool wraps = ++row_index_[dim] == layout_->shape[dim];
+
+    for (size_t operand = 0; operand < offsets_.size(); ++operand) {
+      const size_t stride = layout_->strides[operand][dim];
+      offsets_[operand] = wraps ? offsets_[operand] - stride * (layout_->shape[dim] - 1) : offsets_[operand] + stride;
+    }
+
+    if (!wraps) {
+      return true;
+    }
+
+    row_index_[dim] = 0;
+  }
+
+  return false;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/// <summary>
+/// Computes the shape that two shapes broadcast to using NumPy-style (multidirectional) broadcasting.
+/// </summary>
+/// <param name="shape0">The first shape</param>
+/// <param name="shape1">The second shape</param>
+/// <param name="result">Output parameter set to the broadcast shape</param>
+/// <returns>False if the shapes cannot be broadcast together</returns>
+bool GetBroadcastShape(std::span<const int64_t> shape0, std::span<const int64_t> shape1,
+                       /*out*/ std::vector<int64_t>& result);
+
+/// <summary>
+/// Loop nest that visits every element of a broadcast iteration space, and the stride of each operand in every loop.
+///
+/// Adjacent dimensions are collapsed into one whenever every operand is either contiguous or broadcast across both of
+/// them, and dimensions of size 1 are dropped. E.g., a per-channel scale of shape [1, C, 1, 1] applied to a tensor of
+/// shape [N, C, H, W] is visited as [N, C, H * W] with strides [0, 1, 0] for the scale and [C * H * W, H * W, 1] for
+/// the tensor.
+/// </summary>
+struct BroadcastLayout {
+  std::vector<size_t> shape;                 // Collapsed loop sizes, innermost last. Never empty.
+  std::vector<std::vector<size_t>> strides;  // strides[operand][dim], in elements. 0 if broadcast in that loop.
+
+  size_t GetNumElements() const;
+  size_t GetRowSize() const { return shape.back(); }
+  size_t GetNumRows() const { return GetRowSize() != 0 ? GetNumElements() / GetRowSize() : 0; }
+
+  /// <summary>
+  /// Checks if an operand is broadcast across the innermost loop, i.e., it is a single value within each row.
+  /// Otherwise, the operand is contiguous within each row.
+  /// </summary>
+  bool IsBroadcastInRow(size_t operand) const { return strides[operand].back() == 0; }
+};
+
+/// <summary>
+/// Creates the collapsed loop nest for operands that are broadcast to an iteration shape.
+/// </summary>
+/// <param name="iteration_shape">The shape of the iteration space</param>
+/// <param name="operand_shapes">The shapes of the operands. Each must be broadcastable to `iteration_shape`.</param>
+/// <param name="layout">Output parameter set to the collapsed loop nest</param>
+/// <returns>False if an operand cannot be broadcast to the iteration shape</returns>
+bool CreateBroadcastLayout(std::span<const int64_t> iteration_shape,
+                           const std::vector<std::vector<int64_t>>& operand_shapes,
+                           /*out*/ BroadcastLayout& layout);
+
+/// <summary>
+/// Visits the rows (the innermost loop) of a BroadcastLayout and tracks each operand's offset to the start of the
+/// current row.
+/// </summary>
+class BroadcastRowIterator {
+ public:
+  /// <summary>
+  /// Creates an iterator that must be Reset() before use.
+  /// </summary>
+  BroadcastRowIterator() = default;
+
+  /// <summary>
+  /// Creates an iterator that starts at row `first_row` (in row-major order).
+  /// </summary>
+  explicit BroadcastRowIterator(const BroadcastLayout& layout, size_t first_row = 0) { Reset(layout, first_row); }
+
+  /// <summary>
+  /// Restarts the iterator at row `first_row` of a layout, which must outlive the iteration. Reuses the memory of the
+  /// previous iteration, so an iterator that is reset for layouts of the same size does not allocate.
+  /// </summary>
+  void Reset(const BroadcastLayout& layout, size_t first_row = 0);
+
+  /// <summary>
+  /// Gets the offset, in elements, of the first element of the current row for every operand.
+  /// </summary>
+  const std::vector<size_t>& GetOffsets() const { return offsets_; }
+
+  /// <summary>
+  /// Advances to the next row.
+  /// </summary>
+  /// <returns>False if the current row was the last one</returns>
+  bool Next();
+
+ private:
+  const BroadcastLayout* layout_ = nullptr;
+  std::vector<size_t> row_index_;  // Index in each outer loop.
+  std::vector<size_t> offsets_;
+};
@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "data_transfer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "plugin_ep_utils.h"
+#include "sync_stream.h"
+#include "thread_pool.h"
+
+namespace {
+
+// memcpy is limited by memory bandwidth, which a few threads saturate.
+constexpr size_t kMaxCopyThreads = 4;
+
+// Batches with fewer bytes are copied by the calling thread. Each parallel task copies at least this many bytes.
+constexpr size_t kMinBytesPerTask = size_t{256} << 10;
+
+}  // namespace
+
+DataTransfer::DataTransfer(const OrtApi& ort_api, const OrtEpApi& ep_api, const OrtMemoryDevice* device)
+    : OrtDataTransferImpl{}, ort_api_(ort_api), ep_api_(ep_api), device_(device) {
+  ort_version_supported = ORT_API_VERSION;
+  CanCopy = CanCopyImpl;
+  CopyTensors = CopyTensorsImpl;
+  Release = ReleaseImpl;
+
+  const size_t num_threads = std::min<size_t>(std::thread::hardware_concurrency(), kMaxCopyThreads);
+  if (num_threads > 1) {
+    thread_pool_ = std::make_unique<ThreadPool>(num_threads);
+  }
+}
+
+DataTransfer::~DataTransfer() = default;
+
+DataTransfer::Stats DataTransfer::GetStats() const {
+  Stats stats;
+  stats.host_to_device_bytes = host_to_device_bytes_.load(std::memory_order_relaxed);
+  stats.device_to_host_bytes = device_to_host_bytes_.load(std::memory_order_relaxed);
+  stats.device_to_device_bytes = device_to_device_bytes_.load(std::memory_order_relaxed);
+  stats.num_copies = num_copies_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void DataTransfer::Copy(std::span<const CopyRegion> regions) const {
+  size_t total_bytes = 0;
+  for (const CopyRegion& region : regions) {
+    total_bytes += region.num_bytes;
+  }
+
+  size_t num_tasks = 1;
+  if (thread_pool_ != nullptr) {
+    num_tasks = std::clamp<size_t>(total_bytes / kMinBytesPerTask, 1, thread_pool_->GetNumThreads());
+  }
+
+  if (num_tasks <= 1) {
+    for (const CopyRegion& region : regions) {
+      std::memcpy(region.dst, region.src, region.num_bytes);
+    }
+
+    return;
+  }
+
+  // Each task copies an equal share of the concatenated regions, which may span several regions.
+  thread_pool_->ParallelFor(num_tasks, [&](size_t task) {
+    const size_t task_begin = total_bytes * task / num_tasks;
+    const size_t task_end = total_bytes * (task + 1) / num_tasks;
+
+    size_t region_begin = 0;
+    for (const CopyRegion& region : regions) {
+      const size_t region_end = region_begin + region.num_bytes;
+      const size_t begin = std::max(task_begin, region_begin);
+      const size_t end = std::min(task_end, region_end);
+      if (begin < end) {
+        std::memcpy(static_cast<uint8_t*>(region.dst) + (begin - region_begin),
+                    static_cast<const uint8_t*>(region.src) + (begin - region_begin), end - begin);
+      }
+
+      region_begin = region_end;
+    }
+  });
+}
+
+/*static*/
+bool ORT_API_CALL DataTransfer::CanCopyImpl(const OrtDataTransferImpl* this_ptr,
+                                            const OrtMemoryDevice* src_memory_device,
+                                            const OrtMemoryDevice* dst_memory_device) noexcept {
+  const auto& data_transfer = *static_cast<const DataTransfer*>(this_ptr);
+  const OrtEpApi& ep_api = data_transfer.ep_api_;
+
+  const bool src_is_device = ep_api.MemoryDevice_AreEqual(src_memory_device, data_transfer.device_);
+  const bool dst_is_device = ep_api.MemoryDevice_AreEqual(dst_memory_device, data_transfer.device_);
+
+  // Copies between the virtual device and CPU memory, or within the virtual device.
+  if (src_is_device) {
+    return dst_is_device || ep_api.MemoryDevice_GetDeviceType(dst_memory_device) == OrtMemoryInfoDeviceType_CPU;
+  }
+
+  return dst_is_device && ep_api.MemoryDevice_GetDeviceType(src_memory_device) == OrtMemoryInfoDeviceType_CPU;
+}
+
+/*static*/
+OrtStatus* ORT_API_CALL DataTransfer::CopyTensorsImpl(OrtDataTransferImpl* this_ptr, const OrtValue** src_tensors,
+                                                      OrtValue** dst_tensors, OrtSyncStream** streams,
+                                                      size_t num_tensors) noexcept {
+  EP_API_IMPL_BEGIN
+
+  auto& data_transfer = *static_cast<DataTransfer*>(this_ptr);
+  const OrtApi& ort_api = data_transfer.ort_api_;
+  const OrtEpApi& ep_api = data_transfer.ep_api_;
+
+  std::vector<CopyRegion> regions;  // Copied before returning.
+  std::vector<std::pair<SyncStream*, std::vector<CopyRegion>>> stream_regions;  // Queued on their streams.
+
+  for (size_t i = 0; i < num_tensors; ++i) {
+    const bool src_is_device = ep_api.MemoryDevice_AreEqual(ep_api.Value_GetMemoryDevice(src_tensors[i]),
+                                                            data_transfer.device_);
+    const bool dst_is_device = ep_api.MemoryDevice_AreEqual(ep_api.Value_GetMemoryDevice(dst_tensors[i]),
+                                                            data_transfer.device_);
+
+    size_t num_bytes = 0;
+    RETURN_IF_ERROR(ort_api.GetTensorSizeInBytes(src_tensors[i], &num_bytes));
+
+    std::atomic<uint64_t>& counter = !src_is_device   ? data_transfer.host_to_device_bytes_
+                                     : dst_is_device ? data_transfer.device_to_device_bytes_
+                                                     : data_transfer.device_to_host_bytes_;
+    counter.fetch_add(num_bytes, std::memory_order_relaxed);
+    data_transfer.num_copies_.fetch_add(1, std::memory_order_relaxed);
+
+    const void* src = nullptr;
+    void* dst = nullptr;
+    RETURN_IF_ERROR(ort_api.GetTensorData(src_tensors[i], &src));
+    RETURN_IF_ERROR(ort_api.GetTensorMutableData(dst_tensors[i], &dst));
+    if (num_bytes == 0 || src == dst) {
+      continue;
+    }
+
+    SyncStream* stream = nullptr;
+    if (streams != nullptr && streams[i] != nullptr && src_is_device) {
+      stream = SyncStream::FromHandle(ort_api.SyncStream_GetHandle(streams[i]));
+    }
+
+    if (stream == nullptr) {
+      regions.push_back({src, dst, num_bytes});
+      continue;
+    }
+
+    auto it = std::find_if(stream_regions.begin(), stream_regions.end(),
+                           [stream](const auto& entry) { return entry.first == stream; });
+    if (it == stream_regions.end()) {
+      it = stream_regions.emplace(stream_regions.end(), stream, std::vector<CopyRegion>{});
+    }
+
+    it->second.push_back({src, dst, num_bytes});
+  }
+
+  data_transfer.Copy(regions);
+
+  for (auto& [stream, queued_regions] : stream_regions) {
+    stream->Enqueue([transfer = &data_transfer, queued_regions = std::move(queued_regions)]() {
+      transfer->Copy(queued_regions);
+    });
+  }
+
+  return nullptr;
+
+  EP_API_IMPL_END
+}
+
+/*static*/
+void ORT_API_CALL DataTransfer::ReleaseImpl(OrtDataTransferImpl* /*this_ptr*/) noexcept {
+  // The factory owns the data transfer.
+}
@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#define ORT_API_MANUAL_INIT
+#include "onnxruntime_cxx_api.h"
+#undef ORT_API_MANUAL_INIT
+
+class ThreadPool;
+
+/// <summary>
+/// OrtDataTransferImpl for the EP's virtual device, whose memory is plain CPU memory that ORT treats as device memory.
+///
+/// ORT passes all tensors of a copy step in one CopyTensors() call. Their copies run as one batch that is split into
+/// chunks, which run in parallel on a thread pool of the data transfer. Copies from device memory that ORT assigns to
+/// a SyncStream are queued on the stream, after the kernels that produce their source. Copies from host memory run
+/// before CopyTensors() returns, because ORT may reuse the host memory afterwards.
+/// </summary>
+class DataTransfer : public OrtDataTransferImpl {
+ public:
+  struct Stats {
+    uint64_t host_to_device_bytes = 0;
+    uint64_t device_to_host_bytes = 0;
+    uint64_t device_to_device_bytes = 0;
+    uint64_t num_copies = 0;  // Number of copied tensors.
+  };
+
+  /// <summary>
+  /// Creates the data transfer for `device`, the memory device of the EP's default OrtMemoryInfo.
+  /// </summary>
+  DataTransfer(const OrtApi& ort_api, const OrtEpApi& ep_api, const OrtMemoryDevice* device);
+  ~DataTransfer();
+
+  DataTransfer(const DataTransfer&) = delete;
+  DataTransfer& operator=(const DataTransfer&) = delete;
+
+  /// <summary>
+  /// Gets the bytes copied since the data transfer was created. Concurrent runs of all sessions are included.
+  /// </summary>
+  Stats GetStats() const;
+
+ private:
+  struct CopyRegion {
+    const void* src;
+    void* dst;
+    size_t num_bytes;
+  };
+
+  static bool ORT_API_CALL CanCopyImpl(const OrtDataTransferImpl* this_ptr, const OrtMemoryDevice* src_memory_device,
+                                       const OrtMemoryDevice* dst_memory_device) noexcept;
+  static OrtStatus* ORT_API_CALL CopyTensorsImpl(OrtDataTransferImpl* this_ptr, const OrtValue** src_tensors,
+                                                 OrtValue** dst_tensors, OrtSyncStream** streams,
+                                                 size_t num_tensors) noexcept;
+  static void ORT_API_CALL ReleaseImpl(OrtDataTransferImpl* this_ptr) noexcept;
+
+  // Copies the regions, in parallel if they are large enough.
+  void Copy(std::span<const CopyRegion> regions) const;
+
+  const OrtApi& ort_api_;
+  const OrtEpApi& ep_api_;
+  const OrtMemoryDevice* device_;  // Owned by the factory's OrtMemoryInfo.
+  std::unique_ptr<ThreadPool> thread_pool_;  // Null on single-core machines.
+
+  std::atomic<uint64_t> host_to_device_bytes_{0};
+  std::atomic<uint64_t> device_to_host_bytes_{0};
+  std::atomic<uint64_t> device_to_device_bytes_{0};
+  std::atomic<uint64_t> num_copies_{0};
+};
@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "elementwise_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "elementwise_kernels_impl.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BASIC_EP_X64
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BASIC_EP_ARM64
+#endif
+
+// Defined in the instruction set specific translation units.
+#if defined(BASIC_EP_X64)
+ElementwiseOpFn GetElementwiseOpFnAvx2(ElementwiseOp op, bool is_broadcast0, bool is_broadcast1);
+ElementwiseOpFn GetElementwiseOpFnAvx512(ElementwiseOp op, bool is_broadcast0, bool is_broadcast1);
+#elif defined(BASIC_EP_ARM64)
+ElementwiseOpFn GetElementwiseOpFnNeon(ElementwiseOp op, bool is_broadcast0, bool is_broadcast1);
+#endif
+
+namespace {
+
+template <ElementwiseOp kOp>
+inline float ApplyOp(const ElementwiseNode& node, float a, float b) {
+  if constexpr (kOp == ElementwiseOp::Add) {
+    return a + b;
+  } else if constexpr (kOp == ElementwiseOp::Sub) {
+    return a - b;
+  } else if constexpr (kOp == ElementwiseOp::Mul) {
+    return a * b;
+  } else if constexpr (kOp == ElementwiseOp::Div) {
+    return a / b;
+  } else if constexpr (kOp == ElementwiseOp::Relu) {
+    return std::max(a, 0.0f);
+  } else if constexpr (kOp == ElementwiseOp::Sigmoid) {
+    return 1.0f / (1.0f + std::exp(-a));
+  } else if constexpr (kOp == ElementwiseOp::Tanh) {
+    return std::tanh(a);
+  } else if constexpr (kOp == ElementwiseOp::Clip) {
+    return std::min(std::max(a, node.clip_min), node.clip_max);
+  } else {
+    return a;
+  }
+}
+
+// Scalar kernels, for use with SelectElementwiseOpFn().
+struct ScalarElementwiseOps {
+  template <ElementwiseOp kOp, bool kIsBroadcast0, bool kIsBroadcast1>
+  static void Run(const ElementwiseNode& node, const float* input0, const float* input1, float* output,
+                  size_t count) {
+    constexpr bool kIsBinary = IsBinaryOp(kOp);
+
+    if constexpr (kIsBroadcast0 && (kIsBroadcast1 || !kIsBinary)) {
+      std::fill_n(output, count, ApplyOp<kOp>(node, *input0, kIsBinary ? *input1 : 0.0f));
+    } else if constexpr (kOp == ElementwiseOp::Copy) {
+      if (output != input0) {
+        std::copy(input0, input0 + count, output);
+      }
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        const float value0 = kIsBroadcast0 ? *input0 : input0[i];
+        const float value1 = !kIsBinary ? 0.0f : kIsBroadcast1 ? *input1 : input1[i];
+        output[i] = ApplyOp<kOp>(node, value0, value1);
+      }
+    }
+  }
+};
+
+}  // namespace
+
+void RunElementwiseOpScalar(const ElementwiseNode& node, const float* input0, bool is_broadcast0,
+                            const float* input1, bool is_broadcast1, float* output, size_t count) {
+  const ElementwiseOpFn fn = SelectElementwiseOpFn<ScalarElementwiseOps>(node.op, is_broadcast0, is_broadcast1);
+  fn(node, input0, input1, output, count);
+}
+
+#if defined(BASIC_EP_X64)
+
+static std::array<uint32_t, 4> GetCpuid(uint32_t leaf, uint32_t subleaf) {
+  std::array<uint32_t, 4> regs{};  // eax, ebx, ecx, edx
+#if defined(_MSC_VER)
+  int msvc_regs[4];
+  __cpuidex(msvc_regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+  std::copy(std::begin(msvc_regs), std::end(msvc_regs), regs.begin());
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+  return regs;
+}
+
+// Reads the XCR0 register, which tells which register states the OS saves on context switches.
+static uint64_t GetXcr0() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t eax = 0;
+  uint32_t edx = 0;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+static SimdLevel DetectSimdLevel() {
+  const auto leaf1 = GetCpuid(1, 0);
+  const bool has_fma = (leaf1[2] & (1u << 12)) != 0;
+  const bool has_osxsave = (leaf1[2] & (1u << 27)) != 0;
+  if (!has_osxsave || GetCpuid(0, 0)[0] < 7) {
+    return SimdLevel::Scalar;
+  }
+
+  const uint64_t xcr0 = GetXcr0();
+  const bool os_saves_ymm = (xcr0 & 0x6) == 0x6;    // XMM and YMM state.
+  const bool os_saves_zmm = (xcr0 & 0xe6) == 0xe6;  // XMM, YMM, opmask and ZMM state.
+
+  const auto leaf7 = GetCpuid(7, 0);
+  const bool has_avx2 = (leaf7[1] & (1u << 5)) != 0;
+  const bool has_avx512f = (leaf7[1] & (1u << 16)) != 0;
+
+  if (has_avx512f && os_saves_zmm) {
+    return SimdLevel::Avx512;
+  }
+
+  if (has_avx2 && has_fma && os_saves_ymm) {
+    return SimdLevel::Avx2;
+  }
+
+  return SimdLevel::Scalar;
+}
+
+#elif defined(BASIC_EP_ARM64)
+
+static SimdLevel DetectSimdLevel() { return SimdLevel::Neon; }
+
+#else
+
+static SimdLevel DetectSimdLevel() { return SimdLevel::Scalar; }
+
+#endif
+
+SimdLevel GetBestSimdLevel() {
+  static const SimdLevel best_level = DetectSimdLevel();
+  return best_level;
+}
+
+bool IsSimdLevelSupported(SimdLevel level) {
+  const SimdLevel best_level = GetBestSimdLevel();
+
+  switch (level) {
+    case SimdLevel::Scalar:
+      return true;
+    case SimdLevel::Avx2:
+      return best_level == SimdLevel::Avx2 || best_level == SimdLevel::Avx512;
+    case SimdLevel::Avx512:
+    case SimdLevel::Neon:
+      return best_level == level;
+  }
+
+  return false;
+}
+
+ElementwiseOpFn GetElementwiseOpFn(SimdLevel level, ElementwiseOp op, bool is_broadcast0, bool is_broadcast1) {
+  switch (level) {
+#if defined(BASIC_EP_X64)
+    case SimdLevel::Avx2:
+      return GetElementwiseOpFnAvx2(op, is_broadcast0, is_broadcast1);
+    case SimdLevel::Avx512:
+      return GetElementwiseOpFnAvx512(op, is_broadcast0, is_broadcast1);
+#elif defined(BASIC_EP_ARM64)
+    case SimdLevel::Neon:
+      return GetElementwiseOpFnNeon(op, is_broadcast0, is_broadcast1);
+#endif
+    default:
+      return SelectElementwiseOpFn<ScalarElementwiseOps>(op, is_broadcast0, is_broadcast1);
+  }
+}
+
+const char* SimdLevelToString(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::Scalar:
+      return "scalar";
+    case SimdLevel::Avx2:
+      return "avx2";
+    case SimdLevel::Avx512:
+      return "avx512";
+    case SimdLevel::Neon:
+      return "neon";
+  }
+
+  return "unknown";
+}
+
+std::optional<SimdLevel> SimdLevelFromString(std::string_view str) {
+  for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512, SimdLevel::Neon}) {
+    if (str == SimdLevelToString(level)) {
+      return level;
+    }
+  }
+
+  return std::nullopt;
+}
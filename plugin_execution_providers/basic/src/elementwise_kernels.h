@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+#include "elementwise_ops.h"
+
+/// <summary>
+/// Instruction sets that the elementwise and GEMM kernels are compiled for.
+/// </summary>
+enum class SimdLevel {
+  Scalar,
+  Avx2,    // x86-64 AVX2 + FMA
+  Avx512,  // x86-64 AVX-512F
+  Neon,    // ARM64 NEON
+};
+
+/// <summary>
+/// Computes `count` elements of one elementwise operator for one input layout. The function is selected by
+/// GetElementwiseOpFn() when a kernel is compiled, so it does not branch on the op or on the layout. `input1` is only
+/// used by binary operators. An input that is broadcast holds a single value that applies to all `count` elements.
+/// `output` may alias either input.
+/// </summary>
+using ElementwiseOpFn = void (*)(const ElementwiseNode& node, const float* input0, const float* input1, float* output,
+                                 size_t count);
+
+/// <summary>
+/// Portable scalar kernel for any op and layout. The vectorized kernels use it for the elements that do not fill a
+/// whole vector.
+/// </summary>
+void RunElementwiseOpScalar(const ElementwiseNode& node, const float* input0, bool is_broadcast0,
+                            const float* input1, bool is_broadcast1, float* output, size_t count);
+
+/// <summary>
+/// Detects the best instruction set that both the CPU (queried with CPUID on x86-64) and this build support.
+/// </summary>
+SimdLevel GetBestSimdLevel();
+
+/// <summary>
+/// Checks if the CPU and this build support an instruction set.
+/// </summary>
+bool IsSimdLevelSupported(SimdLevel level);
+
+/// <summary>
+/// Gets the kernel for an op, an instruction set and a layout of the inputs. The instruction set must be supported.
+/// `is_broadcast1` is ignored for unary ops.
+/// </summary>
+ElementwiseOpFn GetElementwiseOpFn(SimdLevel level, ElementwiseOp op, bool is_broadcast0, bool is_broadcast1);
+
+const char* SimdLevelToString(SimdLevel level);
+std::optional<SimdLevel> SimdLevelFromString(std::string_view str);
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Compiled with AVX2 and FMA enabled (see CMakeLists.txt). Only called if GetBestSimdLevel() detects AVX2 and FMA.
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+#include "elementwise_kernels_impl.h"
+
+namespace {
+
+struct Avx2Vec {
+  using Reg = __m256;
+  static constexpr size_t kWidth = 8;
+
+  static Reg Load(const float* data) { return _mm256_loadu_ps(data); }
+  static void Store(float* data, Reg value) { _mm256_storeu_ps(data, value); }
+  static Reg Set1(float value) { return _mm256_set1_ps(value); }
+  static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+  static Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+  static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+  static Reg Div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+  static Reg Min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+  static Reg Max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+  static Reg MulAdd(Reg a, Reg b, Reg c) { return _mm256_fmadd_ps(a, b, c); }
+  static Reg Floor(Reg value) { return _mm256_floor_ps(value); }
+
+  static Reg Pow2n(Reg n) {
+    const __m256i exponent = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(exponent, 23));
+  }
+};
+
+}  // namespace
+
+ElementwiseOpFn GetElementwiseOpFnAvx2(ElementwiseOp op, bool is_broadcast0, bool is_broadcast1) {
+  return SelectElementwiseOpFn<SimdElementwiseOps<Avx2Vec>>(op, is_broadcast0, is_broadcast1);
+}
+
+#endif  // defined(__x86_64__) || defined(_M_X64)
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Compiled with AVX-512F enabled (see CMakeLists.txt). Only called if GetBestSimdLevel() detects AVX-512F.
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+#include "elementwise_kernels_impl.h"
+
+namespace {
+
+struct Avx512Vec {
+  using Reg = __m512;
+  static constexpr size_t kWidth = 16;
+
+  static Reg Load(const float* data) { return _mm512_loadu_ps(data); }
+  static void Store(float* data, Reg value) { _mm512_storeu_ps(data, value); }
+  static Reg Set1(float value) { return _mm512_set1_ps(value); }
+  static Reg Add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+  static Reg Sub(Reg a, Reg b) { return _mm512_sub_ps(a, b); }
+  static Reg Mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+  static Reg Div(Reg a, Reg b) { return _mm512_div_ps(a, b); }
+  static Reg Min(Reg a, Reg b) { return _mm512_min_ps(a, b); }
+  static Reg Max(Reg a, Reg b) { return _mm512_max_ps(a, b); }
+  static Reg MulAdd(Reg a, Reg b, Reg c) { return _mm512_fmadd_ps(a, b, c); }
+  static Reg Floor(Reg value) { return _mm512_roundscale_ps(value, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+
+  static Reg Pow2n(Reg n) {
+    const __m512i exponent = _mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(exponent, 23));
+  }
+};
+
+}  // namespace
+
+ElementwiseOpFn GetElementwiseOpFnAvx512(ElementwiseOp op, bool is_broadcast0, bool is_broadcast1) {
+  return SelectElementwiseOpFn<SimdElementwiseOps<Avx512Vec>>(op, is_broadcast0, is_broadcast1);
+}
+
+#endif  // defined(__x86_64__) || defined(_M_X64)
@@ -0,0 +1,194 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Implementation of the vectorized elementwise kernels, shared by the instruction set specific translation units
+// (elementwise_kernels_avx2.cc, ...). Each of them defines a vector traits type and instantiates
+// SelectElementwiseOpFn<SimdElementwiseOps<V>>() with it. Every instantiation involves a type that is local to its
+// translation unit, so code compiled with instruction set specific compiler flags is never shared with another
+// translation unit. elementwise_kernels.cc uses SelectElementwiseOpFn() for the scalar kernels.
+
+#pragma once
+
+#include <cstddef>
+
+#include "elementwise_kernels.h"
+
+// A vector traits type V provides:
+//   using Reg;                          // Vector register type.
+//   static constexpr size_t kWidth;     // Floats per register.
+//   Load(const float*), Store(float*, Reg), Set1(float),
+//   Add, Sub, Mul, Div, Min, Max(Reg, Reg), MulAdd(a, b, c) = a * b + c,
+//   Floor(Reg), Pow2n(Reg n) = 2^n for integral n in [-126, 127].
+
+/// <summary>
+/// exp(x) with a range reduction to [-ln(2)/2, ln(2)/2] and the Cephes polynomial. Accurate to a few ulp.
+/// </summary>
+template <typename V>
+inline typename V::Reg VecExp(typename V::Reg x) {
+  x = V::Min(V::Max(x, V::Set1(-87.0f)), V::Set1(88.0f));
+
+  // x = n * ln(2) + r. ln(2) is split in two constants so that the product with its high part is exact.
+  const auto n = V::Floor(V::MulAdd(x, V::Set1(1.44269504088896341f), V::Set1(0.5f)));
+  auto r = V::MulAdd(n, V::Set1(-0.693359375f), x);
+  r = V::MulAdd(n, V::Set1(2.12194440e-4f), r);
+
+  auto p = V::Set1(1.9875691500e-4f);
+  p = V::MulAdd(p, r, V::Set1(1.3981999507e-3f));
+  p = V::MulAdd(p, r, V::Set1(8.3334519073e-3f));
+  p = V::MulAdd(p, r, V::Set1(4.1665795894e-2f));
+  p = V::MulAdd(p, r, V::Set1(1.6666665459e-1f));
+  p = V::MulAdd(p, r, V::Set1(5.0000001201e-1f));
+  p = V::MulAdd(p, V::Mul(r, r), V::Add(r, V::Set1(1.0f)));
+
+  return V::Mul(p, V::Pow2n(n));
+}
+
+template <typename V>
+inline typename V::Reg VecSigmoid(typename V::Reg x) {
+  const auto one = V::Set1(1.0f);
+  return V::Div(one, V::Add(one, VecExp<V>(V::Sub(V::Set1(0.0f), x))));
+}
+
+/// <summary>
+/// tanh(x) as a [13/6] rational approximation on [-9, 9], outside of which tanh(x) rounds to +/-1.
+/// </summary>
+template <typename V>
+inline typename V::Reg VecTanh(typename V::Reg x) {
+  x = V::Min(V::Max(x, V::Set1(-9.0f)), V::Set1(9.0f));
+  const auto x2 = V::Mul(x, x);
+
+  auto p = V::Set1(-2.76076847742355e-16f);
+  p = V::MulAdd(p, x2, V::Set1(2.00018790482477e-13f));
+  p = V::MulAdd(p, x2, V::Set1(-8.60467152213735e-11f));
+  p = V::MulAdd(p, x2, V::Set1(5.12229709037114e-08f));
+  p = V::MulAdd(p, x2, V::Set1(1.48572235717979e-05f));
+  p = V::MulAdd(p, x2, V::Set1(6.37261928875436e-04f));
+  p = V::MulAdd(p, x2, V::Set1(4.89352455891786e-03f));
+  p = V::Mul(p, x);
+
+  auto q = V::Set1(1.19825839466702e-06f);
+  q = V::MulAdd(q, x2, V::Set1(1.18534705686654e-04f));
+  q = V::MulAdd(q, x2, V::Set1(2.26843463243900e-03f));
+  q = V::MulAdd(q, x2, V::Set1(4.89352518554385e-03f));
+
+  return V::Div(p, q);
+}
+
+// Runs the full vectors of an elementwise loop and returns the number of elements that were processed. The input
+// layout is a template parameter so that each combination gets a branch-free loop. Unary ops ignore `input1`.
+template <typename V, bool kIsBinary, bool kIsBroadcast0, bool kIsBroadcast1, typename VecFn>
+inline size_t RunVectorLoop(const float* input0, const float* input1, float* output, size_t count, VecFn fn) {
+  const auto broadcast0 = V::Set1(*input0);
+  const auto broadcast1 = kIsBinary ? V::Set1(*input1) : broadcast0;
+
+  size_t i = 0;
+  for (; i + V::kWidth <= count; i += V::kWidth) {
+    const auto value0 = kIsBroadcast0 ? broadcast0 : V::Load(input0 + i);
+    const auto value1 = !kIsBinary ? value0 : kIsBroadcast1 ? broadcast1 : V::Load(input1 + i);
+    V::Store(output + i, fn(value0, value1));
+  }
+
+  return i;
+}
+
+/// <summary>
+/// Gets the instantiation `Ops::Run<op, is_broadcast0, is_broadcast1>` for an op and an input layout. Unary ops are
+/// instantiated with is_broadcast1 = false, and ops whose inputs are all broadcast with a single layout.
+/// </summary>
+template <typename Ops>
+ElementwiseOpFn SelectElementwiseOpFn(ElementwiseOp op, bool is_broadcast0, bool is_broadcast1) {
+  auto select_layout = [&]<ElementwiseOp kOp>() -> ElementwiseOpFn {
+    if (!IsBinaryOp(kOp) || (is_broadcast0 && is_broadcast1)) {
+      return is_broadcast0 ? &Ops::template Run<kOp, true, IsBinaryOp(kOp)> : &Ops::template Run<kOp, false, false>;
+    }
+
+    if (is_broadcast0) {
+      return &Ops::template Run<kOp, true, false>;
+    }
+
+    return is_broadcast1 ? &Ops::template Run<kOp, false, true> : &Ops::template Run<kOp, false, false>;
+  };
+
+  switch (op) {
+    case ElementwiseOp::Add:
+      return select_layout.template operator()<ElementwiseOp::Add>();
+    case ElementwiseOp::Sub:
+      return select_layout.template operator()<ElementwiseOp::Sub>();
+    case ElementwiseOp::Mul:
+      return select_layout.template operator()<ElementwiseOp::Mul>();
+    case ElementwiseOp::Div:
+      return select_layout.template operator()<ElementwiseOp::Div>();
+    case ElementwiseOp::Relu:
+      return select_layout.template operator()<ElementwiseOp::Relu>();
+    case ElementwiseOp::Sigmoid:
+      return select_layout.template operator()<ElementwiseOp::Sigmoid>();
+    case ElementwiseOp::Tanh:
+      return select_layout.template operator()<ElementwiseOp::Tanh>();
+    case ElementwiseOp::Clip:
+      return select_layout.template operator()<ElementwiseOp::Clip>();
+    case ElementwiseOp::Copy:
+      return select_layout.template operator()<ElementwiseOp::Copy>();
+  }
+
+  return nullptr;
+}
+
+// Gets the vector function of an op. Unary ops ignore their second argument.
+template <typename V, ElementwiseOp kOp>
+inline auto GetVecOpFn(const ElementwiseNode& node) {
+  using Reg = typename V::Reg;
+
+  if constexpr (kOp == ElementwiseOp::Add) {
+    return [](Reg a, Reg b) { return V::Add(a, b); };
+  } else if constexpr (kOp == ElementwiseOp::Sub) {
+    return [](Reg a, Reg b) { return V::Sub(a, b); };
+  } else if constexpr (kOp == ElementwiseOp::Mul) {
+    return [](Reg a, Reg b) { return V::Mul(a, b); };
+  } else if constexpr (kOp == ElementwiseOp::Div) {
+    return [](Reg a, Reg b) { return V::Div(a, b); };
+  } else if constexpr (kOp == ElementwiseOp::Relu) {
+    return [](Reg x, Reg) { return V::Max(x, V::Set1(0.0f)); };
+  } else if constexpr (kOp == ElementwiseOp::Sigmoid) {
+    return [](Reg x, Reg) { return VecSigmoid<V>(x); };
+  } else if constexpr (kOp == ElementwiseOp::Tanh) {
+    return [](Reg x, Reg) { return VecTanh<V>(x); };
+  } else if constexpr (kOp == ElementwiseOp::Clip) {
+    const Reg min = V::Set1(node.clip_min);
+    const Reg max = V::Set1(node.clip_max);
+    return [min, max](Reg x, Reg) { return V::Min(V::Max(x, min), max); };
+  } else {
+    return [](Reg x, Reg) { return x; };
+  }
+}
+
+/// <summary>
+/// Vectorized kernels for a vector traits type, for use with SelectElementwiseOpFn().
+/// </summary>
+template <typename V>
+struct SimdElementwiseOps {
+  template <ElementwiseOp kOp, bool kIsBroadcast0, bool kIsBroadcast1>
+  static void Run(const ElementwiseNode& node, const float* input0, const float* input1, float* output,
+                  size_t count) {
+    constexpr bool kIsBinary = IsBinaryOp(kOp);
+
+    if constexpr (kIsBroadcast0 && (kIsBroadcast1 || !kIsBinary)) {
+      // All inputs are single values: compute one value and fill the output.
+      RunElementwiseOpScalar(node, input0, true, input1, true, output, count);
+    } else {
+      if constexpr (kOp == ElementwiseOp::Copy) {
+        if (output == input0) {
+          return;
+        }
+      }
+
+      const size_t num_done = RunVectorLoop<V, kIsBinary, kIsBroadcast0, kIsBroadcast1>(input0, input1, output, count,
+                                                                                         GetVecOpFn<V, kOp>(node));
+
+      if (num_done < count) {
+        RunElementwiseOpScalar(node, kIsBroadcast0 ? input0 : input0 + num_done, kIsBroadcast0,
+                               !kIsBinary || kIsBroadcast1 ? input1 : input1 + num_done, kIsBroadcast1,
+                               output + num_done, count - num_done);
+      }
+    }
+  }
+};
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// NEON is part of the ARM64 baseline, so this file needs no special compiler flags.
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#include <arm_neon.h>
+
+#include "elementwise_kernels_impl.h"
+
+namespace {
+
+struct NeonVec {
+  using Reg = float32x4_t;
+  static constexpr size_t kWidth = 4;
+
+  static Reg Load(const float* data) { return vld1q_f32(data); }
+  static void Store(float* data, Reg value) { vst1q_f32(data, value); }
+  static Reg Set1(float value) { return vdupq_n_f32(value); }
+  static Reg Add(Reg a, Reg b) { return vaddq_f32(a, b); }
+  static Reg Sub(Reg a, Reg b) { return vsubq_f32(a, b); }
+  static Reg Mul(Reg a, Reg b) { return vmulq_f32(a, b); }
+  static Reg Div(Reg a, Reg b) { return vdivq_f32(a, b); }
+  static Reg Min(Reg a, Reg b) { return vminq_f32(a, b); }
+  static Reg Max(Reg a, Reg b) { return vmaxq_f32(a, b); }
+  static Reg MulAdd(Reg a, Reg b, Reg c) { return vfmaq_f32(c, a, b); }
+  static Reg Floor(Reg value) { return vrndmq_f32(value); }
+
+  static Reg Pow2n(Reg n) {
+    const int32x4_t exponent = vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127));
+    return vreinterpretq_f32_s32(vshlq_n_s32(exponent, 23));
+  }
+};
+
+}  // namespace
+
+ElementwiseOpFn GetElementwiseOpFnNeon(ElementwiseOp op, bool is_broadcast0, bool is_broadcast1) {
+  return SelectElementwiseOpFn<SimdElementwiseOps<NeonVec>>(op, is_broadcast0, is_broadcast1);
+}
+
+#endif  // defined(__aarch64__) || defined(_M_ARM64)
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "elementwise_ops.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "plugin_ep_utils.h"
+
+// Reads an optional scalar float constant (e.g., Clip's min or max input). Sets `is_constant` to false if the input
+// is provided but is not a float32 scalar constant initializer.
+static OrtStatus* GetOptionalScalarConstant(Ort::ConstValueInfo input, /*out*/ float& value,
+                                            /*out*/ bool& is_constant) {
+  is_constant = true;
+
+  if (input == nullptr) {
+    return nullptr;  // Missing optional input: keep the default value.
+  }
+
+  if (!input.IsConstantInitializer()) {
+    is_constant = false;
+    return nullptr;
+  }
+
+  Ort::ConstValue initializer;
+  RETURN_IF_ERROR(input.GetInitializer(initializer));
+
+  auto type_shape = initializer.GetTensorTypeAndShapeInfo();
+  if (type_shape.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT || type_shape.GetElementCount() != 1) {
+    is_constant = false;
+    return nullptr;
+  }
+
+  value = *initializer.GetTensorData<float>();
+  return nullptr;
+}
+
+// Reads an optional float attribute (e.g., Clip's min or max attribute before opset 11).
+static OrtStatus* GetOptionalFloatAttribute(Ort::ConstNode node, const char* name, /*out*/ float& value) {
+  Ort::ConstOpAttr attr;
+  Ort::Status status = node.GetAttributeByName(name, attr);
+  if (!status.IsOK()) {
+    return nullptr;  // Attribute is not set: keep the default value.
+  }
+
+  RETURN_IF(attr.GetType() != OrtOpAttrType::ORT_OP_ATTR_FLOAT, "Expected a float attribute");
+  RETURN_IF_ERROR(attr.GetValue(value));
+  return nullptr;
+}
+
+OrtStatus* GetElementwiseNode(Ort::ConstNode node, /*out*/ std::optional<ElementwiseNode>& result) {
+  result = std::nullopt;
+
+  static const std::unordered_map<std::string_view, ElementwiseOp> kOpsByType = {
+      {"Add", ElementwiseOp::Add},         {"Sub", ElementwiseOp::Sub},   {"Mul", ElementwiseOp::Mul},
+      {"Div", ElementwiseOp::Div},         {"Relu", ElementwiseOp::Relu}, {"Sigmoid", ElementwiseOp::Sigmoid},
+      {"Tanh", ElementwiseOp::Tanh},       {"Clip", ElementwiseOp::Clip}, {"Cast", ElementwiseOp::Copy},
+  };
+
+  const std::string domain = node.GetDomain();
+  if (!domain.empty() && domain != "ai.onnx") {
+    return nullptr;
+  }
+
+  const std::string op_type = node.GetOperatorType();
+  auto op_iter = kOpsByType.find(op_type);
+  if (op_iter == kOpsByType.end()) {
+    return nullptr;
+  }
+
+  ElementwiseNode elementwise_node;
+  elementwise_node.op = op_iter->second;
+
+  std::vector<Ort::ConstValueInfo> inputs = node.GetInputs();
+  std::vector<Ort::ConstValueInfo> outputs = node.GetOutputs();
+  if (inputs.size() < GetNumTensorInputs(elementwise_node.op) || outputs.size() != 1) {
+    return nullptr;
+  }
+
+  if (op_type == "Cast") {
+    // Only a cast from float32 to float32 (i.e., a copy) stays in the float32 domain of the fused kernel.
+    Ort::ConstOpAttr to_attr;
+    RETURN_IF_ERROR(node.GetAttributeByName("to", to_attr));
+
+    int64_t to = 0;
+    RETURN_IF_ERROR(to_attr.GetValue(to));
+    if (to != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+      return nullptr;
+    }
+  } else if (op_type == "Clip") {
+    if (node.GetSinceVersion() < 11) {
+      RETURN_IF_ERROR(GetOptionalFloatAttribute(node, "min", elementwise_node.clip_min));
+      RETURN_IF_ERROR(GetOptionalFloatAttribute(node, "max", elementwise_node.clip_max));
+    } else {
+      bool min_is_constant = true;
+      bool max_is_constant = true;
+
+      if (inputs.size() > 1) {
+        RETURN_IF_ERROR(GetOptionalScalarConstant(inputs[1], elementwise_node.clip_min, min_is_constant));
+      }
+
+      if (inputs.size() > 2) {
+        RETURN_IF_ERROR(GetOptionalScalarConstant(inputs[2], elementwise_node.clip_max, max_is_constant));
+      }
+
+      if (!min_is_constant || !max_is_constant) {
+        return nullptr;  // Clip bounds must be known when the kernel is compiled.
+      }
+    }
+  }
+
+  result = elementwise_node;
+  return nullptr;
+}
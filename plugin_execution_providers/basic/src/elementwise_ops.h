@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+
+#define ORT_API_MANUAL_INIT
+#include "onnxruntime_cxx_api.h"
+#undef ORT_API_MANUAL_INIT
+
+/// <summary>
+/// Elementwise float32 operators that the basic plugin EP can fuse.
+/// </summary>
+enum class ElementwiseOp {
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Relu,
+  Sigmoid,
+  Tanh,
+  Clip,
+  Copy,  // Cast to float32 of a float32 tensor.
+};
+
+/// <summary>
+/// An elementwise node and its constant parameters.
+/// </summary>
+struct ElementwiseNode {
+  ElementwiseOp op = ElementwiseOp::Copy;
+  float clip_min = std::numeric_limits<float>::lowest();
+  float clip_max = std::numeric_limits<float>::max();
+};
+
+constexpr bool IsBinaryOp(ElementwiseOp op) {
+  return op == ElementwiseOp::Add || op == ElementwiseOp::Sub || op == ElementwiseOp::Mul || op == ElementwiseOp::Div;
+}
+
+/// <summary>
+/// Gets the number of tensor inputs that the EP reads for an elementwise node. Clip's optional min and max inputs are
+/// constants that are stored in the ElementwiseNode instead.
+/// </summary>
+constexpr size_t GetNumTensorInputs(ElementwiseOp op) { return IsBinaryOp(op) ? 2 : 1; }
+
+/// <summary>
+/// Checks if a node is a supported elementwise operator and gets its parameters. Does not check the types or shapes
+/// of the node's tensor inputs and outputs.
+/// </summary>
+/// <param name="node">The node to check</param>
+/// <param name="result">Output parameter set to the node's parameters, or std::nullopt if the node is not
+/// supported</param>
+/// <returns>An OrtStatus* on error, nullptr on success</returns>
+OrtStatus* GetElementwiseNode(Ort::ConstNode node, /*out*/ std::optional<ElementwiseNode>& result);
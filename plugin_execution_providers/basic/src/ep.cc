@@ -3,113 +3,34 @@
 
 #include "ep.h"
 
-#include <array>
+#include <algorithm>
+#include <fstream>
 #include <memory>
+#include <optional>
 #include <span>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
+#include "blob_utils.h"
+#include "broadcast_utils.h"
+#include "data_transfer.h"
+#include "elementwise_ops.h"
+#include "ep_context.h"
 #include "ep_factory.h"
+#include "ep_kernel.h"
+#include "fused_kernel.h"
+#include "gemm_kernel.h"
+#include "kernel_cache.h"
+#include "kernel_profiler.h"
+#include "mapped_file.h"
+#include "partitioning_utils.h"
 #include "plugin_ep_utils.h"
-
-/// <summary>
-/// Example implementation of ONNX Mul. Does not handle many things like broadcasting.
-/// </summary>
-struct MulKernel {
-  MulKernel(const OrtApi& ort_api, const OrtLogger& logger,
-            const std::unordered_map<std::string, FloatInitializer>& float_initializers,
-            std::string input0_name, std::string input1_name)
-      : ort_api(ort_api),
-        logger(logger),
-        float_initializers(float_initializers),
-        input0_name(input0_name),
-        input1_name(input1_name) {}
-
-  const FloatInitializer* TryGetSavedInitializer(const std::string& name) const {
-    auto iter = float_initializers.find(name);
-    return iter != float_initializers.end() ? &iter->second : nullptr;
-  }
-
-  OrtStatus* GetInputDataAndShape(Ort::KernelContext kernel_context, size_t index,
-                                  /*out*/ std::span<const float>& data,
-                                  /*out*/ std::vector<int64_t>& shape) const {
-    Ort::ConstValue input = kernel_context.GetInput(index);
-    auto type_shape = input.GetTensorTypeAndShapeInfo();
-
-    ONNXTensorElementDataType elem_type = type_shape.GetElementType();
-    RETURN_IF(elem_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, "EP Expected float32 inputs");
-
-    const float* float_data = input.GetTensorData<float>();
-    size_t num_elems = type_shape.GetElementCount();
-    data = std::span<const float>(float_data, num_elems);
-    shape = type_shape.GetShape();
-    return nullptr;
-  }
-
-  OrtStatus* Compute(OrtKernelContext* kernel_ctx) {
-    LOG(ort_api, &logger, INFO, "Running Mul kernel...");
-
-    Ort::KernelContext kernel_context(kernel_ctx);
-
-    std::span<const float> input0;
-    std::span<const float> input1;
-    std::vector<int64_t> shape0;
-    std::vector<int64_t> shape1;
-
-    size_t num_inputs = kernel_context.GetInputCount();
-
-    if (num_inputs == 2) {
-      // Both inputs are non-constant. Get them from ORT's KernelContext.
-      RETURN_IF_ERROR(GetInputDataAndShape(kernel_context, 0, input0, shape0));
-      RETURN_IF_ERROR(GetInputDataAndShape(kernel_context, 1, input1, shape1));
-    } else if (num_inputs == 1) {
-      // ORT is only providing one non-constant input because this EP chose not to request constant initializer inputs.
-      // Get the constant input from the initializers saved by the EP.
-      // Refer to "NodeFusionOptions_DropConstantInitializers()".
-
-      if (const FloatInitializer* const_input0 = TryGetSavedInitializer(input0_name); const_input0 != nullptr) {
-        RETURN_IF_ERROR(GetInputDataAndShape(kernel_context, 0, input1, shape1));
-        input0 = std::span<const float>(const_input0->data);
-        shape0 = const_input0->shape;
-      } else if (const FloatInitializer* const_input1 = TryGetSavedInitializer(input1_name); const_input1 != nullptr) {
-        RETURN_IF_ERROR(GetInputDataAndShape(kernel_context, 0, input0, shape0));
-        input1 = std::span<const float>(const_input1->data);
-        shape1 = const_input1->shape;
-      }
-    } else {
-      // Both inputs are constant. Should never happen unless all ORT optimizations (specifically constant-folding)
-      // are disabled.
-      const FloatInitializer* const_input0 = TryGetSavedInitializer(input0_name);
-      const FloatInitializer* const_input1 = TryGetSavedInitializer(input1_name);
-      RETURN_IF(const_input0 == nullptr || const_input1 == nullptr, "Expected 2 initializer inputs to be saved by EP");
-
-      input0 = std::span<const float>(const_input0->data);
-      input1 = std::span<const float>(const_input1->data);
-      shape0 = const_input0->shape;
-      shape1 = const_input1->shape;
-    }
-
-    RETURN_IF(shape0 != shape1, "Expected same dimensions for both inputs");
-
-    size_t num_outputs = kernel_context.GetOutputCount();
-    RETURN_IF(num_outputs != 1, "Expected 1 output for MulKernel");
-
-    auto output = kernel_context.GetOutput(0, shape0);
-    float* output_data = output.GetTensorMutableData<float>();
-
-    for (size_t i = 0; i < input0.size(); ++i) {
-      output_data[i] = input0[i] * input1[i];
-    }
-
-    return nullptr;
-  }
-
-  const OrtApi& ort_api;
-  const OrtLogger& logger;
-  const std::unordered_map<std::string, FloatInitializer>& float_initializers;
-  std::string input0_name;
-  std::string input1_name;
-};
+#include "qdq_kernel.h"
+#include "sync_stream.h"
+#include "thread_pool.h"
 
 /// <summary>
 /// Example OrtNodeComputeInfo that represents the computation function for a compiled OrtGraph.
@@ -135,7 +56,9 @@ BasicPluginEp::BasicPluginEp(BasicPluginEpFactory& factory, const BasicPluginEp:
       ep_api_{factory.GetEpApi()},
       model_editor_api_{factory.GetModelEditorApi()},
       name_{factory.GetEpName()},
-      logger_{logger} {
+      logger_{logger},
+      data_transfer_{factory.GetDataTransfer()},
+      kernel_cache_{factory.GetKernelCache()} {
   ort_version_supported = ORT_API_VERSION;  // set to the ORT version we were compiled with.
 
   // Initialize the execution provider's function table
@@ -144,18 +67,60 @@ BasicPluginEp::BasicPluginEp(BasicPluginEpFactory& factory, const BasicPluginEp:
   Compile = CompileImpl;
   ReleaseNodeComputeInfos = ReleaseNodeComputeInfosImpl;
 
-  LOG(GetOrtApi(), &logger_, INFO, "BasicPluginEp has been created with name " << name_);
+  if (data_transfer_ != nullptr) {
+    OnRunStart = OnRunStartImpl;
+    OnRunEnd = OnRunEndImpl;
+  }
+
+  const size_t num_threads = config_.num_threads != 0 ? config_.num_threads
+                                                      : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  if (num_threads > 1) {
+    thread_pool_ = std::make_unique<ThreadPool>(num_threads);
+  }
+
+  kernel_resources_.thread_pool = thread_pool_.get();
+  kernel_resources_.parallel_min_elements = config_.parallel_min_elements;
+
+  if (config_.enable_profiling) {
+    profiler_ = std::make_unique<KernelProfiler>();
+    kernel_resources_.profiler = profiler_.get();
+  }
+
+  LOG(GetOrtApi(), &logger_, INFO, "BasicPluginEp has been created with name " << name_ << ", " << num_threads
+                                       << " intra-op thread(s) and " << SimdLevelToString(config_.simd_level)
+                                       << " kernels");
 }
 
-BasicPluginEp::~BasicPluginEp() = default;
+BasicPluginEp::~BasicPluginEp() {
+  // ORT releases the EP with its session, after the session's runs have finished.
+  if (profiler_ != nullptr) {
+    WriteProfilingSummary();
+  }
+}
 
-MulKernel* BasicPluginEp::FindKernelForFusedNode(const std::string& fused_node_name) {
-  if (auto it = kernels_.find(fused_node_name); it != kernels_.end()) {
-    return it->second.get();
+const BasicPluginEp::CompiledNode* BasicPluginEp::FindCompiledNode(const std::string& fused_node_name) {
+  if (auto it = compiled_nodes_.find(fused_node_name); it != compiled_nodes_.end()) {
+    return &it->second;
   }
   return nullptr;
 }
 
+void BasicPluginEp::WriteProfilingSummary() const {
+  std::ostringstream summary;
+  profiler_->WriteSummary(summary);
+  LOG(ort_api_, &logger_, INFO, "Kernel profiling summary of " << name_ << ":\n" << summary.str());
+
+  if (config_.profiling_file.empty()) {
+    return;
+  }
+
+  std::ofstream file(config_.profiling_file);
+  file << summary.str();
+  if (!file) {
+    LOG(ort_api_, &logger_, WARNING, "Unable to write the kernel profiling summary to " << config_.profiling_file);
+  }
+}
+
 /*static*/
 const char* ORT_API_CALL BasicPluginEp::GetNameImpl(const OrtEp* this_ptr) noexcept {
   const auto* ep = static_cast<const BasicPluginEp*>(this_ptr);
@@ -165,29 +130,145 @@ const char* ORT_API_CALL BasicPluginEp::GetNameImpl(const OrtEp* this_ptr) noexc
 OrtStatus* BasicPluginEp::SaveConstantInitializers(const OrtGraph* ort_graph) {
   Ort::ConstGraph graph{ort_graph};
 
-  std::vector<Ort::ConstValueInfo> initializers = graph.GetInitializers();
+  // Only save the initializers that the subgraph's nodes read. Initializers that were saved for a previously compiled
+  // subgraph are shared.
+  for (const Ort::ConstNode& node : graph.GetNodes()) {
+    for (const Ort::ConstValueInfo& input : node.GetInputs()) {
+      if (input == nullptr || !input.IsConstantInitializer() || float_initializers_.count(input.GetName()) != 0) {
+        continue;
+      }
+
+      RETURN_IF_ERROR(SaveConstantInitializer(graph, input));
+    }
+  }
+
+  return nullptr;
+}
+
+OrtStatus* BasicPluginEp::SaveConstantInitializer(Ort::ConstGraph graph, Ort::ConstValueInfo initializer) {
+  Ort::ConstValue value;
+  RETURN_IF_ERROR(initializer.GetInitializer(value));
+
+  auto type_shape = value.GetTensorTypeAndShapeInfo();
+  const size_t num_elems = type_shape.GetElementCount();
+  const ONNXTensorElementDataType elem_type = type_shape.GetElementType();
+  RETURN_IF(elem_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, "Expected float32 initializers");
+
+  FloatInitializer ep_initializer = {};
+  ep_initializer.shape = type_shape.GetShape();
+
+  // Read external data in place. ORT drops its copy of the initializer after Compile() returns (see GetCapability()),
+  // so data stored in the model must be copied.
+  RETURN_IF_ERROR(GetExternalInitializerData(graph, initializer, num_elems * sizeof(float), ep_initializer.storage));
+
+  if (ep_initializer.storage == nullptr) {
+    const float* data = value.GetTensorData<float>();
+    ep_initializer.storage = std::make_shared<const std::vector<float>>(data, data + num_elems);
+    ep_initializer.data = static_cast<const std::vector<float>*>(ep_initializer.storage.get())->data();
+  } else {
+    ep_initializer.data = static_cast<const float*>(ep_initializer.storage.get());
+  }
+
+  float_initializers_.emplace(initializer.GetName(), std::move(ep_initializer));
+  return nullptr;
+}
+
+OrtStatus* BasicPluginEp::GetExternalInitializerData(Ort::ConstGraph graph, Ort::ConstValueInfo initializer,
+                                                     size_t num_bytes, /*out*/ std::shared_ptr<const void>& data) {
+  data = nullptr;
+
+  OrtExternalInitializerInfo* ort_info = nullptr;
+  RETURN_IF_ERROR(ort_api_.ValueInfo_GetExternalInitializerInfo(initializer, &ort_info));
+  if (ort_info == nullptr) {
+    return nullptr;  // Stored in the model.
+  }
+
+  std::unique_ptr<OrtExternalInitializerInfo, decltype(ort_api_.ReleaseExternalInitializerInfo)> info(
+      ort_info, ort_api_.ReleaseExternalInitializerInfo);
+
+  // The location of an external data file is relative to the model's directory. Without a model path (e.g., the
+  // model was loaded from memory), the data may not come from a file at all.
+  const std::filesystem::path model_path{graph.GetModelPath()};
+  std::filesystem::path path{ort_api_.ExternalInitializerInfo_GetFilePath(info.get())};
+  if (path.is_relative()) {
+    if (model_path.empty()) {
+      return nullptr;
+    }
+
+    path = model_path.parent_path() / path;
+  }
+
+  const int64_t offset = ort_api_.ExternalInitializerInfo_GetFileOffset(info.get());
+  const size_t byte_size = ort_api_.ExternalInitializerInfo_GetByteSize(info.get());
+
+  // Fall back to a copy if the data cannot be read in place.
+  if (offset < 0 || offset % alignof(float) != 0 || byte_size != num_bytes) {
+    return nullptr;
+  }
+
+  std::shared_ptr<MappedFile>& file = mapped_files_[path];
+  if (file == nullptr) {
+    file = MappedFile::Open(path);
+    if (file == nullptr) {
+      LOG(ort_api_, &logger_, VERBOSE, "Unable to map external data file " << path.string()
+                                           << ". Copying initializer " << initializer.GetName());
+      mapped_files_.erase(path);
+      return nullptr;
+    }
+  }
+
+  if (static_cast<uint64_t>(offset) > file->GetSize() || file->GetSize() - offset < num_bytes) {
+    return nullptr;
+  }
+
+  // The initializer shares ownership of the mapping.
+  data = std::shared_ptr<const void>(file, file->GetData() + offset);
+  return nullptr;
+}
+
+// Checks if a node is an elementwise op that the fused kernel can compute: all tensor inputs and the output must be
+// float32 tensors with static shapes, and the output shape must be the broadcast of the input shapes.
+static OrtStatus* IsNodeSupported(Ort::ConstNode node, /*out*/ bool& is_supported) {
+  is_supported = false;
+
+  std::optional<ElementwiseNode> elementwise_node;
+  RETURN_IF_ERROR(GetElementwiseNode(node, elementwise_node));
+  if (!elementwise_node.has_value()) {
+    return nullptr;  // Not a supported op
+  }
+
+  const auto get_static_float_shape = [](Ort::ConstValueInfo value_info) -> std::optional<std::vector<int64_t>> {
+    bool is_float = false;
+    IsFloatTensor(value_info, is_float);
+    if (!is_float) {
+      return std::nullopt;  // Not of type float
+    }
 
-  for (const auto& initializer : initializers) {
-    const bool is_constant = initializer.IsConstantInitializer();
+    auto shape = GetTensorShape(value_info);
+    if (!shape.has_value() || std::any_of(shape->begin(), shape->end(), [](int64_t dim) { return dim < 0; })) {
+      return std::nullopt;  // Unable to get shape or shape has dynamic dimensions
+    }
 
-    if (is_constant) {
-      auto name = initializer.GetName();
-      Ort::ConstValue value;
-      RETURN_IF_ERROR(initializer.GetInitializer(value));
+    return shape;
+  };
 
-      auto type_shape = value.GetTensorTypeAndShapeInfo();
-      const size_t num_elems = type_shape.GetElementCount();
-      const ONNXTensorElementDataType elem_type = type_shape.GetElementType();
-      RETURN_IF(elem_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, "Expected float32 initializers");
+  const auto output_shape = get_static_float_shape(node.GetOutputs()[0]);
+  if (!output_shape.has_value()) {
+    return nullptr;
+  }
 
-      std::vector<int64_t> dims = type_shape.GetShape();
-      const float* data = value.GetTensorData<float>();
+  std::vector<Ort::ConstValueInfo> inputs = node.GetInputs();
+  std::vector<int64_t> broadcast_shape;
 
-      FloatInitializer ep_initializer = {std::move(dims), std::vector<float>(data, data + num_elems)};
-      float_initializers_.emplace(std::move(name), std::move(ep_initializer));
+  for (size_t i = 0; i < GetNumTensorInputs(elementwise_node->op); ++i) {
+    const auto input_shape = get_static_float_shape(inputs[i]);
+    if (!input_shape.has_value() || !GetBroadcastShape(broadcast_shape, *input_shape, broadcast_shape)) {
+      return nullptr;
     }
   }
 
+  // The fused kernel writes outputs with the broadcast shape of the inputs.
+  is_supported = broadcast_shape == *output_shape;
   return nullptr;
 }
 
@@ -204,74 +285,194 @@ OrtStatus* ORT_API_CALL BasicPluginEp::GetCapabilityImpl(OrtEp* this_ptr, const
     return nullptr;  // No nodes to process
   }
 
-  std::vector<Ort::ConstNode> supported_nodes;
+  // Create (optional) fusion options for the supported nodes to fuse.
+  OrtNodeFusionOptions node_fusion_options = {};
+  node_fusion_options.ort_version_supported = ORT_API_VERSION;
+
+  // Set "drop constant initializers" to true if the compiling EP doesn't need ORT to provide constant initializers
+  // as inputs to the fused/compiled node at inference time. This allows ORT to release unused initializers.
+  // This example EP sets this to true and saves initializers during the call to OrtEp::Compile for use
+  // during inference.
+  node_fusion_options.drop_constant_initializers = true;
+
+  std::unordered_set<size_t> supported_node_ids;
 
   for (const auto& node : nodes) {
-    auto op_type = node.GetOperatorType();
+    // Each EPContext node that this EP created is compiled on its own, from its serialized kernel.
+    bool is_ep_context_node = false;
+    RETURN_IF_ERROR(IsEpContextNodeForEp(node, ep->name_, is_ep_context_node));
+    if (is_ep_context_node) {
+      const OrtNode* ort_node = node;
+      RETURN_IF_ERROR(ep->ep_api_.EpGraphSupportInfo_AddNodesToFuse(graph_support_info, &ort_node, 1,
+                                                                    &node_fusion_options));
+      continue;
+    }
 
-    if (op_type == "Mul") {
-      // Check that Mul has inputs/output of type float
-      std::vector<Ort::ConstValueInfo> inputs = node.GetInputs();
-      std::vector<Ort::ConstValueInfo> outputs = node.GetOutputs();
+    // Each QDQ node unit (DequantizeLinear -> Add, Mul or MatMul -> QuantizeLinear) is compiled on its own, into a
+    // QdqKernel that computes on the quantized data. The unit is found from its op, which follows the unit's
+    // DequantizeLinear nodes in topological order. Those are not supported on their own.
+    std::optional<QdqNodeUnit> qdq_node_unit;
+    RETURN_IF_ERROR(GetQdqNodeUnit(node, qdq_node_unit));
+    if (qdq_node_unit.has_value()) {
+      RETURN_IF_ERROR(ep->ep_api_.EpGraphSupportInfo_AddNodesToFuse(
+          graph_support_info,
+          reinterpret_cast<const OrtNode* const*>(qdq_node_unit->nodes.data()),
+          qdq_node_unit->nodes.size(),
+          &node_fusion_options));
+      continue;
+    }
 
-      RETURN_IF(inputs.size() != 2 || outputs.size() != 1, "Mul should have 2 inputs and 1 output");
+    // Each MatMul or Gemm with a constant B is compiled on its own, into a GemmKernel that prepacks B.
+    std::optional<GemmNode> gemm_node;
+    RETURN_IF_ERROR(GetGemmNode(node, gemm_node));
+    if (gemm_node.has_value()) {
+      const OrtNode* ort_node = node;
+      RETURN_IF_ERROR(ep->ep_api_.EpGraphSupportInfo_AddNodesToFuse(graph_support_info, &ort_node, 1,
+                                                                    &node_fusion_options));
+      continue;
+    }
 
-      std::array<bool, 3> is_float = {false, false, false};
-      IsFloatTensor(inputs[0], is_float[0]);
-      IsFloatTensor(inputs[1], is_float[1]);
-      IsFloatTensor(outputs[0], is_float[2]);
-      if (!is_float[0] || !is_float[1] || !is_float[2]) {
-        continue;  // Input or output is not of type float
-      }
+    bool is_supported = false;
+    RETURN_IF_ERROR(IsNodeSupported(node, is_supported));
+
+    if (is_supported) {
+      supported_node_ids.insert(node.GetId());
+    }
+  }
 
-      {
-        const auto input_0_shape = GetTensorShape(inputs[0]),
-                   input_1_shape = GetTensorShape(inputs[1]);
+  if (supported_node_ids.empty()) {
+    return nullptr;
+  }
 
-        if (!input_0_shape.has_value() || !input_1_shape.has_value()) {
-          continue;  // unable to get input shape
-        }
+  // Group the supported nodes into connected partitions that can each be fused without creating a cycle.
+  std::vector<std::vector<Ort::ConstNode>> partitions;
+  RETURN_IF_ERROR(PartitionSupportedNodes(graph, supported_node_ids, partitions));
+
+  // Each partition becomes one fused node, which is compiled into a single FusedKernel.
+  for (const std::vector<Ort::ConstNode>& partition : partitions) {
+    RETURN_IF_ERROR(ep->ep_api_.EpGraphSupportInfo_AddNodesToFuse(
+        graph_support_info,
+        reinterpret_cast<const OrtNode* const*>(partition.data()),
+        partition.size(),
+        &node_fusion_options));
+  }
 
-        const auto is_static_shape = [](std::span<const int64_t> shape) -> bool {
-          return std::all_of(shape.begin(), shape.end(), [](int64_t dim) { return dim >= 0; });
-        };
+  return nullptr;
 
-        if (!is_static_shape(*input_0_shape) || !is_static_shape(*input_1_shape)) {
-          continue;  // input shape has dynamic dimensions
-        }
+  EP_API_IMPL_END
+}
 
-        if (*input_0_shape != *input_1_shape) {
-          continue;  // input shapes do not match (no broadcasting support for now)
-        }
-      }
+OrtStatus* BasicPluginEp::CreateKernel(Ort::ConstGraph graph, Ort::ConstNode fused_node,
+                                       /*out*/ std::shared_ptr<const EpKernel>& kernel,
+                                       /*out*/ OrtNode** ep_context_node) {
+  // A subgraph with a single EPContext node that this EP created (see GetCapability()) is loaded from its serialized
+  // kernel. The kernel's initializers are read in place from the node's attribute or from the mapped kernel file.
+  std::vector<Ort::ConstNode> nodes = graph.GetNodes();
+  bool is_ep_context_node = false;
+  if (nodes.size() == 1) {
+    RETURN_IF_ERROR(IsEpContextNodeForEp(nodes[0], name_, is_ep_context_node));
+  }
 
-      supported_nodes.push_back(node);  // Only support a single Mul for now.
-      break;
+  if (is_ep_context_node) {
+    std::span<const uint8_t> blob;
+    std::shared_ptr<const void> blob_storage;
+    RETURN_IF_ERROR(ReadEpContextNode(graph, nodes[0], blob, blob_storage));
+
+    const std::string key = KernelCache::GetBlobKey(blob, config_.simd_level);
+    // Compute() trusts the types and shapes in the blob, so they are checked against the node's inputs and outputs.
+    // A cached kernel was loaded for another node with the same blob, so it is checked as well.
+    kernel = kernel_cache_.Find(key);
+    if (kernel != nullptr) {
+      return kernel->CheckGraphIO(graph);
     }
-  }
 
-  if (supported_nodes.empty()) {
+    // The magic at the start of the blob identifies the kernel class.
+    uint32_t magic = 0;
+    BlobReader(blob).Read(magic);
+
+    std::unique_ptr<EpKernel> new_kernel;
+    if (magic == GemmKernel::kBlobMagic) {
+      std::unique_ptr<GemmKernel> gemm_kernel;
+      RETURN_IF_ERROR(GemmKernel::Deserialize(ort_api_, blob, std::move(blob_storage), config_.simd_level,
+                                              gemm_kernel));
+      new_kernel = std::move(gemm_kernel);
+    } else if (magic == QdqKernel::kBlobMagic) {
+      std::unique_ptr<QdqKernel> qdq_kernel;
+      RETURN_IF_ERROR(QdqKernel::Deserialize(ort_api_, blob, std::move(blob_storage), qdq_kernel));
+      new_kernel = std::move(qdq_kernel);
+    } else {
+      std::unique_ptr<FusedKernel> fused_kernel;
+      RETURN_IF_ERROR(FusedKernel::Deserialize(ort_api_, blob, std::move(blob_storage), config_.simd_level,
+                                               fused_kernel));
+      new_kernel = std::move(fused_kernel);
+    }
+
+    RETURN_IF_ERROR(new_kernel->CheckGraphIO(graph));
+    kernel = kernel_cache_.Insert(key, std::move(new_kernel));
     return nullptr;
   }
 
-  // Create (optional) fusion options for the supported nodes to fuse.
-  OrtNodeFusionOptions node_fusion_options = {};
-  node_fusion_options.ort_version_supported = ORT_API_VERSION;
+  // Sessions of the same model share the kernels of identical subgraphs. A kernel that another session compiled
+  // is used as is, so its initializers are neither saved nor packed again.
+  std::string key;
+  RETURN_IF_ERROR(KernelCache::GetSubgraphKey(graph, config_.simd_level, key));
+  kernel = kernel_cache_.Find(key);
+
+  if (kernel != nullptr) {
+    LOG(ort_api_, &logger_, INFO, "Reusing the compiled kernel of another session for fused node "
+                                      << fused_node.GetName());
+  } else {
+    std::unique_ptr<EpKernel> new_kernel;
+    RETURN_IF_ERROR(CompileKernel(graph, new_kernel));
+    kernel = kernel_cache_.Insert(key, std::move(new_kernel));
+  }
 
-  // Set "drop constant initializers" to true if the compiling EP doesn't need ORT to provide constant initializers
-  // as inputs to the fused/compiled node at inference time. This allows ORT to release unused initializers.
-  // This example EP sets this to true and saves initializers during the call to OrtEp::Compile for use
-  // during inference.
-  node_fusion_options.drop_constant_initializers = true;
-  RETURN_IF_ERROR(ep->ep_api_.EpGraphSupportInfo_AddNodesToFuse(
-      graph_support_info,
-      reinterpret_cast<const OrtNode* const*>(supported_nodes.data()),
-      supported_nodes.size(),
-      &node_fusion_options));
+  if (config_.ep_context.enable) {
+    std::string blob;
+    kernel->Serialize(blob);
+    RETURN_IF_ERROR(CreateEpContextNode(ort_api_, model_editor_api_, graph, fused_node, name_, config_.ep_context,
+                                        blob, ep_context_node));
+  }
 
   return nullptr;
+}
 
-  EP_API_IMPL_END
+OrtStatus* BasicPluginEp::CompileKernel(Ort::ConstGraph graph, /*out*/ std::unique_ptr<EpKernel>& kernel) {
+  std::vector<Ort::ConstNode> nodes = graph.GetNodes();
+
+  // A single MatMul or Gemm node (see GetCapability()) gets a kernel that packs its B input from ORT's initializer.
+  std::optional<GemmNode> gemm_node;
+  if (nodes.size() == 1) {
+    RETURN_IF_ERROR(GetGemmNode(nodes[0], gemm_node));
+  }
+
+  // A QDQ node unit (see GetCapability()) is the only kind of subgraph with a QuantizeLinear node.
+  const bool is_qdq_node_unit = std::any_of(nodes.begin(), nodes.end(), [](Ort::ConstNode node) {
+    return node.GetOperatorType() == "QuantizeLinear";
+  });
+
+  if (is_qdq_node_unit) {
+    std::unique_ptr<QdqKernel> qdq_kernel;
+    RETURN_IF_ERROR(QdqKernel::Create(ort_api_, logger_, graph, qdq_kernel));
+    kernel = std::move(qdq_kernel);
+  } else if (gemm_node.has_value()) {
+    std::unique_ptr<GemmKernel> gemm_kernel;
+    RETURN_IF_ERROR(GemmKernel::Create(ort_api_, logger_, graph, config_.simd_level, gemm_kernel));
+    kernel = std::move(gemm_kernel);
+  } else {
+    // In GetCapability(), this EP specified that it doesn't need ORT to provide constant initializers during
+    // inference. So, this EP saves the constant initializers that the subgraph reads so that they're available
+    // during inference, but an actual EP implementation could transfer the weights to device memory.
+    RETURN_IF_ERROR(SaveConstantInitializers(graph));
+
+    // Compile all nodes of the subgraph into a single kernel.
+    std::unique_ptr<FusedKernel> fused_kernel;
+    RETURN_IF_ERROR(FusedKernel::Create(ort_api_, logger_, float_initializers_, graph, config_.simd_level,
+                                        fused_kernel));
+    kernel = std::move(fused_kernel);
+  }
+
+  return nullptr;
 }
 
 /*static*/
@@ -281,44 +482,36 @@ OrtStatus* ORT_API_CALL BasicPluginEp::CompileImpl(_In_ OrtEp* this_ptr, _In_ co
                                                    _Out_writes_(count) OrtNode** ep_context_nodes) noexcept {
   EP_API_IMPL_BEGIN
 
-  RETURN_IF(count != 1, "Expected to compile a single graph");
-
   auto* ep = static_cast<BasicPluginEp*>(this_ptr);
 
-  Ort::ConstGraph graph{ort_graphs[0]};
-
-  // In GetCapability(), this EP specified that it doesn't need ORT to provide constant initializers during inference.
-  // So, this EP saves constant initializers so that they're available during inference, but an actual EP
-  // implementation could transfer the weights to device memory.
-  RETURN_IF_ERROR(ep->SaveConstantInitializers(graph));
+  for (size_t i = 0; i < count; ++i) {
+    Ort::ConstGraph graph{ort_graphs[i]};
+    Ort::ConstNode fused_node{fused_nodes[i]};
+    auto ep_name = fused_node.GetEpName();
+    RETURN_IF(ep_name != ep->name_, "The fused node is expected to assigned to this EP to run on");
 
-  std::vector<Ort::ConstNode> nodes = graph.GetNodes();
-  RETURN_IF(nodes.size() != 1, "Expected to compile a single node");
+    std::shared_ptr<const EpKernel> kernel;
+    RETURN_IF_ERROR(ep->CreateKernel(graph, fused_node, kernel, &ep_context_nodes[i]));
 
-  auto node_op_type = nodes[0].GetOperatorType();
-  RETURN_IF(node_op_type != "Mul", "Expected to compile a Mul node");
+    // Associate the name of the fused node with its kernel.
+    auto fused_node_name = fused_node.GetName();
+    BasicPluginEp::CompiledNode compiled_node{std::move(kernel), ep->kernel_resources_};
 
-  // Now we know we're compiling a single Mul node. Create a computation kernel.
-  std::vector<Ort::ConstValueInfo> node_inputs = nodes[0].GetInputs();
-  std::array<std::string, 2> node_input_names;
-  node_input_names[0] = node_inputs[0].GetName();
-  node_input_names[1] = node_inputs[1].GetName();
+    if (ep->profiler_ != nullptr) {
+      std::string op_types;
+      for (Ort::ConstNode node : graph.GetNodes()) {
+        op_types += (op_types.empty() ? "" : "+") + node.GetOperatorType();
+      }
 
-  Ort::ConstNode fused_node{fused_nodes[0]};
-  auto ep_name = fused_node.GetEpName();
-  RETURN_IF(ep_name != ep->name_, "The fused node is expected to assigned to this EP to run on");
+      compiled_node.resources.profiler_node = ep->profiler_->AddNode(fused_node_name, std::move(op_types));
+    }
 
-  // Associate the name of the fused node with our MulKernel.
-  auto fused_node_name = fused_node.GetName();
-  ep->kernels_.emplace(std::move(fused_node_name), std::make_unique<MulKernel>(ep->GetOrtApi(),
-                                                                               ep->logger_,
-                                                                               ep->float_initializers_,
-                                                                               node_input_names[0],
-                                                                               node_input_names[1]));
+    ep->compiled_nodes_.emplace(std::move(fused_node_name), std::move(compiled_node));
 
-  // Update the OrtNodeComputeInfo associated with the graph.
-  auto node_compute_info = std::make_unique<ExampleNodeComputeInfo>(*ep);
-  node_compute_infos[0] = node_compute_info.release();
+    // Update the OrtNodeComputeInfo associated with the graph.
+    auto node_compute_info = std::make_unique<ExampleNodeComputeInfo>(*ep);
+    node_compute_infos[i] = node_compute_info.release();
+  }
 
   return nullptr;
 
@@ -334,6 +527,36 @@ void ORT_API_CALL BasicPluginEp::ReleaseNodeComputeInfosImpl(OrtEp* /*this_ptr*/
   }
 }
 
+// Data transfer statistics when the current thread's run started. The counters are shared by all sessions, so the
+// bytes of a run include copies of concurrent runs.
+static thread_local DataTransfer::Stats run_start_transfer_stats;
+
+/*static*/
+OrtStatus* ORT_API_CALL BasicPluginEp::OnRunStartImpl(OrtEp* this_ptr, const OrtRunOptions* /*run_options*/) noexcept {
+  const auto* ep = static_cast<const BasicPluginEp*>(this_ptr);
+  run_start_transfer_stats = ep->data_transfer_->GetStats();
+  return nullptr;
+}
+
+/*static*/
+OrtStatus* ORT_API_CALL BasicPluginEp::OnRunEndImpl(OrtEp* this_ptr, const OrtRunOptions* /*run_options*/,
+                                                    bool /*sync_stream*/) noexcept {
+  EP_API_IMPL_BEGIN
+
+  const auto* ep = static_cast<const BasicPluginEp*>(this_ptr);
+  const DataTransfer::Stats& start = run_start_transfer_stats;
+  const DataTransfer::Stats end = ep->data_transfer_->GetStats();
+
+  LOG(ep->ort_api_, &ep->logger_, INFO,
+      "Run copied " << end.num_copies - start.num_copies << " tensor(s): "
+                    << end.host_to_device_bytes - start.host_to_device_bytes << " bytes host to device, "
+                    << end.device_to_host_bytes - start.device_to_host_bytes << " bytes device to host, "
+                    << end.device_to_device_bytes - start.device_to_device_bytes << " bytes device to device");
+  return nullptr;
+
+  EP_API_IMPL_END
+}
+
 //
 // Implementation of ExampleNodeComputeInfo
 //
@@ -353,12 +576,12 @@ OrtStatus* ORT_API_CALL ExampleNodeComputeInfo::CreateStateImpl(OrtNodeComputeIn
   BasicPluginEp& ep = node_compute_info->ep;
 
   std::string fused_node_name = ep.GetEpApi().NodeComputeContext_NodeName(compute_context);
-  MulKernel* kernel = ep.FindKernelForFusedNode(fused_node_name);
-  if (kernel == nullptr) {
+  const BasicPluginEp::CompiledNode* compiled_node = ep.FindCompiledNode(fused_node_name);
+  if (compiled_node == nullptr) {
     RETURN_ERROR(ORT_EP_FAIL, "Unable to get kernel for fused node with name " << fused_node_name);
   }
 
-  *compute_state = kernel;
+  *compute_state = const_cast<BasicPluginEp::CompiledNode*>(compiled_node);
   return nullptr;
 
   EP_API_IMPL_END
@@ -366,16 +589,22 @@ OrtStatus* ORT_API_CALL ExampleNodeComputeInfo::CreateStateImpl(OrtNodeComputeIn
 
 OrtStatus* ORT_API_CALL ExampleNodeComputeInfo::ComputeImpl(OrtNodeComputeInfo* this_ptr, void* compute_state,
                                                             OrtKernelContext* kernel_context) {
-  EP_API_IMPL_BEGIN(void)
-  this_ptr;
-  MulKernel& kernel = *reinterpret_cast<MulKernel*>(compute_state);
-  return kernel.Compute(kernel_context);
+  EP_API_IMPL_BEGIN
+
+  auto* node_compute_info = static_cast<ExampleNodeComputeInfo*>(this_ptr);
+  const auto& compiled_node = *static_cast<const BasicPluginEp::CompiledNode*>(compute_state);
+
+  // ORT passes the handle of the SyncStream that it created for the node, or null if it does not use streams.
+  void* stream_handle = nullptr;
+  RETURN_IF_ERROR(node_compute_info->ep.GetOrtApi().KernelContext_GetGPUComputeStream(kernel_context,
+                                                                                       &stream_handle));
+  return compiled_node.kernel->Compute(kernel_context, compiled_node.resources, SyncStream::FromHandle(stream_handle));
+
   EP_API_IMPL_END
 }
 
 void ORT_API_CALL ExampleNodeComputeInfo::ReleaseStateImpl(OrtNodeComputeInfo* this_ptr, void* compute_state) {
   (void)this_ptr;
-  MulKernel& kernel = *reinterpret_cast<MulKernel*>(compute_state);
-  (void)kernel;
-  // Do nothing for this example.
+  (void)compute_state;
+  // Do nothing: the compute state is a CompiledNode that the EP owns.
 }
@@ -4,6 +4,8 @@
 #pragma once
 
 #include <cstdint>
+#include <filesystem>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -13,22 +15,53 @@
 #include "onnxruntime_cxx_api.h"
 #undef ORT_API_MANUAL_INIT
 
-class MulKernel;
+#include "elementwise_kernels.h"
+#include "ep_context.h"
+#include "ep_kernel.h"
+
 class BasicPluginEpFactory;
+class DataTransfer;
+class KernelCache;
+class KernelProfiler;
+class MappedFile;
+class ThreadPool;
 
+/// <summary>
+/// Constant float32 initializer that a kernel reads. `data` is either a view into a memory-mapped external data
+/// file or points into a buffer owned by the EP. `storage` keeps that memory alive.
+/// </summary>
 struct FloatInitializer {
   std::vector<int64_t> shape;
-  std::vector<float> data;
+  const float* data = nullptr;
+  std::shared_ptr<const void> storage;
 };
 
 /// <summary>
 /// Basic plugin EP.
-/// Can only compile/execute a single Mul node.
+/// Compiles each connected group of supported elementwise nodes (Add, Sub, Mul, Div, Relu, Sigmoid, Tanh, Clip, Cast)
+/// into a single fused kernel, each MatMul or Gemm with a constant B input into a GEMM kernel with a prepacked B, and
+/// each QDQ node unit of an Add, Mul or MatMul into a kernel that computes on the int8/uint8 data.
+/// Compiled kernels can be saved in EPContext nodes, which later sessions load without analyzing the original
+/// subgraph.
 /// </summary>
 class BasicPluginEp : public OrtEp {
  public:
   struct Config {
     // EP configs (typically extracted from OrtSessionOptions or OrtHardwareDevice(s))
+    size_t num_threads = 0;                     // Intra-op threads, including ORT's calling thread. 0: one per core.
+    size_t parallel_min_elements = 64 * 1024;   // Kernels with fewer elements (GEMM: multiply-adds) run serially.
+    SimdLevel simd_level = GetBestSimdLevel();  // Instruction set of the elementwise and GEMM kernels.
+    EpContextOptions ep_context;                // Creation of EPContext nodes for compiled subgraphs.
+    bool enable_profiling = false;              // Time the fused nodes' runs (see KernelProfiler).
+    std::string profiling_file;                 // File for the profiling summary. Empty: only log it.
+  };
+
+  /// <summary>
+  /// Kernel of a fused node, and the resources that the EP passes to it.
+  /// </summary>
+  struct CompiledNode {
+    std::shared_ptr<const EpKernel> kernel;
+    KernelResources resources;
   };
 
   BasicPluginEp(BasicPluginEpFactory& factory, const Config& config, const OrtLogger& logger);
@@ -37,7 +70,7 @@ class BasicPluginEp : public OrtEp {
   const OrtApi& GetOrtApi() const { return ort_api_; }
   const OrtEpApi& GetEpApi() const { return ep_api_; }
 
-  MulKernel* FindKernelForFusedNode(const std::string& fused_node_name);
+  const CompiledNode* FindCompiledNode(const std::string& fused_node_name);
 
  private:
   static const char* ORT_API_CALL GetNameImpl(const OrtEp* this_ptr) noexcept;
@@ -54,14 +87,42 @@ class BasicPluginEp : public OrtEp {
                                                        OrtNodeComputeInfo** node_compute_infos,
                                                        size_t num_node_compute_infos) noexcept;
 
+  // Log the bytes that the virtual device's data transfer copied during a run.
+  static OrtStatus* ORT_API_CALL OnRunStartImpl(OrtEp* this_ptr, const OrtRunOptions* run_options) noexcept;
+  static OrtStatus* ORT_API_CALL OnRunEndImpl(OrtEp* this_ptr, const OrtRunOptions* run_options,
+                                              bool sync_stream) noexcept;
+
   OrtStatus* SaveConstantInitializers(const OrtGraph* graph);
 
+  // Gets the kernel of a fused subgraph from the factory's KernelCache, or compiles it or loads it from an EPContext
+  // node and adds it to the cache. Optionally creates an EPContext node.
+  OrtStatus* CreateKernel(Ort::ConstGraph graph, Ort::ConstNode fused_node,
+                          /*out*/ std::shared_ptr<const EpKernel>& kernel, /*out*/ OrtNode** ep_context_node);
+
+  // Compiles a fused subgraph that GetCapability() selected.
+  OrtStatus* CompileKernel(Ort::ConstGraph graph, /*out*/ std::unique_ptr<EpKernel>& kernel);
+  OrtStatus* SaveConstantInitializer(Ort::ConstGraph graph, Ort::ConstValueInfo initializer);
+
+  // Gets a view of an initializer's data in its external data file, or null if the data is stored in the model or
+  // the file cannot be mapped.
+  OrtStatus* GetExternalInitializerData(Ort::ConstGraph graph, Ort::ConstValueInfo initializer, size_t num_bytes,
+                                        /*out*/ std::shared_ptr<const void>& data);
+
+  // Logs the profiling summary and writes it to the profiling file, if any.
+  void WriteProfilingSummary() const;
+
   Config config_{};
   const OrtApi& ort_api_;
   const OrtEpApi& ep_api_;
   const OrtModelEditorApi& model_editor_api_;
   std::string name_;
   const OrtLogger& logger_;
-  std::unordered_map<std::string, std::unique_ptr<MulKernel>> kernels_;
+  std::unique_ptr<ThreadPool> thread_pool_;   // Null if the EP runs single-threaded.
+  const DataTransfer* data_transfer_;         // Null unless the factory's virtual device is enabled.
+  KernelCache& kernel_cache_;                 // Owned by the factory and shared with the EPs of other sessions.
+  std::unique_ptr<KernelProfiler> profiler_;  // Null unless profiling is enabled.
+  KernelResources kernel_resources_;          // Resources that all fused nodes share.
+  std::unordered_map<std::string, CompiledNode> compiled_nodes_;  // By fused node name.
   std::unordered_map<std::string, FloatInitializer> float_initializers_;
+  std::map<std::filesystem::path, std::shared_ptr<MappedFile>> mapped_files_;  // External data files.
 };
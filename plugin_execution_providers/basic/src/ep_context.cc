@@ -0,0 +1,181 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "ep_context.h"
+
+#include <array>
+#include <fstream>
+#include <vector>
+
+#include "mapped_file.h"
+#include "plugin_ep_utils.h"
+
+namespace {
+
+constexpr const char* kEpContextOpType = "EPContext";
+constexpr const char* kMsDomain = "com.microsoft";
+
+// Gets the directory and file name of the EPContext model that ORT writes.
+OrtStatus* GetEpContextModelPath(Ort::ConstGraph graph, const EpContextOptions& options,
+                                 /*out*/ std::filesystem::path& path) {
+  if (!options.model_file_path.empty()) {
+    path = options.model_file_path;
+    return nullptr;
+  }
+
+  const std::filesystem::path model_path{graph.GetModelPath()};
+  RETURN_IF(model_path.empty(),
+            "ep.context_file_path must be set to save the basic plugin EP's kernels next to the EPContext model of a "
+            "model that was loaded from memory. Alternatively, set ep.context_embed_mode to 1.");
+
+  path = model_path.parent_path() / (model_path.stem().string() + "_ctx.onnx");
+  return nullptr;
+}
+
+}  // namespace
+
+OrtStatus* IsEpContextNodeForEp(Ort::ConstNode node, const std::string& ep_name, /*out*/ bool& result) {
+  result = false;
+
+  if (node.GetOperatorType() != kEpContextOpType || node.GetDomain() != kMsDomain) {
+    return nullptr;
+  }
+
+  Ort::ConstOpAttr source_attr;
+  Ort::Status status = node.GetAttributeByName("source", source_attr);
+  if (!status.IsOK()) {
+    return nullptr;  // Created by another EP.
+  }
+
+  RETURN_IF(source_attr.GetType() != OrtOpAttrType::ORT_OP_ATTR_STRING, "Expected a string 'source' attribute");
+
+  std::string source;
+  RETURN_IF_ERROR(source_attr.GetValue(source));
+  result = source == ep_name;
+  return nullptr;
+}
+
+OrtStatus* CreateEpContextNode(const OrtApi& ort_api, const OrtModelEditorApi& model_editor_api, Ort::ConstGraph graph,
+                               Ort::ConstNode fused_node, const std::string& ep_name, const EpContextOptions& options,
+                               const std::string& blob, /*out*/ OrtNode** ep_context_node) {
+  const std::string fused_node_name = fused_node.GetName();
+
+  // The EPContext node has the fused node's inputs and outputs, so ORT feeds it the same values.
+  std::vector<std::string> input_names;
+  for (const Ort::ConstValueInfo& input : fused_node.GetInputs()) {
+    input_names.push_back(input.GetName());
+  }
+
+  std::vector<std::string> output_names;
+  for (const Ort::ConstValueInfo& output : fused_node.GetOutputs()) {
+    output_names.push_back(output.GetName());
+  }
+
+  std::vector<const char*> input_name_ptrs;
+  for (const std::string& name : input_names) {
+    input_name_ptrs.push_back(name.c_str());
+  }
+
+  std::vector<const char*> output_name_ptrs;
+  for (const std::string& name : output_names) {
+    output_name_ptrs.push_back(name.c_str());
+  }
+
+  // With embed mode 0, ep_cache_context is the name of a file in the EPContext model's directory.
+  std::string ep_cache_context;
+  if (options.embed_mode) {
+    ep_cache_context = blob;
+  } else {
+    std::filesystem::path ep_context_model_path;
+    RETURN_IF_ERROR(GetEpContextModelPath(graph, options, ep_context_model_path));
+
+    const std::string file_name = ep_context_model_path.stem().string() + "_" + fused_node_name + ".bin";
+    const std::filesystem::path file_path = ep_context_model_path.parent_path() / file_name;
+
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    file.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+    file.close();
+    if (!file) {
+      RETURN_ERROR(ORT_EP_FAIL, "Failed to write the basic plugin EP's kernel to " << file_path.string());
+    }
+
+    ep_cache_context = file_name;
+  }
+
+  const int64_t embed_mode = options.embed_mode ? 1 : 0;
+
+  // Create node attributes. The CreateNode() function copies the attributes, so we have to release them.
+  std::array<OrtOpAttr*, 3> attributes = {};
+  auto release_attributes = [&]() {
+    for (OrtOpAttr* attribute : attributes) {
+      if (attribute != nullptr) {
+        ort_api.ReleaseOpAttr(attribute);
+      }
+    }
+  };
+
+  OrtStatus* status = ort_api.CreateOpAttr("embed_mode", &embed_mode, sizeof(int64_t), ORT_OP_ATTR_INT,
+                                           &attributes[0]);
+  if (status == nullptr) {
+    status = ort_api.CreateOpAttr("ep_cache_context", ep_cache_context.data(),
+                                  static_cast<int>(ep_cache_context.size()), ORT_OP_ATTR_STRING, &attributes[1]);
+  }
+
+  if (status == nullptr) {
+    status = ort_api.CreateOpAttr("source", ep_name.data(), static_cast<int>(ep_name.size()), ORT_OP_ATTR_STRING,
+                                  &attributes[2]);
+  }
+
+  if (status == nullptr) {
+    status = model_editor_api.CreateNode(kEpContextOpType, kMsDomain, fused_node_name.c_str(), input_name_ptrs.data(),
+                                         input_name_ptrs.size(), output_name_ptrs.data(), output_name_ptrs.size(),
+                                         attributes.data(), attributes.size(), ep_context_node);
+  }
+
+  release_attributes();
+  return status;
+}
+
+OrtStatus* ReadEpContextNode(Ort::ConstGraph graph, Ort::ConstNode node, /*out*/ std::span<const uint8_t>& blob,
+                             /*out*/ std::shared_ptr<const void>& blob_storage) {
+  int64_t embed_mode = 1;  // The default of the EPContext op.
+  Ort::ConstOpAttr attr;
+  if (node.GetAttributeByName("embed_mode", attr).IsOK()) {
+    RETURN_IF(attr.GetType() != OrtOpAttrType::ORT_OP_ATTR_INT, "Expected an integer 'embed_mode' attribute");
+    RETURN_IF_ERROR(attr.GetValue(embed_mode));
+  }
+
+  RETURN_IF_ERROR(node.GetAttributeByName("ep_cache_context", attr));
+  RETURN_IF(attr.GetType() != OrtOpAttrType::ORT_OP_ATTR_STRING, "Expected a string 'ep_cache_context' attribute");
+
+  auto ep_cache_context = std::make_shared<std::string>();
+  RETURN_IF_ERROR(attr.GetValue(*ep_cache_context));
+
+  if (embed_mode == 1) {
+    blob = std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(ep_cache_context->data()),
+                                    ep_cache_context->size());
+    blob_storage = std::move(ep_cache_context);
+    return nullptr;
+  }
+
+  // For security, only files in the EPContext model's directory or its subdirectories are read.
+  const std::filesystem::path relative_path{*ep_cache_context};
+  RETURN_IF(relative_path.empty() || relative_path.is_absolute() || relative_path.has_root_path(),
+            "The 'ep_cache_context' attribute must be a path relative to the EPContext model's directory");
+  for (const std::filesystem::path& part : relative_path.lexically_normal()) {
+    RETURN_IF(part == "..", "The 'ep_cache_context' attribute must not point outside the EPContext model's directory");
+  }
+
+  const std::filesystem::path model_path{graph.GetModelPath()};
+  RETURN_IF(model_path.empty(), "Unable to locate the kernel files of an EPContext model that was loaded from memory");
+
+  const std::filesystem::path file_path = model_path.parent_path() / relative_path;
+  std::shared_ptr<MappedFile> file = MappedFile::Open(file_path);
+  if (file == nullptr) {
+    RETURN_ERROR(ORT_EP_FAIL, "Unable to read the basic plugin EP's kernel from " << file_path.string());
+  }
+
+  blob = std::span<const uint8_t>(file->GetData(), file->GetSize());
+  blob_storage = std::move(file);
+  return nullptr;
+}
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+
+#define ORT_API_MANUAL_INIT
+#include "onnxruntime_cxx_api.h"
+#undef ORT_API_MANUAL_INIT
+
+/// <summary>
+/// Options for the EPContext nodes that the EP creates, from the "ep.context_*" session options.
+/// </summary>
+struct EpContextOptions {
+  bool enable = false;          // Create an EPContext node for each compiled subgraph.
+  bool embed_mode = false;      // Store the kernels in the nodes instead of in files next to the EPContext model.
+  std::string model_file_path;  // Path of the EPContext model. Defaults to "<model>_ctx.onnx", like ORT.
+};
+
+/// <summary>
+/// Checks if a node is an EPContext node that was created by the EP named `ep_name`.
+/// </summary>
+/// <returns>An OrtStatus* on error, nullptr on success</returns>
+OrtStatus* IsEpContextNodeForEp(Ort::ConstNode node, const std::string& ep_name, /*out*/ bool& result);
+
+/// <summary>
+/// Creates an EPContext node that replaces a fused node in the EPContext model. It stores a serialized kernel
+/// either in its "ep_cache_context" attribute or in a file next to the EPContext model.
+/// </summary>
+/// <param name="ort_api">The ORT API</param>
+/// <param name="model_editor_api">The model editor API</param>
+/// <param name="graph">The fused subgraph. Used to get the path of the source model.</param>
+/// <param name="fused_node">The fused node to replace</param>
+/// <param name="ep_name">The EP's name, stored in the "source" attribute</param>
+/// <param name="options">The EPContext options</param>
+/// <param name="blob">The serialized kernel</param>
+/// <param name="ep_context_node">Output parameter set to the new node. ORT takes ownership of it.</param>
+/// <returns>An OrtStatus* on error, nullptr on success</returns>
+OrtStatus* CreateEpContextNode(const OrtApi& ort_api, const OrtModelEditorApi& model_editor_api, Ort::ConstGraph graph,
+                               Ort::ConstNode fused_node, const std::string& ep_name, const EpContextOptions& options,
+                               const std::string& blob, /*out*/ OrtNode** ep_context_node);
+
+/// <summary>
+/// Gets the serialized kernel of an EPContext node. Kernels in files are memory-mapped.
+/// </summary>
+/// <param name="graph">The graph with the EPContext node. Used to find the files of non-embedded kernels.</param>
+/// <param name="node">The EPContext node</param>
+/// <param name="blob">Output parameter set to the serialized kernel</param>
+/// <param name="blob_storage">Output parameter set to the owner of the memory of `blob`</param>
+/// <returns>An OrtStatus* on error, nullptr on success</returns>
+OrtStatus* ReadEpContextNode(Ort::ConstGraph graph, Ort::ConstNode node, /*out*/ std::span<const uint8_t>& blob,
+                             /*out*/ std::shared_ptr<const void>& blob_storage);
@@ -3,12 +3,43 @@
 
 #include "ep_factory.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <string>
 
 #include "onnxruntime_ep_device_ep_metadata_keys.h"
+#include "onnxruntime_session_options_config_keys.h"
 
+#include "arena_allocator.h"
+#include "data_transfer.h"
 #include "ep.h"
+#include "kernel_profiler.h"
 #include "plugin_ep_utils.h"
+#include "sync_stream.h"
+
+// Checks if the environment variable ORT_BASIC_EP_VIRTUAL_DEVICE is set to 1. This is not an EP option, because the
+// memory info is registered with each OrtEpDevice in GetSupportedDevices() when the library is registered, before any
+// session options exist, and ORT allocates the EP's tensors and selects the data transfer from that registration for
+// all sessions.
+static bool IsVirtualDeviceEnabled() {
+#if defined(_WIN32)
+  char* value = nullptr;
+  size_t length = 0;
+  if (_dupenv_s(&value, &length, "ORT_BASIC_EP_VIRTUAL_DEVICE") != 0 || value == nullptr) {
+    return false;
+  }
+
+  const bool enabled = std::string{value} == "1";
+  free(value);
+  return enabled;
+#else
+  const char* value = std::getenv("ORT_BASIC_EP_VIRTUAL_DEVICE");
+  return value != nullptr && std::string{value} == "1";
+#endif
+}
 
 BasicPluginEpFactory::BasicPluginEpFactory(const OrtApi& ort_api, const OrtEpApi& ep_api,
                                            const OrtModelEditorApi& model_editor_api,
@@ -33,6 +64,20 @@ BasicPluginEpFactory::BasicPluginEpFactory(const OrtApi& ort_api, const OrtEpApi
 
   IsStreamAware = IsStreamAwareImpl;
   CreateSyncStreamForDevice = CreateSyncStreamForDeviceImpl;
+
+  if (!IsVirtualDeviceEnabled()) {
+    default_memory_info_ = Ort::MemoryInfo{ArenaAllocator::kCpuMemoryName, OrtMemoryInfoDeviceType_CPU,
+                                           /*vendor_id*/ 0, /*device_id*/ 0, OrtDeviceMemoryType_DEFAULT,
+                                           ArenaAllocator::kAlignment, OrtDeviceAllocator};
+    return;
+  }
+
+  // The memory is still CPU memory, which the kernels access directly. Only ORT treats it as device memory.
+  default_memory_info_ = Ort::MemoryInfo{ArenaAllocator::kVirtualDeviceMemoryName, OrtMemoryInfoDeviceType_NPU,
+                                         vendor_id_, /*device_id*/ 0, OrtDeviceMemoryType_DEFAULT,
+                                         ArenaAllocator::kAlignment, OrtDeviceAllocator};
+  data_transfer_ = std::make_unique<DataTransfer>(ort_api_, ep_api_,
+                                                  ep_api_.MemoryInfo_GetMemoryDevice(default_memory_info_));
 }
 
 BasicPluginEpFactory::~BasicPluginEpFactory() = default;
@@ -80,6 +125,10 @@ OrtStatus* ORT_API_CALL BasicPluginEpFactory::GetSupportedDevicesImpl(OrtEpFacto
       Ort::KeyValuePairs ep_options;
       // Implementations can add relevant EP options here.
       Ort::EpDevice ep_device{*this_ptr, device, ep_metadata.GetConst(), ep_options.GetConst()};
+
+      // Tell ORT to allocate this EP's tensors with the allocator that CreateAllocatorImpl returns.
+      RETURN_IF_ERROR(factory->ep_api_.EpDevice_AddAllocatorInfo(ep_device, factory->default_memory_info_));
+
       ep_devices[num_ep_devices++] = ep_device.release();
     }
   }
@@ -89,6 +138,80 @@ OrtStatus* ORT_API_CALL BasicPluginEpFactory::GetSupportedDevicesImpl(OrtEpFacto
   EP_API_IMPL_END
 }
 
+// Parses a size_t EP option. Leaves `value` unchanged if the option is not set.
+static OrtStatus* GetSizeOption(Ort::ConstSessionOptions session_options, const std::string& key,
+                                /*out*/ size_t& value) {
+  const std::string str = session_options.GetConfigEntryOrDefault(key.c_str(), "");
+  if (str.empty()) {
+    return nullptr;
+  }
+
+  auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+  if (ec != std::errc{} || end != str.data() + str.size()) {
+    RETURN_ERROR(ORT_INVALID_ARGUMENT, "Invalid value for EP option " << key << ": '" << str
+                                                                      << "'. Expected a non-negative integer.");
+  }
+
+  return nullptr;
+}
+
+// Reads the EP options from the session options. The implementation of the SessionOptionsAppendExecutionProvider_V2
+// C API function adds them to the session option configurations with the key prefix "ep.<lowercase_ep_name>.".
+static OrtStatus* GetEpConfig(const OrtSessionOptions* ort_session_options, const std::string& ep_name,
+                              /*out*/ BasicPluginEp::Config& config) {
+  Ort::ConstSessionOptions session_options{ort_session_options};
+
+  std::string key_prefix = "ep." + ep_name + ".";
+  std::transform(key_prefix.begin(), key_prefix.end(), key_prefix.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+  RETURN_IF_ERROR(GetSizeOption(session_options, key_prefix + "num_threads", config.num_threads));
+  RETURN_IF_ERROR(GetSizeOption(session_options, key_prefix + "parallel_min_elements", config.parallel_min_elements));
+
+  const std::string simd_level_key = key_prefix + "simd_level";
+  const std::string simd_level_str = session_options.GetConfigEntryOrDefault(simd_level_key.c_str(), "auto");
+  if (simd_level_str != "auto") {
+    const std::optional<SimdLevel> simd_level = SimdLevelFromString(simd_level_str);
+    if (!simd_level.has_value()) {
+      RETURN_ERROR(ORT_INVALID_ARGUMENT, "Invalid value for EP option " << simd_level_key << ": '" << simd_level_str
+                                                                        << "'. Expected auto, scalar, avx2, avx512 "
+                                                                        << "or neon.");
+    }
+
+    if (!IsSimdLevelSupported(*simd_level)) {
+      RETURN_ERROR(ORT_INVALID_ARGUMENT, "EP option " << simd_level_key << " requests " << simd_level_str
+                                                      << " kernels, which this CPU or build does not support.");
+    }
+
+    config.simd_level = *simd_level;
+  }
+
+  const std::string enable_profiling_key = key_prefix + "enable_profiling";
+  const std::string enable_profiling_str = session_options.GetConfigEntryOrDefault(enable_profiling_key.c_str(), "0");
+  if (enable_profiling_str != "0" && enable_profiling_str != "1") {
+    RETURN_ERROR(ORT_INVALID_ARGUMENT, "Invalid value for EP option " << enable_profiling_key << ": '"
+                                                                      << enable_profiling_str << "'. Expected 0 or 1.");
+  }
+
+  // A profiling file implies profiling.
+  const std::string profiling_file_key = key_prefix + "profiling_file";
+  config.profiling_file = session_options.GetConfigEntryOrDefault(profiling_file_key.c_str(), "");
+  config.enable_profiling = enable_profiling_str == "1" || !config.profiling_file.empty();
+
+  if (config.enable_profiling && !KernelProfiler::kEnabled) {
+    RETURN_ERROR(ORT_INVALID_ARGUMENT, "EP options " << enable_profiling_key << " and " << profiling_file_key
+                                                     << " require a build with BASIC_EP_ENABLE_PROFILING.");
+  }
+
+  // EPContext nodes are configured with ORT's session-level options instead of EP options.
+  config.ep_context.enable = session_options.GetConfigEntryOrDefault(kOrtSessionOptionEpContextEnable, "0") == "1";
+  config.ep_context.embed_mode =
+      session_options.GetConfigEntryOrDefault(kOrtSessionOptionEpContextEmbedMode, "0") == "1";
+  config.ep_context.model_file_path = session_options.GetConfigEntryOrDefault(kOrtSessionOptionEpContextFilePath, "");
+
+  return nullptr;
+}
+
 /*static*/
 OrtStatus* ORT_API_CALL BasicPluginEpFactory::CreateEpImpl(OrtEpFactory* this_ptr,
                                                            const OrtHardwareDevice* const* /*devices*/,
@@ -107,6 +230,8 @@ OrtStatus* ORT_API_CALL BasicPluginEpFactory::CreateEpImpl(OrtEpFactory* this_pt
   }
 
   BasicPluginEp::Config config = {};
+  RETURN_IF_ERROR(GetEpConfig(session_options, factory->ep_name_, config));
+
   auto actual_ep = std::make_unique<BasicPluginEp>(*factory, config, *logger);
 
   *ep = actual_ep.release();
@@ -121,38 +246,72 @@ void ORT_API_CALL BasicPluginEpFactory::ReleaseEpImpl(OrtEpFactory* /*this_ptr*/
 }
 
 /*static*/
-OrtStatus* ORT_API_CALL BasicPluginEpFactory::CreateAllocatorImpl(OrtEpFactory* /*this_ptr*/,
-                                                                  const OrtMemoryInfo* /*memory_info*/,
-                                                                  const OrtKeyValuePairs* /*allocator_options*/,
+OrtStatus* ORT_API_CALL BasicPluginEpFactory::CreateAllocatorImpl(OrtEpFactory* this_ptr,
+                                                                  const OrtMemoryInfo* memory_info,
+                                                                  const OrtKeyValuePairs* allocator_options,
                                                                   OrtAllocator** allocator) noexcept {
-  // Don't support custom allocators in this example for simplicity.
+  EP_API_IMPL_BEGIN
+
+  auto* factory = static_cast<BasicPluginEpFactory*>(this_ptr);
   *allocator = nullptr;
+
+  const OrtMemoryInfo* default_memory_info = factory->default_memory_info_;
+
+  int is_different = 0;
+  RETURN_IF_ERROR(factory->ort_api_.CompareMemoryInfo(memory_info, default_memory_info, &is_different));
+  if (is_different != 0) {
+    return factory->ort_api_.CreateStatus(ORT_INVALID_ARGUMENT,
+                                          "Unknown memory info provided to CreateAllocator. Value did not come "
+                                          "directly from an OrtEpDevice returned by this factory.");
+  }
+
+  // Each session gets its own arena, so that the memory of a session is returned to the system when it is released.
+  ArenaAllocator::Options options;
+  RETURN_IF_ERROR(ArenaAllocator::ParseOptions(factory->ort_api_, allocator_options, options));
+
+  *allocator = new ArenaAllocator(factory->ort_api_, *default_memory_info, options);
   return nullptr;
+
+  EP_API_IMPL_END
 }
 
 /*static*/
 void ORT_API_CALL BasicPluginEpFactory::ReleaseAllocatorImpl(OrtEpFactory* /*this_ptr*/,
-                                                             OrtAllocator* /*allocator*/) noexcept {
-  // Do nothing.
+                                                             OrtAllocator* allocator) noexcept {
+  delete static_cast<ArenaAllocator*>(allocator);
 }
 
 /*static*/
-OrtStatus* ORT_API_CALL BasicPluginEpFactory::CreateDataTransferImpl(OrtEpFactory* /*this_ptr*/,
+OrtStatus* ORT_API_CALL BasicPluginEpFactory::CreateDataTransferImpl(OrtEpFactory* this_ptr,
                                                                      OrtDataTransferImpl** data_transfer) noexcept {
-  // Don't support data transfer in this example for simplicity.
-  *data_transfer = nullptr;
+  // Tensors in CPU memory need no data transfer. The factory owns the virtual device's data transfer, so ORT's call to
+  // its Release function does nothing.
+  auto* factory = static_cast<BasicPluginEpFactory*>(this_ptr);
+  *data_transfer = factory->data_transfer_.get();
   return nullptr;
 }
 
 /*static*/
-bool ORT_API_CALL BasicPluginEpFactory::IsStreamAwareImpl(const OrtEpFactory* /*this_ptr*/) noexcept { return false; }
+bool ORT_API_CALL BasicPluginEpFactory::IsStreamAwareImpl(const OrtEpFactory* /*this_ptr*/) noexcept { return true; }
 
 /*static*/
-OrtStatus* ORT_API_CALL BasicPluginEpFactory::CreateSyncStreamForDeviceImpl(OrtEpFactory* /*this_ptr*/,
-                                                                            const OrtMemoryDevice* /*memory_device*/,
+OrtStatus* ORT_API_CALL BasicPluginEpFactory::CreateSyncStreamForDeviceImpl(OrtEpFactory* this_ptr,
+                                                                            const OrtMemoryDevice* memory_device,
                                                                             const OrtKeyValuePairs* /*stream_options*/,
                                                                             OrtSyncStreamImpl** stream) noexcept {
-  // Don't support sync streams in this example.
+  EP_API_IMPL_BEGIN
+
+  auto* factory = static_cast<BasicPluginEpFactory*>(this_ptr);
   *stream = nullptr;
+
+  const OrtMemoryDevice* default_memory_device =
+      factory->ep_api_.MemoryInfo_GetMemoryDevice(factory->default_memory_info_);
+  RETURN_IF(!factory->ep_api_.MemoryDevice_AreEqual(memory_device, default_memory_device),
+            "Unknown memory device provided to CreateSyncStreamForDevice");
+
+  // Each stream has its own worker thread, which runs the kernels that ORT assigns to the stream (see SyncStream).
+  *stream = new SyncStream(factory->ort_api_);
   return nullptr;
+
+  EP_API_IMPL_END
 }
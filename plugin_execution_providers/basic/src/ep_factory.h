@@ -3,12 +3,24 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+
 #define ORT_API_MANUAL_INIT
 #include "onnxruntime_cxx_api.h"
 #undef ORT_API_MANUAL_INIT
 
+#include "kernel_cache.h"
+
+class DataTransfer;
+
 /// <summary>
 /// EP factory that creates a BasicPluginEp.
+///
+/// If the environment variable ORT_BASIC_EP_VIRTUAL_DEVICE is set to 1 when the factory is created, the EP's memory is
+/// tagged as memory of a virtual NPU instead of CPU memory. ORT then copies tensors between the EP and other EPs with
+/// the factory's DataTransfer, as it would for an accelerator with its own memory. The mode applies to all sessions
+/// that use the factory, because the memory info is registered with the OrtEpDevices before any session is created.
 /// </summary>
 class BasicPluginEpFactory : public OrtEpFactory {
  public:
@@ -21,6 +33,16 @@ class BasicPluginEpFactory : public OrtEpFactory {
   const OrtModelEditorApi& GetModelEditorApi() const { return model_editor_api_; }
   const std::string& GetEpName() const { return ep_name_; }
 
+  /// <summary>
+  /// Gets the data transfer of the virtual device, or null if the EP uses CPU memory.
+  /// </summary>
+  const DataTransfer* GetDataTransfer() const { return data_transfer_.get(); }
+
+  /// <summary>
+  /// Gets the cache of the kernels that the factory's EPs compiled.
+  /// </summary>
+  KernelCache& GetKernelCache() { return kernel_cache_; }
+
  private:
   static const char* ORT_API_CALL GetNameImpl(const OrtEpFactory* this_ptr) noexcept;
 
@@ -48,7 +70,7 @@ class BasicPluginEpFactory : public OrtEpFactory {
 
   static OrtStatus* ORT_API_CALL CreateAllocatorImpl(OrtEpFactory* this_ptr,
                                                      const OrtMemoryInfo* memory_info,
-                                                     const OrtKeyValuePairs* /*allocator_options*/,
+                                                     const OrtKeyValuePairs* allocator_options,
                                                      OrtAllocator** allocator) noexcept;
 
   static void ORT_API_CALL ReleaseAllocatorImpl(OrtEpFactory* /*this*/, OrtAllocator* allocator) noexcept;
@@ -71,4 +93,13 @@ class BasicPluginEpFactory : public OrtEpFactory {
   const std::string vendor_{"Contoso"};    // EP vendor name
   const uint32_t vendor_id_{0xB357};       // EP vendor ID
   const std::string ep_version_{"0.1.0"};  // EP version
+
+  // Memory info of the arena allocator that the factory registers with each OrtEpDevice. It describes plain CPU
+  // memory (vendor ID 0), so ORT can pass tensors between this EP and the CPU EP without copies. With the virtual
+  // device, it describes NPU memory of this EP's vendor instead.
+  Ort::MemoryInfo default_memory_info_{nullptr};
+
+  std::unique_ptr<DataTransfer> data_transfer_;  // Null unless the virtual device is enabled.
+
+  KernelCache kernel_cache_;
 };
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define ORT_API_MANUAL_INIT
+#include "onnxruntime_cxx_api.h"
+#undef ORT_API_MANUAL_INIT
+
+#include "elementwise_kernels.h"
+#include "gemm_kernels.h"
+#include "plugin_ep_utils.h"
+
+class KernelProfiler;
+class SyncStream;
+class ThreadPool;
+
+/// <summary>
+/// Compute resources of a BasicPluginEp that it passes to its kernels for each run. Kernels are shared by the EPs of
+/// all sessions (see KernelCache), so they do not keep per-session resources.
+/// </summary>
+struct KernelResources {
+  ThreadPool* thread_pool = nullptr;   // Null to run on the calling thread.
+  size_t parallel_min_elements = 0;    // Kernels with less work run on the calling thread.
+  KernelProfiler* profiler = nullptr;  // Null unless the EP's profiling is enabled.
+  size_t profiler_node = 0;            // The fused node's index in `profiler`.
+};
+
+/// <summary>
+/// Kernel that computes a fused node of the basic plugin EP. A kernel is immutable once it is created, and is
+/// compiled for a SimdLevel that is part of its KernelCache key.
+/// </summary>
+class EpKernel {
+ public:
+  virtual ~EpKernel() = default;
+
+  /// <summary>
+  /// Runs the kernel. Safe to call concurrently: all per-run state is local to the call.
+  /// </summary>
+  /// <param name="kernel_ctx">The kernel context of the fused node</param>
+  /// <param name="resources">The thread pool of the session's EP, which must outlive the stream's tasks</param>
+  /// <param name="stream">The stream that ORT runs the node on, or null to compute on the calling thread. With a
+  /// stream, and inputs that are all in the EP's arena memory, the call only reads the inputs' data pointers and
+  /// allocates the outputs, and the stream computes the outputs later.</param>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  virtual OrtStatus* Compute(OrtKernelContext* kernel_ctx, const KernelResources& resources,
+                             SyncStream* stream) const = 0;
+
+  /// <summary>
+  /// Serializes the kernel for an EPContext node. A serialized kernel starts with a uint32 magic that identifies the
+  /// kernel class. The blob does not depend on the EP's resources (e.g., the SIMD level), which are chosen again when
+  /// it is loaded.
+  /// </summary>
+  /// <param name="blob">Output parameter set to the serialized kernel</param>
+  virtual void Serialize(/*out*/ std::string& blob) const = 0;
+
+  /// <summary>
+  /// Checks that a fused node's inputs and outputs have the element types and shapes that the kernel was created for.
+  /// Compute() relies on them instead of querying the shapes, so a kernel that is loaded from an EPContext node is
+  /// checked against the node before it is used.
+  /// </summary>
+  /// <param name="graph">The fused node's subgraph</param>
+  /// <returns>An OrtStatus* with ORT_INVALID_GRAPH on a mismatch, nullptr on success</returns>
+  virtual OrtStatus* CheckGraphIO(Ort::ConstGraph graph) const = 0;
+
+ protected:
+  /// <summary>
+  /// Checks that a fused node input or output is a tensor of `element_type`. If `shape` is not null, the value must
+  /// also have its rank, and its dimensions must match the non-negative dimensions of `shape`.
+  /// </summary>
+  /// <returns>An OrtStatus* with ORT_INVALID_GRAPH on a mismatch, nullptr on success</returns>
+  static OrtStatus* CheckGraphValue(Ort::ConstValueInfo value_info, ONNXTensorElementDataType element_type,
+                                    const std::vector<int64_t>* shape) {
+    const auto type_info = value_info.TypeInfo();
+    bool matches = type_info.GetONNXType() == ONNX_TYPE_TENSOR;
+
+    if (matches) {
+      const auto type_shape = type_info.GetTensorTypeAndShapeInfo();
+      matches = type_shape.GetElementType() == element_type;
+
+      if (matches && shape != nullptr) {
+        const std::vector<int64_t> actual_shape = type_shape.GetShape();
+        matches = actual_shape.size() == shape->size();
+        for (size_t i = 0; matches && i < shape->size(); ++i) {
+          matches = (*shape)[i] < 0 || actual_shape[i] == (*shape)[i];
+        }
+      }
+    }
+
+    if (!matches) {
+      RETURN_ERROR(ORT_INVALID_GRAPH, "The type or shape of value " << value_info.GetName()
+                                                                    << " does not match the serialized kernel");
+    }
+
+    return nullptr;
+  }
+
+  /// <summary>
+  /// Checks that a fused node has the given numbers of inputs and outputs.
+  /// </summary>
+  static OrtStatus* CheckGraphIOCounts(Ort::ConstGraph graph, size_t num_inputs, size_t num_outputs) {
+    if (graph.GetInputs().size() != num_inputs || graph.GetOutputs().size() != num_outputs) {
+      RETURN_ERROR(ORT_INVALID_GRAPH, "The inputs or outputs of fused node " << graph.GetName()
+                                                                              << " do not match the serialized kernel");
+    }
+
+    return nullptr;
+  }
+};
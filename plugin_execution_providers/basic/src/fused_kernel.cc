@@ -0,0 +1,590 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "fused_kernel.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "blob_utils.h"
+#include "kernel_profiler.h"
+#include "plugin_ep_utils.h"
+#include "sync_stream.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Serialized kernel format (host byte order):
+//   header:  magic, version
+//   shapes:  fused node input shapes, output shapes, iteration shape
+//   program: slots, instructions, number of tile buffers
+//   data:    initializer shapes and data offsets, then the initializer data, starting at a kBlobDataAlignment boundary
+// The magic is FusedKernel::kBlobMagic.
+constexpr uint32_t kBlobVersion = 1;
+
+}  // namespace
+
+/*static*/
+OrtStatus* FusedKernel::Create(const OrtApi& ort_api, const OrtLogger& logger,
+                               const std::unordered_map<std::string, FloatInitializer>& float_initializers,
+                               Ort::ConstGraph graph, SimdLevel simd_level,
+                               /*out*/ std::unique_ptr<FusedKernel>& kernel) {
+  auto new_kernel = std::unique_ptr<FusedKernel>(new FusedKernel(ort_api, simd_level));
+  std::vector<Slot>& slots = new_kernel->slots_;
+  std::unordered_map<std::string, size_t> slots_by_name;
+
+  auto add_slot = [&](const std::string& name, Slot slot) -> size_t {
+    slots.push_back(slot);
+    slots_by_name.emplace(name, slots.size() - 1);
+    return slots.size() - 1;
+  };
+
+  // The fused node's inputs are the subgraph's inputs. Constant initializers are not passed to the fused node
+  // because the EP requested that ORT drop them (see GetCapability()). They are read from the saved initializers.
+  // Shapes of the values that are read from or written to memory, indexed by Slot::operand.
+  std::vector<std::vector<int64_t>> operand_shapes;
+
+  auto get_static_shape = [](Ort::ConstValueInfo value_info, /*out*/ std::vector<int64_t>& shape) -> OrtStatus* {
+    std::optional<std::vector<int64_t>> maybe_shape = GetTensorShape(value_info);
+    RETURN_IF(!maybe_shape.has_value(), "Expected the values of the fused subgraph to be tensors");
+    RETURN_IF(std::any_of(maybe_shape->begin(), maybe_shape->end(), [](int64_t dim) { return dim < 0; }),
+              "Expected the values of the fused subgraph to have static shapes");
+    shape = std::move(*maybe_shape);
+    return nullptr;
+  };
+
+  for (const Ort::ConstValueInfo& input : graph.GetInputs()) {
+    std::vector<int64_t>& shape = new_kernel->input_shapes_.emplace_back();
+    RETURN_IF_ERROR(get_static_shape(input, shape));
+
+    add_slot(input.GetName(), Slot{SlotKind::Input, new_kernel->input_shapes_.size() - 1, operand_shapes.size()});
+    operand_shapes.push_back(shape);
+  }
+
+  std::vector<Ort::ConstValueInfo> graph_outputs = graph.GetOutputs();
+  std::unordered_map<std::string, size_t> output_indices_by_name;
+  RETURN_IF(graph_outputs.empty(), "Expected the fused subgraph to have at least one output");
+
+  for (size_t i = 0; i < graph_outputs.size(); ++i) {
+    std::vector<int64_t>& shape = new_kernel->output_shapes_.emplace_back();
+    RETURN_IF_ERROR(get_static_shape(graph_outputs[i], shape));
+    output_indices_by_name.emplace(graph_outputs[i].GetName(), i);
+  }
+
+  // Every value of the subgraph broadcasts to the iteration shape. Intermediate values are computed over the full
+  // iteration shape, which is correct because elementwise ops commute with broadcasting.
+  std::vector<int64_t> iteration_shape;
+
+  // Nodes are returned in topological order, so every input is either a subgraph input, a constant initializer, or
+  // the output of a previous node.
+  for (const Ort::ConstNode& ort_node : graph.GetNodes()) {
+    std::optional<ElementwiseNode> elementwise_node;
+    RETURN_IF_ERROR(GetElementwiseNode(ort_node, elementwise_node));
+    if (!elementwise_node.has_value()) {
+      RETURN_ERROR(ORT_EP_FAIL, "FusedKernel does not support node " << ort_node.GetName() << " with op type "
+                                                                      << ort_node.GetOperatorType());
+    }
+
+    Instruction& instruction = new_kernel->instructions_.emplace_back();
+    instruction.node = *elementwise_node;
+
+    std::vector<int64_t> node_output_shape;
+    RETURN_IF_ERROR(get_static_shape(ort_node.GetOutputs()[0], node_output_shape));
+    RETURN_IF(!GetBroadcastShape(iteration_shape, node_output_shape, iteration_shape),
+              "Expected the outputs of the fused subgraph's nodes to be broadcastable to a common shape");
+
+    std::vector<Ort::ConstValueInfo> inputs = ort_node.GetInputs();
+    for (size_t i = 0; i < GetNumTensorInputs(instruction.node.op); ++i) {
+      const std::string input_name = inputs[i].GetName();
+
+      if (auto slot_iter = slots_by_name.find(input_name); slot_iter != slots_by_name.end()) {
+        instruction.input_slots[i] = slot_iter->second;
+        continue;
+      }
+
+      auto initializer_iter = float_initializers.find(input_name);
+      if (initializer_iter == float_initializers.end()) {
+        RETURN_ERROR(ORT_EP_FAIL, "Unable to find the producer of input " << input_name << " of node "
+                                                                           << ort_node.GetName());
+      }
+
+      // The kernel shares ownership of the initializer's data with the EP.
+      new_kernel->initializers_.push_back(initializer_iter->second);
+      instruction.input_slots[i] = add_slot(input_name, Slot{SlotKind::Initializer,
+                                                             new_kernel->initializers_.size() - 1,
+                                                             operand_shapes.size()});
+      operand_shapes.push_back(initializer_iter->second.shape);
+    }
+
+    const std::string output_name = ort_node.GetOutputs()[0].GetName();
+    if (auto output_iter = output_indices_by_name.find(output_name); output_iter != output_indices_by_name.end()) {
+      instruction.output_slot = add_slot(output_name, Slot{SlotKind::Output, output_iter->second,
+                                                            operand_shapes.size()});
+      operand_shapes.push_back(new_kernel->output_shapes_[output_iter->second]);
+    } else {
+      instruction.output_slot = add_slot(output_name, Slot{SlotKind::Tile, 0});
+    }
+  }
+
+  for (const Ort::ConstValueInfo& graph_output : graph_outputs) {
+    auto slot_iter = slots_by_name.find(graph_output.GetName());
+    RETURN_IF(slot_iter == slots_by_name.end() || slots[slot_iter->second].kind != SlotKind::Output,
+              "Fused node outputs must be produced by a node of the fused subgraph");
+  }
+
+  new_kernel->iteration_shape_ = std::move(iteration_shape);
+  RETURN_IF(!new_kernel->InitializeLayout(operand_shapes),
+            "Expected the values of the fused subgraph to be broadcastable to the iteration shape");
+
+  // Assign tile buffers to intermediate values. A buffer is released after the last instruction that reads it, so
+  // the instruction's own output may reuse it (elementwise ops can run in place).
+  const std::vector<Instruction>& instructions = new_kernel->instructions_;
+  std::vector<size_t> last_uses(slots.size(), kNoSlot);
+
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    for (size_t input_slot : instructions[i].input_slots) {
+      if (input_slot != kNoSlot) {
+        last_uses[input_slot] = i;
+      }
+    }
+  }
+
+  std::vector<size_t> free_buffers;
+
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    const Instruction& instruction = instructions[i];
+
+    for (size_t j = 0; j < 2; ++j) {
+      const size_t input_slot = instruction.input_slots[j];
+      const bool is_duplicate = j == 1 && input_slot == instruction.input_slots[0];
+
+      if (input_slot != kNoSlot && !is_duplicate && slots[input_slot].kind == SlotKind::Tile &&
+          last_uses[input_slot] == i) {
+        free_buffers.push_back(slots[input_slot].index);
+      }
+    }
+
+    Slot& output_slot = slots[instruction.output_slot];
+    if (output_slot.kind != SlotKind::Tile) {
+      continue;
+    }
+
+    if (free_buffers.empty()) {
+      output_slot.index = new_kernel->num_tile_buffers_++;
+    } else {
+      output_slot.index = free_buffers.back();
+      free_buffers.pop_back();
+    }
+
+    if (last_uses[instruction.output_slot] == kNoSlot) {
+      free_buffers.push_back(output_slot.index);  // Unused value.
+    }
+  }
+
+  LOG(ort_api, &logger, INFO, "Compiled fused kernel with " << instructions.size() << " node(s) and "
+                                                           << new_kernel->num_tile_buffers_ << " tile buffer(s)");
+
+  kernel = std::move(new_kernel);
+  return nullptr;
+}
+
+void FusedKernel::Serialize(/*out*/ std::string& blob) const {
+  BlobWriter writer(blob);
+  writer.Write(kBlobMagic);
+  writer.Write(kBlobVersion);
+
+  writer.Write<uint64_t>(input_shapes_.size());
+  for (const std::vector<int64_t>& shape : input_shapes_) {
+    writer.WriteShape(shape);
+  }
+
+  writer.Write<uint64_t>(output_shapes_.size());
+  for (const std::vector<int64_t>& shape : output_shapes_) {
+    writer.WriteShape(shape);
+  }
+
+  writer.WriteShape(iteration_shape_);
+
+  writer.Write<uint64_t>(slots_.size());
+  for (const Slot& slot : slots_) {
+    writer.Write(static_cast<uint8_t>(slot.kind));
+    writer.Write<uint64_t>(slot.index);
+    writer.Write<uint64_t>(slot.operand);
+  }
+
+  writer.Write<uint64_t>(instructions_.size());
+  for (const Instruction& instruction : instructions_) {
+    writer.Write(static_cast<uint8_t>(instruction.node.op));
+    writer.Write(instruction.node.clip_min);
+    writer.Write(instruction.node.clip_max);
+    writer.Write<uint64_t>(instruction.input_slots[0]);
+    writer.Write<uint64_t>(instruction.input_slots[1]);
+    writer.Write<uint64_t>(instruction.output_slot);
+  }
+
+  writer.Write<uint64_t>(num_tile_buffers_);
+
+  // Initializer data offsets are relative to the start of the data section.
+  size_t data_offset = 0;
+  writer.Write<uint64_t>(initializers_.size());
+  for (const FloatInitializer& initializer : initializers_) {
+    writer.WriteShape(initializer.shape);
+    writer.Write<uint64_t>(data_offset);
+    data_offset = AlignUp(data_offset + GetNumElements(initializer.shape) * sizeof(float), kBlobDataAlignment);
+  }
+
+  for (const FloatInitializer& initializer : initializers_) {
+    writer.PadTo(kBlobDataAlignment);
+    writer.WriteBytes(initializer.data, GetNumElements(initializer.shape) * sizeof(float));
+  }
+}
+
+OrtStatus* FusedKernel::CheckGraphIO(Ort::ConstGraph graph) const {
+  RETURN_IF_ERROR(CheckGraphIOCounts(graph, input_shapes_.size(), output_shapes_.size()));
+
+  const std::vector<Ort::ConstValueInfo> inputs = graph.GetInputs();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    RETURN_IF_ERROR(CheckGraphValue(inputs[i], ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &input_shapes_[i]));
+  }
+
+  const std::vector<Ort::ConstValueInfo> outputs = graph.GetOutputs();
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    RETURN_IF_ERROR(CheckGraphValue(outputs[i], ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &output_shapes_[i]));
+  }
+
+  return nullptr;
+}
+
+/*static*/
+OrtStatus* FusedKernel::Deserialize(const OrtApi& ort_api, std::span<const uint8_t> blob,
+                                    std::shared_ptr<const void> blob_storage, SimdLevel simd_level,
+                                    /*out*/ std::unique_ptr<FusedKernel>& kernel) {
+  auto new_kernel = std::unique_ptr<FusedKernel>(new FusedKernel(ort_api, simd_level));
+  BlobReader reader(blob);
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  RETURN_IF(!reader.Read(magic) || magic != kBlobMagic, "EPContext node does not contain a basic plugin EP kernel");
+  RETURN_IF(!reader.Read(version) || version != kBlobVersion,
+            "EPContext node was created by an incompatible version of the basic plugin EP");
+
+  // Upper bound for counts, so that a corrupt blob cannot request huge allocations.
+  const uint64_t max_count = blob.size();
+
+  // Reads the blob and checks that every index is in range. Returns false if the blob is corrupt.
+  auto read_kernel = [&](FusedKernel& k) -> bool {
+    size_t num_inputs = 0;
+    if (!reader.ReadSize(num_inputs, max_count)) {
+      return false;
+    }
+
+    k.input_shapes_.resize(num_inputs);
+    for (std::vector<int64_t>& shape : k.input_shapes_) {
+      if (!reader.ReadShape(shape)) {
+        return false;
+      }
+    }
+
+    size_t num_outputs = 0;
+    if (!reader.ReadSize(num_outputs, max_count) || num_outputs == 0) {
+      return false;
+    }
+
+    k.output_shapes_.resize(num_outputs);
+    for (std::vector<int64_t>& shape : k.output_shapes_) {
+      if (!reader.ReadShape(shape)) {
+        return false;
+      }
+    }
+
+    if (!reader.ReadShape(k.iteration_shape_)) {
+      return false;
+    }
+
+    size_t num_slots = 0;
+    if (!reader.ReadSize(num_slots, max_count)) {
+      return false;
+    }
+
+    k.slots_.resize(num_slots);
+    for (Slot& slot : k.slots_) {
+      uint8_t kind = 0;
+      if (!reader.Read(kind) || kind > static_cast<uint8_t>(SlotKind::Tile) ||
+          !reader.ReadSize(slot.index, max_count) || !reader.ReadSize(slot.operand, kNoSlot)) {
+        return false;
+      }
+
+      slot.kind = static_cast<SlotKind>(kind);
+    }
+
+    size_t num_instructions = 0;
+    if (!reader.ReadSize(num_instructions, max_count) || num_instructions == 0) {
+      return false;
+    }
+
+    k.instructions_.resize(num_instructions);
+    for (Instruction& instruction : k.instructions_) {
+      uint8_t op = 0;
+      if (!reader.Read(op) || op > static_cast<uint8_t>(ElementwiseOp::Copy) ||
+          !reader.Read(instruction.node.clip_min) || !reader.Read(instruction.node.clip_max) ||
+          !reader.ReadSize(instruction.input_slots[0], kNoSlot) ||
+          !reader.ReadSize(instruction.input_slots[1], kNoSlot) ||
+          !reader.ReadSize(instruction.output_slot, kNoSlot)) {
+        return false;
+      }
+
+      instruction.node.op = static_cast<ElementwiseOp>(op);
+
+      const bool is_binary = IsBinaryOp(instruction.node.op);
+      if (instruction.input_slots[0] >= num_slots || instruction.output_slot >= num_slots ||
+          (is_binary ? instruction.input_slots[1] >= num_slots : instruction.input_slots[1] != kNoSlot)) {
+        return false;
+      }
+
+      const SlotKind output_kind = k.slots_[instruction.output_slot].kind;
+      if (output_kind != SlotKind::Output && output_kind != SlotKind::Tile) {
+        return false;
+      }
+    }
+
+    if (!reader.ReadSize(k.num_tile_buffers_, max_count)) {
+      return false;
+    }
+
+    size_t num_initializers = 0;
+    if (!reader.ReadSize(num_initializers, max_count)) {
+      return false;
+    }
+
+    std::vector<size_t> data_offsets(num_initializers);
+    k.initializers_.resize(num_initializers);
+    for (size_t i = 0; i < num_initializers; ++i) {
+      if (!reader.ReadShape(k.initializers_[i].shape) || !reader.ReadSize(data_offsets[i], max_count)) {
+        return false;
+      }
+    }
+
+    // The initializers share ownership of the blob's memory and read their data in place.
+    const size_t data_start = AlignUp(reader.GetPosition(), kBlobDataAlignment);
+    for (size_t i = 0; i < num_initializers; ++i) {
+      k.initializers_[i].data = GetBlobTensorData(blob, data_start, data_offsets[i], k.initializers_[i].shape);
+      if (k.initializers_[i].data == nullptr) {
+        return false;
+      }
+
+      k.initializers_[i].storage = blob_storage;
+    }
+
+    // Build the operand shapes from the slots and check the slot indices.
+    std::vector<std::vector<int64_t>> operand_shapes;
+    for (const Slot& slot : k.slots_) {
+      const std::vector<int64_t>* shape = nullptr;
+      switch (slot.kind) {
+        case SlotKind::Input:
+          shape = slot.index < num_inputs ? &k.input_shapes_[slot.index] : nullptr;
+          break;
+        case SlotKind::Initializer:
+          shape = slot.index < num_initializers ? &k.initializers_[slot.index].shape : nullptr;
+          break;
+        case SlotKind::Output:
+          shape = slot.index < num_outputs ? &k.output_shapes_[slot.index] : nullptr;
+          break;
+        case SlotKind::Tile:
+          if (slot.index >= k.num_tile_buffers_) {
+            return false;
+          }
+          continue;
+      }
+
+      if (shape == nullptr || slot.operand >= num_slots) {
+        return false;
+      }
+
+      if (slot.operand >= operand_shapes.size()) {
+        operand_shapes.resize(slot.operand + 1);
+      }
+
+      operand_shapes[slot.operand] = *shape;
+    }
+
+    return k.InitializeLayout(operand_shapes);
+  };
+
+  RETURN_IF(!read_kernel(*new_kernel), "EPContext node contains a corrupt basic plugin EP kernel");
+
+  kernel = std::move(new_kernel);
+  return nullptr;
+}
+
+bool FusedKernel::InitializeLayout(const std::vector<std::vector<int64_t>>& operand_shapes) {
+  if (!CreateBroadcastLayout(iteration_shape_, operand_shapes, layout_)) {
+    return false;
+  }
+
+  // An output that is broadcast in some loop is smaller than the iteration shape, and several tiles write each of its
+  // elements.
+  has_broadcast_outputs_ = false;
+  bytes_read_ = 0;
+  bytes_written_ = 0;
+  for (Slot& slot : slots_) {
+    if (slot.kind == SlotKind::Tile) {
+      slot.is_broadcast = false;
+      continue;
+    }
+
+    (slot.kind == SlotKind::Output ? bytes_written_ : bytes_read_) +=
+        GetNumElements(operand_shapes[slot.operand]) * sizeof(float);
+
+    slot.is_broadcast = layout_.IsBroadcastInRow(slot.operand);
+
+    const std::vector<size_t>& strides = layout_.strides[slot.operand];
+    if (slot.kind == SlotKind::Output && std::find(strides.begin(), strides.end(), 0) != strides.end()) {
+      has_broadcast_outputs_ = true;
+    }
+  }
+
+  for (Instruction& instruction : instructions_) {
+    const size_t input_slot1 = instruction.input_slots[1];
+    instruction.run = GetElementwiseOpFn(simd_level_, instruction.node.op,
+                                         slots_[instruction.input_slots[0]].is_broadcast,
+                                         input_slot1 != kNoSlot && slots_[input_slot1].is_broadcast);
+    instruction.is_output_broadcast = slots_[instruction.output_slot].is_broadcast;
+  }
+
+  return true;
+}
+
+OrtStatus* FusedKernel::Compute(OrtKernelContext* kernel_ctx, const KernelResources& resources,
+                                SyncStream* stream) const {
+  Ort::KernelContext kernel_context(kernel_ctx);
+  RETURN_IF(kernel_context.GetInputCount() != input_shapes_.size(), "Unexpected number of inputs for fused node");
+  RETURN_IF(kernel_context.GetOutputCount() != output_shapes_.size(), "Unexpected number of outputs for fused node");
+
+  // The types and static shapes of the inputs were checked when the kernel was compiled or loaded from an EPContext
+  // node, and ORT checks the model's inputs against them, so they are not queried again. The data pointers are kept
+  // in per-thread buffers that are reused across runs, so that a run does not allocate.
+  thread_local std::vector<const float*> input_data;
+  thread_local std::vector<float*> output_data;
+  input_data.resize(input_shapes_.size());
+  output_data.resize(output_shapes_.size());
+
+  for (size_t i = 0; i < input_shapes_.size(); ++i) {
+    input_data[i] = kernel_context.GetInput(i).GetTensorData<float>();
+  }
+
+  for (size_t i = 0; i < output_shapes_.size(); ++i) {
+    auto output = kernel_context.GetOutput(i, output_shapes_[i]);
+    output_data[i] = output.GetTensorMutableData<float>();
+  }
+
+  if (stream != nullptr && SyncStream::CanReadInputsLater(kernel_context)) {
+    // The task outlives the call, so it gets its own copies of the data pointers.
+    stream->Enqueue([this, resources, inputs = std::vector<const float*>(input_data),
+                     outputs = std::vector<float*>(output_data)]() { Run(resources, inputs, outputs); });
+    return nullptr;
+  }
+
+  if (stream != nullptr) {
+    stream->WaitForAll();  // Earlier tasks may write the inputs.
+  }
+
+  Run(resources, input_data, output_data);
+  return nullptr;
+}
+
+void FusedKernel::Run(const KernelResources& resources, std::span<const float* const> inputs,
+                      std::span<float* const> outputs) const {
+  KernelProfiler::Scope profiler_scope(resources.profiler, resources.profiler_node, bytes_read_, bytes_written_);
+
+  // Static shapes may have dimensions of size 0. The outputs are then empty, and RunTiles() would visit a row.
+  const size_t num_elements = layout_.GetNumElements();
+  if (num_elements == 0) {
+    return;
+  }
+
+  const size_t tiles_per_row = (layout_.GetRowSize() + kTileSize - 1) / kTileSize;
+  const size_t num_tiles = layout_.GetNumRows() * tiles_per_row;
+
+  // Outputs that are smaller than the iteration shape are written by several tiles, so they stay single-threaded.
+  size_t num_tasks = 1;
+  if (resources.thread_pool != nullptr && num_elements >= resources.parallel_min_elements &&
+      !has_broadcast_outputs_) {
+    num_tasks = std::min(resources.thread_pool->GetNumThreads(), num_tiles);
+  }
+
+  if (num_tasks <= 1) {
+    RunTiles(inputs, outputs, 0, num_tiles);
+  } else {
+    resources.thread_pool->ParallelFor(num_tasks, [&](size_t task) {
+      RunTiles(inputs, outputs, num_tiles * task / num_tasks, num_tiles * (task + 1) / num_tasks);
+    });
+  }
+}
+
+void FusedKernel::RunTiles(std::span<const float* const> input_data, std::span<float* const> output_data,
+                           size_t begin, size_t end) const {
+  // Per-thread buffers that are reused across runs and kernels.
+  thread_local std::vector<float> tile_buffers;
+  thread_local BroadcastRowIterator row_iter;
+  if (tile_buffers.size() < num_tile_buffers_ * kTileSize) {
+    tile_buffers.resize(num_tile_buffers_ * kTileSize);
+  }
+
+  const size_t row_size = layout_.GetRowSize();
+  const size_t tiles_per_row = (row_size + kTileSize - 1) / kTileSize;
+
+  // Get the start of a slot's tile. A slot that is broadcast within the row is a single value within the tile.
+  auto get_input_tile = [&](size_t slot_index, const std::vector<size_t>& row_offsets,
+                            size_t tile_start) -> const float* {
+    const Slot& slot = slots_[slot_index];
+    if (slot.kind == SlotKind::Tile) {
+      return tile_buffers.data() + slot.index * kTileSize;
+    }
+
+    const size_t offset = row_offsets[slot.operand] + (slot.is_broadcast ? 0 : tile_start);
+
+    switch (slot.kind) {
+      case SlotKind::Input:
+        return input_data[slot.index] + offset;
+      case SlotKind::Initializer:
+        return initializers_[slot.index].data + offset;
+      default:
+        return output_data[slot.index] + offset;
+    }
+  };
+
+  auto get_output_tile = [&](size_t slot_index, const std::vector<size_t>& row_offsets, size_t tile_start) -> float* {
+    const Slot& slot = slots_[slot_index];
+    if (slot.kind == SlotKind::Tile) {
+      return tile_buffers.data() + slot.index * kTileSize;
+    }
+
+    return output_data[slot.index] + row_offsets[slot.operand] + (slot.is_broadcast ? 0 : tile_start);
+  };
+
+  row_iter.Reset(layout_, begin / tiles_per_row);
+  size_t tile_start = (begin % tiles_per_row) * kTileSize;
+
+  for (size_t tile = begin; tile < end; ++tile) {
+    const std::vector<size_t>& row_offsets = row_iter.GetOffsets();
+    const size_t tile_size = std::min(kTileSize, row_size - tile_start);
+
+    for (const Instruction& instruction : instructions_) {
+      const float* input0 = get_input_tile(instruction.input_slots[0], row_offsets, tile_start);
+      const float* input1 = instruction.input_slots[1] != kNoSlot
+                                ? get_input_tile(instruction.input_slots[1], row_offsets, tile_start)
+                                : nullptr;
+      float* output = get_output_tile(instruction.output_slot, row_offsets, tile_start);
+
+      // An output that is broadcast within the row is smaller than the iteration shape. Its inputs are then also
+      // single values within the row, so computing one element is enough.
+      instruction.run(instruction.node, input0, input1, output, instruction.is_output_broadcast ? 1 : tile_size);
+    }
+
+    tile_start += kTileSize;
+    if (tile_start >= row_size) {
+      tile_start = 0;
+      row_iter.Next();
+    }
+  }
+}
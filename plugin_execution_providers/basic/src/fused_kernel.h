@@ -0,0 +1,141 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "broadcast_utils.h"
+#include "elementwise_kernels.h"
+#include "elementwise_ops.h"
+#include "ep.h"
+#include "ep_kernel.h"
+
+/// <summary>
+/// Kernel for a fused node that computes a subgraph of elementwise float32 ops in a single loop nest.
+///
+/// The subgraph is compiled into a list of instructions (one per node, in topological order) that operate on slots.
+/// A slot holds a value of the subgraph: a fused node input, a saved constant initializer, a fused node output, or an
+/// intermediate value. At inference time, the kernel walks the tensors in tiles of kTileSize elements and runs every
+/// instruction on a tile before moving on to the next one. Intermediate values only live in small tile buffers that
+/// stay in the L1 cache and are reused once their last consumer has run, so memory traffic is proportional to the
+/// subgraph's inputs and outputs instead of the number of ops.
+///
+/// Inputs, initializers and outputs may have any shape that broadcasts to the subgraph's iteration shape (the
+/// broadcast of all node outputs). Tiles are cut from the rows of a collapsed BroadcastLayout, so within a tile every
+/// such value is either contiguous or a single broadcast value.
+///
+/// Large kernels split their tiles into contiguous ranges that run in parallel on the EP's thread pool. Tiles start
+/// at multiples of kTileSize elements within a row, so tasks do not write to the same cache lines unless the row size
+/// is not a multiple of the cache line size.
+/// </summary>
+class FusedKernel : public EpKernel {
+ public:
+  static constexpr size_t kTileSize = 1024;           // Elements per tile (4 KiB of float32).
+  static constexpr uint32_t kBlobMagic = 0x4B504542;  // "BEPK", the start of a serialized FusedKernel.
+
+  /// <summary>
+  /// Creates a kernel for a subgraph that was selected in GetCapability().
+  /// </summary>
+  /// <param name="ort_api">The ORT API</param>
+  /// <param name="logger">The EP's logger</param>
+  /// <param name="float_initializers">The constant initializers saved by the EP</param>
+  /// <param name="graph">The subgraph to compile</param>
+  /// <param name="simd_level">The instruction set of the kernel's functions</param>
+  /// <param name="kernel">Output parameter set to the new kernel</param>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  static OrtStatus* Create(const OrtApi& ort_api, const OrtLogger& logger,
+                           const std::unordered_map<std::string, FloatInitializer>& float_initializers,
+                           Ort::ConstGraph graph, SimdLevel simd_level,
+                           /*out*/ std::unique_ptr<FusedKernel>& kernel);
+
+  /// <summary>
+  /// Creates a kernel from a blob that Serialize() wrote, without analyzing a graph.
+  /// </summary>
+  /// <param name="ort_api">The ORT API</param>
+  /// <param name="blob">The serialized kernel. The kernel reads the initializers' data in place.</param>
+  /// <param name="blob_storage">Keeps the memory of `blob` alive. The kernel shares ownership of it.</param>
+  /// <param name="simd_level">The instruction set of the kernel's functions</param>
+  /// <param name="kernel">Output parameter set to the new kernel</param>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  static OrtStatus* Deserialize(const OrtApi& ort_api, std::span<const uint8_t> blob,
+                                std::shared_ptr<const void> blob_storage, SimdLevel simd_level,
+                                /*out*/ std::unique_ptr<FusedKernel>& kernel);
+
+  /// <summary>
+  /// Serializes the instructions, slots, shapes, and the data of the constant initializers.
+  /// </summary>
+  void Serialize(/*out*/ std::string& blob) const override;
+
+  /// <summary>
+  /// Checks that the fused node has float inputs and outputs with the shapes the subgraph was planned for.
+  /// </summary>
+  OrtStatus* CheckGraphIO(Ort::ConstGraph graph) const override;
+
+  /// <summary>
+  /// Runs the subgraph, or enqueues it on `stream`.
+  /// </summary>
+  OrtStatus* Compute(OrtKernelContext* kernel_ctx, const KernelResources& resources,
+                     SyncStream* stream) const override;
+
+ private:
+  static constexpr size_t kNoSlot = SIZE_MAX;
+
+  enum class SlotKind {
+    Input,        // Fused node input. `index` is the input index.
+    Initializer,  // Saved constant initializer. `index` is the index in `initializers_`.
+    Output,       // Fused node output. `index` is the output index.
+    Tile,         // Intermediate value. `index` is the tile buffer index.
+  };
+
+  struct Slot {
+    SlotKind kind = SlotKind::Tile;
+    size_t index = 0;
+    size_t operand = kNoSlot;   // Operand index in `layout_`. Unused for tiles.
+    bool is_broadcast = false;  // Single value within each row. Set by InitializeLayout().
+  };
+
+  struct Instruction {
+    ElementwiseNode node;
+    size_t input_slots[2] = {kNoSlot, kNoSlot};
+    size_t output_slot = kNoSlot;
+
+    // Set by InitializeLayout() for the layout of the slots, so that running a tile does not branch on the op.
+    ElementwiseOpFn run = nullptr;
+    bool is_output_broadcast = false;
+  };
+
+  FusedKernel(const OrtApi& ort_api, SimdLevel simd_level) : ort_api_(ort_api), simd_level_(simd_level) {}
+
+  // Creates `layout_` from the iteration shape and the shapes of the slots that are read from or written to memory,
+  // selects the function of every instruction for the layout of its slots, and counts the bytes that a run reads and
+  // writes.
+  bool InitializeLayout(const std::vector<std::vector<int64_t>>& operand_shapes);
+
+  // Runs the subgraph for the data of the fused node's inputs and outputs.
+  void Run(const KernelResources& resources, std::span<const float* const> inputs,
+           std::span<float* const> outputs) const;
+
+  // Runs tiles [begin, end). Tiles are numbered in row-major order, with ceil(row size / kTileSize) tiles per row.
+  void RunTiles(std::span<const float* const> input_data, std::span<float* const> output_data, size_t begin,
+                size_t end) const;
+
+  const OrtApi& ort_api_;
+  SimdLevel simd_level_;
+  std::vector<Slot> slots_;
+  std::vector<Instruction> instructions_;  // In topological order.
+  std::vector<std::vector<int64_t>> input_shapes_;
+  std::vector<std::vector<int64_t>> output_shapes_;
+  std::vector<FloatInitializer> initializers_;
+  std::vector<int64_t> iteration_shape_;
+  BroadcastLayout layout_;       // Loop nest over the iteration shape for all non-tile slots.
+  size_t num_tile_buffers_ = 0;  // Maximum number of intermediate values that are live at the same time.
+  bool has_broadcast_outputs_ = false;  // Some output is smaller than the iteration shape and is written repeatedly.
+  uint64_t bytes_read_ = 0;             // Inputs and initializers. Reported to the EP's KernelProfiler.
+  uint64_t bytes_written_ = 0;          // Outputs.
+};
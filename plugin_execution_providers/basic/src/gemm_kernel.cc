@@ -0,0 +1,505 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gemm_kernel.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "blob_utils.h"
+#include "kernel_profiler.h"
+#include "plugin_ep_utils.h"
+#include "sync_stream.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Serialized kernel format (host byte order):
+//   header:  magic (GemmKernel::kBlobMagic), version
+//   params:  K, N, number of fused node inputs, input index of A, bias kind, input index and scale of a bias input,
+//            bias shape, static output shape (empty if A has a dynamic shape)
+//   data:    packed B, then the constant bias, if any, each starting at a kBlobDataAlignment boundary
+constexpr uint32_t kBlobVersion = 2;
+
+// Reads an optional attribute (e.g., Gemm's alpha). Keeps the default value if the attribute is not set.
+template <typename T>
+OrtStatus* GetOptionalAttribute(Ort::ConstNode node, const char* name, OrtOpAttrType type, /*out*/ T& value) {
+  Ort::ConstOpAttr attr;
+  Ort::Status status = node.GetAttributeByName(name, attr);
+  if (!status.IsOK()) {
+    return nullptr;
+  }
+
+  RETURN_IF(attr.GetType() != type, "Unexpected type of a MatMul or Gemm attribute");
+  RETURN_IF_ERROR(attr.GetValue(value));
+  return nullptr;
+}
+
+// Gets the number of rows and columns of the bias that are broadcast to an output with `n` columns, or false if the
+// shape cannot be broadcast (unidirectionally) to such an output. A bias with a single row or column is repeated.
+bool GetBiasDims(const std::vector<int64_t>& shape, size_t n, /*out*/ size_t& rows, /*out*/ size_t& cols) {
+  if (shape.size() > 2 || std::any_of(shape.begin(), shape.end(), [](int64_t dim) { return dim < 0; })) {
+    return false;
+  }
+
+  rows = shape.size() == 2 ? static_cast<size_t>(shape[0]) : 1;
+  cols = shape.empty() ? 1 : static_cast<size_t>(shape.back());
+  return cols == 1 || cols == n;
+}
+
+}  // namespace
+
+OrtStatus* GetGemmNode(Ort::ConstNode node, /*out*/ std::optional<GemmNode>& result) {
+  result = std::nullopt;
+
+  const std::string domain = node.GetDomain();
+  if (!domain.empty() && domain != "ai.onnx") {
+    return nullptr;
+  }
+
+  const std::string op_type = node.GetOperatorType();
+  const bool is_gemm = op_type == "Gemm";
+  if (op_type != "MatMul" && !is_gemm) {
+    return nullptr;
+  }
+
+  std::vector<Ort::ConstValueInfo> inputs = node.GetInputs();
+  std::vector<Ort::ConstValueInfo> outputs = node.GetOutputs();
+  if (inputs.size() < 2 || inputs.size() > (is_gemm ? 3u : 2u) || outputs.size() != 1 || inputs[0] == nullptr ||
+      inputs[1] == nullptr) {
+    return nullptr;
+  }
+
+  GemmNode gemm_node;
+  if (is_gemm) {
+    if (node.GetSinceVersion() < 7) {
+      return nullptr;  // Older versions have a "broadcast" attribute.
+    }
+
+    int64_t trans_a = 0;
+    int64_t trans_b = 0;
+    RETURN_IF_ERROR(GetOptionalAttribute(node, "transA", OrtOpAttrType::ORT_OP_ATTR_INT, trans_a));
+    RETURN_IF_ERROR(GetOptionalAttribute(node, "transB", OrtOpAttrType::ORT_OP_ATTR_INT, trans_b));
+    RETURN_IF_ERROR(GetOptionalAttribute(node, "alpha", OrtOpAttrType::ORT_OP_ATTR_FLOAT, gemm_node.alpha));
+    RETURN_IF_ERROR(GetOptionalAttribute(node, "beta", OrtOpAttrType::ORT_OP_ATTR_FLOAT, gemm_node.beta));
+    if (trans_a != 0) {
+      return nullptr;
+    }
+
+    gemm_node.trans_b = trans_b != 0;
+  }
+
+  // B is packed when the kernel is compiled, so it must be a constant. A constant A would not be passed to the fused
+  // node.
+  if (inputs[0].IsConstantInitializer() || !inputs[1].IsConstantInitializer()) {
+    return nullptr;
+  }
+
+  Ort::ConstValue b;
+  RETURN_IF_ERROR(inputs[1].GetInitializer(b));
+
+  auto b_type_shape = b.GetTensorTypeAndShapeInfo();
+  const std::vector<int64_t> b_shape = b_type_shape.GetShape();
+  if (b_type_shape.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT || b_shape.size() != 2) {
+    return nullptr;
+  }
+
+  const int64_t k = gemm_node.trans_b ? b_shape[1] : b_shape[0];
+  const int64_t n = gemm_node.trans_b ? b_shape[0] : b_shape[1];
+
+  bool is_float = false;
+  IsFloatTensor(inputs[0], is_float);
+  const auto a_shape = is_float ? GetTensorShape(inputs[0]) : std::nullopt;
+  if (!a_shape.has_value() || a_shape->empty() || (is_gemm && a_shape->size() != 2) ||
+      (a_shape->back() >= 0 && a_shape->back() != k)) {
+    return nullptr;
+  }
+
+  IsFloatTensor(outputs[0], is_float);
+  if (!is_float) {
+    return nullptr;
+  }
+
+  if (inputs.size() > 2 && inputs[2] != nullptr) {
+    IsFloatTensor(inputs[2], is_float);
+    const auto c_shape = is_float ? GetTensorShape(inputs[2]) : std::nullopt;
+
+    size_t c_rows = 0;
+    size_t c_cols = 0;
+    if (!c_shape.has_value() || !GetBiasDims(*c_shape, static_cast<size_t>(n), c_rows, c_cols)) {
+      return nullptr;  // C must have a static shape that broadcasts to [M, N].
+    }
+
+    const int64_t m = (*a_shape)[0];
+    if (c_rows != 1 && m >= 0 && static_cast<int64_t>(c_rows) != m) {
+      return nullptr;
+    }
+  }
+
+  result = gemm_node;
+  return nullptr;
+}
+
+/*static*/
+OrtStatus* GemmKernel::Create(const OrtApi& ort_api, const OrtLogger& logger, Ort::ConstGraph graph,
+                              SimdLevel simd_level, /*out*/ std::unique_ptr<GemmKernel>& kernel) {
+  std::vector<Ort::ConstNode> nodes = graph.GetNodes();
+  RETURN_IF(nodes.size() != 1, "Expected a single MatMul or Gemm node in the subgraph");
+
+  std::optional<GemmNode> gemm_node;
+  RETURN_IF_ERROR(GetGemmNode(nodes[0], gemm_node));
+  if (!gemm_node.has_value()) {
+    RETURN_ERROR(ORT_EP_FAIL, "GemmKernel does not support node " << nodes[0].GetName() << " with op type "
+                                                                   << nodes[0].GetOperatorType());
+  }
+
+  auto new_kernel = std::unique_ptr<GemmKernel>(new GemmKernel(ort_api, simd_level));
+  std::vector<Ort::ConstValueInfo> node_inputs = nodes[0].GetInputs();
+
+  // Pack B from ORT's initializer. The EP requested that ORT drop it (see GetCapability()), so only the packed copy
+  // stays in memory.
+  Ort::ConstValue b;
+  RETURN_IF_ERROR(node_inputs[1].GetInitializer(b));
+
+  const std::vector<int64_t> b_shape = b.GetTensorTypeAndShapeInfo().GetShape();
+  new_kernel->k_ = static_cast<size_t>(gemm_node->trans_b ? b_shape[1] : b_shape[0]);
+  new_kernel->n_ = static_cast<size_t>(gemm_node->trans_b ? b_shape[0] : b_shape[1]);
+
+  const size_t k = new_kernel->k_;
+  const size_t n = new_kernel->n_;
+  const size_t num_panels = (n + kGemmPanelWidth - 1) / kGemmPanelWidth;
+
+  auto packed_b = std::make_shared<std::vector<float>>(GetPackedGemmBSize(k, n));
+  PackGemmB(b.GetTensorData<float>(), k, n, gemm_node->trans_b, gemm_node->alpha, packed_b->data());
+
+  new_kernel->packed_b_.shape = {static_cast<int64_t>(num_panels), static_cast<int64_t>(k),
+                                 static_cast<int64_t>(kGemmPanelWidth)};
+  new_kernel->packed_b_.data = packed_b->data();
+  new_kernel->packed_b_.storage = std::move(packed_b);
+
+  // The fused node's inputs are A and a non-constant C.
+  std::vector<Ort::ConstValueInfo> graph_inputs = graph.GetInputs();
+  auto find_graph_input = [&](Ort::ConstValueInfo value_info, /*out*/ size_t& index) -> OrtStatus* {
+    const std::string name = value_info.GetName();
+    auto iter = std::find_if(graph_inputs.begin(), graph_inputs.end(),
+                             [&name](Ort::ConstValueInfo input) { return input.GetName() == name; });
+    if (iter == graph_inputs.end()) {
+      RETURN_ERROR(ORT_EP_FAIL, "Unable to find input " << name << " of the fused MatMul or Gemm node");
+    }
+
+    index = static_cast<size_t>(iter - graph_inputs.begin());
+    return nullptr;
+  };
+
+  new_kernel->num_inputs_ = graph_inputs.size();
+  RETURN_IF_ERROR(find_graph_input(node_inputs[0], new_kernel->a_input_index_));
+
+  // Gemm computes alpha * A * B + beta * C. With beta == 0, C is not read.
+  const bool has_bias = node_inputs.size() > 2 && node_inputs[2] != nullptr && gemm_node->beta != 0.0f;
+  if (has_bias) {
+    new_kernel->bias_shape_ = *GetTensorShape(node_inputs[2]);
+
+    if (node_inputs[2].IsConstantInitializer()) {
+      Ort::ConstValue c;
+      RETURN_IF_ERROR(node_inputs[2].GetInitializer(c));
+
+      const float* c_data = c.GetTensorData<float>();
+      auto bias = std::make_shared<std::vector<float>>(c_data, c_data + GetNumElements(new_kernel->bias_shape_));
+      for (float& value : *bias) {
+        value *= gemm_node->beta;
+      }
+
+      new_kernel->bias_kind_ = BiasKind::Constant;
+      new_kernel->bias_.shape = new_kernel->bias_shape_;
+      new_kernel->bias_.data = bias->data();
+      new_kernel->bias_.storage = std::move(bias);
+    } else {
+      new_kernel->bias_kind_ = BiasKind::Input;
+      new_kernel->bias_scale_ = gemm_node->beta;
+      RETURN_IF_ERROR(find_graph_input(node_inputs[2], new_kernel->bias_input_index_));
+    }
+  }
+
+  // A static shape of A fixes the output shape.
+  std::optional<std::vector<int64_t>> a_shape = GetTensorShape(node_inputs[0]);
+  if (a_shape.has_value() && std::all_of(a_shape->begin(), a_shape->end(), [](int64_t dim) { return dim >= 0; })) {
+    new_kernel->static_output_shape_ = std::move(*a_shape);
+    new_kernel->static_output_shape_.back() = static_cast<int64_t>(n);
+  }
+
+  RETURN_IF(!new_kernel->Initialize(), "Unexpected inputs of the fused MatMul or Gemm node");
+
+  const char* a_shape_kind = new_kernel->static_output_shape_.empty() ? "dynamic" : "static";
+  LOG(ort_api, &logger, INFO, "Compiled GEMM kernel with K=" << k << ", N=" << n << " and a " << a_shape_kind
+                                                              << " shape of A");
+
+  kernel = std::move(new_kernel);
+  return nullptr;
+}
+
+void GemmKernel::Serialize(/*out*/ std::string& blob) const {
+  BlobWriter writer(blob);
+  writer.Write(kBlobMagic);
+  writer.Write(kBlobVersion);
+
+  writer.Write<uint64_t>(k_);
+  writer.Write<uint64_t>(n_);
+  writer.Write<uint64_t>(num_inputs_);
+  writer.Write<uint64_t>(a_input_index_);
+  writer.Write(static_cast<uint8_t>(bias_kind_));
+  writer.Write<uint64_t>(bias_input_index_);
+  writer.Write(bias_scale_);
+  writer.WriteShape(bias_shape_);
+  writer.WriteShape(static_output_shape_);
+
+  writer.PadTo(kBlobDataAlignment);
+  writer.WriteBytes(packed_b_.data, GetNumElements(packed_b_.shape) * sizeof(float));
+
+  if (bias_kind_ == BiasKind::Constant) {
+    writer.PadTo(kBlobDataAlignment);
+    writer.WriteBytes(bias_.data, GetNumElements(bias_.shape) * sizeof(float));
+  }
+}
+
+OrtStatus* GemmKernel::CheckGraphIO(Ort::ConstGraph graph) const {
+  RETURN_IF_ERROR(CheckGraphIOCounts(graph, num_inputs_, 1));
+
+  // A dynamic A is checked by Compute(), which reads its shape.
+  const bool is_static = !static_output_shape_.empty();
+  std::vector<int64_t> a_shape = static_output_shape_;
+  if (is_static) {
+    a_shape.back() = static_cast<int64_t>(k_);
+  }
+
+  const std::vector<Ort::ConstValueInfo> inputs = graph.GetInputs();
+  RETURN_IF_ERROR(CheckGraphValue(inputs[a_input_index_], ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT,
+                                  is_static ? &a_shape : nullptr));
+
+  if (bias_kind_ == BiasKind::Input) {
+    RETURN_IF_ERROR(CheckGraphValue(inputs[bias_input_index_], ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &bias_shape_));
+  }
+
+  return CheckGraphValue(graph.GetOutputs()[0], ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT,
+                         is_static ? &static_output_shape_ : nullptr);
+}
+
+/*static*/
+OrtStatus* GemmKernel::Deserialize(const OrtApi& ort_api, std::span<const uint8_t> blob,
+                                   std::shared_ptr<const void> blob_storage, SimdLevel simd_level,
+                                   /*out*/ std::unique_ptr<GemmKernel>& kernel) {
+  auto new_kernel = std::unique_ptr<GemmKernel>(new GemmKernel(ort_api, simd_level));
+  BlobReader reader(blob);
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  RETURN_IF(!reader.Read(magic) || magic != kBlobMagic, "EPContext node does not contain a basic plugin EP kernel");
+  RETURN_IF(!reader.Read(version) || version != kBlobVersion,
+            "EPContext node was created by an incompatible version of the basic plugin EP");
+
+  // Upper bound for sizes and indices, so that a corrupt blob cannot request huge allocations.
+  const uint64_t max_count = blob.size();
+
+  // Reads the blob and checks the sizes and indices. Returns false if the blob is corrupt.
+  auto read_kernel = [&](GemmKernel& k) -> bool {
+    uint8_t bias_kind = 0;
+    if (!reader.ReadSize(k.k_, max_count) || !reader.ReadSize(k.n_, max_count) ||
+        !reader.ReadSize(k.num_inputs_, max_count) || !reader.ReadSize(k.a_input_index_, max_count) ||
+        !reader.Read(bias_kind) || bias_kind > static_cast<uint8_t>(BiasKind::Input) ||
+        !reader.ReadSize(k.bias_input_index_, max_count) || !reader.Read(k.bias_scale_) ||
+        !reader.ReadShape(k.bias_shape_) || !reader.ReadShape(k.static_output_shape_)) {
+      return false;
+    }
+
+    k.bias_kind_ = static_cast<BiasKind>(bias_kind);
+
+    // The packed B and the bias share ownership of the blob's memory and are read in place.
+    const size_t num_panels = (k.n_ + kGemmPanelWidth - 1) / kGemmPanelWidth;
+    k.packed_b_.shape = {static_cast<int64_t>(num_panels), static_cast<int64_t>(k.k_),
+                         static_cast<int64_t>(kGemmPanelWidth)};
+
+    const size_t data_start = AlignUp(reader.GetPosition(), kBlobDataAlignment);
+    k.packed_b_.data = GetBlobTensorData(blob, data_start, 0, k.packed_b_.shape);
+    if (k.packed_b_.data == nullptr) {
+      return false;
+    }
+
+    k.packed_b_.storage = blob_storage;
+
+    if (k.bias_kind_ == BiasKind::Constant) {
+      const size_t bias_offset = AlignUp(GetNumElements(k.packed_b_.shape) * sizeof(float), kBlobDataAlignment);
+      k.bias_.shape = k.bias_shape_;
+      k.bias_.data = GetBlobTensorData(blob, data_start, bias_offset, k.bias_.shape);
+      if (k.bias_.data == nullptr) {
+        return false;
+      }
+
+      k.bias_.storage = blob_storage;
+    }
+
+    return k.Initialize();
+  };
+
+  RETURN_IF(!read_kernel(*new_kernel), "EPContext node contains a corrupt basic plugin EP kernel");
+
+  kernel = std::move(new_kernel);
+  return nullptr;
+}
+
+bool GemmKernel::Initialize() {
+  // The fused node has A and, if it is not a constant, C. C is not read if beta is 0.
+  if (num_inputs_ == 0 || num_inputs_ > 2 || a_input_index_ >= num_inputs_) {
+    return false;
+  }
+
+  if (bias_kind_ == BiasKind::Input && bias_input_index_ >= num_inputs_) {
+    return false;
+  }
+
+  if (bias_kind_ != BiasKind::None && !GetBiasDims(bias_shape_, n_, bias_rows_, bias_cols_)) {
+    return false;
+  }
+
+  if (static_output_shape_.empty()) {
+    return true;
+  }
+
+  if (static_output_shape_.back() != static_cast<int64_t>(n_)) {
+    return false;
+  }
+
+  static_rows_ = 1;
+  for (size_t i = 0; i + 1 < static_output_shape_.size(); ++i) {
+    if (static_output_shape_[i] < 0) {
+      return false;
+    }
+
+    static_rows_ *= static_cast<size_t>(static_output_shape_[i]);
+  }
+
+  return bias_kind_ == BiasKind::None || bias_rows_ == 1 || bias_rows_ == static_rows_;
+}
+
+OrtStatus* GemmKernel::Compute(OrtKernelContext* kernel_ctx, const KernelResources& resources,
+                               SyncStream* stream) const {
+  Ort::KernelContext kernel_context(kernel_ctx);
+  RETURN_IF(kernel_context.GetInputCount() != num_inputs_, "Unexpected number of inputs for fused node");
+  RETURN_IF(kernel_context.GetOutputCount() != 1, "Unexpected number of outputs for fused node");
+
+  Ort::ConstValue a = kernel_context.GetInput(a_input_index_);
+  const float* a_data = a.GetTensorData<float>();
+  float* output_data = nullptr;
+  size_t rows = static_rows_;
+
+  if (!static_output_shape_.empty()) {
+    // The shapes were checked when the kernel was compiled or loaded from an EPContext node, and ORT checks the
+    // model's inputs against them.
+    output_data = kernel_context.GetOutput(0, static_output_shape_).GetTensorMutableData<float>();
+  } else {
+    // The output has A's shape with the last dimension (K) replaced by N. The other dimensions are the rows.
+    std::vector<int64_t> output_shape = a.GetTensorTypeAndShapeInfo().GetShape();
+    RETURN_IF(output_shape.empty() || output_shape.back() != static_cast<int64_t>(k_),
+              "Unexpected shape for input A of the fused MatMul or Gemm node");
+
+    output_shape.back() = static_cast<int64_t>(n_);
+    rows = 1;
+    for (size_t i = 0; i + 1 < output_shape.size(); ++i) {
+      rows *= static_cast<size_t>(output_shape[i]);
+    }
+
+    RETURN_IF(bias_kind_ != BiasKind::None && bias_rows_ != 1 && bias_rows_ != rows,
+              "Input C of the fused Gemm node does not broadcast to the output");
+    output_data = kernel_context.GetOutput(0, output_shape).GetTensorMutableData<float>();
+  }
+
+  // C has a static shape, which was checked when the kernel was compiled or loaded.
+  BiasView bias;
+  if (bias_kind_ != BiasKind::None) {
+    bias.row_stride = bias_rows_ != 1 ? bias_cols_ : 0;
+    bias.col_stride = bias_cols_ != 1 ? 1 : 0;
+
+    if (bias_kind_ == BiasKind::Constant) {
+      bias.data = bias_.data;
+    } else {
+      bias.data = kernel_context.GetInput(bias_input_index_).GetTensorData<float>();
+      bias.scale = bias_scale_;
+    }
+  }
+
+  if (stream != nullptr && SyncStream::CanReadInputsLater(kernel_context)) {
+    stream->Enqueue([this, resources, a_data, bias, output_data, rows]() {
+      Run(resources, a_data, bias, output_data, rows);
+    });
+    return nullptr;
+  }
+
+  if (stream != nullptr) {
+    stream->WaitForAll();  // Earlier tasks may write the inputs.
+  }
+
+  Run(resources, a_data, bias, output_data, rows);
+  return nullptr;
+}
+
+void GemmKernel::Run(const KernelResources& resources, const float* a, const BiasView& bias, float* output,
+                     size_t rows) const {
+  // The bytes of the tensors, as if each was read or written once.
+  const uint64_t bytes_read = (rows * k_ + GetNumElements(packed_b_.shape) +
+                               (bias.data != nullptr ? bias_rows_ * bias_cols_ : 0)) * sizeof(float);
+  KernelProfiler::Scope profiler_scope(resources.profiler, resources.profiler_node, bytes_read,
+                                       rows * n_ * sizeof(float));
+
+  const size_t row_blocks = (rows + kBlockRows - 1) / kBlockRows;
+  const size_t col_blocks = (n_ + kBlockCols - 1) / kBlockCols;
+  const size_t num_blocks = row_blocks * col_blocks;
+
+  auto run_block = [&](size_t block) {
+    const size_t row_begin = (block / col_blocks) * kBlockRows;
+    const size_t col_begin = (block % col_blocks) * kBlockCols;
+    RunBlock(a, bias, output, row_begin, std::min(row_begin + kBlockRows, rows), col_begin,
+             std::min(col_begin + kBlockCols, n_));
+  };
+
+  // The work is measured in multiply-adds. The blocks do not share output cache lines unless N is not a multiple of
+  // the cache line size.
+  const size_t num_multiply_adds = rows * n_ * k_;
+  if (resources.thread_pool == nullptr || num_multiply_adds < resources.parallel_min_elements || num_blocks <= 1) {
+    for (size_t block = 0; block < num_blocks; ++block) {
+      run_block(block);
+    }
+  } else {
+    resources.thread_pool->ParallelFor(num_blocks, run_block);
+  }
+}
+
+void GemmKernel::RunBlock(const float* a, const BiasView& bias, float* output, size_t row_begin, size_t row_end,
+                          size_t col_begin, size_t col_end) const {
+  for (size_t i = row_begin; i < row_end; ++i) {
+    float* output_row = output + i * n_;
+    if (bias.data == nullptr) {
+      std::fill(output_row + col_begin, output_row + col_end, 0.0f);
+      continue;
+    }
+
+    const float* bias_row = bias.data + i * bias.row_stride;
+    for (size_t j = col_begin; j < col_end; ++j) {
+      output_row[j] = bias.scale * bias_row[j * bias.col_stride];
+    }
+  }
+
+  const GemmMicroKernelFn micro_kernel = run_micro_kernel_;
+
+  for (size_t depth_begin = 0; depth_begin < k_; depth_begin += kBlockDepth) {
+    const size_t depth = std::min(kBlockDepth, k_ - depth_begin);
+
+    for (size_t col = col_begin; col < col_end; col += kGemmPanelWidth) {
+      const size_t panel = col / kGemmPanelWidth;
+      const float* panel_data = packed_b_.data + (panel * k_ + depth_begin) * kGemmPanelWidth;
+      const size_t cols = std::min(kGemmPanelWidth, col_end - col);
+
+      for (size_t row = row_begin; row < row_end; row += kGemmMicroKernelRows) {
+        micro_kernel(depth, a + row * k_ + depth_begin, k_, panel_data, output + row * n_ + col, n_,
+                     std::min(kGemmMicroKernelRows, row_end - row), cols);
+      }
+    }
+  }
+}
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ep.h"
+#include "ep_kernel.h"
+
+/// <summary>
+/// Constant parameters of a MatMul or Gemm node. MatMul is a Gemm with the default attributes.
+/// </summary>
+struct GemmNode {
+  bool trans_b = false;
+  float alpha = 1.0f;
+  float beta = 1.0f;
+};
+
+/// <summary>
+/// Checks if a node is a MatMul or Gemm that GemmKernel can compute: B must be a 2D float32 constant initializer, and
+/// A, the optional C and the output must be float32 tensors. A may have a dynamic shape, including its last dimension,
+/// which Compute() checks against B's K dimension. A static last dimension must match K. Gemm must not transpose A,
+/// and C must have a static shape.
+/// </summary>
+/// <param name="node">The node to check</param>
+/// <param name="result">Output parameter set to the node's parameters, or std::nullopt if the node is not
+/// supported</param>
+/// <returns>An OrtStatus* on error, nullptr on success</returns>
+OrtStatus* GetGemmNode(Ort::ConstNode node, /*out*/ std::optional<GemmNode>& result);
+
+/// <summary>
+/// Kernel for a fused node with a single MatMul or Gemm node whose B input is a constant initializer.
+///
+/// B is packed once, when the kernel is created, into column panels of kGemmPanelWidth columns (see PackGemmB()) with
+/// Gemm's alpha folded in. ORT then drops its copy of B. At inference time, C (the output) is split into blocks of
+/// kBlockRows x kBlockCols elements that run in parallel on the EP's thread pool. Each block is computed in passes of
+/// kBlockDepth steps over K: a pass reuses kBlockRows x kBlockDepth elements of A from the L2 cache for every panel,
+/// and each panel's kBlockDepth x kGemmPanelWidth slice from the L1 cache for every kGemmMicroKernelRows rows of A.
+///
+/// MatMul's A may have any rank: all dimensions but the last one are flattened into the rows of the product. Gemm's C
+/// is broadcast to the output (unidirectional broadcasting) and initializes it before the products are added. If A
+/// has a static shape, the output shape is fixed when the kernel is compiled and is not queried at inference time.
+/// </summary>
+class GemmKernel : public EpKernel {
+ public:
+  static constexpr uint32_t kBlobMagic = 0x47504542;  // "BEPG", the start of a serialized GemmKernel.
+  static constexpr size_t kBlockRows = 8 * kGemmMicroKernelRows;
+  static constexpr size_t kBlockCols = 8 * kGemmPanelWidth;
+  static constexpr size_t kBlockDepth = 256;
+
+  /// <summary>
+  /// Creates a kernel for a subgraph with a single node that GetGemmNode() supports, and packs its B input.
+  /// </summary>
+  /// <param name="ort_api">The ORT API</param>
+  /// <param name="logger">The EP's logger</param>
+  /// <param name="graph">The subgraph to compile. Its initializers are only read by this call.</param>
+  /// <param name="simd_level">The instruction set of the kernel's functions</param>
+  /// <param name="kernel">Output parameter set to the new kernel</param>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  static OrtStatus* Create(const OrtApi& ort_api, const OrtLogger& logger, Ort::ConstGraph graph,
+                           SimdLevel simd_level, /*out*/ std::unique_ptr<GemmKernel>& kernel);
+
+  /// <summary>
+  /// Creates a kernel from a blob that Serialize() wrote. The packed B is read in place.
+  /// </summary>
+  /// <param name="ort_api">The ORT API</param>
+  /// <param name="blob">The serialized kernel</param>
+  /// <param name="blob_storage">Keeps the memory of `blob` alive. The kernel shares ownership of it.</param>
+  /// <param name="simd_level">The instruction set of the kernel's functions</param>
+  /// <param name="kernel">Output parameter set to the new kernel</param>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  static OrtStatus* Deserialize(const OrtApi& ort_api, std::span<const uint8_t> blob,
+                                std::shared_ptr<const void> blob_storage, SimdLevel simd_level,
+                                /*out*/ std::unique_ptr<GemmKernel>& kernel);
+
+  /// <summary>
+  /// Serializes the dimensions, the static output shape, the packed B and the constant C, if any.
+  /// </summary>
+  void Serialize(/*out*/ std::string& blob) const override;
+
+  /// <summary>
+  /// Checks the types of A, the bias input and Y, and their shapes if the output shape is static.
+  /// </summary>
+  OrtStatus* CheckGraphIO(Ort::ConstGraph graph) const override;
+
+  /// <summary>
+  /// Computes the product, or enqueues it on `stream`.
+  /// </summary>
+  OrtStatus* Compute(OrtKernelContext* kernel_ctx, const KernelResources& resources,
+                     SyncStream* stream) const override;
+
+ private:
+  enum class BiasKind : uint8_t {
+    None,
+    Constant,  // Constant initializer C, multiplied by beta when the kernel is created. Stored in `bias_`.
+    Input,     // Fused node input C. Multiplied by `bias_scale_` at inference time.
+  };
+
+  // Gemm's C, broadcast to the output.
+  struct BiasView {
+    const float* data = nullptr;  // Null if there is no bias.
+    size_t row_stride = 0;
+    size_t col_stride = 0;
+    float scale = 1.0f;
+  };
+
+  GemmKernel(const OrtApi& ort_api, SimdLevel simd_level)
+      : ort_api_(ort_api), run_micro_kernel_(GetGemmMicroKernel(simd_level)) {}
+
+  // Checks the dimensions and the bias after the kernel was created or deserialized, and computes the values that
+  // Compute() reads instead of the shapes.
+  bool Initialize();
+
+  // Computes the `rows` x N output.
+  void Run(const KernelResources& resources, const float* a, const BiasView& bias, float* output, size_t rows) const;
+
+  // Computes rows [row_begin, row_end) and columns [col_begin, col_end) of the output. `col_begin` must be a multiple
+  // of kGemmPanelWidth.
+  void RunBlock(const float* a, const BiasView& bias, float* output, size_t row_begin, size_t row_end,
+                size_t col_begin, size_t col_end) const;
+
+  const OrtApi& ort_api_;
+  GemmMicroKernelFn run_micro_kernel_;
+  size_t k_ = 0;
+  size_t n_ = 0;
+  FloatInitializer packed_b_;  // Shape [number of panels, K, kGemmPanelWidth].
+  size_t num_inputs_ = 1;
+  size_t a_input_index_ = 0;
+  BiasKind bias_kind_ = BiasKind::None;
+  size_t bias_input_index_ = 0;  // Used if `bias_kind_` is Input.
+  float bias_scale_ = 1.0f;      // Used if `bias_kind_` is Input.
+  std::vector<int64_t> bias_shape_;
+  FloatInitializer bias_;  // Used if `bias_kind_` is Constant.
+  std::vector<int64_t> static_output_shape_;  // Empty if A has a dynamic shape.
+
+  // Set by Initialize().
+  size_t static_rows_ = 0;  // Used if A has a static shape.
+  size_t bias_rows_ = 0;
+  size_t bias_cols_ = 0;
+};
@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gemm_kernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BASIC_EP_X64
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BASIC_EP_ARM64
+#endif
+
+// Defined in the instruction set specific translation units.
+#if defined(BASIC_EP_X64)
+void RunGemmMicroKernelAvx2(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c, size_t ldc,
+                            size_t m, size_t n);
+void RunGemmMicroKernelAvx512(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c,
+                              size_t ldc, size_t m, size_t n);
+#elif defined(BASIC_EP_ARM64)
+void RunGemmMicroKernelNeon(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c, size_t ldc,
+                            size_t m, size_t n);
+#endif
+
+void PackGemmB(const float* b, size_t k, size_t n, bool trans_b, float alpha, float* packed_b) {
+  for (size_t panel_start = 0; panel_start < n; panel_start += kGemmPanelWidth) {
+    const size_t panel_width = std::min(kGemmPanelWidth, n - panel_start);
+
+    for (size_t p = 0; p < k; ++p) {
+      for (size_t j = 0; j < panel_width; ++j) {
+        const size_t col = panel_start + j;
+        packed_b[j] = alpha * (trans_b ? b[col * k + p] : b[p * n + col]);
+      }
+
+      std::fill(packed_b + panel_width, packed_b + kGemmPanelWidth, 0.0f);
+      packed_b += kGemmPanelWidth;
+    }
+  }
+}
+
+void RunGemmMicroKernelScalar(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c,
+                              size_t ldc, size_t m, size_t n) {
+  float acc[kGemmMicroKernelRows][kGemmPanelWidth] = {};
+
+  for (size_t p = 0; p < k; ++p) {
+    const float* b_row = packed_b_panel + p * kGemmPanelWidth;
+    for (size_t i = 0; i < m; ++i) {
+      const float a_value = a[i * lda + p];
+      for (size_t j = 0; j < kGemmPanelWidth; ++j) {
+        acc[i][j] += a_value * b_row[j];
+      }
+    }
+  }
+
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      c[i * ldc + j] += acc[i][j];
+    }
+  }
+}
+
+GemmMicroKernelFn GetGemmMicroKernel(SimdLevel level) {
+  switch (level) {
+#if defined(BASIC_EP_X64)
+    case SimdLevel::Avx2:
+      return RunGemmMicroKernelAvx2;
+    case SimdLevel::Avx512:
+      return RunGemmMicroKernelAvx512;
+#elif defined(BASIC_EP_ARM64)
+    case SimdLevel::Neon:
+      return RunGemmMicroKernelNeon;
+#endif
+    default:
+      return RunGemmMicroKernelScalar;
+  }
+}
@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+
+#include "elementwise_kernels.h"
+
+// Columns of B in each packed panel. Every instruction set uses the same packed layout, so packed weights that are
+// saved in an EPContext node can be used with any SIMD level.
+constexpr size_t kGemmPanelWidth = 16;
+
+// Maximum number of rows of A and C that a micro-kernel call computes, which keeps all accumulators in registers.
+constexpr size_t kGemmMicroKernelRows = 6;
+
+/// <summary>
+/// Gets the number of floats that PackGemmB() writes for a K x N matrix: ceil(N / kGemmPanelWidth) panels of
+/// K x kGemmPanelWidth floats.
+/// </summary>
+inline size_t GetPackedGemmBSize(size_t k, size_t n) {
+  return (n + kGemmPanelWidth - 1) / kGemmPanelWidth * k * kGemmPanelWidth;
+}
+
+/// <summary>
+/// Packs the constant B matrix of a GEMM into column panels for the micro-kernels.
+///
+/// Panel p holds columns [p * kGemmPanelWidth, (p + 1) * kGemmPanelWidth) of alpha * B as K rows of kGemmPanelWidth
+/// contiguous floats. The columns past N in the last panel are zero. A block of consecutive rows of a panel is
+/// contiguous, so the micro-kernel streams it from the L1 cache while it is reused for every row of A.
+/// </summary>
+/// <param name="b">B, row-major: K x N, or N x K if `trans_b` is true</param>
+/// <param name="k">Rows of B (after the optional transpose)</param>
+/// <param name="n">Columns of B (after the optional transpose)</param>
+/// <param name="trans_b">Whether `b` is stored transposed</param>
+/// <param name="alpha">Factor that B is multiplied by</param>
+/// <param name="packed_b">Output buffer of GetPackedGemmBSize(k, n) floats</param>
+void PackGemmB(const float* b, size_t k, size_t n, bool trans_b, float alpha, float* packed_b);
+
+/// <summary>
+/// Adds the product of `m` rows of A (m <= kGemmMicroKernelRows) and `k` rows of a packed panel of B to `m` x `n`
+/// elements of C (n <= kGemmPanelWidth): C[i][j] += sum(A[i][p] * B_panel[p][j] for p in [0, k)).
+/// </summary>
+using GemmMicroKernelFn = void (*)(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c,
+                                   size_t ldc, size_t m, size_t n);
+
+/// <summary>
+/// Portable scalar micro-kernel.
+/// </summary>
+void RunGemmMicroKernelScalar(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c,
+                              size_t ldc, size_t m, size_t n);
+
+/// <summary>
+/// Gets the GEMM micro-kernel for an instruction set. The instruction set must be supported.
+/// </summary>
+GemmMicroKernelFn GetGemmMicroKernel(SimdLevel level);
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Compiled with AVX2 and FMA enabled (see CMakeLists.txt). Only called if GetBestSimdLevel() detects AVX2 and FMA.
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+#include "gemm_kernels_impl.h"
+
+namespace {
+
+struct Avx2Vec {
+  using Reg = __m256;
+  static constexpr size_t kWidth = 8;
+
+  static Reg Load(const float* data) { return _mm256_loadu_ps(data); }
+  static void Store(float* data, Reg value) { _mm256_storeu_ps(data, value); }
+  static Reg Set1(float value) { return _mm256_set1_ps(value); }
+  static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+  static Reg MulAdd(Reg a, Reg b, Reg c) { return _mm256_fmadd_ps(a, b, c); }
+};
+
+}  // namespace
+
+// 6 rows x 2 registers: 12 accumulators, 2 registers for the panel row and 1 for the broadcast element of A.
+void RunGemmMicroKernelAvx2(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c, size_t ldc,
+                            size_t m, size_t n) {
+  RunGemmMicroKernelSimd<Avx2Vec>(k, a, lda, packed_b_panel, c, ldc, m, n);
+}
+
+#endif  // defined(__x86_64__) || defined(_M_X64)
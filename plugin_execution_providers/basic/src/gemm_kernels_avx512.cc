@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Compiled with AVX-512F enabled (see CMakeLists.txt). Only called if GetBestSimdLevel() detects AVX-512F.
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+#include "gemm_kernels_impl.h"
+
+namespace {
+
+struct Avx512Vec {
+  using Reg = __m512;
+  static constexpr size_t kWidth = 16;
+
+  static Reg Load(const float* data) { return _mm512_loadu_ps(data); }
+  static void Store(float* data, Reg value) { _mm512_storeu_ps(data, value); }
+  static Reg Set1(float value) { return _mm512_set1_ps(value); }
+  static Reg Add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+  static Reg MulAdd(Reg a, Reg b, Reg c) { return _mm512_fmadd_ps(a, b, c); }
+};
+
+}  // namespace
+
+// A panel row is a single register, so each step over K is 6 independent FMAs.
+void RunGemmMicroKernelAvx512(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c,
+                              size_t ldc, size_t m, size_t n) {
+  RunGemmMicroKernelSimd<Avx512Vec>(k, a, lda, packed_b_panel, c, ldc, m, n);
+}
+
+#endif  // defined(__x86_64__) || defined(_M_X64)
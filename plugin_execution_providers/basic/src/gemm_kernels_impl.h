@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Implementation of the vectorized GEMM micro-kernels, shared by the instruction set specific translation units
+// (gemm_kernels_avx2.cc, ...). Each of them defines a vector traits type and instantiates RunGemmMicroKernelSimd()
+// with it. This header must only be included by those translation units, because they are compiled with instruction
+// set specific compiler flags.
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "gemm_kernels.h"
+
+// A vector traits type V provides:
+//   using Reg;                          // Vector register type.
+//   static constexpr size_t kWidth;     // Floats per register. Must divide kGemmPanelWidth.
+//   Load(const float*), Store(float*, Reg), Set1(float), Add(Reg, Reg), MulAdd(a, b, c) = a * b + c.
+
+/// <summary>
+/// Calls `fn(std::integral_constant<size_t, I>{})` for every I in [0, N). The loops over the accumulators are unrolled
+/// this way instead of relying on the optimization level, so that the accumulators always stay in registers.
+/// </summary>
+template <size_t N, typename Fn>
+inline void Unroll(Fn&& fn) {
+  [&]<size_t... I>(std::index_sequence<I...>) { (fn(std::integral_constant<size_t, I>{}), ...); }
+  (std::make_index_sequence<N>{});
+}
+
+/// <summary>
+/// Register-blocked micro-kernel for exactly `Rows` rows of A and C. The Rows x kGemmPanelWidth block of C is
+/// accumulated in registers, so each step over K loads one row of the panel and broadcasts one element of A per row.
+/// Only the first `n` columns of C are updated.
+/// </summary>
+template <typename V, size_t Rows>
+inline void RunGemmMicroKernelRows(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c,
+                                   size_t ldc, size_t n) {
+  using Reg = typename V::Reg;
+  constexpr size_t kRegsPerRow = kGemmPanelWidth / V::kWidth;
+  static_assert(kGemmPanelWidth % V::kWidth == 0);
+
+  Reg acc[Rows][kRegsPerRow];
+  Unroll<Rows>([&](auto i) { Unroll<kRegsPerRow>([&](auto j) { acc[i][j] = V::Set1(0.0f); }); });
+
+  for (size_t p = 0; p < k; ++p) {
+    const float* b_row = packed_b_panel + p * kGemmPanelWidth;
+    Reg b[kRegsPerRow];
+    Unroll<kRegsPerRow>([&](auto j) { b[j] = V::Load(b_row + j * V::kWidth); });
+
+    Unroll<Rows>([&](auto i) {
+      const Reg a_value = V::Set1(a[i * lda + p]);
+      Unroll<kRegsPerRow>([&](auto j) { acc[i][j] = V::MulAdd(a_value, b[j], acc[i][j]); });
+    });
+  }
+
+  if (n == kGemmPanelWidth) {
+    Unroll<Rows>([&](auto i) {
+      Unroll<kRegsPerRow>([&](auto j) {
+        float* c_ptr = c + i * ldc + j * V::kWidth;
+        V::Store(c_ptr, V::Add(V::Load(c_ptr), acc[i][j]));
+      });
+    });
+
+    return;
+  }
+
+  // Partial panel at the right edge of C: the columns past `n` hold products with the zero padding of the panel.
+  for (size_t i = 0; i < Rows; ++i) {
+    float row[kGemmPanelWidth];
+    for (size_t j = 0; j < kRegsPerRow; ++j) {
+      V::Store(row + j * V::kWidth, acc[i][j]);
+    }
+
+    for (size_t j = 0; j < n; ++j) {
+      c[i * ldc + j] += row[j];
+    }
+  }
+}
+
+/// <summary>
+/// GemmMicroKernelFn implementation for a vector traits type.
+/// </summary>
+template <typename V>
+void RunGemmMicroKernelSimd(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c, size_t ldc,
+                            size_t m, size_t n) {
+  static_assert(kGemmMicroKernelRows == 6);
+
+  switch (m) {
+    case 6:
+      RunGemmMicroKernelRows<V, 6>(k, a, lda, packed_b_panel, c, ldc, n);
+      break;
+    case 5:
+      RunGemmMicroKernelRows<V, 5>(k, a, lda, packed_b_panel, c, ldc, n);
+      break;
+    case 4:
+      RunGemmMicroKernelRows<V, 4>(k, a, lda, packed_b_panel, c, ldc, n);
+      break;
+    case 3:
+      RunGemmMicroKernelRows<V, 3>(k, a, lda, packed_b_panel, c, ldc, n);
+      break;
+    case 2:
+      RunGemmMicroKernelRows<V, 2>(k, a, lda, packed_b_panel, c, ldc, n);
+      break;
+    case 1:
+      RunGemmMicroKernelRows<V, 1>(k, a, lda, packed_b_panel, c, ldc, n);
+      break;
+    default:
+      break;
+  }
+}
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// NEON is part of the ARM64 baseline, so this file needs no special compiler flags.
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#include <arm_neon.h>
+
+#include "gemm_kernels_impl.h"
+
+namespace {
+
+struct NeonVec {
+  using Reg = float32x4_t;
+  static constexpr size_t kWidth = 4;
+
+  static Reg Load(const float* data) { return vld1q_f32(data); }
+  static void Store(float* data, Reg value) { vst1q_f32(data, value); }
+  static Reg Set1(float value) { return vdupq_n_f32(value); }
+  static Reg Add(Reg a, Reg b) { return vaddq_f32(a, b); }
+  static Reg MulAdd(Reg a, Reg b, Reg c) { return vfmaq_f32(c, a, b); }
+};
+
+}  // namespace
+
+// 6 rows x 4 registers: 24 accumulators and 5 more registers out of the 32 NEON registers.
+void RunGemmMicroKernelNeon(size_t k, const float* a, size_t lda, const float* packed_b_panel, float* c, size_t ldc,
+                            size_t m, size_t n) {
+  RunGemmMicroKernelSimd<NeonVec>(k, a, lda, packed_b_panel, c, ldc, m, n);
+}
+
+#endif  // defined(__aarch64__) || defined(_M_ARM64)
@@ -0,0 +1,302 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "kernel_cache.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "blob_utils.h"
+#include "elementwise_ops.h"
+#include "ep_kernel.h"
+#include "gemm_kernel.h"
+#include "plugin_ep_utils.h"
+#include "qdq_kernel.h"
+
+namespace {
+
+// Kinds of values in a subgraph key.
+enum class KeyValueKind : uint8_t {
+  Missing,      // Omitted optional input.
+  GraphInput,   // Followed by the input index.
+  NodeOutput,   // Followed by the node index and the output index.
+  Constant,     // Followed by the element type, the shape and the SHA-256 of the data.
+  OuterValue,   // Followed by the name. Not expected for the subgraphs that GetCapability() selects.
+};
+
+// SHA-256 (FIPS 180-4) of data. A cache hit does not compare the constant data or the serialized kernel, so the key
+// holds a collision-resistant digest of it: two different weights only get the same key if they are a SHA-256
+// collision, which is not known to be feasible even for a model crafted to cause one.
+std::array<uint8_t, 32> Sha256(const void* data, size_t size) {
+  static constexpr std::array<uint32_t, 64> kRoundConstants = {
+      0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+      0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+      0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+      0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+      0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+      0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+      0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+      0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+  };
+
+  std::array<uint32_t, 8> state = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                                   0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+  auto process_block = [&](const uint8_t* block) {
+    std::array<uint32_t, 64> w;
+    for (size_t i = 0; i < 16; ++i) {
+      w[i] = (uint32_t{block[4 * i]} << 24) | (uint32_t{block[4 * i + 1]} << 16) |
+             (uint32_t{block[4 * i + 2]} << 8) | uint32_t{block[4 * i + 3]};
+    }
+
+    for (size_t i = 16; i < 64; ++i) {
+      const uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      const uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = state;
+    for (size_t i = 0; i < 64; ++i) {
+      const uint32_t t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g)) +
+                          kRoundConstants[i] + w[i];
+      const uint32_t t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+
+    const std::array<uint32_t, 8> round_state = {a, b, c, d, e, f, g, h};
+    for (size_t i = 0; i < 8; ++i) {
+      state[i] += round_state[i];
+    }
+  };
+
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  size_t i = 0;
+  for (; i + 64 <= size; i += 64) {
+    process_block(bytes + i);
+  }
+
+  // Pad the remaining bytes with 0x80, zeros and the size in bits, into one or two blocks.
+  std::array<uint8_t, 128> tail = {};
+  const size_t num_remaining = size - i;
+  if (num_remaining != 0) {
+    std::memcpy(tail.data(), bytes + i, num_remaining);
+  }
+
+  tail[num_remaining] = 0x80;
+  const size_t tail_size = num_remaining < 56 ? 64 : 128;
+  const uint64_t num_bits = static_cast<uint64_t>(size) * 8;
+  for (size_t j = 0; j < 8; ++j) {
+    tail[tail_size - 1 - j] = static_cast<uint8_t>(num_bits >> (8 * j));
+  }
+
+  for (size_t offset = 0; offset < tail_size; offset += 64) {
+    process_block(tail.data() + offset);
+  }
+
+  std::array<uint8_t, 32> digest;
+  for (size_t j = 0; j < 32; ++j) {
+    digest[j] = static_cast<uint8_t>(state[j / 4] >> (24 - 8 * (j % 4)));
+  }
+
+  return digest;
+}
+
+void WriteString(BlobWriter& writer, const std::string& str) {
+  writer.Write<uint64_t>(str.size());
+  writer.WriteBytes(str.data(), str.size());
+}
+
+void WriteValueType(BlobWriter& writer, Ort::ConstValueInfo value_info) {
+  const auto type_info = value_info.TypeInfo();
+  int32_t element_type = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+  if (type_info.GetONNXType() == ONNX_TYPE_TENSOR) {
+    element_type = type_info.GetTensorTypeAndShapeInfo().GetElementType();
+  }
+
+  writer.Write(element_type);
+
+  std::optional<std::vector<int64_t>> shape = GetTensorShape(value_info);
+  writer.Write<uint8_t>(shape.has_value());
+  if (shape.has_value()) {
+    writer.WriteShape(*shape);
+  }
+}
+
+}  // namespace
+
+/*static*/
+OrtStatus* KernelCache::GetSubgraphKey(Ort::ConstGraph graph, SimdLevel simd_level, /*out*/ std::string& key) {
+  BlobWriter writer(key);
+  writer.Write('S');
+  writer.Write(static_cast<uint8_t>(simd_level));
+
+  // Values are identified by their position in the subgraph instead of their names, so that subgraphs of different
+  // models (or different copies of a model) with the same structure get the same key.
+  std::unordered_map<std::string, size_t> graph_input_indices;
+  std::unordered_map<std::string, std::pair<size_t, size_t>> node_outputs;  // Node index and output index.
+
+  std::vector<Ort::ConstValueInfo> graph_inputs = graph.GetInputs();
+  writer.Write<uint64_t>(graph_inputs.size());
+  for (size_t i = 0; i < graph_inputs.size(); ++i) {
+    WriteValueType(writer, graph_inputs[i]);
+    graph_input_indices.emplace(graph_inputs[i].GetName(), i);
+  }
+
+  auto write_input = [&](Ort::ConstValueInfo input) -> OrtStatus* {
+    if (input == nullptr) {
+      writer.Write(KeyValueKind::Missing);
+      return nullptr;
+    }
+
+    const std::string name = input.GetName();
+    if (auto it = graph_input_indices.find(name); it != graph_input_indices.end()) {
+      writer.Write(KeyValueKind::GraphInput);
+      writer.Write<uint64_t>(it->second);
+      return nullptr;
+    }
+
+    if (auto it = node_outputs.find(name); it != node_outputs.end()) {
+      writer.Write(KeyValueKind::NodeOutput);
+      writer.Write<uint64_t>(it->second.first);
+      writer.Write<uint64_t>(it->second.second);
+      return nullptr;
+    }
+
+    if (!input.IsConstantInitializer()) {
+      writer.Write(KeyValueKind::OuterValue);
+      WriteString(writer, name);
+      return nullptr;
+    }
+
+    // The kernels only read float32 tensors, and the int8/uint8 data and zero points of QDQ node units (see
+    // IsNodeSupported(), GetGemmNode() and GetQdqNodeUnit()).
+    Ort::ConstValue value;
+    RETURN_IF_ERROR(input.GetInitializer(value));
+    auto type_shape = value.GetTensorTypeAndShapeInfo();
+    const ONNXTensorElementDataType element_type = type_shape.GetElementType();
+    RETURN_IF(element_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT &&
+                  element_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8 &&
+                  element_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8,
+              "Expected float32, int8 or uint8 initializers");
+
+    const size_t element_size = element_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT ? sizeof(float) : 1;
+    const auto digest = Sha256(value.GetTensorRawData(), type_shape.GetElementCount() * element_size);
+    writer.Write(KeyValueKind::Constant);
+    writer.Write(static_cast<int32_t>(element_type));
+    writer.WriteShape(type_shape.GetShape());
+    writer.WriteBytes(digest.data(), digest.size());
+    return nullptr;
+  };
+
+  std::vector<Ort::ConstNode> nodes = graph.GetNodes();
+  writer.Write<uint64_t>(nodes.size());
+
+  for (size_t node_index = 0; node_index < nodes.size(); ++node_index) {
+    Ort::ConstNode node = nodes[node_index];
+    WriteString(writer, node.GetDomain());
+    WriteString(writer, node.GetOperatorType());
+
+    // The parsed parameters are all that the kernels read from the node's attributes and constant scalar inputs.
+    std::vector<Ort::ConstValueInfo> inputs = node.GetInputs();
+    size_t num_tensor_inputs = 0;
+
+    std::optional<ElementwiseNode> elementwise_node;
+    std::optional<GemmNode> gemm_node;
+    RETURN_IF_ERROR(GetElementwiseNode(node, elementwise_node));
+
+    if (elementwise_node.has_value()) {
+      writer.Write(elementwise_node->op);
+      writer.Write(elementwise_node->clip_min);
+      writer.Write(elementwise_node->clip_max);
+      num_tensor_inputs = GetNumTensorInputs(elementwise_node->op);
+    } else {
+      RETURN_IF_ERROR(GetGemmNode(node, gemm_node));
+
+      if (gemm_node.has_value()) {
+        writer.Write<uint8_t>(gemm_node->trans_b);
+        writer.Write(gemm_node->alpha);
+        writer.Write(gemm_node->beta);
+      } else if (!IsQdqNodeUnitOp(node)) {
+        RETURN_ERROR(ORT_EP_FAIL, "Unable to get the kernel cache key of node " << node.GetName()
+                                                                               << " with op type "
+                                                                               << node.GetOperatorType());
+      }
+
+      // The QDQ node unit's nodes are described by their inputs, which include the constant scales and zero points.
+      num_tensor_inputs = inputs.size();
+    }
+
+    RETURN_IF(inputs.size() < num_tensor_inputs, "Unexpected number of node inputs");
+    writer.Write<uint64_t>(num_tensor_inputs);
+    for (size_t i = 0; i < num_tensor_inputs; ++i) {
+      RETURN_IF_ERROR(write_input(inputs[i]));
+    }
+
+    std::vector<Ort::ConstValueInfo> outputs = node.GetOutputs();
+    writer.Write<uint64_t>(outputs.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      if (outputs[i] == nullptr) {
+        writer.Write<uint8_t>(0);
+        continue;
+      }
+
+      writer.Write<uint8_t>(1);
+      WriteValueType(writer, outputs[i]);
+      node_outputs.emplace(outputs[i].GetName(), std::make_pair(node_index, i));
+    }
+  }
+
+  std::vector<Ort::ConstValueInfo> graph_outputs = graph.GetOutputs();
+  writer.Write<uint64_t>(graph_outputs.size());
+  for (Ort::ConstValueInfo output : graph_outputs) {
+    RETURN_IF_ERROR(write_input(output));
+  }
+
+  return nullptr;
+}
+
+/*static*/
+std::string KernelCache::GetBlobKey(std::span<const uint8_t> blob, SimdLevel simd_level) {
+  std::string key;
+  BlobWriter writer(key);
+  writer.Write('B');
+  writer.Write(static_cast<uint8_t>(simd_level));
+  writer.Write<uint64_t>(blob.size());
+
+  const auto digest = Sha256(blob.data(), blob.size());
+  writer.WriteBytes(digest.data(), digest.size());
+  return key;
+}
+
+std::shared_ptr<const EpKernel> KernelCache::Find(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = kernels_.find(key);
+  return it != kernels_.end() ? it->second.lock() : nullptr;
+}
+
+std::shared_ptr<const EpKernel> KernelCache::Insert(const std::string& key, std::unique_ptr<const EpKernel> kernel) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Remove the entries of kernels that all sessions have released.
+  std::erase_if(kernels_, [](const auto& entry) { return entry.second.expired(); });
+
+  std::weak_ptr<const EpKernel>& entry = kernels_[key];
+  if (std::shared_ptr<const EpKernel> existing = entry.lock(); existing != nullptr) {
+    return existing;
+  }
+
+  std::shared_ptr<const EpKernel> shared_kernel = std::move(kernel);
+  entry = shared_kernel;
+  return shared_kernel;
+}
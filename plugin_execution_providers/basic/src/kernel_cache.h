@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+#define ORT_API_MANUAL_INIT
+#include "onnxruntime_cxx_api.h"
+#undef ORT_API_MANUAL_INIT
+
+#include "elementwise_kernels.h"
+
+class EpKernel;
+
+/// <summary>
+/// Cache of compiled kernels that BasicPluginEpFactory shares across the EPs of all sessions, so that sessions of the
+/// same model compile each fused subgraph and pack each weight once.
+///
+/// A kernel is keyed by its subgraph's structure (ops, parameters, shapes and how the nodes are connected), the SHA-256
+/// of the data of each constant initializer that it reads, and the SIMD level that it is compiled for. Kernels of
+/// EPContext nodes are keyed by the SHA-256 of the serialized kernel instead. A cache hit does not compare the data
+/// (the kernels do not keep the original bytes), so different weights would only share a kernel if their digests
+/// collided. The EPs hold the kernels, and the cache only refers to them, so a kernel is released with the last session
+/// that uses it. Per-session resources (the thread pool and the stream) are passed to each Compute() call.
+/// </summary>
+class KernelCache {
+ public:
+  /// <summary>
+  /// Gets the key of a subgraph that GetCapability() selected.
+  /// </summary>
+  /// <param name="graph">The subgraph</param>
+  /// <param name="simd_level">The SIMD level that the kernel would be compiled for</param>
+  /// <param name="key">Output parameter set to the key</param>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  static OrtStatus* GetSubgraphKey(Ort::ConstGraph graph, SimdLevel simd_level, /*out*/ std::string& key);
+
+  /// <summary>
+  /// Gets the key of a kernel that is loaded from the serialized kernel of an EPContext node.
+  /// </summary>
+  static std::string GetBlobKey(std::span<const uint8_t> blob, SimdLevel simd_level);
+
+  /// <summary>
+  /// Gets the kernel for a key, or null if no session holds it.
+  /// </summary>
+  std::shared_ptr<const EpKernel> Find(const std::string& key);
+
+  /// <summary>
+  /// Adds a kernel. If another EP added a kernel for the same key first (e.g., while its session was created
+  /// concurrently), `kernel` is released and the existing kernel is returned.
+  /// </summary>
+  std::shared_ptr<const EpKernel> Insert(const std::string& key, std::unique_ptr<const EpKernel> kernel);
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<const EpKernel>> kernels_;  // Expired entries are removed by Insert().
+};
@@ -0,0 +1,177 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "kernel_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <utility>
+
+namespace {
+
+std::atomic<uint64_t> next_profiler_id{1};
+
+// The counters that the current thread used last.
+struct CachedThreadCounters {
+  uint64_t profiler_id = 0;
+  void* counters = nullptr;
+};
+
+thread_local CachedThreadCounters cached_thread_counters;
+
+}  // namespace
+
+KernelProfiler::KernelProfiler() : id_(next_profiler_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+size_t KernelProfiler::AddNode(std::string name, std::string description) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  nodes_.push_back({std::move(name), std::move(description)});
+  return nodes_.size() - 1;
+}
+
+void KernelProfiler::Counters::Merge(const Counters& other) {
+  count += other.count;
+  total_ns += other.total_ns;
+  min_ns = std::min(min_ns, other.min_ns);
+  max_ns = std::max(max_ns, other.max_ns);
+  bytes_read += other.bytes_read;
+  bytes_written += other.bytes_written;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    histogram[i] += other.histogram[i];
+  }
+}
+
+/*static*/
+size_t KernelProfiler::GetBucket(uint64_t duration_ns) {
+  constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+  if (duration_ns < kSubBuckets) {
+    return static_cast<size_t>(duration_ns);
+  }
+
+  const size_t exponent = static_cast<size_t>(std::bit_width(duration_ns)) - 1;  // At least kSubBucketBits.
+  if (exponent > kMaxExponent) {
+    return kNumBuckets - 1;
+  }
+
+  const size_t sub_bucket = static_cast<size_t>(duration_ns >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+  return ((exponent - kSubBucketBits + 1) << kSubBucketBits) + sub_bucket;
+}
+
+/*static*/
+uint64_t KernelProfiler::GetBucketMidpoint(size_t bucket) {
+  constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+  if (bucket < kSubBuckets) {
+    return bucket;
+  }
+
+  const size_t exponent = (bucket >> kSubBucketBits) + kSubBucketBits - 1;
+  const uint64_t sub_bucket = bucket & (kSubBuckets - 1);
+  const uint64_t width = uint64_t{1} << (exponent - kSubBucketBits);
+  return (kSubBuckets + sub_bucket) * width + width / 2;
+}
+
+/*static*/
+uint64_t KernelProfiler::GetPercentile(const Counters& counters, double percentile) {
+  const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile * counters.count)), 1);
+
+  uint64_t num_below = 0;
+  for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+    num_below += counters.histogram[bucket];
+    if (num_below >= rank) {
+      return std::clamp(GetBucketMidpoint(bucket), counters.min_ns, counters.max_ns);
+    }
+  }
+
+  return counters.max_ns;
+}
+
+KernelProfiler::ThreadCounters& KernelProfiler::GetThreadCounters() {
+  CachedThreadCounters& cached = cached_thread_counters;
+  if (cached.profiler_id == id_) {
+    return *static_cast<ThreadCounters*>(cached.counters);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_ptr<ThreadCounters>& counters = thread_counters_[std::this_thread::get_id()];
+  if (counters == nullptr) {
+    counters = std::make_unique<ThreadCounters>();
+  }
+
+  cached.profiler_id = id_;
+  cached.counters = counters.get();
+  return *counters;
+}
+
+void KernelProfiler::Record(size_t node, uint64_t duration_ns, uint64_t bytes_read, uint64_t bytes_written) {
+  ThreadCounters& thread_counters = GetThreadCounters();
+  if (node >= thread_counters.nodes.size()) {
+    thread_counters.nodes.resize(node + 1);
+  }
+
+  Counters& counters = thread_counters.nodes[node];
+  ++counters.count;
+  counters.total_ns += duration_ns;
+  counters.min_ns = std::min(counters.min_ns, duration_ns);
+  counters.max_ns = std::max(counters.max_ns, duration_ns);
+  counters.bytes_read += bytes_read;
+  counters.bytes_written += bytes_written;
+  ++counters.histogram[GetBucket(duration_ns)];
+}
+
+void KernelProfiler::WriteSummary(std::ostream& out) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::vector<Counters> nodes(nodes_.size());
+  for (const auto& [thread_id, thread_counters] : thread_counters_) {
+    for (size_t i = 0; i < thread_counters->nodes.size() && i < nodes.size(); ++i) {
+      nodes[i].Merge(thread_counters->nodes[i]);
+    }
+  }
+
+  const std::ios_base::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+
+  constexpr int kNameWidth = 40;
+  constexpr int kColumnWidth = 12;
+  out << std::left << std::setw(kNameWidth) << "Fused node" << std::right;
+  for (const char* column : {"Runs", "Total us", "Min us", "P50 us", "P90 us", "P99 us", "Max us", "Read B/run",
+                             "Write B/run", "GB/s"}) {
+    out << std::setw(kColumnWidth) << column;
+  }
+
+  out << "  Ops\n";
+
+  auto to_us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+  out << std::fixed << std::setprecision(2);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const Counters& counters = nodes[i];
+    if (counters.count == 0) {
+      continue;
+    }
+
+    // Bytes per nanosecond are GB/s.
+    const double gb_per_s = counters.total_ns != 0 ? static_cast<double>(counters.bytes_read + counters.bytes_written) /
+                                                         static_cast<double>(counters.total_ns)
+                                                   : 0.0;
+
+    out << std::left << std::setw(kNameWidth) << nodes_[i].name << std::right
+        << std::setw(kColumnWidth) << counters.count
+        << std::setw(kColumnWidth) << to_us(counters.total_ns)
+        << std::setw(kColumnWidth) << to_us(counters.min_ns)
+        << std::setw(kColumnWidth) << to_us(GetPercentile(counters, 0.5))
+        << std::setw(kColumnWidth) << to_us(GetPercentile(counters, 0.9))
+        << std::setw(kColumnWidth) << to_us(GetPercentile(counters, 0.99))
+        << std::setw(kColumnWidth) << to_us(counters.max_ns)
+        << std::setw(kColumnWidth) << counters.bytes_read / counters.count
+        << std::setw(kColumnWidth) << counters.bytes_written / counters.count
+        << std::setw(kColumnWidth) << gb_per_s
+        << "  " << nodes_[i].description << "\n";
+  }
+
+  out.flags(flags);
+  out.precision(precision);
+}
@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Set to 0 (e.g., with the CMake option BASIC_EP_ENABLE_PROFILING=OFF) to compile the timing of kernel runs out of
+// the kernels.
+#ifndef BASIC_EP_ENABLE_PROFILING
+#define BASIC_EP_ENABLE_PROFILING 1
+#endif
+
+/// <summary>
+/// Per-fused-node run statistics of a BasicPluginEp: number of runs, total/min/max time, approximate percentiles,
+/// and the bytes that the runs read and wrote.
+///
+/// Each thread that runs kernels records into its own counters, so recording only takes a lock the first time a
+/// thread records for the profiler (or after it recorded for another one). The counters of all threads are merged
+/// when the summary is written, which must not run concurrently with recording (e.g., when the session is released).
+/// </summary>
+class KernelProfiler {
+ public:
+  // False if the timing of kernel runs is compiled out.
+  static constexpr bool kEnabled = BASIC_EP_ENABLE_PROFILING != 0;
+
+  /// <summary>
+  /// Times a kernel run from construction to destruction. Does nothing if `profiler` is null or profiling is compiled
+  /// out.
+  /// </summary>
+  class Scope {
+   public:
+    Scope(KernelProfiler* profiler, size_t node, uint64_t bytes_read, uint64_t bytes_written)
+        : profiler_(profiler), node_(node), bytes_read_(bytes_read), bytes_written_(bytes_written) {
+      if constexpr (kEnabled) {
+        if (profiler_ != nullptr) {
+          start_ = std::chrono::steady_clock::now();
+        }
+      }
+    }
+
+    ~Scope() {
+      if constexpr (kEnabled) {
+        if (profiler_ != nullptr) {
+          const auto duration = std::chrono::steady_clock::now() - start_;
+          profiler_->Record(node_, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+                            bytes_read_, bytes_written_);
+        }
+      }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    KernelProfiler* profiler_;
+    size_t node_;
+    uint64_t bytes_read_;
+    uint64_t bytes_written_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  KernelProfiler();
+
+  KernelProfiler(const KernelProfiler&) = delete;
+  KernelProfiler& operator=(const KernelProfiler&) = delete;
+
+  /// <summary>
+  /// Adds a fused node when it is compiled.
+  /// </summary>
+  /// <param name="name">The name of the fused node</param>
+  /// <param name="description">The op types of the fused subgraph</param>
+  /// <returns>The node's index for Scope</returns>
+  size_t AddNode(std::string name, std::string description);
+
+  /// <summary>
+  /// Records a run of a node. Safe to call concurrently.
+  /// </summary>
+  void Record(size_t node, uint64_t duration_ns, uint64_t bytes_read, uint64_t bytes_written);
+
+  /// <summary>
+  /// Writes a table with a row per node that ran: runs, total/min/max/p50/p90/p99 time in microseconds, bytes read
+  /// and written per run, and the achieved bandwidth in GB/s.
+  /// </summary>
+  void WriteSummary(std::ostream& out) const;
+
+ private:
+  // Durations are counted in buckets with 4 sub-buckets per power of two, so that a percentile is within 12.5% of
+  // the recorded value. The last bucket counts durations of about 2^40 ns (18 minutes) and more.
+  static constexpr size_t kSubBucketBits = 2;
+  static constexpr size_t kMaxExponent = 40;
+  static constexpr size_t kNumBuckets = (kMaxExponent - kSubBucketBits + 2) << kSubBucketBits;
+
+  struct Counters {
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t min_ns = UINT64_MAX;
+    uint64_t max_ns = 0;
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+    std::array<uint64_t, kNumBuckets> histogram{};
+
+    void Merge(const Counters& other);
+  };
+
+  struct ThreadCounters {
+    std::vector<Counters> nodes;  // Indexed by node. Grows as the thread records for new nodes.
+  };
+
+  struct NodeInfo {
+    std::string name;
+    std::string description;
+  };
+
+  static size_t GetBucket(uint64_t duration_ns);
+  static uint64_t GetBucketMidpoint(size_t bucket);
+
+  // Gets an approximate percentile of the durations.
+  static uint64_t GetPercentile(const Counters& counters, double percentile);
+
+  ThreadCounters& GetThreadCounters();
+
+  const uint64_t id_;  // Unique across profilers, so that a thread's cached counters are not reused by a new one.
+
+  mutable std::mutex mutex_;  // Protects the members below.
+  std::vector<NodeInfo> nodes_;
+  std::unordered_map<std::thread::id, std::unique_ptr<ThreadCounters>> thread_counters_;
+};
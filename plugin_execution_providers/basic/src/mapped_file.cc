@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*static*/
+std::unique_ptr<MappedFile> MappedFile::Open(const std::filesystem::path& path) {
+  auto file = std::unique_ptr<MappedFile>(new MappedFile());
+
+#if defined(_WIN32)
+  HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+  file->file_ = handle;  // Closed by the destructor from now on.
+
+  LARGE_INTEGER size = {};
+  if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+    return nullptr;
+  }
+
+  file->mapping_ = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (file->mapping_ == nullptr) {
+    return nullptr;
+  }
+
+  file->data_ = static_cast<const uint8_t*>(MapViewOfFile(file->mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (file->data_ == nullptr) {
+    return nullptr;
+  }
+
+  file->size_ = static_cast<size_t>(size.QuadPart);
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat st = {};
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+
+  close(fd);  // The mapping stays valid after the file is closed.
+
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+
+  file->data_ = static_cast<const uint8_t*>(data);
+  file->size_ = static_cast<size_t>(st.st_size);
+#endif
+
+  return file;
+}
+
+MappedFile::~MappedFile() {
+#if defined(_WIN32)
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+  }
+
+  if (file_ != nullptr) {
+    CloseHandle(file_);
+  }
+#else
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+#endif
+}
@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+/// <summary>
+/// Read-only memory mapping of an entire file. Used to read external initializer data in place instead of copying
+/// it into EP-owned buffers.
+/// </summary>
+class MappedFile {
+ public:
+  /// <summary>
+  /// Maps a file into memory.
+  /// </summary>
+  /// <returns>Null if the file cannot be opened or mapped (e.g., it does not exist or is empty)</returns>
+  static std::unique_ptr<MappedFile> Open(const std::filesystem::path& path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+
+ private:
+  MappedFile() = default;
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#if defined(_WIN32)
+  void* file_ = nullptr;     // HANDLE
+  void* mapping_ = nullptr;  // HANDLE
+#endif
+};
@@ -0,0 +1,271 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "partitioning_utils.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
+#include "plugin_ep_utils.h"
+
+namespace {
+
+constexpr size_t kNoSegment = std::numeric_limits<size_t>::max();
+
+// Minimal union-find used to split a partition into its connected components.
+struct DisjointSets {
+  explicit DisjointSets(size_t size) : parents(size) { std::iota(parents.begin(), parents.end(), size_t{0}); }
+
+  size_t Find(size_t index) {
+    while (parents[index] != index) {
+      parents[index] = parents[parents[index]];  // Path halving.
+      index = parents[index];
+    }
+    return index;
+  }
+
+  void Union(size_t a, size_t b) { parents[Find(a)] = Find(b); }
+
+  std::vector<size_t> parents;
+};
+
+// Returns true if `target` can be reached from `source` through at least one other group.
+bool HasIndirectPath(const std::vector<std::set<size_t>>& successors, size_t source, size_t target) {
+  std::vector<bool> visited(successors.size(), false);
+  std::vector<size_t> to_visit;
+
+  for (size_t successor : successors[source]) {
+    if (successor != target) {
+      to_visit.push_back(successor);
+    }
+  }
+
+  while (!to_visit.empty()) {
+    const size_t group = to_visit.back();
+    to_visit.pop_back();
+
+    if (group == target) {
+      return true;
+    }
+
+    if (visited[group]) {
+      continue;
+    }
+
+    visited[group] = true;
+    to_visit.insert(to_visit.end(), successors[group].begin(), successors[group].end());
+  }
+
+  return false;
+}
+
+}  // namespace
+
+OrtStatus* PartitionSupportedNodes(Ort::ConstGraph graph, const std::unordered_set<size_t>& supported_node_ids,
+                                   /*out*/ std::vector<std::vector<Ort::ConstNode>>& partitions) {
+  partitions.clear();
+
+  std::vector<Ort::ConstNode> nodes = graph.GetNodes();
+  const size_t num_nodes = nodes.size();
+
+  std::unordered_map<size_t, size_t> node_index_by_id;  // Node ID -> index into `nodes`.
+  node_index_by_id.reserve(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    node_index_by_id.emplace(nodes[i].GetId(), i);
+  }
+
+  // Build the edges between the nodes of this graph. Values produced outside of the graph (graph inputs,
+  // initializers, and values from an outer scope) do not constrain the order of the nodes.
+  std::vector<std::vector<size_t>> consumers(num_nodes);
+  std::vector<size_t> in_degrees(num_nodes, 0);
+
+  auto add_input_edges = [&](size_t node_index, const std::vector<Ort::ConstValueInfo>& inputs) {
+    for (const Ort::ConstValueInfo& input : inputs) {
+      if (input == nullptr) {
+        continue;  // Missing optional input.
+      }
+
+      Ort::ConstNode producer = input.GetProducerNode().node;
+      if (producer == nullptr) {
+        continue;
+      }
+
+      auto producer_iter = node_index_by_id.find(producer.GetId());
+      if (producer_iter == node_index_by_id.end()) {
+        continue;
+      }
+
+      consumers[producer_iter->second].push_back(node_index);
+      ++in_degrees[node_index];
+    }
+  };
+
+  std::vector<bool> is_supported(num_nodes, false);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    is_supported[i] = supported_node_ids.count(nodes[i].GetId()) != 0;
+    add_input_edges(i, nodes[i].GetInputs());
+    add_input_edges(i, nodes[i].GetImplicitInputs());  // E.g., outer scope values used by an If node's subgraphs.
+  }
+
+  // Kahn's topological sort with two ready queues. Unsupported nodes are processed as soon as they are ready because
+  // they may unblock more supported nodes. Once only supported nodes are ready, all supported nodes that become ready
+  // without processing an unsupported node form one contiguous segment of the topological order.
+  std::deque<size_t> ready_supported;
+  std::deque<size_t> ready_unsupported;
+  std::vector<size_t> segment_ids(num_nodes, kNoSegment);
+  std::vector<std::vector<size_t>> segments;
+  std::vector<size_t> topological_positions(num_nodes, 0);
+  size_t num_processed = 0;
+
+  auto push_ready = [&](size_t node_index) {
+    (is_supported[node_index] ? ready_supported : ready_unsupported).push_back(node_index);
+  };
+
+  auto process = [&](size_t node_index) {
+    topological_positions[node_index] = num_processed++;
+    for (size_t consumer_index : consumers[node_index]) {
+      if (--in_degrees[consumer_index] == 0) {
+        push_ready(consumer_index);
+      }
+    }
+  };
+
+  for (size_t i = 0; i < num_nodes; ++i) {
+    if (in_degrees[i] == 0) {
+      push_ready(i);
+    }
+  }
+
+  while (!ready_supported.empty() || !ready_unsupported.empty()) {
+    if (!ready_unsupported.empty()) {
+      const size_t node_index = ready_unsupported.front();
+      ready_unsupported.pop_front();
+      process(node_index);
+      continue;
+    }
+
+    std::vector<size_t>& segment = segments.emplace_back();
+    while (!ready_supported.empty()) {
+      const size_t node_index = ready_supported.front();
+      ready_supported.pop_front();
+      segment_ids[node_index] = segments.size() - 1;
+      segment.push_back(node_index);
+      process(node_index);
+    }
+  }
+
+  RETURN_IF(num_processed != num_nodes, "Unable to partition graph: the graph contains a cycle");
+
+  // A segment may contain several independent chains of nodes. Split each segment into its connected components so
+  // that every fused node computes a single connected subgraph. A connected component of a segment cannot form a
+  // cycle either: any path between two of its nodes that leaves the component also leaves the segment.
+  DisjointSets components(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    for (size_t consumer_index : consumers[i]) {
+      if (segment_ids[i] != kNoSegment && segment_ids[i] == segment_ids[consumer_index]) {
+        components.Union(i, consumer_index);
+      }
+    }
+  }
+
+  // Assign every node to a group: one group per connected component of a segment, and one group per unsupported node.
+  std::vector<size_t> group_ids(num_nodes, kNoSegment);
+  std::vector<bool> is_partition_group;
+
+  for (const std::vector<size_t>& segment : segments) {
+    std::unordered_map<size_t, size_t> group_id_by_root;
+
+    for (size_t node_index : segment) {
+      auto [iter, inserted] = group_id_by_root.emplace(components.Find(node_index), is_partition_group.size());
+      if (inserted) {
+        is_partition_group.push_back(true);
+      }
+
+      group_ids[node_index] = iter->second;
+    }
+  }
+
+  for (size_t i = 0; i < num_nodes; ++i) {
+    if (group_ids[i] == kNoSegment) {
+      group_ids[i] = is_partition_group.size();
+      is_partition_group.push_back(false);
+    }
+  }
+
+  // Greedily merge partitions that are directly connected when no other path connects them. The topological sort
+  // may place independent chains of supported nodes (e.g., one per graph input) into different segments even when a
+  // later node consumes both of them.
+  const size_t num_groups = is_partition_group.size();
+  std::vector<std::set<size_t>> successors(num_groups);
+
+  for (size_t i = 0; i < num_nodes; ++i) {
+    for (size_t consumer_index : consumers[i]) {
+      if (group_ids[i] != group_ids[consumer_index]) {
+        successors[group_ids[i]].insert(group_ids[consumer_index]);
+      }
+    }
+  }
+
+  DisjointSets merged_groups(num_groups);
+  bool merged_any = true;
+
+  while (merged_any) {
+    merged_any = false;
+
+    for (size_t source = 0; source < num_groups && !merged_any; ++source) {
+      if (!is_partition_group[source] || merged_groups.Find(source) != source) {
+        continue;
+      }
+
+      for (size_t target : successors[source]) {
+        if (!is_partition_group[target] || HasIndirectPath(successors, source, target)) {
+          continue;
+        }
+
+        // Merge `target` into `source`.
+        merged_groups.Union(target, source);
+        successors[source].erase(target);
+        successors[source].insert(successors[target].begin(), successors[target].end());
+        successors[source].erase(source);
+        successors[target].clear();
+
+        for (std::set<size_t>& group_successors : successors) {
+          if (group_successors.erase(target) != 0 && &group_successors != &successors[source]) {
+            group_successors.insert(source);
+          }
+        }
+
+        merged_any = true;
+        break;
+      }
+    }
+  }
+
+  // Collect the nodes of each partition in topological order.
+  std::vector<size_t> nodes_by_position(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    nodes_by_position[topological_positions[i]] = i;
+  }
+
+  std::unordered_map<size_t, size_t> partition_index_by_group;
+
+  for (size_t node_index : nodes_by_position) {
+    const size_t group = merged_groups.Find(group_ids[node_index]);
+    if (!is_partition_group[group]) {
+      continue;
+    }
+
+    auto [iter, inserted] = partition_index_by_group.emplace(group, partitions.size());
+    if (inserted) {
+      partitions.emplace_back();
+    }
+
+    partitions[iter->second].push_back(nodes[node_index]);
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+#define ORT_API_MANUAL_INIT
+#include "onnxruntime_cxx_api.h"
+#undef ORT_API_MANUAL_INIT
+
+/// <summary>
+/// Groups the supported nodes of a graph into partitions that can each be fused into a single node.
+///
+/// Each partition is a set of supported nodes that are connected by edges between supported nodes. No path may leave a
+/// partition and re-enter it (e.g., through an unsupported node), as that would form a cycle once the partition is
+/// fused into one node. Partitions are seeded from contiguous runs of supported nodes in a topological order of the
+/// graph and then merged with directly connected partitions while no other path connects them.
+/// </summary>
+/// <param name="graph">The graph to partition</param>
+/// <param name="supported_node_ids">The IDs of the nodes that the EP can run</param>
+/// <param name="partitions">Output parameter set to the partitions. The nodes in each partition are in topological
+/// order.</param>
+/// <returns>An OrtStatus* on error, nullptr on success</returns>
+OrtStatus* PartitionSupportedNodes(Ort::ConstGraph graph, const std::unordered_set<size_t>& supported_node_ids,
+                                   /*out*/ std::vector<std::vector<Ort::ConstNode>>& partitions);
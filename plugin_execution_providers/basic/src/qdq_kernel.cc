@@ -0,0 +1,761 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "qdq_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "blob_utils.h"
+#include "kernel_profiler.h"
+#include "plugin_ep_utils.h"
+#include "sync_stream.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Serialized kernel format (host byte order):
+//   header:  magic (QdqKernel::kBlobMagic), version
+//   params:  op, number of fused node inputs, output quantization parameters, whether the output shape is static, the
+//            output shape, then for each operand: quantization parameters, shape, whether it is a constant, input
+//            index. Then K and N.
+//   data:    the data of the constant operands, then MatMul's packed B, each starting at a kBlobDataAlignment boundary
+constexpr uint32_t kBlobVersion = 1;
+
+// Parallel tasks of Add and Mul start at multiples of this many elements, so that they do not write to the same
+// cache lines.
+constexpr size_t kElementwiseTaskAlignment = 64;
+
+bool IsDefaultDomain(Ort::ConstNode node) {
+  const std::string domain = node.GetDomain();
+  return domain.empty() || domain == "ai.onnx";
+}
+
+// Gets the element type of a tensor, or ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED if the value is not a tensor.
+ONNXTensorElementDataType GetElementType(Ort::ConstValueInfo value_info) {
+  const auto type_info = value_info.TypeInfo();
+  if (type_info.GetONNXType() != ONNX_TYPE_TENSOR) {
+    return ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+  }
+
+  return type_info.GetTensorTypeAndShapeInfo().GetElementType();
+}
+
+bool IsQuantizedType(ONNXTensorElementDataType type) {
+  return type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8 || type == ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8;
+}
+
+bool IsStaticShape(const std::optional<std::vector<int64_t>>& shape) {
+  return shape.has_value() && std::all_of(shape->begin(), shape->end(), [](int64_t dim) { return dim >= 0; });
+}
+
+// Gets the data of a constant initializer with a single element of type `type`, or null if `value_info` is not such
+// a constant. The data is valid while ORT holds the initializer.
+OrtStatus* GetConstantScalar(Ort::ConstValueInfo value_info, ONNXTensorElementDataType type,
+                             /*out*/ const void*& data) {
+  data = nullptr;
+  if (value_info == nullptr || !value_info.IsConstantInitializer()) {
+    return nullptr;
+  }
+
+  Ort::ConstValue value;
+  RETURN_IF_ERROR(value_info.GetInitializer(value));
+
+  auto type_shape = value.GetTensorTypeAndShapeInfo();
+  if (type_shape.GetElementType() == type && type_shape.GetElementCount() == 1) {
+    data = value.GetTensorRawData();
+  }
+
+  return nullptr;
+}
+
+// Gets the per-tensor quantization parameters of a DequantizeLinear or QuantizeLinear node whose quantized value has
+// type `type`. Sets `params` to std::nullopt if the scale or the zero point is not a constant scalar.
+OrtStatus* GetQuantParams(Ort::ConstNode node, ONNXTensorElementDataType type,
+                          /*out*/ std::optional<QuantParams>& params) {
+  params = std::nullopt;
+
+  std::vector<Ort::ConstValueInfo> inputs = node.GetInputs();
+  if (inputs.size() < 2 || !IsQuantizedType(type)) {
+    return nullptr;
+  }
+
+  const void* scale = nullptr;
+  RETURN_IF_ERROR(GetConstantScalar(inputs[1], ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, scale));
+  if (scale == nullptr) {
+    return nullptr;
+  }
+
+  QuantParams quant_params;
+  std::memcpy(&quant_params.scale, scale, sizeof(float));
+  quant_params.is_signed = type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8;
+  if (!std::isfinite(quant_params.scale) || quant_params.scale == 0.0f) {
+    return nullptr;
+  }
+
+  // The zero point is optional, and has the type of the quantized value.
+  if (inputs.size() > 2 && inputs[2] != nullptr) {
+    const void* zero_point = nullptr;
+    RETURN_IF_ERROR(GetConstantScalar(inputs[2], type, zero_point));
+    if (zero_point == nullptr) {
+      return nullptr;
+    }
+
+    quant_params.zero_point = quant_params.is_signed ? *static_cast<const int8_t*>(zero_point)
+                                                     : *static_cast<const uint8_t*>(zero_point);
+  }
+
+  params = quant_params;
+  return nullptr;
+}
+
+// Checks if `node` is the only node that reads `value`, which must not be a graph output either.
+bool IsOnlyConsumer(Ort::ConstValueInfo value, Ort::ConstNode node) {
+  if (value.IsGraphOutput()) {
+    return false;
+  }
+
+  std::vector<Ort::ValueInfoConsumerProducerInfo> consumers = value.GetConsumers();
+  return consumers.size() == 1 && consumers[0].node != nullptr && consumers[0].node.GetId() == node.GetId();
+}
+
+// Rounds a value to the nearest integer (ties to even), adds the zero point and saturates the result to TY. Values
+// are limited first, which does not change the saturated result, so that the rounding trick is exact and NaN maps to
+// the lowest value.
+template <typename TY>
+inline TY Requantize(float value, int32_t zero_point) {
+  constexpr float kLimit = 65536.0f;
+  constexpr float kRoundMagic = 12582912.0f;  // 1.5 * 2^23. Adding it rounds values below 2^22 to an integer.
+
+  value = value > -kLimit ? value : -kLimit;
+  value = value < kLimit ? value : kLimit;
+  const int32_t rounded = static_cast<int32_t>((value + kRoundMagic) - kRoundMagic);
+  return static_cast<TY>(std::clamp<int32_t>(rounded + zero_point, std::numeric_limits<TY>::min(),
+                                             std::numeric_limits<TY>::max()));
+}
+
+void WriteQuantParams(BlobWriter& writer, const QuantParams& params) {
+  writer.Write(params.scale);
+  writer.Write(params.zero_point);
+  writer.Write<uint8_t>(params.is_signed);
+}
+
+bool ReadQuantParams(BlobReader& reader, /*out*/ QuantParams& params) {
+  uint8_t is_signed = 0;
+  if (!reader.Read(params.scale) || !reader.Read(params.zero_point) || !reader.Read(is_signed) || is_signed > 1) {
+    return false;
+  }
+
+  params.is_signed = is_signed != 0;
+  return true;
+}
+
+}  // namespace
+
+OrtStatus* GetQdqNodeUnit(Ort::ConstNode node, /*out*/ std::optional<QdqNodeUnit>& result) {
+  result = std::nullopt;
+
+  if (!IsDefaultDomain(node)) {
+    return nullptr;
+  }
+
+  QdqNodeUnit unit;
+  const std::string op_type = node.GetOperatorType();
+  if (op_type == "Add") {
+    unit.op = QdqOp::Add;
+  } else if (op_type == "Mul") {
+    unit.op = QdqOp::Mul;
+  } else if (op_type == "MatMul") {
+    unit.op = QdqOp::MatMul;
+  } else {
+    return nullptr;
+  }
+
+  std::vector<Ort::ConstValueInfo> inputs = node.GetInputs();
+  std::vector<Ort::ConstValueInfo> outputs = node.GetOutputs();
+  if (inputs.size() != 2 || outputs.size() != 1 || inputs[0] == nullptr || inputs[1] == nullptr ||
+      outputs[0] == nullptr || GetElementType(outputs[0]) != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+    return nullptr;
+  }
+
+  // Each input must be dequantized by a DequantizeLinear node that only feeds the op.
+  std::optional<std::vector<int64_t>> input_shapes[2];
+  bool is_constant[2] = {false, false};
+
+  for (size_t i = 0; i < 2; ++i) {
+    Ort::ConstNode dq_node = inputs[i].GetProducerNode().node;
+    if (dq_node == nullptr || !IsDefaultDomain(dq_node) || dq_node.GetOperatorType() != "DequantizeLinear" ||
+        !IsOnlyConsumer(inputs[i], node)) {
+      return nullptr;
+    }
+
+    Ort::ConstValueInfo quantized = dq_node.GetInputs()[0];
+    std::optional<QuantParams> params;
+    RETURN_IF_ERROR(GetQuantParams(dq_node, GetElementType(quantized), params));
+    if (!params.has_value()) {
+      return nullptr;
+    }
+
+    unit.input_params[i] = *params;
+    input_shapes[i] = GetTensorShape(quantized);
+    is_constant[i] = quantized.IsConstantInitializer();
+    unit.nodes.push_back(dq_node);
+  }
+
+  // The output must only be quantized, by a QuantizeLinear node whose output type determines the kernel's.
+  std::vector<Ort::ValueInfoConsumerProducerInfo> output_consumers = outputs[0].GetConsumers();
+  if (outputs[0].IsGraphOutput() || output_consumers.size() != 1 || output_consumers[0].node == nullptr) {
+    return nullptr;
+  }
+
+  Ort::ConstNode q_node = output_consumers[0].node;
+  if (!IsDefaultDomain(q_node) || q_node.GetOperatorType() != "QuantizeLinear" || q_node.GetOutputs().size() != 1) {
+    return nullptr;
+  }
+
+  Ort::ConstValueInfo q_output = q_node.GetOutputs()[0];
+  std::optional<QuantParams> output_params;
+  RETURN_IF_ERROR(GetQuantParams(q_node, GetElementType(q_output), output_params));
+  if (!output_params.has_value()) {
+    return nullptr;
+  }
+
+  unit.output_params = *output_params;
+  const std::optional<std::vector<int64_t>> output_shape = GetTensorShape(q_output);
+
+  if (unit.op == QdqOp::MatMul) {
+    // B is packed when the kernel is compiled, so it must be a constant. A constant A would not be passed to the
+    // fused node.
+    if (is_constant[0] || !is_constant[1] || !IsStaticShape(input_shapes[1]) || input_shapes[1]->size() != 2 ||
+        !input_shapes[0].has_value() || input_shapes[0]->empty()) {
+      return nullptr;
+    }
+
+    const int64_t k = (*input_shapes[1])[0];
+    if (k <= 0 || static_cast<size_t>(k) > QdqKernel::kMaxK || (*input_shapes[1])[1] <= 0 ||
+        input_shapes[0]->back() != k) {
+      return nullptr;
+    }
+  } else {
+    // Each input has the output's shape or a single element.
+    if (!IsStaticShape(output_shape)) {
+      return nullptr;
+    }
+
+    for (const std::optional<std::vector<int64_t>>& shape : input_shapes) {
+      if (!IsStaticShape(shape) || (*shape != *output_shape && GetNumElements(*shape) != 1) ||
+          shape->size() > output_shape->size()) {
+        return nullptr;
+      }
+    }
+  }
+
+  unit.nodes.push_back(node);
+  unit.nodes.push_back(q_node);
+  result = std::move(unit);
+  return nullptr;
+}
+
+bool IsQdqNodeUnitOp(Ort::ConstNode node) {
+  const std::string op_type = node.GetOperatorType();
+  return IsDefaultDomain(node) &&
+         (op_type == "DequantizeLinear" || op_type == "QuantizeLinear" || op_type == "MatMul");
+}
+
+/*static*/
+OrtStatus* QdqKernel::Create(const OrtApi& ort_api, const OrtLogger& logger, Ort::ConstGraph graph,
+                             /*out*/ std::unique_ptr<QdqKernel>& kernel) {
+  std::vector<Ort::ConstNode> nodes = graph.GetNodes();
+
+  // The op is the node of the unit that is neither a DequantizeLinear nor a QuantizeLinear node.
+  auto op_iter = std::find_if(nodes.begin(), nodes.end(), [](Ort::ConstNode node) {
+    const std::string op_type = node.GetOperatorType();
+    return op_type != "DequantizeLinear" && op_type != "QuantizeLinear";
+  });
+  RETURN_IF(op_iter == nodes.end(), "Expected a QDQ node unit in the subgraph");
+
+  std::optional<QdqNodeUnit> unit;
+  RETURN_IF_ERROR(GetQdqNodeUnit(*op_iter, unit));
+  if (!unit.has_value() || unit->nodes.size() != nodes.size()) {
+    RETURN_ERROR(ORT_EP_FAIL, "QdqKernel does not support the QDQ node unit of node " << op_iter->GetName()
+                                                                                       << " with op type "
+                                                                                       << op_iter->GetOperatorType());
+  }
+
+  auto new_kernel = std::unique_ptr<QdqKernel>(new QdqKernel(ort_api));
+  new_kernel->op_ = unit->op;
+  new_kernel->output_params_ = unit->output_params;
+
+  // The fused node's inputs are the quantized inputs that are not constants.
+  std::vector<Ort::ConstValueInfo> graph_inputs = graph.GetInputs();
+  new_kernel->num_inputs_ = graph_inputs.size();
+
+  for (size_t i = 0; i < 2; ++i) {
+    Operand& operand = new_kernel->operands_[i];
+    operand.params = unit->input_params[i];
+
+    Ort::ConstValueInfo quantized = unit->nodes[i].GetInputs()[0];
+    if (!quantized.IsConstantInitializer()) {
+      const std::string name = quantized.GetName();
+      auto iter = std::find_if(graph_inputs.begin(), graph_inputs.end(),
+                               [&name](Ort::ConstValueInfo input) { return input.GetName() == name; });
+      if (iter == graph_inputs.end()) {
+        RETURN_ERROR(ORT_EP_FAIL, "Unable to find input " << name << " of the fused QDQ node unit");
+      }
+
+      operand.input_index = static_cast<size_t>(iter - graph_inputs.begin());
+      if (unit->op != QdqOp::MatMul) {
+        operand.shape = *GetTensorShape(quantized);
+      }
+
+      continue;
+    }
+
+    // Constants are copied (or packed) from ORT's initializers. The EP requested that ORT drop them (see
+    // GetCapability()).
+    Ort::ConstValue value;
+    RETURN_IF_ERROR(quantized.GetInitializer(value));
+    operand.shape = value.GetTensorTypeAndShapeInfo().GetShape();
+
+    const size_t num_elements = GetNumElements(operand.shape);
+    const auto* data = static_cast<const uint8_t*>(value.GetTensorRawData());
+
+    if (unit->op != QdqOp::MatMul) {
+      auto storage = std::make_shared<std::vector<uint8_t>>(data, data + num_elements);
+      operand.data = storage->data();
+      operand.storage = std::move(storage);
+      continue;
+    }
+
+    // B's columns become rows of K int16 values, with B's zero point subtracted.
+    const size_t k = static_cast<size_t>(operand.shape[0]);
+    const size_t n = static_cast<size_t>(operand.shape[1]);
+    auto packed_b = std::make_shared<std::vector<int16_t>>(k * n);
+
+    for (size_t row = 0; row < k; ++row) {
+      for (size_t col = 0; col < n; ++col) {
+        const int32_t b = operand.params.is_signed ? static_cast<int8_t>(data[row * n + col]) : data[row * n + col];
+        (*packed_b)[col * k + row] = static_cast<int16_t>(b - operand.params.zero_point);
+      }
+    }
+
+    new_kernel->k_ = k;
+    new_kernel->n_ = n;
+    new_kernel->packed_b_ = packed_b->data();
+    new_kernel->packed_b_storage_ = std::move(packed_b);
+  }
+
+  // A static shape of the output (for MatMul, of A) is fixed when the kernel is compiled.
+  std::optional<std::vector<int64_t>> output_shape = GetTensorShape(unit->nodes.back().GetOutputs()[0]);
+  if (IsStaticShape(output_shape)) {
+    new_kernel->has_static_output_shape_ = true;
+    new_kernel->static_output_shape_ = std::move(*output_shape);
+  }
+
+  RETURN_IF(!new_kernel->Initialize(), "Unexpected inputs of the fused QDQ node unit");
+
+  const char* op_name = unit->op == QdqOp::Add ? "Add" : unit->op == QdqOp::Mul ? "Mul" : "MatMul";
+  const char* output_type = new_kernel->output_params_.is_signed ? "int8" : "uint8";
+  LOG(ort_api, &logger, INFO, "Compiled QDQ " << op_name << " kernel with " << output_type << " output");
+
+  kernel = std::move(new_kernel);
+  return nullptr;
+}
+
+void QdqKernel::Serialize(/*out*/ std::string& blob) const {
+  BlobWriter writer(blob);
+  writer.Write(kBlobMagic);
+  writer.Write(kBlobVersion);
+
+  writer.Write(op_);
+  writer.Write<uint64_t>(num_inputs_);
+  WriteQuantParams(writer, output_params_);
+  writer.Write<uint8_t>(has_static_output_shape_);
+  writer.WriteShape(static_output_shape_);
+
+  for (const Operand& operand : operands_) {
+    WriteQuantParams(writer, operand.params);
+    writer.WriteShape(operand.shape);
+    writer.Write<uint8_t>(operand.data != nullptr);
+    writer.Write<uint64_t>(operand.input_index);
+  }
+
+  writer.Write<uint64_t>(k_);
+  writer.Write<uint64_t>(n_);
+
+  for (const Operand& operand : operands_) {
+    if (operand.data != nullptr) {
+      writer.PadTo(kBlobDataAlignment);
+      writer.WriteBytes(operand.data, GetNumElements(operand.shape));
+    }
+  }
+
+  if (op_ == QdqOp::MatMul) {
+    writer.PadTo(kBlobDataAlignment);
+    writer.WriteBytes(packed_b_, k_ * n_ * sizeof(int16_t));
+  }
+}
+
+OrtStatus* QdqKernel::CheckGraphIO(Ort::ConstGraph graph) const {
+  RETURN_IF_ERROR(CheckGraphIOCounts(graph, num_inputs_, 1));
+
+  auto quantized_type = [](const QuantParams& params) {
+    return params.is_signed ? ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8 : ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8;
+  };
+
+  // MatMul's A has the output's shape with the last dimension replaced by K. A dynamic A is checked by Compute().
+  std::vector<int64_t> matmul_a_shape = static_output_shape_;
+  if (op_ == QdqOp::MatMul && has_static_output_shape_) {
+    matmul_a_shape.back() = static_cast<int64_t>(k_);
+  }
+
+  const std::vector<Ort::ConstValueInfo> inputs = graph.GetInputs();
+  for (size_t i = 0; i < 2; ++i) {
+    const Operand& operand = operands_[i];
+    if (operand.data != nullptr || (op_ == QdqOp::MatMul && i == 1)) {
+      continue;
+    }
+
+    const std::vector<int64_t>* shape = &operand.shape;
+    if (op_ == QdqOp::MatMul) {
+      shape = has_static_output_shape_ ? &matmul_a_shape : nullptr;
+    }
+
+    RETURN_IF_ERROR(CheckGraphValue(inputs[operand.input_index], quantized_type(operand.params), shape));
+  }
+
+  return CheckGraphValue(graph.GetOutputs()[0], quantized_type(output_params_),
+                         has_static_output_shape_ ? &static_output_shape_ : nullptr);
+}
+
+/*static*/
+OrtStatus* QdqKernel::Deserialize(const OrtApi& ort_api, std::span<const uint8_t> blob,
+                                  std::shared_ptr<const void> blob_storage,
+                                  /*out*/ std::unique_ptr<QdqKernel>& kernel) {
+  auto new_kernel = std::unique_ptr<QdqKernel>(new QdqKernel(ort_api));
+  BlobReader reader(blob);
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  RETURN_IF(!reader.Read(magic) || magic != kBlobMagic, "EPContext node does not contain a basic plugin EP kernel");
+  RETURN_IF(!reader.Read(version) || version != kBlobVersion,
+            "EPContext node was created by an incompatible version of the basic plugin EP");
+
+  // Upper bound for sizes and indices, so that a corrupt blob cannot request huge allocations.
+  const uint64_t max_count = blob.size();
+
+  // Reads the blob and checks the sizes and indices. Returns false if the blob is corrupt.
+  auto read_kernel = [&](QdqKernel& k) -> bool {
+    uint8_t op = 0;
+    uint8_t has_static_output_shape = 0;
+    if (!reader.Read(op) || op > static_cast<uint8_t>(QdqOp::MatMul) || !reader.ReadSize(k.num_inputs_, max_count) ||
+        !ReadQuantParams(reader, k.output_params_) || !reader.Read(has_static_output_shape) ||
+        !reader.ReadShape(k.static_output_shape_)) {
+      return false;
+    }
+
+    k.op_ = static_cast<QdqOp>(op);
+    k.has_static_output_shape_ = has_static_output_shape != 0;
+
+    bool is_constant[2] = {false, false};
+    for (size_t i = 0; i < 2; ++i) {
+      uint8_t is_constant_operand = 0;
+      if (!ReadQuantParams(reader, k.operands_[i].params) || !reader.ReadShape(k.operands_[i].shape) ||
+          !reader.Read(is_constant_operand) || !reader.ReadSize(k.operands_[i].input_index, max_count)) {
+        return false;
+      }
+
+      is_constant[i] = is_constant_operand != 0;
+    }
+
+    if (!reader.ReadSize(k.k_, kMaxK) || !reader.ReadSize(k.n_, max_count)) {
+      return false;
+    }
+
+    // The constant data shares ownership of the blob's memory and is read in place.
+    const size_t data_start = AlignUp(reader.GetPosition(), kBlobDataAlignment);
+    size_t offset = 0;
+
+    for (size_t i = 0; i < 2; ++i) {
+      if (!is_constant[i]) {
+        continue;
+      }
+
+      Operand& operand = k.operands_[i];
+      operand.data = GetBlobTensorBytes(blob, data_start, offset, operand.shape, 1);
+      if (operand.data == nullptr) {
+        return false;
+      }
+
+      operand.storage = blob_storage;
+      offset = AlignUp(offset + GetNumElements(operand.shape), kBlobDataAlignment);
+    }
+
+    if (k.op_ == QdqOp::MatMul) {
+      const std::vector<int64_t> packed_b_shape = {static_cast<int64_t>(k.n_), static_cast<int64_t>(k.k_)};
+      k.packed_b_ = static_cast<const int16_t*>(
+          GetBlobTensorBytes(blob, data_start, offset, packed_b_shape, sizeof(int16_t)));
+      if (k.packed_b_ == nullptr) {
+        return false;
+      }
+
+      k.packed_b_storage_ = blob_storage;
+    }
+
+    return k.Initialize();
+  };
+
+  RETURN_IF(!read_kernel(*new_kernel), "EPContext node contains a corrupt basic plugin EP kernel");
+
+  kernel = std::move(new_kernel);
+  return nullptr;
+}
+
+bool QdqKernel::Initialize() {
+  // The fused node's inputs are the operands that are not constants.
+  if (num_inputs_ > 2) {
+    return false;
+  }
+
+  for (size_t i = 0; i < 2; ++i) {
+    const bool is_packed = op_ == QdqOp::MatMul && i == 1;
+    if (operands_[i].data == nullptr && !is_packed && operands_[i].input_index >= num_inputs_) {
+      return false;
+    }
+  }
+
+  const float output_scale = output_params_.scale;
+  const float a_scale = operands_[0].params.scale;
+  const float b_scale = operands_[1].params.scale;
+
+  if (op_ == QdqOp::Add) {
+    multipliers_[0] = a_scale / output_scale;
+    multipliers_[1] = b_scale / output_scale;
+  } else {
+    multipliers_[0] = a_scale * b_scale / output_scale;
+  }
+
+  if (!std::isfinite(multipliers_[0]) || !std::isfinite(multipliers_[1])) {
+    return false;
+  }
+
+  num_elements_ = has_static_output_shape_ ? GetNumElements(static_output_shape_) : 0;
+
+  const bool is_signed[3] = {operands_[0].params.is_signed, operands_[1].params.is_signed, output_params_.is_signed};
+
+  if (op_ == QdqOp::MatMul) {
+    // A static output shape is A's shape with K replaced by N.
+    if (k_ == 0 || k_ > kMaxK || n_ == 0 || packed_b_ == nullptr || operands_[0].data != nullptr ||
+        (has_static_output_shape_ &&
+         (static_output_shape_.empty() || static_output_shape_.back() != static_cast<int64_t>(n_)))) {
+      return false;
+    }
+
+    const bool matmul_is_signed[2] = {is_signed[0], is_signed[2]};
+    run_matmul_ = GetMatMulFn(matmul_is_signed);
+    return true;
+  }
+
+  // Each input has the output's shape or a single element.
+  if (!has_static_output_shape_) {
+    return false;
+  }
+
+  for (const Operand& operand : operands_) {
+    const size_t num_elements = GetNumElements(operand.shape);
+    if (num_elements != 1 && num_elements != num_elements_) {
+      return false;
+    }
+  }
+
+  run_elementwise_ = op_ == QdqOp::Add ? GetElementwiseFn<QdqOp::Add>(is_signed)
+                                       : GetElementwiseFn<QdqOp::Mul>(is_signed);
+  return true;
+}
+
+template <QdqOp kOp, typename... Types>
+/*static*/ QdqKernel::ElementwiseFn QdqKernel::GetElementwiseFn(const bool* is_signed) {
+  if constexpr (sizeof...(Types) == 3) {
+    return &RunElementwise<kOp, Types...>;
+  } else {
+    return *is_signed ? GetElementwiseFn<kOp, Types..., int8_t>(is_signed + 1)
+                      : GetElementwiseFn<kOp, Types..., uint8_t>(is_signed + 1);
+  }
+}
+
+template <typename... Types>
+/*static*/ QdqKernel::MatMulFn QdqKernel::GetMatMulFn(const bool* is_signed) {
+  if constexpr (sizeof...(Types) == 2) {
+    return &RunMatMul<Types...>;
+  } else {
+    return *is_signed ? GetMatMulFn<Types..., int8_t>(is_signed + 1) : GetMatMulFn<Types..., uint8_t>(is_signed + 1);
+  }
+}
+
+OrtStatus* QdqKernel::Compute(OrtKernelContext* kernel_ctx, const KernelResources& resources,
+                              SyncStream* stream) const {
+  Ort::KernelContext kernel_context(kernel_ctx);
+  RETURN_IF(kernel_context.GetInputCount() != num_inputs_, "Unexpected number of inputs for fused node");
+  RETURN_IF(kernel_context.GetOutputCount() != 1, "Unexpected number of outputs for fused node");
+
+  const void* input_data[2] = {operands_[0].data, operands_[1].data};
+  for (size_t i = 0; i < 2; ++i) {
+    if (input_data[i] == nullptr && !(op_ == QdqOp::MatMul && i == 1)) {
+      input_data[i] = kernel_context.GetInput(operands_[i].input_index).GetTensorRawData();
+    }
+  }
+
+  void* output_data = nullptr;
+  size_t rows = 0;
+
+  if (has_static_output_shape_) {
+    // The shapes were checked when the kernel was compiled or loaded from an EPContext node, and ORT checks the
+    // model's inputs against them.
+    output_data = kernel_context.GetOutput(0, static_output_shape_).GetTensorMutableRawData();
+    rows = op_ == QdqOp::MatMul ? num_elements_ / n_ : 0;
+  } else {
+    // The output has A's shape with the last dimension (K) replaced by N. The other dimensions are the rows.
+    std::vector<int64_t> output_shape =
+        kernel_context.GetInput(operands_[0].input_index).GetTensorTypeAndShapeInfo().GetShape();
+    RETURN_IF(output_shape.empty() || output_shape.back() != static_cast<int64_t>(k_),
+              "Unexpected shape for input A of the fused QDQ MatMul node unit");
+
+    output_shape.back() = static_cast<int64_t>(n_);
+    rows = 1;
+    for (size_t i = 0; i + 1 < output_shape.size(); ++i) {
+      rows *= static_cast<size_t>(output_shape[i]);
+    }
+
+    output_data = kernel_context.GetOutput(0, output_shape).GetTensorMutableRawData();
+  }
+
+  if (stream != nullptr && SyncStream::CanReadInputsLater(kernel_context)) {
+    stream->Enqueue([this, resources, a = input_data[0], b = input_data[1], output_data, rows]() {
+      Run(resources, a, b, output_data, rows);
+    });
+    return nullptr;
+  }
+
+  if (stream != nullptr) {
+    stream->WaitForAll();  // Earlier tasks may write the inputs.
+  }
+
+  Run(resources, input_data[0], input_data[1], output_data, rows);
+  return nullptr;
+}
+
+void QdqKernel::Run(const KernelResources& resources, const void* a, const void* b, void* output,
+                    size_t rows) const {
+  if (op_ == QdqOp::MatMul) {
+    KernelProfiler::Scope profiler_scope(resources.profiler, resources.profiler_node,
+                                         rows * k_ + n_ * k_ * sizeof(int16_t), rows * n_);
+
+    // The work is measured in multiply-adds.
+    const size_t num_blocks = (rows + kBlockRows - 1) / kBlockRows;
+    if (resources.thread_pool == nullptr || rows * n_ * k_ < resources.parallel_min_elements || num_blocks <= 1) {
+      run_matmul_(*this, a, output, 0, rows);
+      return;
+    }
+
+    const size_t num_tasks = std::min(resources.thread_pool->GetNumThreads(), num_blocks);
+    resources.thread_pool->ParallelFor(num_tasks, [&](size_t task) {
+      const size_t row_begin = num_blocks * task / num_tasks * kBlockRows;
+      const size_t row_end = std::min(num_blocks * (task + 1) / num_tasks * kBlockRows, rows);
+      run_matmul_(*this, a, output, row_begin, row_end);
+    });
+    return;
+  }
+
+  const size_t a_size = GetNumElements(operands_[0].shape);
+  const size_t b_size = GetNumElements(operands_[1].shape);
+  KernelProfiler::Scope profiler_scope(resources.profiler, resources.profiler_node, a_size + b_size, num_elements_);
+
+  const size_t a_stride = a_size == 1 ? 0 : 1;
+  const size_t b_stride = b_size == 1 ? 0 : 1;
+  const size_t num_chunks = (num_elements_ + kElementwiseTaskAlignment - 1) / kElementwiseTaskAlignment;
+
+  if (resources.thread_pool == nullptr || num_elements_ < resources.parallel_min_elements || num_chunks <= 1) {
+    run_elementwise_(*this, a, a_stride, b, b_stride, output, 0, num_elements_);
+    return;
+  }
+
+  const size_t num_tasks = std::min(resources.thread_pool->GetNumThreads(), num_chunks);
+  resources.thread_pool->ParallelFor(num_tasks, [&](size_t task) {
+    const size_t begin = num_chunks * task / num_tasks * kElementwiseTaskAlignment;
+    const size_t end = std::min(num_chunks * (task + 1) / num_tasks * kElementwiseTaskAlignment, num_elements_);
+    run_elementwise_(*this, a, a_stride, b, b_stride, output, begin, end);
+  });
+}
+
+template <QdqOp kOp, typename TA, typename TB, typename TY>
+/*static*/ void QdqKernel::RunElementwise(const QdqKernel& kernel, const void* a, size_t a_stride, const void* b,
+                                          size_t b_stride, void* output, size_t begin, size_t end) {
+  const auto* a_data = static_cast<const TA*>(a);
+  const auto* b_data = static_cast<const TB*>(b);
+  auto* output_data = static_cast<TY*>(output);
+
+  const float a_zero_point = static_cast<float>(kernel.operands_[0].params.zero_point);
+  const float b_zero_point = static_cast<float>(kernel.operands_[1].params.zero_point);
+  const int32_t output_zero_point = kernel.output_params_.zero_point;
+  const float multiplier0 = kernel.multipliers_[0];
+  const float multiplier1 = kernel.multipliers_[1];
+
+  for (size_t i = begin; i < end; ++i) {
+    const float a_value = static_cast<float>(a_data[i * a_stride]) - a_zero_point;
+    const float b_value = static_cast<float>(b_data[i * b_stride]) - b_zero_point;
+
+    float value = 0.0f;
+    if constexpr (kOp == QdqOp::Add) {
+      value = multiplier0 * a_value + multiplier1 * b_value;
+    } else {
+      value = multiplier0 * a_value * b_value;
+    }
+
+    output_data[i] = Requantize<TY>(value, output_zero_point);
+  }
+}
+
+template <typename TA, typename TY>
+/*static*/ void QdqKernel::RunMatMul(const QdqKernel& kernel, const void* a, void* output, size_t row_begin,
+                                     size_t row_end) {
+  const auto* a_data = static_cast<const TA*>(a);
+  auto* output_data = static_cast<TY*>(output);
+
+  const size_t k = kernel.k_;
+  const size_t n = kernel.n_;
+  const int32_t a_zero_point = kernel.operands_[0].params.zero_point;
+  const int32_t output_zero_point = kernel.output_params_.zero_point;
+  const float multiplier = kernel.multipliers_[0];
+
+  // A block of rows of A with A's zero point subtracted, which is reused for every packed column. The buffer is
+  // reused across runs, so that a run does not allocate.
+  thread_local std::vector<int16_t> a_block;
+  a_block.resize(kBlockRows * k);
+
+  for (size_t block_begin = row_begin; block_begin < row_end; block_begin += kBlockRows) {
+    const size_t block_rows = std::min(kBlockRows, row_end - block_begin);
+    for (size_t i = 0; i < block_rows * k; ++i) {
+      a_block[i] = static_cast<int16_t>(static_cast<int32_t>(a_data[block_begin * k + i]) - a_zero_point);
+    }
+
+    for (size_t col = 0; col < n; ++col) {
+      const int16_t* b_col = kernel.packed_b_ + col * k;
+
+      for (size_t row = 0; row < block_rows; ++row) {
+        const int16_t* a_row = a_block.data() + row * k;
+
+        // |a - a_zero_point| and |b - b_zero_point| are at most 255, so K <= kMaxK products fit in int32.
+        int32_t sum = 0;
+        for (size_t i = 0; i < k; ++i) {
+          sum += static_cast<int32_t>(a_row[i]) * static_cast<int32_t>(b_col[i]);
+        }
+
+        output_data[(block_begin + row) * n + col] =
+            Requantize<TY>(static_cast<float>(sum) * multiplier, output_zero_point);
+      }
+    }
+  }
+}
@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ep_kernel.h"
+
+/// <summary>
+/// Ops of the QDQ node units that QdqKernel computes.
+/// </summary>
+enum class QdqOp : uint8_t {
+  Add,
+  Mul,
+  MatMul,
+};
+
+/// <summary>
+/// Per-tensor quantization parameters of a DequantizeLinear input or a QuantizeLinear output.
+/// </summary>
+struct QuantParams {
+  float scale = 1.0f;
+  int32_t zero_point = 0;
+  bool is_signed = false;  // int8 instead of uint8.
+};
+
+/// <summary>
+/// A QDQ node unit: a DequantizeLinear node for each input of an Add, Mul or MatMul node, and a QuantizeLinear node
+/// for its output.
+/// </summary>
+struct QdqNodeUnit {
+  QdqOp op = QdqOp::Add;
+  std::vector<Ort::ConstNode> nodes;  // The DequantizeLinear nodes, the op node and the QuantizeLinear node.
+  QuantParams input_params[2];
+  QuantParams output_params;
+};
+
+/// <summary>
+/// Checks if a node is the op of a QDQ node unit that QdqKernel can compute:
+/// - The DequantizeLinear and QuantizeLinear nodes have int8 or uint8 data and constant per-tensor scales and zero
+///   points. The op's inputs and output are consumed only by the unit's nodes.
+/// - Add and Mul have inputs with the same static shape, or one input with a single element.
+/// - MatMul has a 2D constant B with K <= QdqKernel::kMaxK. A may have a dynamic shape, except for its last
+///   dimension.
+/// </summary>
+/// <param name="node">The node to check</param>
+/// <param name="result">Output parameter set to the node unit, or std::nullopt if the node is not supported</param>
+/// <returns>An OrtStatus* on error, nullptr on success</returns>
+OrtStatus* GetQdqNodeUnit(Ort::ConstNode node, /*out*/ std::optional<QdqNodeUnit>& result);
+
+/// <summary>
+/// Checks if a node has the op type of a QDQ node unit's node that has no parameters besides its inputs
+/// (DequantizeLinear, QuantizeLinear or MatMul).
+/// </summary>
+bool IsQdqNodeUnitOp(Ort::ConstNode node);
+
+/// <summary>
+/// Kernel for a fused node with a QDQ node unit (see GetQdqNodeUnit()), which computes the op on the quantized data.
+///
+/// Only the int8/uint8 tensors move through memory. Add and Mul dequantize, compute and requantize each element in
+/// registers, with the scales folded into one or two multipliers. MatMul accumulates the products of the zero-point
+/// adjusted values in int32, and requantizes each output with a single multiplier. Its B is packed once, when the
+/// kernel is created, into int16 rows of B's columns with B's zero point subtracted, and ORT drops its copy of B.
+/// Blocks of rows of A reuse each packed column from the cache. The inner loops are plain integer loops that the
+/// compiler vectorizes for the build's instruction set.
+///
+/// Results are rounded half to even, as QuantizeLinear specifies, but may differ by one from an implementation that
+/// dequantizes to float32 tensors, because the scales are folded.
+/// </summary>
+class QdqKernel : public EpKernel {
+ public:
+  static constexpr uint32_t kBlobMagic = 0x51504542;  // "BEPQ", the start of a serialized QdqKernel.
+  static constexpr size_t kMaxK = 32768;              // Largest K for which a MatMul's int32 sums cannot overflow.
+  static constexpr size_t kBlockRows = 4;             // Rows of A that MatMul computes for each packed column.
+
+  /// <summary>
+  /// Creates a kernel for a subgraph with a single QDQ node unit that GetQdqNodeUnit() supports.
+  /// </summary>
+  /// <param name="ort_api">The ORT API</param>
+  /// <param name="logger">The EP's logger</param>
+  /// <param name="graph">The subgraph to compile. Its initializers are only read by this call.</param>
+  /// <param name="kernel">Output parameter set to the new kernel</param>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  static OrtStatus* Create(const OrtApi& ort_api, const OrtLogger& logger, Ort::ConstGraph graph,
+                           /*out*/ std::unique_ptr<QdqKernel>& kernel);
+
+  /// <summary>
+  /// Creates a kernel from a blob that Serialize() wrote. Constant data is read in place.
+  /// </summary>
+  /// <param name="ort_api">The ORT API</param>
+  /// <param name="blob">The serialized kernel</param>
+  /// <param name="blob_storage">Keeps the memory of `blob` alive. The kernel shares ownership of it.</param>
+  /// <param name="kernel">Output parameter set to the new kernel</param>
+  /// <returns>An OrtStatus* on error, nullptr on success</returns>
+  static OrtStatus* Deserialize(const OrtApi& ort_api, std::span<const uint8_t> blob,
+                                std::shared_ptr<const void> blob_storage, /*out*/ std::unique_ptr<QdqKernel>& kernel);
+
+  /// <summary>
+  /// Serializes the op, the quantization parameters, the shapes, and the constant data.
+  /// </summary>
+  void Serialize(/*out*/ std::string& blob) const override;
+
+  /// <summary>
+  /// Checks the quantized types of the non-constant operands and Y, and the shapes the kernel relies on.
+  /// </summary>
+  OrtStatus* CheckGraphIO(Ort::ConstGraph graph) const override;
+
+  /// <summary>
+  /// Computes the quantized output, or enqueues it on `stream`.
+  /// </summary>
+  OrtStatus* Compute(OrtKernelContext* kernel_ctx, const KernelResources& resources,
+                     SyncStream* stream) const override;
+
+ private:
+  // Computes outputs [begin, end) of Add or Mul. A stride is 0 for an input with a single element, and 1 otherwise.
+  using ElementwiseFn = void (*)(const QdqKernel& kernel, const void* a, size_t a_stride, const void* b,
+                                 size_t b_stride, void* output, size_t begin, size_t end);
+
+  // Computes rows [row_begin, row_end) of MatMul.
+  using MatMulFn = void (*)(const QdqKernel& kernel, const void* a, void* output, size_t row_begin, size_t row_end);
+
+  // An input of the op: the data of a DequantizeLinear node, either a fused node input or a constant.
+  struct Operand {
+    QuantParams params;
+    std::vector<int64_t> shape;  // Empty for MatMul's A, which may have a dynamic shape.
+    size_t input_index = 0;      // Fused node input index. Used if `data` is null.
+    const void* data = nullptr;  // Constant int8 or uint8 data. Not set for MatMul's B, which is packed.
+    std::shared_ptr<const void> storage;
+  };
+
+  explicit QdqKernel(const OrtApi& ort_api) : ort_api_(ort_api) {}
+
+  // Checks the shapes after the kernel was created or deserialized, and computes the multipliers and selects the
+  // functions for the data types.
+  bool Initialize();
+
+  // Computes the `rows` x N output of MatMul, or the output of Add or Mul.
+  void Run(const KernelResources& resources, const void* a, const void* b, void* output, size_t rows) const;
+
+  template <QdqOp kOp, typename TA, typename TB, typename TY>
+  static void RunElementwise(const QdqKernel& kernel, const void* a, size_t a_stride, const void* b, size_t b_stride,
+                             void* output, size_t begin, size_t end);
+
+  template <typename TA, typename TY>
+  static void RunMatMul(const QdqKernel& kernel, const void* a, void* output, size_t row_begin, size_t row_end);
+
+  // Select the instantiation for the signedness of the remaining types, one type per call.
+  template <QdqOp kOp, typename... Types>
+  static ElementwiseFn GetElementwiseFn(const bool* is_signed);
+  template <typename... Types>
+  static MatMulFn GetMatMulFn(const bool* is_signed);
+
+  const OrtApi& ort_api_;
+  QdqOp op_ = QdqOp::Add;
+  size_t num_inputs_ = 0;
+  Operand operands_[2];
+  QuantParams output_params_;
+  bool has_static_output_shape_ = false;  // False if MatMul's A has a dynamic shape.
+  std::vector<int64_t> static_output_shape_;
+
+  // MatMul's dimensions and packed B, with shape [N, K].
+  size_t k_ = 0;
+  size_t n_ = 0;
+  const int16_t* packed_b_ = nullptr;
+  std::shared_ptr<const void> packed_b_storage_;
+
+  // Set by Initialize().
+  float multipliers_[2] = {1.0f, 1.0f};  // Add: input scales / output scale. Mul and MatMul: product / output scale.
+  size_t num_elements_ = 0;              // Output elements of Add and Mul, or of a MatMul with a static shape.
+  ElementwiseFn run_elementwise_ = nullptr;
+  MatMulFn run_matmul_ = nullptr;
+};
@@ -0,0 +1,216 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "sync_stream.h"
+
+#include <memory>
+#include <utility>
+
+#include "arena_allocator.h"
+#include "plugin_ep_utils.h"
+
+//
+// SyncStream
+//
+
+SyncStream::SyncStream(const OrtApi& ort_api) : OrtSyncStreamImpl{}, ort_api_(ort_api) {
+  ort_version_supported = ORT_API_VERSION;
+  CreateNotification = CreateNotificationImpl;
+  GetHandle = GetHandleImpl;
+  Flush = FlushImpl;
+  OnSessionRunEnd = OnSessionRunEndImpl;
+  Release = ReleaseImpl;
+
+  worker_ = std::thread([this]() { WorkerLoop(); });
+}
+
+SyncStream::~SyncStream() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+  }
+
+  // The worker finishes the pending tasks before it exits.
+  task_available_.notify_one();
+  worker_.join();
+}
+
+/*static*/
+bool SyncStream::CanReadInputsLater(const Ort::KernelContext& kernel_context) {
+  for (size_t i = 0; i < kernel_context.GetInputCount(); ++i) {
+    Ort::ConstValue input = kernel_context.GetInput(i);
+    if (input != nullptr && !ArenaAllocator::IsArenaMemory(input.GetTensorMemoryInfo())) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+uint64_t SyncStream::Enqueue(std::function<void()> task) {
+  uint64_t sequence = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t ticket = 0;
+    {
+      std::lock_guard<std::mutex> tickets_lock(tickets_mutex_);
+      ticket = ++last_ticket_;
+      pending_tickets_.insert(ticket);
+    }
+
+    tasks_.push_back({ticket, std::move(task)});
+    sequence = ++last_sequence_;
+    num_pending_tasks_.fetch_add(1, std::memory_order_acq_rel);
+  }
+
+  task_available_.notify_one();
+  return sequence;
+}
+
+/*static*/
+uint64_t SyncStream::GetLastTicket() {
+  std::lock_guard<std::mutex> lock(tickets_mutex_);
+  return last_ticket_;
+}
+
+/*static*/
+uint64_t SyncStream::GetCompletedTicket() {
+  std::lock_guard<std::mutex> lock(tickets_mutex_);
+  return pending_tickets_.empty() ? last_ticket_ : *pending_tickets_.begin() - 1;
+}
+
+uint64_t SyncStream::GetLastSequence() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return last_sequence_;
+}
+
+void SyncStream::WaitFor(uint64_t sequence) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_done_.wait(lock, [&]() { return completed_sequence_ >= sequence; });
+}
+
+void SyncStream::WorkerLoop() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_available_.wait(lock, [this]() { return shutting_down_ || !tasks_.empty(); });
+
+      if (tasks_.empty()) {
+        return;  // Shutting down.
+      }
+
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+
+    task.fn();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++completed_sequence_;
+      num_pending_tasks_.fetch_sub(1, std::memory_order_acq_rel);
+
+      std::lock_guard<std::mutex> tickets_lock(tickets_mutex_);
+      pending_tickets_.erase(task.ticket);
+    }
+
+    task_done_.notify_all();
+  }
+}
+
+/*static*/
+OrtStatus* ORT_API_CALL SyncStream::CreateNotificationImpl(OrtSyncStreamImpl* this_ptr,
+                                                           OrtSyncNotificationImpl** notification) noexcept {
+  EP_API_IMPL_BEGIN
+
+  auto* stream = static_cast<SyncStream*>(this_ptr);
+  *notification = std::make_unique<SyncNotification>(stream->ort_api_, *stream).release();
+  return nullptr;
+
+  EP_API_IMPL_END
+}
+
+/*static*/
+void* ORT_API_CALL SyncStream::GetHandleImpl(OrtSyncStreamImpl* this_ptr) noexcept {
+  return static_cast<SyncStream*>(this_ptr);
+}
+
+/*static*/
+OrtStatus* ORT_API_CALL SyncStream::FlushImpl(OrtSyncStreamImpl* this_ptr) noexcept {
+  static_cast<SyncStream*>(this_ptr)->WaitForAll();
+  return nullptr;
+}
+
+/*static*/
+OrtStatus* ORT_API_CALL SyncStream::OnSessionRunEndImpl(OrtSyncStreamImpl* this_ptr) noexcept {
+  // The outputs of the run must be complete before ORT returns them.
+  return FlushImpl(this_ptr);
+}
+
+/*static*/
+void ORT_API_CALL SyncStream::ReleaseImpl(OrtSyncStreamImpl* this_ptr) noexcept {
+  delete static_cast<SyncStream*>(this_ptr);
+}
+
+//
+// SyncNotification
+//
+
+SyncNotification::SyncNotification(const OrtApi& ort_api, SyncStream& stream)
+    : OrtSyncNotificationImpl{}, ort_api_(ort_api), stream_(stream) {
+  ort_version_supported = ORT_API_VERSION;
+  Activate = ActivateImpl;
+  WaitOnDevice = WaitOnDeviceImpl;
+  WaitOnHost = WaitOnHostImpl;
+  Release = ReleaseImpl;
+}
+
+/*static*/
+OrtStatus* ORT_API_CALL SyncNotification::ActivateImpl(OrtSyncNotificationImpl* this_ptr) noexcept {
+  auto* notification = static_cast<SyncNotification*>(this_ptr);
+  notification->sequence_ = notification->stream_.GetLastSequence();
+  return nullptr;
+}
+
+/*static*/
+OrtStatus* ORT_API_CALL SyncNotification::WaitOnDeviceImpl(OrtSyncNotificationImpl* this_ptr,
+                                                           OrtSyncStream* consumer_stream) noexcept {
+  EP_API_IMPL_BEGIN
+
+  auto* notification = static_cast<SyncNotification*>(this_ptr);
+  SyncStream* consumer = SyncStream::FromHandle(notification->ort_api_.SyncStream_GetHandle(consumer_stream));
+
+  // Tasks of the same stream already run in order.
+  if (consumer == &notification->stream_) {
+    return nullptr;
+  }
+
+  if (consumer == nullptr) {
+    notification->stream_.WaitFor(notification->sequence_);
+    return nullptr;
+  }
+
+  // The consumer's worker waits for the producer's task before it runs the consumer's later tasks. The notification
+  // may be released before then, so the task copies what it needs. ORT releases streams only after their work has
+  // finished.
+  consumer->Enqueue([producer = &notification->stream_, sequence = notification->sequence_]() {
+    producer->WaitFor(sequence);
+  });
+
+  return nullptr;
+
+  EP_API_IMPL_END
+}
+
+/*static*/
+OrtStatus* ORT_API_CALL SyncNotification::WaitOnHostImpl(OrtSyncNotificationImpl* this_ptr) noexcept {
+  auto* notification = static_cast<SyncNotification*>(this_ptr);
+  notification->stream_.WaitFor(notification->sequence_);
+  return nullptr;
+}
+
+/*static*/
+void ORT_API_CALL SyncNotification::ReleaseImpl(OrtSyncNotificationImpl* this_ptr) noexcept {
+  delete static_cast<SyncNotification*>(this_ptr);
+}
@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#define ORT_API_MANUAL_INIT
+#include "onnxruntime_cxx_api.h"
+#undef ORT_API_MANUAL_INIT
+
+/// <summary>
+/// OrtSyncStreamImpl backed by a worker thread that runs the stream's tasks in FIFO order.
+///
+/// A kernel that runs on a stream reads its inputs' data pointers and allocates its outputs on ORT's thread, then
+/// enqueues the computation and returns. ORT's thread can then run nodes of other EPs (e.g., on a parallel branch of
+/// the graph) while the worker computes. ORT orders work across streams with SyncNotification: a consumer waits for the
+/// tasks that the producer's stream had enqueued when the notification was activated.
+///
+/// ORT frees a kernel's inputs when the kernel returns, while an enqueued task may still read them. Only ArenaAllocator
+/// holds freed blocks back until the tasks that were enqueued before have finished (see GetLastTicket() and
+/// GetCompletedTicket()), so a kernel only enqueues its computation if all of its inputs are in the EP's arena memory
+/// (see CanReadInputsLater()). Otherwise, it flushes the stream and computes on ORT's thread.
+/// </summary>
+class SyncStream : public OrtSyncStreamImpl {
+ public:
+  explicit SyncStream(const OrtApi& ort_api);
+  ~SyncStream();
+
+  SyncStream(const SyncStream&) = delete;
+  SyncStream& operator=(const SyncStream&) = delete;
+
+  /// <summary>
+  /// Gets the stream of a kernel from the handle that ORT returns for the kernel's OrtKernelContext.
+  /// </summary>
+  static SyncStream* FromHandle(void* handle) { return static_cast<SyncStream*>(handle); }
+
+  /// <summary>
+  /// Checks if any stream has tasks that have not finished.
+  /// </summary>
+  static bool HasPendingTasks() { return num_pending_tasks_.load(std::memory_order_acquire) != 0; }
+
+  /// <summary>
+  /// Gets the ticket of the last task that any stream enqueued, or 0 if no task was enqueued. Tickets are numbered
+  /// across all streams in the order that the tasks were enqueued.
+  /// </summary>
+  static uint64_t GetLastTicket();
+
+  /// <summary>
+  /// Gets the highest ticket such that the tasks with that ticket and all lower tickets have finished.
+  /// </summary>
+  static uint64_t GetCompletedTicket();
+
+  /// <summary>
+  /// Checks if a task may read a kernel's inputs after the kernel returns: every input must have been allocated by an
+  /// ArenaAllocator. Inputs from other allocators (e.g., ORT's CPU allocator, which allocates the outputs of the CPU
+  /// EP's nodes) may be reused as soon as ORT frees them.
+  /// </summary>
+  static bool CanReadInputsLater(const Ort::KernelContext& kernel_context);
+
+  /// <summary>
+  /// Enqueues a task, which must not throw.
+  /// </summary>
+  /// <returns>The task's sequence number. Sequence numbers of a stream start at 1 and increase by 1.</returns>
+  uint64_t Enqueue(std::function<void()> task);
+
+  /// <summary>
+  /// Gets the sequence number of the last enqueued task, or 0 if no task was enqueued.
+  /// </summary>
+  uint64_t GetLastSequence() const;
+
+  /// <summary>
+  /// Blocks until the tasks up to sequence number `sequence` have finished.
+  /// </summary>
+  void WaitFor(uint64_t sequence);
+
+  /// <summary>
+  /// Blocks until all enqueued tasks have finished.
+  /// </summary>
+  void WaitForAll() { WaitFor(GetLastSequence()); }
+
+ private:
+  static OrtStatus* ORT_API_CALL CreateNotificationImpl(OrtSyncStreamImpl* this_ptr,
+                                                        OrtSyncNotificationImpl** notification) noexcept;
+  static void* ORT_API_CALL GetHandleImpl(OrtSyncStreamImpl* this_ptr) noexcept;
+  static OrtStatus* ORT_API_CALL FlushImpl(OrtSyncStreamImpl* this_ptr) noexcept;
+  static OrtStatus* ORT_API_CALL OnSessionRunEndImpl(OrtSyncStreamImpl* this_ptr) noexcept;
+  static void ORT_API_CALL ReleaseImpl(OrtSyncStreamImpl* this_ptr) noexcept;
+
+  void WorkerLoop();
+
+  struct Task {
+    uint64_t ticket;
+    std::function<void()> fn;
+  };
+
+  // Tasks of all streams that were enqueued and have not finished.
+  static inline std::atomic<size_t> num_pending_tasks_{0};
+
+  static inline std::mutex tickets_mutex_;  // Protects the tickets below. Taken after a stream's `mutex_`.
+  static inline uint64_t last_ticket_ = 0;
+  static inline std::set<uint64_t> pending_tickets_;  // Tickets of the tasks that have not finished.
+
+  const OrtApi& ort_api_;
+
+  mutable std::mutex mutex_;  // Protects the members below.
+  std::condition_variable task_available_;
+  std::condition_variable task_done_;
+  std::deque<Task> tasks_;
+  uint64_t last_sequence_ = 0;       // Sequence number of the last enqueued task.
+  uint64_t completed_sequence_ = 0;  // Sequence number of the last finished task.
+  bool shutting_down_ = false;
+
+  std::thread worker_;  // Started last, after the members that it reads.
+};
+
+/// <summary>
+/// OrtSyncNotificationImpl for a SyncStream. Activating the notification records the producer's last task, and
+/// waiting for it waits for that task, either on ORT's thread or as a task of the consumer's stream.
+/// </summary>
+class SyncNotification : public OrtSyncNotificationImpl {
+ public:
+  SyncNotification(const OrtApi& ort_api, SyncStream& stream);
+
+ private:
+  static OrtStatus* ORT_API_CALL ActivateImpl(OrtSyncNotificationImpl* this_ptr) noexcept;
+  static OrtStatus* ORT_API_CALL WaitOnDeviceImpl(OrtSyncNotificationImpl* this_ptr,
+                                                  OrtSyncStream* consumer_stream) noexcept;
+  static OrtStatus* ORT_API_CALL WaitOnHostImpl(OrtSyncNotificationImpl* this_ptr) noexcept;
+  static void ORT_API_CALL ReleaseImpl(OrtSyncNotificationImpl* this_ptr) noexcept;
+
+  const OrtApi& ort_api_;
+  SyncStream& stream_;
+  uint64_t sequence_ = 0;  // Task of `stream_` to wait for. Set by Activate().
+};
@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  for (size_t i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+  }
+
+  work_available_.notify_all();
+
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t num_tasks, TaskFn fn, const void* context) {
+  std::unique_lock<std::mutex> loop_lock(loop_mutex_, std::try_to_lock);
+
+  if (!loop_lock.owns_lock() || workers_.empty() || num_tasks <= 1) {
+    for (size_t task = 0; task < num_tasks; ++task) {
+      fn(context, task);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = fn;
+    context_ = context;
+    num_tasks_ = num_tasks;
+    num_busy_workers_ = workers_.size();
+    next_task_.store(0, std::memory_order_relaxed);
+    ++loop_generation_;
+  }
+
+  work_available_.notify_all();
+  RunTasks();
+
+  // Wait for the workers to finish their tasks and to stop reading context_ before it goes out of scope.
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return num_busy_workers_ == 0; });
+  fn_ = nullptr;
+  context_ = nullptr;
+}
+
+void ThreadPool::RunTasks() {
+  for (size_t task = next_task_.fetch_add(1); task < num_tasks_; task = next_task_.fetch_add(1)) {
+    fn_(context_, task);
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  uint64_t last_generation = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [&]() { return shutting_down_ || loop_generation_ != last_generation; });
+
+      if (shutting_down_) {
+        return;
+      }
+
+      last_generation = loop_generation_;
+    }
+
+    RunTasks();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--num_busy_workers_ == 0) {
+        work_done_.notify_one();
+      }
+    }
+  }
+}
@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Fixed-size pool of worker threads that the basic plugin EP uses for intra-op parallelism.
+///
+/// Runs one parallel loop at a time. The calling thread takes part in the loop, so a pool for N threads has N - 1
+/// workers. A loop that is started while another one is running (e.g., by a concurrent Run() call) runs on its
+/// calling thread only, instead of waiting for the pool.
+/// </summary>
+class ThreadPool {
+ public:
+  /// <summary>
+  /// Creates a pool for `num_threads` threads, including the calling thread of each parallel loop.
+  /// </summary>
+  explicit ThreadPool(size_t num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t GetNumThreads() const { return workers_.size() + 1; }
+
+  /// <summary>
+  /// Calls `fn(task)` for every task in [0, num_tasks) and waits for all calls to finish. `fn` must not throw. `fn` is
+  /// called through a plain function pointer, so that starting a loop does not allocate.
+  /// </summary>
+  template <typename Fn>
+  void ParallelFor(size_t num_tasks, const Fn& fn) {
+    ParallelFor(num_tasks, [](const void* context, size_t task) { (*static_cast<const Fn*>(context))(task); }, &fn);
+  }
+
+ private:
+  using TaskFn = void (*)(const void* context, size_t task);
+
+  void ParallelFor(size_t num_tasks, TaskFn fn, const void* context);
+  void WorkerLoop();
+  void RunTasks();
+
+  std::vector<std::thread> workers_;
+
+  std::mutex loop_mutex_;  // Held by the thread that runs the current parallel loop.
+
+  std::mutex mutex_;  // Protects the members below.
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  TaskFn fn_ = nullptr;
+  const void* context_ = nullptr;
+  size_t num_tasks_ = 0;
+  size_t num_busy_workers_ = 0;
+  uint64_t loop_generation_ = 0;  // Incremented for each parallel loop.
+  bool shutting_down_ = false;
+
+  std::atomic<size_t> next_task_{0};
+};